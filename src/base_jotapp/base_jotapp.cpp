@@ -567,18 +567,11 @@ BaseJOTapp::load_png_file(const string &file)
 bool
 BaseJOTapp::load_obj_file(const string &file)
 {
-   // read an .obj file
-
-   ifstream obj_stream(file.c_str());
-   if (!obj_stream.is_open()) {
-      cerr << "BaseJOTapp::load_obj_file: error: couldn't open .obj file"
-           << endl;
-      return false;
-   }
+   // read an .obj file (mapped into memory, read on several threads)
 
    OBJReader reader;
-   if (!reader.read(obj_stream)) {
-      cerr << "BaseJOTapp::load_obj_file: error: couldn't understand .obj file"
+   if (!reader.read_file(file)) {
+      cerr << "BaseJOTapp::load_obj_file: error: couldn't read .obj file"
            << endl;
       return false;
    }
@@ -22,6 +22,10 @@
   Modified from ply2iv.c in Greg Turk's PLY 1-1 code:
     ftp://graphics.stanford.edu/pub/zippack/ply-1.1.tar.Z
 
+  The file is now read by BMESH::read_ply_data() (see
+  mesh/bmesh_ply.cpp), which loads binary PLY in bulk; meshes can
+  also load .ply files directly, without converting them.
+
   -------------------------------------------------------
 
   Copyright (c) 1998 Georgia Institute of Technology.
@@ -40,220 +44,46 @@
 
 #include "mesh/lmesh.hpp"
 
-#include "ply.hpp"
+#include <fstream>
 
 static bool debug = Config::get_var_bool("DEBUG_PLY2SM",false,true);
 
-/* vertex and face definitions for a polygonal object */
-
-typedef struct Vertex {
-   float x,y,z;
-   float r,g,b;
-   float nx,ny,nz;
-   void *other_props;       /* other properties */
-} Vertex;
-
-typedef struct Face {
-   unsigned char nverts;    /* number of vertex indices in list */
-   int *verts;              /* vertex index list */
-   void *other_props;       /* other properties */
-} Face;
-
-const char *elem_names[] = { /* list of the elements in the object */
-   "vertex", "face"
-};
-
-PlyProperty vert_props[] = { /* list of property information for a vertex */
-   {(char *)"x", Float32, Float32, offsetof(Vertex,x), 0, 0, 0, 0},
-   {(char *)"y", Float32, Float32, offsetof(Vertex,y), 0, 0, 0, 0},
-   {(char *)"z", Float32, Float32, offsetof(Vertex,z), 0, 0, 0, 0},
-   {(char *)"r", Float32, Float32, offsetof(Vertex,r), 0, 0, 0, 0},
-   {(char *)"g", Float32, Float32, offsetof(Vertex,g), 0, 0, 0, 0},
-   {(char *)"b", Float32, Float32, offsetof(Vertex,b), 0, 0, 0, 0},
-   {(char *)"nx", Float32, Float32, offsetof(Vertex,nx), 0, 0, 0, 0},
-   {(char *)"ny", Float32, Float32, offsetof(Vertex,ny), 0, 0, 0, 0},
-   {(char *)"nz", Float32, Float32, offsetof(Vertex,nz), 0, 0, 0, 0},
-};
-
-PlyProperty face_props[] = { /* list of property information for a face */
-   {(char *)"vertex_indices", Int32, Int32, offsetof(Face,verts),
-    1, Uint8, Uint8, offsetof(Face,nverts)},
-};
-
-
-/*** the PLY object ***/
-
-static int nverts=0,nfaces=0;
-static Vertex **vlist=nullptr;
-static Face **flist=nullptr;
-
-static PlyOtherProp *vert_other=nullptr,*face_other=nullptr;
-
-static int per_vertex_color = 0;
-static int has_normals = 0;
-
-
 /******************************************************************************
 Print out usage information.
 ******************************************************************************/
 void
 usage(char *progname)
 {
-   err_msg("usage: %s [flags] < in.ply > out.sm", progname);
+   err_msg("usage: %s [flags] [in.ply] > out.sm  (reads standard in if no file)",
+           progname);
+   err_msg("  -b  write the binary mesh format (see bmesh_binary.cpp)");
 }
 
 
 /******************************************************************************
-Read in the PLY file from standard in.
+Read in the PLY file, from the named file or from standard in. Vertices
+and faces go straight into the mesh (see BMESH::read_ply_data()).
 ******************************************************************************/
-void
-read_file()
-{
-   /*** Read in the original PLY object ***/
-
-   PlyFile *in_ply = read_ply (stdin);
-
-   for (int i = 0; i < in_ply->num_elem_types; i++) {
-
-      /* prepare to read the i'th list of elements */
-      int elem_count=0;
-      const char *elem_name = setup_element_read_ply (in_ply, i, &elem_count);
-
-      err_adv(debug, "%s: %d elements", elem_name, elem_count);
-
-      if (strcmp("vertex", elem_name) == 0) {
-
-         /* create a vertex list to hold all the vertices */
-         vlist = (Vertex **) malloc (sizeof (Vertex *) * elem_count);
-         nverts = elem_count;
-
-         /* set up for getting vertex elements */
-
-         setup_property_ply (in_ply, &vert_props[0]);
-         setup_property_ply (in_ply, &vert_props[1]);
-         setup_property_ply (in_ply, &vert_props[2]);
-
-         int j;
-         for (j = 0; j < in_ply->elems[i]->nprops; j++) {
-            PlyProperty *prop;
-            prop = in_ply->elems[i]->props[j];
-            if (strcmp("r", prop->name) == 0) {
-               setup_property_ply (in_ply, &vert_props[3]);
-               per_vertex_color = 1;
-            }
-            if (strcmp("g", prop->name) == 0) {
-               setup_property_ply (in_ply, &vert_props[4]);
-               per_vertex_color = 1;
-            }
-            if (strcmp("b", prop->name) == 0) {
-               setup_property_ply (in_ply, &vert_props[5]);
-               per_vertex_color = 1;
-            }
-            if (strcmp("nx", prop->name) == 0) {
-               setup_property_ply (in_ply, &vert_props[6]);
-               has_normals = 1;
-            }
-            if (strcmp("ny", prop->name) == 0) {
-               setup_property_ply (in_ply, &vert_props[7]);
-               has_normals = 1;
-            }
-            if (strcmp("nz", prop->name) == 0) {
-               setup_property_ply (in_ply, &vert_props[8]);
-               has_normals = 1;
-            }
-         }
-
-         vert_other = get_other_properties_ply (in_ply, 
-                                                offsetof(Vertex,other_props));
-
-         /* grab all the vertex elements */
-         for (j = 0; j < elem_count; j++) {
-            vlist[j] = (Vertex *) malloc (sizeof (Vertex));
-            vlist[j]->r = 1;
-            vlist[j]->g = 1;
-            vlist[j]->b = 1;
-            get_element_ply (in_ply, (void *) vlist[j]);
-         }
-      }
-      else if (strcmp("face", elem_name) == 0) {
-
-         /* create a list to hold all the face elements */
-         flist = (Face **) malloc (sizeof (Face *) * elem_count);
-         nfaces = elem_count;
-
-         /* set up for getting face elements */
-
-         setup_property_ply (in_ply, &face_props[0]);
-         face_other = get_other_properties_ply (in_ply, 
-                                                offsetof(Face,other_props));
-
-         /* grab all the face elements */
-         for (int j = 0; j < elem_count; j++) {
-            flist[j] = (Face *) malloc (sizeof (Face));
-            get_element_ply (in_ply, (void *) flist[j]);
-         }
-      }
-      else
-         get_other_element_ply (in_ply);
-   }
-
-   close_ply (in_ply);
-   free_ply (in_ply);
-}
-
-
-inline void
-add_face(LMESHptr& mesh, Face* f)
+LMESHptr
+read_file(const char* filename)
 {
-   assert(mesh && f);
-   switch (f->nverts) {
-    case 3:     // triangle
-      mesh->add_face(f->verts[2], f->verts[1], f->verts[0]);
-      break;
-    case 4:     // quad
-      mesh->add_quad(f->verts[3], f->verts[2], f->verts[1], f->verts[0]);
-      break;
-    default:    // other
-      // XXX - should fix this to convert to triangles
-      err_msg("ply2sm: can't add face: %d-gon", f->nverts);
-   }
+   LMESHptr mesh = make_shared<LMESH>();
+   BMESHptr ret = filename ?
+      BMESH::read_ply_file(filename, mesh) :
+      BMESH::read_ply_stream(cin, mesh);
+   return ret ? mesh : nullptr;
 }
 
 /******************************************************************************
 Write out a jot .sm file.
 ******************************************************************************/
 void
-write_sm()
+write_sm(LMESHptr mesh, bool binary)
 {
-   LMESHptr mesh = make_shared<LMESH>();
-   
    int i=0;
 
-   //******** Build the mesh ********
-
-   err_adv(debug, "read ply file: %d vertices, %d faces\n", nverts, nfaces);
-
-   err_adv(debug, "building mesh:");
-
-   // Add vertices to mesh
-   err_adv(debug, "  adding vertices...");
-   for (i = 0; i < nverts; i++)
-      mesh->add_vertex(Wpt(vlist[i]->x, vlist[i]->y, vlist[i]->z));
-   err_adv(debug, "  done\n");
-
-   // Add per-vertex colors if needed
-   if (per_vertex_color) {
-      err_adv(debug, "  adding colors...");
-      for (i = 0; i < nverts; i++)
-         mesh->bv(i)->set_color(COLOR(vlist[i]->r, vlist[i]->g, vlist[i]->b));
-      err_adv(debug, "  done\n");
-   }
-
-   // Add faces
-   err_adv(debug, "  adding faces...");
-   for (i = 0; i < nfaces; i++)
-      add_face(mesh, flist[i]);
-   err_adv(debug, "  done\n");
+   err_adv(debug, "read ply file: %d vertices, %d faces\n",
+           mesh->nverts(), mesh->nfaces());
 
    //******** Filter the mesh ********
 
@@ -291,7 +121,10 @@ write_sm()
    //******** Write mesh ********
 
    err_adv(debug, "writing mesh...");
-   mesh->write_stream(cout);
+   if (binary)
+      mesh->write_binary_stream(cout);
+   else
+      mesh->write_stream(cout);
    err_adv(debug, "done\n");
 }
 
@@ -303,24 +136,34 @@ main(int argc, char *argv[])
 {
    char *s;
    char *progname;
+   bool binary = false;
 
    progname = argv[0];
 
    while (--argc > 0 && (*++argv)[0]=='-') {
       for (s = argv[0]+1; *s; s++)
          switch (*s) {
+          case 'b':
+            binary = true;
+            break;
           default:
             usage (progname);
             exit (-1);
             break;
          }
    }
+   if (argc > 1) {
+      usage (progname);
+      exit (-1);
+   }
 
    err_adv(debug, "reading ply file...");
-   read_file();
+   LMESHptr mesh = read_file(argc == 1 ? argv[0] : nullptr);
+   if (!mesh)
+      return 1;
    err_adv(debug, "done\n");
 
-   write_sm();
+   write_sm(mesh, binary);
 
    return 0;
 }
@@ -84,6 +84,9 @@ class IVNormalIterator : public StripCB {
    public:
       IVNormalIterator(Formatter *form) : _form(form) {}
 
+      // (one normal per strip vertex, to match write_strips())
+      virtual bool needs_tri_strips() const { return true; }
+
       virtual void faceCB(CBvert *, CBface *f) {
          char tmp[64];
          CWvec &norm = f->norm();
@@ -138,6 +141,7 @@ class IVTriStripIterator : public StripCB {
          _form->write("-1");
          if (_left) _form->write(comma);
       }
+      virtual bool needs_tri_strips() const { return true; }
       void set_left(int left) { _left = left;}
 };
 
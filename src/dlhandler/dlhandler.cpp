@@ -53,11 +53,23 @@ DLhandler::DLhandler()
 int
 DLhandler::dl(CVIEWptr &v)  const
 {
-   const int view_id = dl_per_view ? v->view_id() : 0;
+   const int view_id = context_id(v);
    return _dl_array[view_id];
 }
 
 
+/***********************************************************************
+ * Method : DLhandler::context_id
+ * Params : 
+ * Returns: int
+ * Effects: 
+ ***********************************************************************/
+int
+DLhandler::context_id(CVIEWptr &v)
+{
+   return dl_per_view ? v->view_id() : 0;
+}
+
 /***********************************************************************
  * Method : DLhandler::valid
  * Params : 
@@ -67,7 +79,7 @@ DLhandler::dl(CVIEWptr &v)  const
 bool
 DLhandler::valid(CVIEWptr &v, int cmp_stamp) const
 {
-   const int view_id = dl_per_view ? v->view_id() : 0;
+   const int view_id = context_id(v);
    ((DLhandler *) this)->make_dl_stamp_big_enough(view_id);
    return ((_dl_stamp_array[view_id] != -1) && 
            (_dl_stamp_array[view_id] >= cmp_stamp));
@@ -99,7 +111,7 @@ DLhandler::invalidate()
 int
 DLhandler::get_dl(CVIEWptr &v, int num_dls, int set_stamp) 
 {
-   const int view_id = dl_per_view ? v->view_id() : 0;
+   const int view_id = context_id(v);
 
    // If we're all set, don't panic:
    if (valid(v, set_stamp))
@@ -138,7 +150,7 @@ DLhandler::close_dl(CVIEWptr &)
 void
 DLhandler::delete_dl(CVIEWptr &v)
 {
-   const int view_id = dl_per_view ? v->view_id() : 0;
+   const int view_id = context_id(v);
    if (0 <= view_id && view_id < (int)_dl_array.size()) {
       if (_dl_array[view_id]) {
          glDeleteLists(_dl_array[view_id], 1);
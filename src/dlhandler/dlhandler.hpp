@@ -50,6 +50,11 @@ class DLhandler {
       int  get_dl  (CVIEWptr &v, int num_dls=1, int set_stamp = 1);
       // Close display list
       void close_dl(CVIEWptr &v);
+
+      // Which GL context v draws in: its own with JOT_MULTITHREAD or
+      // JOT_DL_PER_VIEW, else the one all views share. Other per-context
+      // GL objects (e.g. PatchBuffers) are kept by this number too:
+      static int context_id(CVIEWptr &v);
       
    protected:
       vector<int> _dl_array;
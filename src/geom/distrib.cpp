@@ -638,6 +638,9 @@ DISTRIB::load_stream(
                  header.c_str());
          err_adv(debug,
                  "DISTRIB::load_stream: Attempting conventional load...");
+         // Read the external files the scene names on several
+         // threads first; decoding it below takes the results:
+         IOManager::prefetch(s.name());
          ret = load(s);
          if (!ret)
          {
@@ -20,6 +20,7 @@
  *****************************************************************/
 #include <fstream>
 #include "std/config.hpp"
+#include "net/io_manager.hpp"
 #include "geom/image.hpp"
 
 /*****************************************************************
@@ -35,6 +36,19 @@ eat_whitespace(istream& in)
    }
 }
 
+// Decodes .png files named in a scene before it's decoded (see
+// IOManager::prefetch()); load_file() then takes the result:
+static shared_ptr<void>
+prefetch_png(const string& path)
+{
+   shared_ptr<Image> img = make_shared<Image>();
+   if (!img->read_png(path))
+      return nullptr;
+   return img;
+}
+static bool prefetch_png_added =
+   (IOManager::add_prefetch_ext(".png", prefetch_png), true);
+
 /******************************************************************
  * Image
  ******************************************************************/
@@ -230,6 +244,16 @@ Image::load_file(const string &file)
    if (file.empty())
       return 0;
 
+   // use the image decoded ahead of time, if any
+   // (taking its data):
+   shared_ptr<Image> img =
+      static_pointer_cast<Image>(IOManager::take_prefetched(file));
+   if (img && !img->empty()) {
+      set(img->_width, img->_height, img->_bpp, img->_data, img->_no_delete);
+      img->_data = nullptr;
+      return 1;
+   }
+
    // see if file can be opened before running off parsing...
    {
 #if (defined (WIN32) && defined(_MSC_VER) && (_MSC_VER <=1300)) /*VS 6.0*/
@@ -22,6 +22,7 @@
 #include "mesh/gtexture.hpp"
 #include "std/config.hpp"
 #include "gtex/util.hpp"
+#include "gtex/patch_buffers.hpp"
 
 /**********************************************************************
  *
@@ -100,7 +101,8 @@ class OGLTexture : public GTexture {
  * BasicTexture:
  *
  *   Base class for "procedural textures" that keep and manage a
- *   display list.
+ *   display list, or vertex buffers (see PatchBuffers) for those
+ *   whose triangles can be drawn from them.
  **********************************************************************/
 class BasicTexture : public OGLTexture {
  public:
@@ -119,9 +121,18 @@ class BasicTexture : public OGLTexture {
    // Returns 1 if display list is used to draw, 0 otherwise
    virtual int dl_valid(CVIEWptr& v);
 
+   // Draw the patch's triangles in view v from vertex buffers
+   // holding what a StripCB of the given kind would send; returns
+   // false (drawing nothing) if they can't be used, so the caller
+   // should draw the triangle strips instead:
+   bool draw_buffers(CVIEWptr& v, PatchBuffers::layout_t l) {
+      return _buffers.draw(v, _patch, l, alpha());
+   }
+
 
  protected:
    DLhandler    _dl;
+   PatchBuffers _buffers;
 
    void delete_dl() {
       _dl.delete_all_dl();
@@ -19,6 +19,8 @@
 #include "color_id_texture.hpp"
 #include "ref_image.hpp"
 
+#include <typeinfo>
+
 /**********************************************************************
  * ColorIDStripCB:
  **********************************************************************/
@@ -102,8 +104,11 @@ ColorIDTexture::draw(CVIEWptr& v)
    }
 
    // draw triangles and/or polyline strips
-   // use a display list if it's valid:
-   if (!BasicTexture::draw(v)) {
+   // use vertex buffers if possible, or a display list if it's valid:
+   if (typeid(*_cb) == typeid(ColorIDStripCB) &&
+       draw_buffers(v, PatchBuffers::ID_COLORS)) {
+      glPopAttrib();
+   } else if (!BasicTexture::draw(v)) {
 
       int dl = _dl.get_dl(v, 1, _patch->stamp());
       if (dl)
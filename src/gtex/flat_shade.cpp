@@ -32,6 +32,8 @@
 
 #include "flat_shade.hpp"
 
+#include <typeinfo>
+
 bool FlatShadeTexture::_debug_uv = false;
 
 static bool debug = Config::get_var_bool("DEBUG_DEBUG_UV",false);
@@ -180,8 +182,19 @@ FlatShadeTexture::draw(CVIEWptr& v)
    // Set material parameters for OGL:
    GtexUtil::setup_material(_patch);
 
+   // Without texture coordinates, draw from vertex buffers
+   // if possible:
+   bool texcoords = ((_debug_uv && _debug_uv_tex) ||
+                     (_has_uv_coords && _patch->has_texture()));
+   bool drawn = false;
+   if (!texcoords && typeid(*_cb) == typeid(FlatShadeStripCB)) {
+      if (!set_face_culling()) 
+         glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);  // GL_LIGHTING_BIT
+      drawn = draw_buffers(v, PatchBuffers::FLAT_SHADE);
+   }
+
    // Try for the display list if it's valid
-   if (!(_debug_uv == _debug_uv_in_dl && BasicTexture::draw(v))) {
+   if (!drawn && !(_debug_uv == _debug_uv_in_dl && BasicTexture::draw(v))) {
 
       // Try to generate a display list
       int dl = _dl.get_dl(v, 1, _patch->stamp());
@@ -197,8 +210,7 @@ FlatShadeTexture::draw(CVIEWptr& v)
       FlatShadeStripCB *flat_cb = dynamic_cast<FlatShadeStripCB*>(_cb);
       if (flat_cb) {
          // send texture coordinates?
-         if ((_debug_uv && _debug_uv_tex) ||
-             (_has_uv_coords && _patch->has_texture())) {
+         if (texcoords) {
             flat_cb->enable_texcoords();
          } else {
             flat_cb->disable_texcoords();
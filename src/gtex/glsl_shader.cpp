@@ -549,9 +549,11 @@ GLSLShader::draw(CVIEWptr& v)
       GL_VIEW_PRINT_GL_ERRORS(class_name() + "::draw: set uniform variables");
    }
 
-   // now draw the triangles using a display list.
-   // execute display list if it's valid:
-   if (BasicTexture::dl_valid(v)) {
+   // now draw the triangles from vertex buffers, or using a
+   // display list. execute display list if it's valid:
+   if (draw_triangle_buffers(v)) {
+      // done
+   } else if (BasicTexture::dl_valid(v)) {
       BasicTexture::draw(v);
    } else {
       // try to generate a display list
@@ -24,6 +24,8 @@
 #include "basic_texture.hpp"
 #include "perlin.hpp" //header file still included so it can use the namespace
 
+#include <typeinfo>
+
 /**********************************************************************
  * GLSLShader:
  *
@@ -136,6 +138,16 @@ class GLSLShader : public BasicTexture { //no longer derived from Perlin
       _patch->draw_tri_strips(_cb);
    }
 
+   // Or, if the StripCB is a plain VertNormStripCB, draw them from
+   // vertex buffers (see PatchBuffers) in place of a display list
+   // of draw_triangles(). Returns false if they weren't drawn. If
+   // a subclass draws something else in draw_triangles() with a
+   // VertNormStripCB, it should override this to return false:
+   virtual bool draw_triangle_buffers(CVIEWptr& v) {
+      return (typeid(*_cb) == typeid(VertNormStripCB) &&
+              draw_buffers(v, PatchBuffers::VERT_NORMALS));
+   }
+
    // Calls glPopAttrib():
    virtual void restore_gl_state() const;
 
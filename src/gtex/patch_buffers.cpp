@@ -0,0 +1,383 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "gtex/gl_extensions.hpp"
+#include "std/config.hpp"
+#include "dlhandler/dlhandler.hpp"
+#include "ref_image.hpp"
+#include "patch_buffers.hpp"
+
+#include <cstring>
+
+// changed vertices this close together are sent as one range:
+static const int RANGE_GAP = 16;
+
+int                      PatchBuffers::_use_buffers = -1;
+vector<vector<GLuint> >  PatchBuffers::_dead;
+ThreadMutex              PatchBuffers::_dead_mutex;
+
+bool
+PatchBuffers::use_buffers()
+{
+   if (_use_buffers < 0)
+      _use_buffers = Config::get_var_bool("JOT_USE_VERTEX_BUFFERS",true) ? 1 : 0;
+   return _use_buffers == 1 && GLEW_VERSION_1_5;
+}
+
+bool
+PatchBuffers::draw(CVIEWptr& v, Patch* p, layout_t layout, double alpha)
+{
+   if (!p || !use_buffers())
+      return false;
+
+   int c = DLhandler::context_id(v);
+   delete_dead(c);
+   Buffers* b;
+   {
+      CriticalSection cs(&_mutex);
+      if ((int)_bufs.size() <= c)
+         _bufs.resize(c + 1, nullptr);
+      if (!_bufs[c])
+         _bufs[c] = new Buffers;
+      b = _bufs[c];
+   }
+   _last = b;
+   return b->draw(p, layout, alpha);
+}
+
+void
+PatchBuffers::delete_buffers()
+{
+   CriticalSection cs(&_mutex);
+   for (size_t c = 0; c < _bufs.size(); c++) {
+      if (!_bufs[c])
+         continue;
+      vector<GLuint> names;
+      _bufs[c]->release(names);
+      delete _bufs[c];
+      _bufs[c] = nullptr;
+      if (!names.empty()) {
+         CriticalSection dcs(&_dead_mutex);
+         if (_dead.size() <= c)
+            _dead.resize(c + 1);
+         _dead[c].insert(_dead[c].end(), names.begin(), names.end());
+      }
+   }
+   _last = nullptr;
+}
+
+void
+PatchBuffers::delete_dead(int c)
+{
+   vector<GLuint> names;
+   {
+      CriticalSection cs(&_dead_mutex);
+      if (c < (int)_dead.size())
+         names.swap(_dead[c]);
+   }
+   if (!names.empty())
+      glDeleteBuffers(names.size(), &names[0]);
+}
+
+/**********************************************************************
+ * PatchBuffers::Buffers
+ **********************************************************************/
+PatchBuffers::Buffers::Buffers() :
+   _layout(FLAT_SHADE),
+   _list(nullptr),
+   _list_stamp(0),
+   _patch_stamp(0),
+   _alpha(1),
+   _has_colors(false),
+   _valid(false),
+   _num_verts(0),
+   _ibo(0),
+   _uploaded_bytes(0),
+   _uploaded_ranges(0)
+{
+   for (int a = 0; a < NUM_ARRAYS; a++)
+      _vbo[a] = 0;
+}
+
+void
+PatchBuffers::Buffers::release(vector<GLuint>& names)
+{
+   for (int a = 0; a < NUM_ARRAYS; a++) {
+      if (_vbo[a])
+         names.push_back(_vbo[a]);
+      _vbo[a] = 0;
+   }
+   if (_ibo)
+      names.push_back(_ibo);
+   _ibo = 0;
+   _valid = false;
+}
+
+bool
+PatchBuffers::Buffers::has(int a) const
+{
+   switch (a) {
+    case POS:   return true;
+    case NORM:  return _layout != ID_COLORS;
+    case COL:   return _layout == ID_COLORS || _has_colors;
+   }
+   return false;
+}
+
+bool
+PatchBuffers::Buffers::draw(Patch* p, layout_t layout, double alpha)
+{
+   if (!p || !use_buffers())
+      return false;
+   const TriList* list = p->cur_tri_list();
+   if (!list)
+      return false;
+
+   _uploaded_bytes = _uploaded_ranges = 0;
+
+   // New faces (or different attributes) mean new buffers;
+   // anything else that changed the patch may have changed values:
+   bool rebuild = (!_valid || list != _list ||
+                   list->stamp() != _list_stamp || layout != _layout);
+   uint stamp = p->stamp();
+   if (rebuild || stamp != _patch_stamp || alpha != _alpha ||
+       p->color() != _color) {
+      // vertex colors are sent only if some vertex has one:
+      bool cols = false;
+      if (layout == FLAT_SHADE || layout == SMOOTH_SHADE)
+         for (auto& v : list->verts())
+            if ((cols = v->has_color()))
+               break;
+      if (cols != _has_colors)
+         rebuild = true;
+      _layout     = layout;
+      _has_colors = cols;
+      _alpha      = alpha;
+      _color      = p->color();
+
+      vector<float> corner[NUM_ARRAYS], vals[NUM_ARRAYS];
+      corner_vals(p, *list, corner);
+      if (rebuild || !gather(corner, vals)) {
+         build(*list, corner);
+      } else {
+         upload(vals);
+      }
+      _list        = list;
+      _list_stamp  = list->stamp();
+      _patch_stamp = stamp;
+   }
+   if (_index.empty())
+      return true;
+
+   glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+   glBindBuffer(GL_ARRAY_BUFFER, _vbo[POS]);
+   glVertexPointer(3, GL_FLOAT, 0, nullptr);
+   glEnableClientState(GL_VERTEX_ARRAY);
+   if (has(NORM)) {
+      glBindBuffer(GL_ARRAY_BUFFER, _vbo[NORM]);
+      glNormalPointer(GL_FLOAT, 0, nullptr);
+      glEnableClientState(GL_NORMAL_ARRAY);
+   }
+   if (has(COL)) {
+      glBindBuffer(GL_ARRAY_BUFFER, _vbo[COL]);
+      glColorPointer(4, GL_FLOAT, 0, nullptr);
+      glEnableClientState(GL_COLOR_ARRAY);
+   }
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+   glDrawElements(GL_TRIANGLES, _index.size(), GL_UNSIGNED_INT, nullptr);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   glPopClientAttrib();
+
+   return true;
+}
+
+void
+PatchBuffers::Buffers::corner_vals(Patch* p, const TriList& list, vector<float>* vals) const
+{
+   // What FlatShadeStripCB, SmoothShadeStripCB, VertNormStripCB
+   // or ColorIDStripCB sends for each corner, in drawing order.
+   // GL keeps the current color until a vertex sets one, so
+   // vertices without colors get the last color sent (starting
+   // with the patch color the textures set first):
+
+   int nc = list.indices().size();
+   for (int a = 0; a < NUM_ARRAYS; a++)
+      if (has(a))
+         vals[a].resize(nc*width(a));
+
+   float4 cur(p->color(), _alpha);
+   Wvec n;
+   for (int k = 0; k < nc; k++) {
+      Bvert* v = list.verts()[list.indices()[k]];
+      Bface* f = list.faces()[k/3];
+      float* pos = &vals[POS][3*k];
+      for (int j = 0; j < 3; j++)
+         pos[j] = (float)v->loc()[j];
+
+      if (has(NORM)) {
+         if (_layout == FLAT_SHADE)
+            n = f->norm();
+         else
+            f->vert_normal(v, n);
+         float* nrm = &vals[NORM][3*k];
+         for (int j = 0; j < 3; j++)
+            nrm[j] = (float)n[j];
+      }
+      if (has(COL)) {
+         float* col = &vals[COL][4*k];
+         if (_layout == ID_COLORS) {
+            uint rgba = IDRefImage::key_to_rgba(f->key());
+            GLubyte* c = (GLubyte*)&rgba;
+            for (int j = 0; j < 4; j++)
+               col[j] = c[j]/255.0f;
+         } else {
+            if (v->has_color())
+               cur = float4(v->color(), _alpha*v->alpha());
+            memcpy(col, (const float*)cur, 4*sizeof(float));
+         }
+      }
+   }
+}
+
+void
+PatchBuffers::Buffers::build(const TriList& list, vector<float>* corner)
+{
+   // Corners of the same vertex share a buffer vertex when all
+   // their values agree. Buffer vertices of each mesh vertex are
+   // chained through next[], starting at first[]:
+
+   int nc = list.indices().size();
+   vector<int> first(list.verts().size(), -1), next, src;
+   _index.resize(nc);
+   for (int k = 0; k < nc; k++) {
+      int& head = first[list.indices()[k]];
+      int b = head;
+      for ( ; b >= 0; b = next[b]) {
+         bool same = true;
+         for (int a = 0; same && a < NUM_ARRAYS; a++) {
+            int w = width(a);
+            same = !has(a) || !memcmp(&corner[a][w*k], &corner[a][w*src[b]],
+                                      w*sizeof(float));
+         }
+         if (same)
+            break;
+      }
+      if (b < 0) {
+         b = src.size();
+         src.push_back(k);
+         next.push_back(head);
+         head = b;
+      }
+      _index[k] = b;
+   }
+   _num_verts = src.size();
+   _valid = true;
+   if (nc == 0) {
+      for (int a = 0; a < NUM_ARRAYS; a++)
+         _vals[a].clear();
+      return;
+   }
+
+   // send everything:
+   if (!_ibo)
+      glGenBuffers(1, &_ibo);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, nc*sizeof(int), &_index[0],
+                GL_STATIC_DRAW);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+   _uploaded_bytes  = nc*sizeof(int);
+   _uploaded_ranges = 1;
+
+   for (int a = 0; a < NUM_ARRAYS; a++) {
+      _vals[a].clear();
+      if (!has(a))
+         continue;
+      int w = width(a);
+      _vals[a].resize(_num_verts*w);
+      for (int b = 0; b < _num_verts; b++)
+         memcpy(&_vals[a][w*b], &corner[a][w*src[b]], w*sizeof(float));
+
+      if (!_vbo[a])
+         glGenBuffers(1, &_vbo[a]);
+      glBindBuffer(GL_ARRAY_BUFFER, _vbo[a]);
+      glBufferData(GL_ARRAY_BUFFER, _vals[a].size()*sizeof(float),
+                   &_vals[a][0], GL_DYNAMIC_DRAW);
+      _uploaded_bytes += _vals[a].size()*sizeof(float);
+      _uploaded_ranges++;
+   }
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool
+PatchBuffers::Buffers::gather(vector<float>* corner, vector<float>* vals) const
+{
+   int nc = _index.size();
+   vector<bool> seen(_num_verts, false);
+   for (int a = 0; a < NUM_ARRAYS; a++)
+      if (has(a))
+         vals[a].resize(_num_verts*width(a));
+
+   for (int k = 0; k < nc; k++) {
+      int b = _index[k];
+      for (int a = 0; a < NUM_ARRAYS; a++) {
+         if (!has(a))
+            continue;
+         int w = width(a);
+         if (!seen[b])
+            memcpy(&vals[a][w*b], &corner[a][w*k], w*sizeof(float));
+         else if (memcmp(&vals[a][w*b], &corner[a][w*k], w*sizeof(float)))
+            return false;
+      }
+      seen[b] = true;
+   }
+   return true;
+}
+
+void
+PatchBuffers::Buffers::upload(vector<float>* vals)
+{
+   for (int a = 0; a < NUM_ARRAYS; a++) {
+      if (!has(a))
+         continue;
+      int w = width(a);
+      size_t bytes = w*sizeof(float);
+      glBindBuffer(GL_ARRAY_BUFFER, _vbo[a]);
+      int b = 0;
+      while (b < _num_verts) {
+         // find the next run of changed vertices, allowing gaps
+         // of up to RANGE_GAP unchanged ones:
+         while (b < _num_verts &&
+                !memcmp(&vals[a][w*b], &_vals[a][w*b], bytes))
+            b++;
+         if (b == _num_verts)
+            break;
+         int start = b, end = b + 1;
+         for (b++; b < _num_verts && b - end <= RANGE_GAP; b++)
+            if (memcmp(&vals[a][w*b], &_vals[a][w*b], bytes))
+               end = b + 1;
+         b = end;
+
+         glBufferSubData(GL_ARRAY_BUFFER, start*bytes, (end - start)*bytes,
+                         &vals[a][w*start]);
+         _uploaded_bytes += (end - start)*bytes;
+         _uploaded_ranges++;
+      }
+      _vals[a].swap(vals[a]);
+   }
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
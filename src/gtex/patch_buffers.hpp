@@ -0,0 +1,161 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef PATCH_BUFFERS_H_IS_INCLUDED
+#define PATCH_BUFFERS_H_IS_INCLUDED
+
+#include "geom/gl_util.hpp"
+#include "mesh/patch.hpp"
+#include "std/thread_mutex.hpp"
+
+#include <vector>
+
+/**********************************************************************
+ * PatchBuffers:
+ *
+ *    Retained vertex and index buffers holding a patch's triangles,
+ *    in place of a display list of StripCB calls. The triangles
+ *    come from the patch's TriList (Patch::cur_tri_list()), in the
+ *    same order and with the same attribute values the matching
+ *    StripCB would send, so the results are the same pixels.
+ *
+ *    Each buffer vertex is one mesh vertex with one set of
+ *    attributes; a vertex whose corners need different normals or
+ *    colors (e.g. at creases, or with face normals) gets one
+ *    buffer vertex per distinct set.
+ *
+ *    Changes to the faces (a new TriList) rebuild the buffers.
+ *    Other changes (vertices moved, colors, alpha) recompute the
+ *    attributes and upload only the ranges of buffer vertices
+ *    whose values changed.
+ *
+ *    Like display lists (see DLhandler), buffers are kept per GL
+ *    context (DLhandler::context_id()). Buffers are only deleted
+ *    while their context is current: delete_buffers() (and the
+ *    destructor) hand them over, and the next draw() in that
+ *    context deletes them.
+ *
+ *    Used by BasicTexture subclasses (see BasicTexture::draw_buffers()).
+ **********************************************************************/
+class PatchBuffers {
+ public:
+   // Which attributes to send, matching the StripCB they stand in for:
+   enum layout_t {
+      FLAT_SHADE = 0,   // face normals, vertex colors (FlatShadeStripCB)
+      SMOOTH_SHADE,     // vertex normals, vertex colors (SmoothShadeStripCB)
+      VERT_NORMALS,     // vertex normals (VertNormStripCB)
+      ID_COLORS         // face key colors (ColorIDStripCB)
+   };
+
+   //******** MANAGERS ********
+   PatchBuffers() : _last(nullptr) {}
+   ~PatchBuffers() { delete_buffers(); }
+
+   //******** DRAWING ********
+
+   // Draw the triangles of p (the patch of a GTexture) in view v with
+   // the given attributes. Vertex colors (when the layout has them)
+   // are sent with the given alpha. Returns false, drawing nothing, if
+   // the buffers can't be used (see use_buffers()) or p doesn't draw a
+   // triangle list:
+   bool draw(CVIEWptr& v, Patch* p, layout_t layout, double alpha = 1);
+
+   // Use vertex buffers where possible. Set with JOT_USE_VERTEX_BUFFERS
+   // (default: on); needs OpenGL 1.5:
+   static bool use_buffers();
+   static void set_use_buffers(bool b) { _use_buffers = b ? 1 : 0; }
+
+   //******** STATISTICS ********
+   // Of the buffers used by the last draw():
+   int  num_verts()              const { return _last ? _last->_num_verts : 0; }
+   int  num_indices()            const { return _last ? _last->_index.size() : 0; }
+
+   // bytes sent to OpenGL by the last draw(), and in how many ranges:
+   int  uploaded_bytes()         const { return _last ? _last->_uploaded_bytes  : 0; }
+   int  uploaded_ranges()        const { return _last ? _last->_uploaded_ranges : 0; }
+
+   //******** RELEASING ********
+   // Give up the buffers of every context; each context's are deleted
+   // by the next draw() there, so no context need be current:
+   void delete_buffers();
+
+ protected:
+   enum { POS = 0, NORM, COL, NUM_ARRAYS };
+
+   // The buffers of one GL context, and the values sent to them:
+   class Buffers {
+    public:
+      Buffers();
+
+      bool draw(Patch* p, layout_t layout, double alpha);
+
+      // Hand over the buffer names, to be deleted in their context:
+      void release(vector<GLuint>& names);
+
+      layout_t      _layout;
+      const TriList* _list;        // list the buffers were built from
+      uint          _list_stamp;   // its stamp then
+      uint          _patch_stamp;  // patch stamp of the current values
+      double        _alpha;        // alpha of the current values
+      COLOR         _color;        // patch color then
+      bool          _has_colors;   // whether vertex colors are sent
+      bool          _valid;
+
+      int           _num_verts;    // buffer vertices
+      vector<int>   _index;        // buffer vertex of each corner
+      vector<float> _vals[NUM_ARRAYS];  // current values, 3 or 4 per vertex
+
+      GLuint        _vbo[NUM_ARRAYS];
+      GLuint        _ibo;
+
+      int           _uploaded_bytes;
+      int           _uploaded_ranges;
+
+    protected:
+      int  width(int a)             const { return a == COL ? 4 : 3; }
+      bool has(int a)               const;
+
+      // Attribute values of every corner, as the StripCB would send them:
+      void corner_vals(Patch* p, const TriList& list, vector<float>* vals) const;
+
+      // Share buffer vertices among corners of a vertex with equal
+      // values, and send all the buffers:
+      void build(const TriList& list, vector<float>* corner);
+
+      // Values of each buffer vertex, or false if the corners that
+      // share a buffer vertex no longer agree:
+      bool gather(vector<float>* corner, vector<float>* vals) const;
+
+      // Send the ranges of buffer vertices whose values changed:
+      void upload(vector<float>* vals);
+   };
+
+   vector<Buffers*> _bufs;      // by DLhandler::context_id()
+   Buffers*         _last;      // used by the last draw()
+   ThreadMutex      _mutex;     // guards _bufs
+
+   // Buffer names given up, by context, to be deleted there:
+   static vector<vector<GLuint> > _dead;
+   static ThreadMutex             _dead_mutex;
+
+   static int    _use_buffers;  // -1 until read from config
+
+   // Delete the buffers given up in context c (which is current):
+   static void delete_dead(int c);
+};
+
+#endif // PATCH_BUFFERS_H_IS_INCLUDED
@@ -29,6 +29,8 @@
 
 #include "smooth_shade.hpp"
 
+#include <typeinfo>
+
 /**********************************************************************
  * SmoothShadeStripCB:
  **********************************************************************/
@@ -97,6 +99,18 @@ SmoothShadeTexture::draw(CVIEWptr& v)
    GL_MAT_COLOR(GL_FRONT_AND_BACK, GL_SPECULAR, _patch->specular_color(), alpha());
    glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, static_cast<GLfloat>(_patch->shininess()));
 
+   // without texture coordinates, draw from vertex buffers
+   // if possible:
+   if (!_patch->has_texture() &&
+       typeid(*_cb) == typeid(SmoothShadeStripCB)) {
+      if (!set_face_culling())
+         glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);  // GL_LIGHTING_BIT
+      if (draw_buffers(v, PatchBuffers::SMOOTH_SHADE)) {
+         glPopAttrib();
+         return _patch->num_faces();
+      }
+   }
+
    // execute display list if it's valid:
    if (BasicTexture::dl_valid(v)) {
       BasicTexture::draw(v);
@@ -0,0 +1,325 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_patch_buffers.cpp:
+ *
+ *    Regression test for PatchBuffers. Draws a subdivided, creased,
+ *    partly colored icosahedron offscreen (EGL pbuffers) for each
+ *    attribute layout, once from vertex buffers and once through
+ *    the matching StripCB, and checks the pixels are identical.
+ *    Over several frames a vertex moves and colors change, so
+ *    partial uploads are checked too.
+ *
+ *    Two views draw, each in its own context. With JOT_DL_PER_VIEW
+ *    the contexts share nothing, so each view needs its own buffers;
+ *    otherwise they share objects, as jot's views do. Buffers given
+ *    up with no context current must be deleted by the next draw()
+ *    in their context.
+ *
+ *    Exits with 77 (skipped) if no OpenGL context can be made.
+ **********************************************************************/
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "disp/view.hpp"
+#include "dlhandler/dlhandler.hpp"
+#include "geom/gl_view.hpp"
+#include "gtex/color_id_texture.hpp"
+#include "gtex/flat_shade.hpp"
+#include "gtex/smooth_shade.hpp"
+#include "gtex/util.hpp"
+#include "gtex/patch_buffers.hpp"
+#include "mesh/lmesh.hpp"
+#include "std/config.hpp"
+
+#include <cstring>
+
+using namespace mlib;
+
+static const int SIZE   = 128;
+static const int FRAMES = 4;
+static const int SKIP   = 77;
+
+static int num_failed = 0;
+
+static void
+check(bool ok, const string& what)
+{
+   if (!ok) {
+      cerr << "FAILED: " << what << endl;
+      num_failed++;
+   }
+}
+
+/*****************************************************************
+ * Offscreen contexts
+ *****************************************************************/
+static EGLDisplay display = EGL_NO_DISPLAY;
+static EGLConfig  config;
+
+static bool
+init_egl()
+{
+   // A display server may not be running; Mesa can do without:
+   EGLint major, minor;
+   display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+   if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+      display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                      EGL_DEFAULT_DISPLAY, nullptr);
+      if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+         return false;
+#else
+      return false;
+#endif
+   }
+   EGLint attribs[] = {
+      EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+      EGL_RED_SIZE,        8,
+      EGL_GREEN_SIZE,      8,
+      EGL_BLUE_SIZE,       8,
+      EGL_ALPHA_SIZE,      8,
+      EGL_DEPTH_SIZE,      24,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_NONE
+   };
+   EGLint n = 0;
+   return (eglBindAPI(EGL_OPENGL_API) &&
+           eglChooseConfig(display, attribs, &config, 1, &n) && n == 1);
+}
+
+struct context_t {
+   EGLSurface _surf;
+   EGLContext _ctx;
+   VIEWptr    _view;
+
+   bool make(EGLContext share) {
+      EGLint size[] = { EGL_WIDTH, SIZE, EGL_HEIGHT, SIZE, EGL_NONE };
+      _surf = eglCreatePbufferSurface(display, config, size);
+      _ctx  = eglCreateContext(display, config, share, nullptr);
+      return _surf != EGL_NO_SURFACE && _ctx != EGL_NO_CONTEXT;
+   }
+   bool make_current() {
+      return eglMakeCurrent(display, _surf, _surf, _ctx);
+   }
+};
+
+static void
+release_current()
+{
+   eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+/*****************************************************************
+ * Drawing
+ *****************************************************************/
+
+// Opens access to the buffer names, for the deletion checks:
+class TestBuffers : public PatchBuffers {
+ public:
+   vector<GLuint> names(int c) const {
+      vector<GLuint> ret;
+      if (c < (int)_bufs.size() && _bufs[c]) {
+         for (auto& vbo : _bufs[c]->_vbo)
+            if (vbo)
+               ret.push_back(vbo);
+         if (_bufs[c]->_ibo)
+            ret.push_back(_bufs[c]->_ibo);
+      }
+      return ret;
+   }
+};
+
+static void
+setup_gl(PatchBuffers::layout_t layout, Patch* p)
+{
+   glViewport(0, 0, SIZE, SIZE);
+   glClearColor(0.2f, 0.3f, 0.4f, 1);
+   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+   glEnable(GL_DEPTH_TEST);
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   glOrtho(-1.2, 1.2, -1.2, 1.2, -2, 2);
+   glMatrixMode(GL_MODELVIEW);
+   glLoadIdentity();
+   glRotated(30, 1, 1, 0);
+
+   if (layout == PatchBuffers::ID_COLORS) {
+      glDisable(GL_LIGHTING);
+   } else {
+      GLfloat pos[] = { 1, 2, 3, 0 };
+      glLightfv(GL_LIGHT0, GL_POSITION, pos);
+      glEnable(GL_LIGHT0);
+      glEnable(GL_LIGHTING);
+      glEnable(GL_COLOR_MATERIAL);
+   }
+   // as the textures do before drawing:
+   GL_COL(p->color(), 1);
+}
+
+static vector<GLubyte>
+read_pixels()
+{
+   vector<GLubyte> ret(SIZE*SIZE*4);
+   glFinish();
+   glReadPixels(0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, &ret[0]);
+   return ret;
+}
+
+static StripCB*
+strip_cb(PatchBuffers::layout_t layout)
+{
+   static FlatShadeStripCB   flat;
+   static SmoothShadeStripCB smooth;
+   static VertNormStripCB    norms;
+   static ColorIDStripCB     ids;
+   switch (layout) {
+    case PatchBuffers::FLAT_SHADE:   return &flat;
+    case PatchBuffers::SMOOTH_SHADE: return &smooth;
+    case PatchBuffers::VERT_NORMALS: return &norms;
+    case PatchBuffers::ID_COLORS:    return &ids;
+   }
+   return nullptr;
+}
+
+static string
+layout_name(PatchBuffers::layout_t layout)
+{
+   static const char* names[] = {
+      "FLAT_SHADE", "SMOOTH_SHADE", "VERT_NORMALS", "ID_COLORS"
+   };
+   return names[layout];
+}
+
+/*****************************************************************
+ * main
+ *****************************************************************/
+int
+main(int argc, char *argv[])
+{
+   context_t cx[2];
+   bool per_view = Config::get_var_bool("JOT_DL_PER_VIEW",false,true);
+   if (!init_egl() || !cx[0].make(EGL_NO_CONTEXT) ||
+       !cx[1].make(per_view ? EGL_NO_CONTEXT : cx[0]._ctx) ||
+       !cx[0].make_current()) {
+      cerr << argv[0] << ": no OpenGL context, skipping" << endl;
+      return SKIP;
+   }
+   glewInit();  // may complain about GLX; GL itself is what counts
+   if (!PatchBuffers::use_buffers()) {
+      cerr << argv[0] << ": no vertex buffers, skipping" << endl;
+      return SKIP;
+   }
+   for (auto& c : cx)
+      c._view = (new VIEW("test", nullptr, new GL_VIEW))->shared_from_this();
+   check(per_view == (DLhandler::context_id(cx[0]._view) !=
+                      DLhandler::context_id(cx[1]._view)),
+         "views get contexts as DLhandler assigns them");
+
+   // The mesh: creases and colors give vertices several sets
+   // of attributes:
+   LMESHptr mesh = make_shared<LMESH>();
+   mesh->Icosahedron();
+   for (int i = 0; i < mesh->nedges(); i += 5)
+      mesh->be(i)->set_crease();
+   for (int i = 0; i < mesh->nverts(); i += 3)
+      mesh->bv(i)->set_color(COLOR(1, 0.5, i/12.0), 1);
+   mesh->changed(BMESH::CREASES_CHANGED);
+   mesh->update_subdivision(2);
+   Patch* p = mesh->patch(0);
+   Patch::set_use_tri_strips(false);
+   check(p->cur_tri_list() != nullptr, "patch draws a triangle list");
+
+   const PatchBuffers::layout_t layouts[] = {
+      PatchBuffers::FLAT_SHADE,   PatchBuffers::SMOOTH_SHADE,
+      PatchBuffers::VERT_NORMALS, PatchBuffers::ID_COLORS
+   };
+   TestBuffers bufs[4];
+   int built_bytes[4] = {};
+   for (int frame = 0; frame < FRAMES; frame++) {
+      if (frame > 0) {
+         // move one vertex, and recolor another (one that had a
+         // color: vertices without one take the last color sent,
+         // so giving one a color can change which corners match,
+         // which rebuilds the buffers):
+         Bvert* v = mesh->bv(frame);
+         v->set_loc(v->loc() + Wvec(0.05, -0.03, 0.02));
+         mesh->bv(3*frame)->set_color(COLOR(0.2*frame, 1, 0.3), 1);
+         mesh->changed(BMESH::VERT_POSITIONS_CHANGED);
+         mesh->changed(BMESH::VERT_COLORS_CHANGED);
+         mesh->update();
+      }
+      for (auto& c : cx) {
+         check(c.make_current(), "make context current");
+         for (int k = 0; k < 4; k++) {
+            PatchBuffers::layout_t layout = layouts[k];
+            string what = layout_name(layout) + ", frame " + to_string(frame);
+
+            setup_gl(layout, p);
+            p->draw_tri_strips(strip_cb(layout));
+            vector<GLubyte> strips = read_pixels();
+
+            setup_gl(layout, p);
+            check(bufs[k].draw(c._view, p, layout), what + ": buffers drawn");
+            vector<GLubyte> buffers = read_pixels();
+            check(glGetError() == GL_NO_ERROR, what + ": no GL errors");
+
+            check(strips == buffers, what + ": same pixels as the StripCB");
+            check(bufs[k].num_indices() == 3*(int)p->cur_tri_list()->faces().size(),
+                  what + ": index count");
+
+            // After the first frame, only changed ranges are sent:
+            if (frame == 0 && &c == &cx[0])
+               built_bytes[k] = bufs[k].uploaded_bytes();
+            else if (frame > 0 && (per_view || &c == &cx[0]))
+               check(0 < bufs[k].uploaded_bytes() &&
+                     bufs[k].uploaded_bytes() < built_bytes[k],
+                     what + ": partial upload");
+            else if (!per_view && &c == &cx[1])
+               check(bufs[k].uploaded_bytes() == 0,
+                     what + ": shared context reuses buffers");
+         }
+      }
+   }
+
+   // Buffers given up with no context current stay until the
+   // next draw() in their context:
+   check(cx[0].make_current(), "make context current");
+   vector<GLuint> names = bufs[0].names(DLhandler::context_id(cx[0]._view));
+   release_current();
+   bufs[0].delete_buffers();
+   check(cx[0].make_current(), "make context current");
+   bool alive = !names.empty();
+   for (auto& n : names)
+      alive = alive && glIsBuffer(n);
+   check(alive, "buffers kept until their context draws");
+   setup_gl(PatchBuffers::FLAT_SHADE, p);
+   bufs[1].draw(cx[0]._view, p, PatchBuffers::SMOOTH_SHADE);
+   bool gone = true;
+   for (auto& n : names)
+      gone = gone && !glIsBuffer(n);
+   check(gone, "buffers deleted by the next draw in their context");
+
+   if (num_failed) {
+      cerr << num_failed << " check(s) failed" << endl;
+      return 1;
+   }
+   cerr << "all checks passed" << endl;
+   return 0;
+}
@@ -24,6 +24,8 @@
 #include "geom/gl_view.hpp"
 #include "toon_texture_1D.hpp"
 
+#include <typeinfo>
+
 /**********************************************************************
  * Globals
  * changed (appended with "_1D") 
@@ -582,7 +584,24 @@ ToonTexture_1D::draw(CVIEWptr& v)
 
    if (ntt_use_vertex_program_1D) 
       {
-      
+         // The vertex program needs just normals and positions,
+         // so try vertex buffers first:
+         if (typeid(*_cb) == typeid(ToonTexCB_1D))
+            {
+               set_face_culling();                  // GL_ENABLE_BIT
+               ntt_setup_vertex_program_1D();       // GL_ENABLE_BIT, ???
+               bool drawn = draw_buffers(v, PatchBuffers::VERT_NORMALS);
+               ntt_done_vertex_program_1D();
+
+               if (drawn)
+                  {
+                     PaperEffect::end_paper_effect(ntt_paper_flag_1D);
+
+                     glPopAttrib();
+
+                     return _patch->num_faces();
+                  }
+            }
 
          // Try it with the display list
          if (BasicTexture::dl_valid(v))
@@ -50,6 +50,7 @@ class StripColorCB : public FlatShadeStripCB {
    StripColorCB() : _starting(0) {}
 
    //******** TRI STRIPS ********
+   virtual bool needs_tri_strips() const { return true; }
    virtual void begin_faces(TriStrip* t) {
       // set a random color per strip
       // choose same color next time for this strip
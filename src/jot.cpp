@@ -1486,7 +1486,9 @@ JOTapp::do_save(string fullpath)
 
    cerr << "\ndo_save() - Saving...\n";
 
-   STDdstream s(fullpath, STDdstream::ascii_w);
+   // Binary scenes load the same way (the format is detected):
+   STDdstream s(fullpath, Config::get_var_bool("JOT_SAVE_BINARY",false) ?
+                STDdstream::write : STDdstream::ascii_w);
 
    int old_cursor = VIEW::peek()->get_cursor();
    VIEW::peek()->set_cursor(WINSYS::CURSOR_WAIT);
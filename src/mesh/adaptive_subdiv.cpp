@@ -0,0 +1,609 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "std/config.hpp"
+#include "std/parallel.hpp"
+#include "disp/view.hpp"
+#include "mesh/lmesh.hpp"
+#include "mesh/lpatch.hpp"
+#include "mesh/feature_lines.hpp"
+#include "mesh/adaptive_subdiv.hpp"
+
+#include <algorithm>
+#include <queue>
+
+using namespace mlib;
+
+// faces per task in the per-face passes:
+static const int ADAPTIVE_GRAIN = 512;
+
+// |n . v| below this counts as near the silhouette:
+static const double SIL_NEAR = 0.25;
+
+AdaptiveSubdiv::AdaptiveSubdiv(LMESH* ctrl) :
+   _ctrl(ctrl),
+   _max_level(Config::get_var_int("JOT_ADAPTIVE_MAX_LEVEL", 4)),
+   _face_budget(Config::get_var_int("JOT_ADAPTIVE_FACE_BUDGET", 500000)),
+   _target_pix(Config::get_var_dbl("JOT_ADAPTIVE_TARGET_PIX", 8.0)),
+   _curv_angle(0.1),
+   _release_frames(30),
+   _front_level(0),
+   _front_version(0),
+   _version(0),
+   _num_refined(0),
+   _num_released(0)
+{
+}
+
+AdaptiveSubdiv::~AdaptiveSubdiv()
+{
+   // the subdivision elements belong to the mesh
+   for (auto& l : _lines) {
+      delete l.creases;
+      delete l.borders;
+   }
+}
+
+int
+AdaptiveSubdiv::update()
+{
+   // measure screen size as BMESH::pix_size() does: pix_size() is
+   // the size of a pixel at the mesh's distance, so a length L
+   // at distance d covers about (d0/pix_size)*L/d pixels:
+
+   if (!_ctrl)
+      return 0;
+   CBBOX& bb = _ctrl->get_bb();
+   double d0 = _ctrl->eye_local().dist(bb.center());
+   double ps = _ctrl->pix_size();
+   return update(_ctrl->eye_local(), (ps > 0) ? d0/ps : 0);
+}
+
+int
+AdaptiveSubdiv::update(CWpt& eye, double pix_scale)
+{
+   if (!_ctrl || !_ctrl->is_control_mesh()) {
+      err_msg("AdaptiveSubdiv::update: error: need a control mesh");
+      return 0;
+   }
+   _num_refined = _num_released = 0;
+
+   reset();
+   vector<int> old_depth = _depth;
+   bool moved = (_ctrl->version() != _version);
+   measure(eye, pix_scale);
+   choose();
+   refine();
+   find_needs();
+   release();
+   collect();
+
+   // what the patches draw changed, even if no element did:
+   if (_depth != old_depth)
+      _ctrl->BMESH::changed(BMESH::RENDERING_CHANGED);
+   if (_depth != old_depth || _num_released || moved)
+      _front_version++;
+
+   // refining and releasing change the version too; only changes
+   // made elsewhere should count next time:
+   _version = _ctrl->version();
+
+   return _front.size();
+}
+
+void
+AdaptiveSubdiv::reset()
+{
+   // (Re)start the per-face records when the faces change:
+
+   size_t nf = _ctrl->nfaces();
+   if (_depth.size() == nf)
+      return;
+
+   // we don't know what was refined before, so assume the
+   // deepest level may be allocated anywhere; release() frees
+   // what isn't needed:
+   int alloc = _ctrl->max_cur_level();
+
+   _depth.assign(nf, 0);
+   _alloc.assign(nf, alloc);
+   _idle .assign(nf, 0);
+   _pix  .assign(nf, 0);
+   _want .assign(nf, 0);
+   _need .assign(nf, 0);
+   _sil  .assign(nf, 0);
+   _version = 0;
+}
+
+void
+AdaptiveSubdiv::measure(CWpt& eye, double pix_scale)
+{
+   // For each control face, its size on screen, whether it is on
+   // or near the silhouette, and how much the surface bends there;
+   // from those, the depth it asks for:
+
+   const MeshSnapshot& snap = _ctrl->snapshot();
+
+   parallel_for(snap.nfaces(), ADAPTIVE_GRAIN, [&](int begin, int end) {
+      for (int f = begin; f < end; f++) {
+         const int* fv = snap.face_verts(f);
+         const int* fe = snap.face_edges(f);
+         Wpt a = snap.loc(fv[0]), b = snap.loc(fv[1]), c = snap.loc(fv[2]);
+         Wpt ctr = a + ((b - a) + (c - a))/3;
+         double len = max(a.dist(b), max(b.dist(c), c.dist(a)));
+         double r   = max(ctr.dist(a), max(ctr.dist(b), ctr.dist(c)));
+
+         // distance to the nearest point of the face, about; if the
+         // eye is that close, the face is as big as it gets:
+         double d   = max(eye.dist(ctr) - r, len*1e-3);
+         double pix = pix_scale*len/max(d, 1e-12);
+
+         Wvec n   = snap.norm(f);
+         double nv = n*(eye - ctr).normalized();
+         bool front = (nv > 0);
+         bool sil   = (fabs(nv) < SIL_NEAR);
+         double bend = 0;
+         for (int j = 0; j < 3; j++) {
+            const int* ef = snap.edge_faces(fe[j]);
+            int g = (ef[0] == f) ? ef[1] : ef[0];
+            if (g < 0) {
+               sil = true;      // border
+               continue;
+            }
+            Wvec m = snap.norm(g);
+            if ((m*(eye - snap.loc(fv[j])) > 0) != front)
+               sil = true;      // contour edge
+            bend = max(bend, Acos(n*m));
+         }
+
+         // edges and bend angles halve at each level:
+         int want = 0;
+         if (pix > _target_pix) {
+            int k_size = (int)ceil(log2(pix/_target_pix));
+            int k_curv = (bend > _curv_angle) ?
+               (int)ceil(log2(bend/_curv_angle)) : 0;
+            want = sil ? k_size : min(k_size, k_curv);
+         }
+         _want[f] = min(want, _max_level);
+         _pix [f] = pix;
+         _sil [f] = sil ? 1 : 0;
+      }
+   });
+}
+
+void
+AdaptiveSubdiv::choose()
+{
+   // Give out levels within the face budget, one at a time, each
+   // to the face whose triangles are then largest on screen.
+   // deepen() keeps faces sharing a vertex within a level of each
+   // other, so collect() can stitch the seams between them:
+
+   typedef pair<double,int> err_t;      // error, face
+   priority_queue<err_t> queue;
+
+   int nf = _want.size();
+   long long total = nf;
+   auto error = [&](int f) {
+      return _pix[f]*(_sil[f] ? 2 : 1)/(1 << _depth[f]);
+   };
+   for (int f = 0; f < nf; f++)
+      _depth[f] = 0;
+   for (int f = 0; f < nf; f++)
+      if (_want[f] > 0)
+         queue.push(err_t(error(f), f));
+   while (!queue.empty()) {
+      err_t top = queue.top();
+      queue.pop();
+      int f = top.second;
+      if (_depth[f] >= _want[f])
+         continue;
+      // a neighbor took it deeper since it was queued:
+      if (top.first != error(f)) {
+         queue.push(err_t(error(f), f));
+         continue;
+      }
+      if (deepen(f, total) && _depth[f] < _want[f])
+         queue.push(err_t(error(f), f));
+   }
+}
+
+bool
+AdaptiveSubdiv::deepen(int f, long long& total)
+{
+   // Take face f one level deeper, after bringing each face that
+   // shares a vertex with it to its current depth. Fails if that
+   // goes past max_level() or the face budget:
+
+   int d = _depth[f];
+   if (d >= _max_level)
+      return false;
+   const MeshSnapshot& snap = _ctrl->snapshot();
+   const int* fv = snap.face_verts(f);
+   for (int i = 0; i < 3; i++) {
+      const int* ve = snap.vert_edges(fv[i]);
+      for (int j = 0; j < snap.degree(fv[i]); j++) {
+         const int* ef = snap.edge_faces(ve[j]);
+         for (int k = 0; k < 2; k++)
+            while (ef[k] >= 0 && _depth[ef[k]] < d)
+               if (!deepen(ef[k], total))
+                  return false;
+      }
+   }
+   // going from depth d to d+1 adds 4^(d+1) - 4^d faces:
+   long long cost = 3LL << (2*d);
+   if (total + cost > _face_budget)
+      return false;
+   total += cost;
+   _depth[f] = d + 1;
+   return true;
+}
+
+void
+AdaptiveSubdiv::refine()
+{
+   // Bring each face up to date at its depth. When the control
+   // mesh has changed since last time (e.g. vertices moved), all
+   // refined faces are updated; otherwise just the ones that got
+   // deeper:
+
+   bool moved = (_ctrl->version() != _version);
+   vector<Bface_list> by_depth(_max_level + 1);
+   for (size_t f = 0; f < _depth.size(); f++) {
+      int d = _depth[f];
+      if (d == 0)
+         continue;
+      if (d > _alloc[f])
+         _num_refined++;
+      if (moved || d > _alloc[f])
+         by_depth[d].push_back(_ctrl->bf(f));
+   }
+   for (int d = 1; d <= _max_level; d++)
+      if (!by_depth[d].empty())
+         LMESH::update_subdivision(by_depth[d], d);
+}
+
+void
+AdaptiveSubdiv::find_needs()
+{
+   // Refining a face at depth d also allocates its one-ring at
+   // depth d. A face needs its elements down to the deepest depth
+   // of any face sharing a vertex with it:
+
+   const MeshSnapshot& snap = _ctrl->snapshot();
+   vector<int> vert_need(snap.nverts(), 0);
+
+   parallel_for(snap.nverts(), ADAPTIVE_GRAIN, [&](int begin, int end) {
+      for (int v = begin; v < end; v++) {
+         int need = 0;
+         const int* ve = snap.vert_edges(v);
+         for (int j = 0; j < snap.degree(v); j++) {
+            const int* ef = snap.edge_faces(ve[j]);
+            for (int k = 0; k < 2; k++)
+               if (ef[k] >= 0)
+                  need = max(need, _depth[ef[k]]);
+         }
+         vert_need[v] = need;
+      }
+   });
+   parallel_for(snap.nfaces(), ADAPTIVE_GRAIN, [&](int begin, int end) {
+      for (int f = begin; f < end; f++) {
+         const int* fv = snap.face_verts(f);
+         _need[f] = max(vert_need[fv[0]],
+                        max(vert_need[fv[1]], vert_need[fv[2]]));
+         _alloc[f] = max(_alloc[f], _depth[f]);
+      }
+   });
+}
+
+void
+AdaptiveSubdiv::release()
+{
+   // Delete elements below what faces need, once they have been
+   // unneeded for release_frames() frames, but only while more
+   // than twice the face budget is allocated: removing elements
+   // from a mesh is slow (each is looked up in the mesh's lists),
+   // so regions are kept in case they're needed again until the
+   // memory is wanted. Regions unneeded the longest go first:
+
+   long long total = 0;
+   vector<int> idle;
+   for (size_t f = 0; f < _need.size(); f++) {
+      total += 1LL << (2*_alloc[f]);
+      if (_need[f] >= _alloc[f]) {
+         _idle[f] = 0;
+      } else if (++_idle[f] > _release_frames) {
+         idle.push_back(f);
+      }
+   }
+   const long long max_total = 2LL*_face_budget;
+   if (total <= max_total)
+      return;
+   std::sort(idle.begin(), idle.end(), [&](int a, int b) {
+      return _idle[a] > _idle[b];
+   });
+
+   vector<Bface*> sub;
+   for (auto& f : idle) {
+      if (total <= max_total)
+         break;
+      int need = _need[f];
+      Lface* lf = (Lface*)_ctrl->bf(f);
+      if (need == 0) {
+         lf->delete_subdiv_elements();
+      } else {
+         sub.clear();
+         lf->append_subdiv_faces(need, sub);
+         for (auto& s : sub)
+            ((Lface*)s)->delete_subdiv_elements();
+      }
+      total -= (1LL << (2*_alloc[f])) - (1LL << (2*need));
+      _alloc[f] = need;
+      _idle[f]  = 0;
+      _num_released++;
+   }
+}
+
+void
+AdaptiveSubdiv::collect()
+{
+   // The faces to draw: each control face's descendants at its
+   // depth, or the face itself if they aren't all there:
+
+   _front.clear();
+   _front_patches.clear();
+   _front_level = 0;
+   vector<Bface*> sub;
+   vector<size_t> starts(_depth.size() + 1, 0);
+   for (size_t f = 0; f < _depth.size(); f++) {
+      Lface* lf = (Lface*)_ctrl->bf(f);
+      int d = _depth[f];
+      sub.clear();
+      if (d > 0)
+         lf->append_subdiv_faces(d, sub);
+      if (sub.size() != (size_t)(1 << (2*d))) {
+         sub.clear();
+         sub.push_back(lf);
+         _depth[f] = 0;
+      }
+      _front_level = max(_front_level, _depth[f]);
+      starts[f] = _front.size();
+      _front.insert(_front.end(), sub.begin(), sub.end());
+      _front_patches.insert(_front_patches.end(), sub.size(), lf->patch());
+   }
+   starts.back() = _front.size();
+
+   // Faces next to a deeper region are split at the vertices it
+   // puts on their edges and corners (with the depths settled, as
+   // a missing region above brings its face back to depth 0):
+
+   _split.assign(_front.size(), 0);
+   _stitch.clear();
+   _stitch_patches.clear();
+   vector<Bface*> nbrs;
+   for (size_t f = 0; f < _depth.size(); f++)
+      if (_need[f] > _depth[f])
+         for (size_t i = starts[f]; i < starts[f+1]; i++)
+            stitch(i, _depth[f], nbrs);
+}
+
+void
+AdaptiveSubdiv::stitch(size_t i, int level, vector<Bface*>& nbrs)
+{
+   // Face i of _front is at the given level. Where a corner
+   // touches a deeper region, use the vertex that replaces it on
+   // the next level; where an edge borders one, add the vertex
+   // splitting it; then fan the polygon into _stitch:
+
+   Lface* f = (Lface*)_front[i];
+   auto deeper = [&](Bvert* v) {
+      nbrs.clear();
+      v->get_faces(nbrs);
+      for (auto& g : nbrs)
+         if (is_deeper(g))
+            return true;
+      return false;
+   };
+   auto front_face = [&](Bvert* v) -> Bface* {
+      nbrs.clear();
+      v->get_faces(nbrs);
+      for (auto& g : nbrs)
+         if (is_front(g))
+            return g;
+      return v->get_face();
+   };
+
+   corner_t poly[6];
+   int n = 0, first = 0;
+   bool split = false;
+   for (int k = 1; k <= 3; k++) {
+      Bvert* v = f->lv(k);
+      Bface* vf = f;
+      if (deeper(v)) {
+         if (!(v = f->lv(k)->subdiv_vertex()))
+            return;
+         vf = front_face(v);
+         split = true;
+      }
+      poly[n++] = { v, vf };
+      if (is_deeper(f->nbr(k))) {
+         Bvert* m = f->le(k)->subdiv_vertex();
+         if (!m)
+            return;
+         if (first == 0)
+            first = n;
+         poly[n++] = { m, front_face(m) };
+         split = true;
+      }
+   }
+   if (!split)
+      return;
+
+   // fan from the first edge vertex, if any:
+   for (int j = 1; j + 1 < n; j++) {
+      _stitch.push_back(poly[first]);
+      _stitch.push_back(poly[(first + j) % n]);
+      _stitch.push_back(poly[(first + j + 1) % n]);
+      _stitch_patches.push_back(_front_patches[i]);
+   }
+   _split[i] = 1;
+}
+
+int
+AdaptiveSubdiv::draw_triangles(StripCB* cb, Patch* p) const
+{
+   assert(cb);
+   int n = 0;
+   cb->begin_triangles();
+   for (size_t i = 0; i < _front.size(); i++) {
+      if (_split[i] || (p && _front_patches[i] != p))
+         continue;
+      Bface* f = _front[i];
+      cb->faceCB(f->v1(), f);
+      cb->faceCB(f->v2(), f);
+      cb->faceCB(f->v3(), f);
+      n++;
+   }
+   for (size_t t = 0; t < _stitch_patches.size(); t++) {
+      if (p && _stitch_patches[t] != p)
+         continue;
+      for (int k = 0; k < 3; k++)
+         cb->faceCB(_stitch[3*t + k].v, _stitch[3*t + k].f);
+      n++;
+   }
+   cb->end_triangles();
+   return n;
+}
+
+int
+AdaptiveSubdiv::region_depth(CBface* f, int& level) const
+{
+   level = 0;
+   if (!f)
+      return -1;
+   Lface* c = (Lface*)f;
+   for ( ; c->parent(); c = c->parent())
+      level++;
+   int i = _ctrl->snapshot().index(c);
+   return (i >= 0 && i < (int)_depth.size()) ? _depth[i] : -1;
+}
+
+/*****************************************************************
+ * Lines
+ *****************************************************************/
+int
+AdaptiveSubdiv::get_sil_strips(EdgeStrip& sils) const
+{
+   // As BMESH::get_sil_strips() does, on the edges of front():
+
+   sils.reset();
+   AdaptiveFrontEdgeFilter front(this);
+   NewSilEdgeFilter sil(VIEW::stamp(), !_ctrl->show_secondary_faces());
+   AndFilter filter = front + sil;
+   for (auto& f : _front)
+      for (int k = 1; k <= 3; k++)
+         if (f->e(k)->is_sil())
+            sils.build(nullptr, f->e(k), filter);
+   return sils.num();
+}
+
+int
+AdaptiveSubdiv::get_zcross_strips(ZcrossPath& zx) const
+{
+   // As BMESH::get_zcross_strips() does, on front(). The paths
+   // end where they would leave it:
+
+   zx.reset();
+   zx.set_eye(_ctrl->eye_local());
+   AdaptiveFrontFilter front(this);
+   zx.set_face_filter(&front);
+   for (auto& f : _front)
+      zx.start_sil(f);
+   zx.set_face_filter(nullptr);
+   return zx.num();
+}
+
+AdaptiveSubdiv::lines_t*
+AdaptiveSubdiv::lines(Patch* p)
+{
+   // The creases and borders of front() on control patch p, kept
+   // by the patch's index in the mesh:
+
+   int i = _ctrl->patches().get_index(p);
+   if (i < 0)
+      return nullptr;
+   if ((int)_lines.size() <= i)
+      _lines.resize(i + 1, lines_t{nullptr, nullptr, nullptr, 0});
+   lines_t& ret = _lines[i];
+   if (ret.patch == p && ret.creases && ret.version == _front_version)
+      return &ret;
+
+   Bface_list faces;
+   for (size_t k = 0; k < _front.size(); k++)
+      if (_front_patches[k] == p)
+         faces.push_back(_front[k]);
+   Bedge_list edges = faces.get_edges();
+   if (!ret.creases) {
+      ret.creases = new EdgeStrip;
+      ret.borders = new EdgeStrip;
+   }
+   AdaptiveFrontEdgeFilter front(this);
+   ret.creases->reset();
+   ret.creases->build_with_tips(edges, CreaseEdgeFilter() + front);
+   ret.borders->reset();
+   ret.borders->build_with_tips(edges, BorderEdgeFilter() + front);
+   ret.patch   = p;
+   ret.version = _front_version;
+   return &ret;
+}
+
+EdgeStrip*
+AdaptiveSubdiv::creases(Patch* p)
+{
+   lines_t* l = lines(p);
+   return l ? l->creases : nullptr;
+}
+
+EdgeStrip*
+AdaptiveSubdiv::borders(Patch* p)
+{
+   lines_t* l = lines(p);
+   return l ? l->borders : nullptr;
+}
+
+int
+AdaptiveSubdiv::extract_feature_lines(Patch* p, int kinds,
+                                      vector<ZXseg>& ret, uint stamp) const
+{
+   // Each level with faces in front() has its lines found on its
+   // own mesh (which keeps its fields between the patches' calls,
+   // given a stamp), kept to the faces in front():
+
+   Lpatch* lp = dynamic_cast<Lpatch*>(p);
+   if (!lp)
+      return 0;
+   AdaptiveFrontFilter front(this);
+   int n = 0;
+   for (int k = 0; k <= _front_level; k++) {
+      LMESHptr m = _ctrl->subdiv_mesh(k);
+      if (!m)
+         break;
+      n += m->feature_lines().extract(m, m->eye_local(), kinds, ret,
+                                      lp->sub_patch(k), stamp, &front);
+   }
+   return n;
+}
@@ -0,0 +1,252 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef ADAPTIVE_SUBDIV_H_IS_INCLUDED
+#define ADAPTIVE_SUBDIV_H_IS_INCLUDED
+
+#include "mesh/bface.hpp"
+#include "mesh/zcross_path.hpp"
+#include "mlib/points.hpp"
+
+#include <vector>
+
+class LMESH;
+class Patch;
+class StripCB;
+class EdgeStrip;
+
+/*****************************************************************
+ * AdaptiveSubdiv:
+ *
+ *      View-dependent subdivision of an LMESH. Instead of one
+ *      subdivision level for the whole mesh, each face of the
+ *      control mesh gets its own depth each frame, and only
+ *      those regions are refined, with
+ *      LMESH::update_subdivision(CBface_list&, int).
+ *
+ *      A face is refined until its edges are about target_pix()
+ *      pixels long on screen (measured against BMESH::pix_size()),
+ *      but only where that shows: on and near the silhouette, or
+ *      where the surface bends (by more than curv_angle() radians
+ *      between neighboring faces, halved at each level). Depths
+ *      go no deeper than max_level(), and the total number of
+ *      faces stays within face_budget(): when the budget is
+ *      short, the faces that are largest on screen (silhouette
+ *      faces counting double) are refined first. Faces sharing a
+ *      vertex are kept within one level of each other, so a face
+ *      going deeper may take its neighbors along.
+ *
+ *      Regions that need less refinement than they have are kept
+ *      until the allocated faces exceed twice face_budget(); then
+ *      the ones unneeded for longest (and for at least
+ *      release_frames() frames) are released, i.e. their
+ *      subdivision elements are deleted. A camera going back and
+ *      forth doesn't rebuild them each time.
+ *
+ *      The faces to draw (front()) mix levels. Where a face meets
+ *      a deeper region, it is drawn as a fan through the vertices
+ *      that region puts on their shared edges and corners, so the
+ *      seams close up without T-junctions.
+ *
+ *      Set on the control mesh with LMESH::set_adaptive(), which
+ *      then updates it before drawing in place of the global
+ *      subdivision level, and draws front() for its patches.
+ *      Silhouettes, creases, borders and feature lines are then
+ *      found on front() too, each level's lines on that level's
+ *      faces; their chains may break where the level changes.
+ *****************************************************************/
+class AdaptiveSubdiv {
+ public:
+
+   //******** MANAGERS ********
+
+   AdaptiveSubdiv(LMESH* ctrl);
+   ~AdaptiveSubdiv();
+
+   //******** SETTINGS ********
+
+   int    max_level()          const { return _max_level;      }
+   int    face_budget()        const { return _face_budget;    }
+   double target_pix()         const { return _target_pix;     }
+   double curv_angle()         const { return _curv_angle;     }
+   int    release_frames()     const { return _release_frames; }
+
+   void   set_max_level(int l)          { _max_level      = max(l, 0);    }
+   void   set_face_budget(int n)        { _face_budget    = n;            }
+   void   set_target_pix(double p)      { _target_pix     = max(p, 1.0);  }
+   void   set_curv_angle(double a)      { _curv_angle     = max(a, 1e-3); }
+   void   set_release_frames(int n)     { _release_frames = max(n, 0);    }
+
+   //******** UPDATING ********
+
+   // Choose depths for the current view and refine/release to
+   // match. Returns the number of faces in front():
+   int update();
+
+   // Same, from an eye point in the mesh's object space and the
+   // size in pixels of a unit length at unit distance (so a
+   // length L at distance d covers pix_scale*L/d pixels):
+   int update(mlib::CWpt& eye, double pix_scale);
+
+   //******** RESULTS ********
+
+   // Depth of the given control face (by index in the mesh):
+   int depth(int f) const { return _depth[f]; }
+
+   // Depth of the region holding f, a face of the control mesh
+   // or of its subdivision meshes, whose level is returned in
+   // level. Returns -1 if f is from another mesh:
+   int region_depth(CBface* f, int& level) const;
+
+   // Is f in front()? Is it above a deeper region?
+   bool is_front(CBface* f) const {
+      int l, d = region_depth(f, l); return d == l;
+   }
+   bool is_deeper(CBface* f) const {
+      int l; return f && region_depth(f, l) > l;
+   }
+
+   // Faces to draw, at their chosen depths:
+   CBface_list& front() const { return _front; }
+
+   // Draw the faces of front() from the given control patch (or
+   // all of them, if p is null) as triangles, stitched to deeper
+   // neighbors. Returns the number of triangles drawn:
+   int draw_triangles(StripCB* cb, Patch* p = nullptr) const;
+
+   //******** LINES ********
+
+   // Silhouette edges and zero-crossing silhouettes of front(),
+   // for LMESH::get_sil_strips() and get_zcross_strips():
+   int get_sil_strips(EdgeStrip& sils) const;
+   int get_zcross_strips(ZcrossPath& zx) const;
+
+   // Creases and borders of front() on the given patch of the
+   // control mesh (null for other patches), rebuilt when front()
+   // changes:
+   EdgeStrip* creases(Patch* p);
+   EdgeStrip* borders(Patch* p);
+
+   // Append to ret the feature lines (see FeatureLines::extract())
+   // of the given kinds on front() for the control patch p:
+   int extract_feature_lines(Patch* p, int kinds, vector<ZXseg>& ret,
+                             uint stamp = 0) const;
+
+   // Statistics for the last update():
+   int num_refined()  const { return _num_refined;  }
+   int num_released() const { return _num_released; }
+
+ protected:
+   LMESH*   _ctrl;
+   int      _max_level;
+   int      _face_budget;
+   double   _target_pix;
+   double   _curv_angle;
+   int      _release_frames;
+
+   // per control face:
+   std::vector<int>      _depth;   // chosen depth
+   std::vector<int>      _alloc;   // depth of allocated elements
+   std::vector<int>      _idle;    // frames _alloc has been too deep
+   std::vector<double>   _pix;     // edge length on screen
+   std::vector<int>      _want;    // depth the view asks for
+   std::vector<int>      _need;    // deepest depth in the one-ring
+   std::vector<unsigned char> _sil;// 1 if on or near the silhouette
+
+   Bface_list            _front;
+   std::vector<Patch*>   _front_patches;   // control patch of each
+   std::vector<unsigned char> _split;      // 1 if drawn from _stitch
+   int                   _front_level;     // deepest level in _front
+   uint                  _front_version;   // bumped when _front changes
+
+   // triangles drawn in place of split faces of _front:
+   struct corner_t {
+      Bvert* v;
+      Bface* f;         // front face holding v, for normals etc.
+   };
+   std::vector<corner_t> _stitch;          // 3 per triangle
+   std::vector<Patch*>   _stitch_patches;  // control patch of each
+
+   // creases and borders of _front, per control patch:
+   struct lines_t {
+      Patch*     patch;
+      EdgeStrip* creases;
+      EdgeStrip* borders;
+      uint       version;
+   };
+   std::vector<lines_t>  _lines;
+
+   uint                  _version; // ctrl mesh version last refined
+   int                   _num_refined;
+   int                   _num_released;
+
+   //******** INTERNAL METHODS ********
+
+   void reset();
+   void measure(mlib::CWpt& eye, double pix_scale);
+   void choose();
+   bool deepen(int f, long long& total);
+   void refine();
+   void find_needs();
+   void release();
+   void collect();
+   void stitch(size_t i, int level, std::vector<Bface*>& nbrs);
+   lines_t* lines(Patch* p);
+};
+
+/*****************************************************************
+ * AdaptiveFrontFilter:
+ *
+ *      Accepts faces in AdaptiveSubdiv::front().
+ *****************************************************************/
+class AdaptiveFrontFilter : public SimplexFilter {
+ public:
+   AdaptiveFrontFilter(const AdaptiveSubdiv* a) : _a(a) {}
+
+   virtual bool accept(CBsimplex* s) const {
+      return is_face(s) && _a->is_front((CBface*)s);
+   }
+
+ protected:
+   const AdaptiveSubdiv* _a;
+};
+
+/*****************************************************************
+ * AdaptiveFrontEdgeFilter:
+ *
+ *      Accepts edges of faces in AdaptiveSubdiv::front(), except
+ *      where they border a deeper region, whose own finer edges
+ *      stand in for them.
+ *****************************************************************/
+class AdaptiveFrontEdgeFilter : public SimplexFilter {
+ public:
+   AdaptiveFrontEdgeFilter(const AdaptiveSubdiv* a) : _a(a) {}
+
+   virtual bool accept(CBsimplex* s) const {
+      if (!is_edge(s))
+         return false;
+      Bedge* e = (Bedge*)s;
+      return ((e->f1() && _a->is_front(e->f1())) ||
+              (e->f2() && _a->is_front(e->f2()))) &&
+         !_a->is_deeper(e->f1()) && !_a->is_deeper(e->f2());
+   }
+
+ protected:
+   const AdaptiveSubdiv* _a;
+};
+
+#endif // ADAPTIVE_SUBDIV_H_IS_INCLUDED
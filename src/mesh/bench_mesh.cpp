@@ -0,0 +1,1631 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ *  Timings for core mesh operations, run headless on meshes built
+ *  by subdividing BMESH::Icosahedron().
+ *
+ *  Usage: bench_mesh <test> [ num_levels ]
+ *
+ *  Each test prints one line per subdivision level.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "std/parallel.hpp"
+#include "std/platform.hpp"
+#include "std/stop_watch.hpp"
+#include "mesh/adaptive_subdiv.hpp"
+#include "mesh/feature_lines.hpp"
+#include "mesh/objreader.hpp"
+#include "mesh/proximity_index.hpp"
+#include "mesh/subdiv_stencils.hpp"
+#include "mesh/uv_data.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "net/io_manager.hpp"
+#include "mi.hpp"
+
+#include <fstream>
+#include <iterator>
+
+// Where the timed loops leave what they compute, so it isn't
+// optimized away:
+static volatile double sink;
+
+/*****************************************************************
+ * HeapBMESH:
+ *
+ *   BMESH that allocates each element separately on the heap,
+ *   the way all meshes did before SimplexPool. Used as the
+ *   baseline for the "alloc" test.
+ *****************************************************************/
+class HeapBMESH : public BMESH {
+ public:
+   virtual Bvert* new_vert(CWpt& p) const { return new Bvert(p); }
+   virtual Bedge* new_edge(Bvert* u, Bvert* v) const {
+      return new Bedge(u,v);
+   }
+   virtual Bface* new_face(Bvert* u, Bvert* v, Bvert* w,
+                           Bedge* e, Bedge* f, Bedge* g) const {
+      return new Bface(u,v,w,e,f,g);
+   }
+   virtual void delete_vert(Bvert* v) const { delete v; }
+   virtual void delete_edge(Bedge* e) const { delete e; }
+   virtual void delete_face(Bface* f) const { delete f; }
+
+   virtual ~HeapBMESH() { delete_elements(); }
+};
+
+/*****************************************************************
+ * alloc:
+ *
+ *   Allocation and teardown of mesh elements: building the
+ *   LMESH subdivision hierarchy, copying the finest level into
+ *   a BMESH (pooled vs. plain heap), and deleting it all.
+ *****************************************************************/
+template <class M>
+inline void
+time_copy(CBMESHptr& src, double& build, double& teardown)
+{
+   stop_watch clock;
+   shared_ptr<M> m = make_shared<M>();
+   BMESH& dst = *m;
+   dst = *src;
+   build = clock.elapsed_time();
+   clock.set();
+   m = nullptr;
+   teardown = clock.elapsed_time();
+}
+
+static void
+bench_alloc(int num_levels)
+{
+   cout << "level    faces    subdiv   delete   "
+        << "pool copy/free    heap copy/free" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      stop_watch clock;
+      LMESHptr ctrl = make_shared<LMESH>();
+      ctrl->Icosahedron();
+      ctrl->set_subdiv_loc_calc(new LoopLoc());
+      ctrl->update_subdivision(level);
+      double subdiv = clock.elapsed_time();
+
+      BMESHptr cur = ctrl->cur_mesh();
+      int nf = cur->nfaces();
+
+      double pool_build, pool_free, heap_build, heap_free;
+      time_copy<BMESH>    (cur, pool_build, pool_free);
+      time_copy<HeapBMESH>(cur, heap_build, heap_free);
+
+      cur = nullptr;
+      clock.set();
+      ctrl = nullptr;
+      double del = clock.elapsed_time();
+
+      printf("%5d %8d  %8.4f %8.4f   %8.4f %8.4f  %8.4f %8.4f\n",
+             level, nf, subdiv, del,
+             pool_build, pool_free, heap_build, heap_free);
+   }
+}
+
+/*****************************************************************
+ * keys:
+ *
+ *   Bsimplex key churn: repeatedly build a mesh, key every
+ *   element, look every key up, then delete the mesh. Reports
+ *   keys assigned per second, lookups per second, and the size
+ *   of the key table afterward (which should stay near the size
+ *   of the largest mesh rather than grow with each round).
+ *****************************************************************/
+static void
+bench_keys(int num_levels)
+{
+   const int num_rounds = 8;
+
+   cout << "level    faces    keys/s       lookups/s    "
+        << "stale   table size" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      double key_time = 0, lookup_time = 0;
+      size_t num_keyed = 0, num_stale = 0;
+      int nf = 0;
+      vector<uintptr_t> keys;
+
+      for (int r = 0; r < num_rounds; r++) {
+         LMESHptr ctrl = make_shared<LMESH>();
+         ctrl->Icosahedron();
+         ctrl->set_subdiv_loc_calc(new LoopLoc());
+         ctrl->update_subdivision(level);
+         BMESHptr cur = ctrl->cur_mesh();
+         nf = cur->nfaces();
+
+         // keys from the previous round must all be dead by now:
+         for (auto k : keys)
+            if (Bsimplex::lookup(k))
+               num_stale++;
+         keys.clear();
+
+         stop_watch clock;
+         for (int i=0; i<cur->nverts(); i++)
+            keys.push_back(cur->bv(i)->key());
+         for (int i=0; i<cur->nedges(); i++)
+            keys.push_back(cur->be(i)->key());
+         for (int i=0; i<cur->nfaces(); i++)
+            keys.push_back(cur->bf(i)->key());
+         key_time += clock.elapsed_time();
+         num_keyed += keys.size();
+
+         clock.set();
+         for (auto k : keys)
+            if (!Bsimplex::lookup(k))
+               num_stale++;
+         lookup_time += clock.elapsed_time();
+      }
+      for (auto k : keys)
+         if (Bsimplex::lookup(k))
+            num_stale++;
+
+      printf("%5d %8d  %11.0f  %11.0f  %6d  %10d\n",
+             level, nf,
+             num_keyed/max(key_time, 1e-9),
+             num_keyed/max(lookup_time, 1e-9),
+             int(num_stale), int(Bsimplex::key_table_size()));
+   }
+}
+
+/*****************************************************************
+ * build:
+ *
+ *   Topology construction from flat arrays: a regular grid of
+ *   2*n*n triangles (n = 16 << level) built one add_face() at a
+ *   time vs. in one call to BMESH::build(). (test_build checks
+ *   both give the same mesh.)
+ *****************************************************************/
+static void
+bench_build(int num_levels)
+{
+   cout << "level    faces    edges   add_face    build   speedup" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      Wpt_list pts;
+      vector<Point3i> tris;
+      grid(16 << level, pts, tris);
+
+      stop_watch clock;
+      BMESHptr a = make_shared<BMESH>();
+      for (Wpt_list::size_type i=0; i<pts.size(); i++)
+         a->add_vertex(pts[i]);
+      for (auto& tri : tris)
+         a->add_face(tri[0], tri[1], tri[2]);
+      double slow = clock.elapsed_time();
+
+      clock.set();
+      BMESHptr b = make_shared<BMESH>();
+      b->build(pts, tris);
+      double fast = clock.elapsed_time();
+
+      printf("%5d %8d %8d  %9.4f %8.4f  %7.2fx\n",
+             level, b->nfaces(), b->nedges(), slow, fast,
+             slow/max(fast, 1e-9));
+   }
+}
+
+/*****************************************************************
+ * snapshot:
+ *
+ *   MeshSnapshot: time to build it, time to refresh positions
+ *   and face normals, and a sweep over all face normals read
+ *   from the snapshot vs. from the Bfaces. (test_snapshot checks
+ *   the snapshot matches the mesh.)
+ *****************************************************************/
+static void
+bench_snapshot(int num_levels)
+{
+   cout << "level    faces     build  refresh   "
+        << "sweep: Bface  snapshot" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      LMESHptr ctrl = subdiv_icosahedron(level);
+      BMESHptr cur = ctrl->cur_mesh();
+
+      stop_watch clock;
+      cur->snapshot();
+      double build = clock.elapsed_time();
+
+      cur->changed(BMESH::VERT_POSITIONS_CHANGED);
+      clock.set();
+      cur->snapshot();
+      double refresh = clock.elapsed_time();
+
+      // Sum face normals (both ways), after moving the vertices
+      // so cached Bface normals must be recomputed too:
+      cur->changed(BMESH::VERT_POSITIONS_CHANGED);
+      for (int i=0; i<cur->nfaces(); i++)
+         cur->bf(i)->geometry_changed();
+      clock.set();
+      Wvec a;
+      for (int i=0; i<cur->nfaces(); i++)
+         a += cur->bf(i)->norm();
+      double slow = clock.elapsed_time();
+
+      clock.set();
+      const MeshSnapshot& s = cur->snapshot();
+      double x = 0, y = 0, z = 0;
+      for (int i=0; i<s.nfaces(); i++) {
+         x += s.nx()[i];
+         y += s.ny()[i];
+         z += s.nz()[i];
+      }
+      double fast = clock.elapsed_time();
+      sink = a.length() + x + y + z;
+
+      printf("%5d %8d  %8.4f %8.4f         %8.4f  %8.4f\n",
+             level, cur->nfaces(), build, refresh, slow, fast);
+   }
+}
+
+/*****************************************************************
+ * normals:
+ *
+ *   Recomputing all vertex normals after the mesh moves: lazily,
+ *   one Bvert::norm() call at a time, vs. BMESH::update_normals()
+ *   (the batch is forced on for every level). (test_normals
+ *   checks both give the same normals.)
+ *****************************************************************/
+static void
+move_verts(BMESHptr m)
+{
+   for (int i=0; i<m->nverts(); i++)
+      m->bv(i)->set_loc(m->bv(i)->loc());
+   m->changed(BMESH::VERT_POSITIONS_CHANGED);
+}
+
+static void
+bench_normals(int num_levels)
+{
+   Config::set_var_int("JOT_BATCH_NORMALS_MIN_FACES", 0);
+
+   cout << "level    faces  threads      lazy     batch  speedup" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      LMESHptr ctrl = subdiv_icosahedron(level);
+      BMESHptr cur = ctrl->cur_mesh();
+      cur->snapshot();
+
+      move_verts(cur);
+      stop_watch clock;
+      vector<Wvec> lazy;
+      lazy.reserve(cur->nverts());
+      for (int i=0; i<cur->nverts(); i++)
+         lazy.push_back(cur->bv(i)->norm());
+      double slow = clock.elapsed_time();
+
+      move_verts(cur);
+      clock.set();
+      cur->update_normals();
+      double fast = clock.elapsed_time();
+
+      printf("%5d %8d  %7d  %8.4f  %8.4f  %6.2fx\n",
+             level, cur->nfaces(), parallel_num_threads(), slow, fast,
+             slow/max(fast, 1e-9));
+   }
+}
+
+/*****************************************************************
+ * pick:
+ *
+ *   Ray picking: a brute force loop over all faces, as
+ *   BMESH::pick_face() used to do, vs. pick_face() with the
+ *   FaceBVH, one ray at a time and batched. Rays go from random
+ *   points outside the mesh through random points inside it.
+ *   Times are for the whole set of rays. (test_pick checks all
+ *   three hit the same faces.)
+ *****************************************************************/
+static void
+bench_pick(int num_levels)
+{
+   const int num_rays = 1000;
+
+   cout << "level    faces     build    brute      bvh    batch  speedup"
+        << endl;
+
+   srand48(1);
+   vector<Wline> rays;
+   for (int i=0; i<num_rays; i++) {
+      Wvec dir = Wvec(drand48()-0.5, drand48()-0.5, drand48()-0.5);
+      Wpt  a   = Wpt::Origin() + dir.normalized()*4;
+      Wpt  b   = Wpt(drand48()-0.5, drand48()-0.5, drand48()-0.5)*0.5;
+      rays.push_back(Wline(a, b));
+   }
+
+   for (int level = 0; level <= num_levels; level++) {
+      LMESHptr ctrl = subdiv_icosahedron(level);
+      BMESHptr cur = ctrl->cur_mesh();
+
+      stop_watch clock;
+      cur->face_bvh();
+      double build = clock.elapsed_time();
+
+      // the brute force loop gets too slow at the finer levels:
+      int num_brute = (cur->nfaces() > 100000) ? 0 : num_rays;
+      vector<Bface*> slow_faces(num_brute);
+      vector<Wpt>    slow_hits(num_brute);
+      clock.set();
+      for (int i=0; i<num_brute; i++)
+         slow_faces[i] = brute_pick(cur, rays[i], slow_hits[i]);
+      double slow = clock.elapsed_time();
+
+      vector<Bface*> fast_faces(num_rays);
+      vector<Wpt>    fast_hits(num_rays);
+      clock.set();
+      for (int i=0; i<num_rays; i++)
+         fast_faces[i] = cur->pick_face(rays[i], fast_hits[i]);
+      double fast = clock.elapsed_time();
+
+      vector<Bface*> batch_faces;
+      vector<Wpt>    batch_hits;
+      clock.set();
+      cur->pick_faces(rays, batch_faces, batch_hits);
+      double batch = clock.elapsed_time();
+
+      if (num_brute > 0)
+         printf("%5d %8d  %8.4f %8.4f %8.4f %8.4f  %6.0fx\n",
+                level, cur->nfaces(), build, slow, fast, batch,
+                slow/max(fast, 1e-9));
+      else
+         printf("%5d %8d  %8.4f      -   %8.4f %8.4f\n",
+                level, cur->nfaces(), build, fast, batch);
+   }
+}
+
+/*****************************************************************
+ * nearest:
+ *
+ *   Query latency of BMESH::nearest_vert() and nearest_edge()
+ *   with their ProximityIndex, vs. the brute force loops they
+ *   used to run, and of k-nearest (k = 8) and radius queries.
+ *   Query points are random points near the surface. Times are
+ *   microseconds per query; the index build is timed apart.
+ *   (test_nearest checks the queries against brute force.)
+ *****************************************************************/
+static void
+bench_nearest(int num_levels)
+{
+   const int num_pts = 1000;
+
+   cout << "level    faces     build   vert: brute   index"
+        << "   edge: brute   index    knn   radius" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      LMESHptr ctrl = subdiv_icosahedron(level);
+      BMESHptr cur = ctrl->cur_mesh();
+
+      srand48(1);
+      vector<Wpt> pts;
+      for (int i=0; i<num_pts; i++) {
+         Bvert* v = cur->bv(lrand48() % cur->nverts());
+         pts.push_back(v->loc() + Wvec(drand48()-0.5, drand48()-0.5,
+                                       drand48()-0.5)*0.1);
+      }
+
+      stop_watch clock;
+      cur->nearest_vert(pts[0]);
+      cur->nearest_edge(pts[0]);
+      double build = clock.elapsed_time();
+
+      // the brute force loops get too slow at the finer levels:
+      int num_brute = (cur->nfaces() > 100000) ? 0 : num_pts;
+
+      clock.set();
+      for (int i=0; i<num_brute; i++)
+         brute_nearest_vert(cur, pts[i]);
+      double slow_v = clock.elapsed_time();
+      clock.set();
+      for (int i=0; i<num_pts; i++)
+         cur->nearest_vert(pts[i]);
+      double fast_v = clock.elapsed_time();
+
+      clock.set();
+      for (int i=0; i<num_brute; i++)
+         brute_nearest_edge(cur, pts[i]);
+      double slow_e = clock.elapsed_time();
+      clock.set();
+      for (int i=0; i<num_pts; i++)
+         cur->nearest_edge(pts[i]);
+      double fast_e = clock.elapsed_time();
+
+      ProximityIndex index(cur.get(), ProximityIndex::VERTS);
+      vector<int> ret;
+      index.k_nearest(pts[0], 8, ret);
+      clock.set();
+      for (int i=0; i<num_pts; i++)
+         index.k_nearest(pts[i], 8, ret);
+      double knn = clock.elapsed_time();
+      double r = cur->avg_len();
+      clock.set();
+      for (int i=0; i<num_pts; i++)
+         index.within(pts[i], r, ret);
+      double radius = clock.elapsed_time();
+
+      double us = 1e6/num_pts;
+      if (num_brute > 0)
+         printf("%5d %8d  %8.4f    %9.2f %7.2f   %9.2f %7.2f %7.2f %7.2f\n",
+                level, cur->nfaces(), build, slow_v*us, fast_v*us,
+                slow_e*us, fast_e*us, knn*us, radius*us);
+      else
+         printf("%5d %8d  %8.4f          -   %7.2f         -   %7.2f %7.2f %7.2f\n",
+                level, cur->nfaces(), build, fast_v*us, fast_e*us,
+                knn*us, radius*us);
+   }
+}
+
+/*****************************************************************
+ * weld:
+ *
+ *   Vertex welding on a "triangle soup": the grid of the build
+ *   test (n = 8 << level) with every triangle given its own 3
+ *   vertices. Times the pair-at-a-time merge_vertex() loop that
+ *   remove_duplicate_vertices() used to run vs. weld_vertices(),
+ *   and weld_vertices() with a tolerance after the copies are
+ *   jittered. (test_weld checks the welded meshes.)
+ *****************************************************************/
+static void
+bench_weld(int num_levels)
+{
+   cout << "level    faces    verts  pairwise     weld  speedup  weld(tol)"
+        << endl;
+
+   srand48(1);
+   for (int level = 0; level <= num_levels; level++) {
+      int n = 8 << level;
+
+      // the pairwise loop gets too slow at the finer levels:
+      double slow = 0;
+      bool do_slow = (level <= 3);
+      if (do_slow) {
+         BMESHptr a = soup(n, 0);
+         stop_watch clock;
+         pairwise_weld(a);
+         slow = clock.elapsed_time();
+      }
+
+      BMESHptr b = soup(n, 0);
+      stop_watch clock;
+      b->weld_vertices(0);
+      double fast = clock.elapsed_time();
+
+      BMESHptr c = soup(n, 1e-6);
+      clock.set();
+      c->weld_vertices(1e-4);
+      double tol = clock.elapsed_time();
+
+      int nv = b->nverts();
+
+      if (do_slow)
+         printf("%5d %8d %8d  %8.4f %8.4f  %6.1fx   %8.4f\n",
+                level, b->nfaces(), nv, slow, fast,
+                slow/max(fast, 1e-9), tol);
+      else
+         printf("%5d %8d %8d        -  %8.4f            %8.4f\n",
+                level, b->nfaces(), nv, fast, tol);
+   }
+}
+
+/*****************************************************************
+ * traverse:
+ *
+ *   Graph searches on the triangle soup of the weld test, where
+ *   each face is its own component: get_components(), and
+ *   reachable_faces() from 1000 random faces, with the flags
+ *   cleared over the whole mesh first (as they used to be) vs.
+ *   with TraversalMarks. Then split_components() on 16 separate
+ *   grids. (test_traverse checks what the searches find.)
+ *****************************************************************/
+static void
+bench_traverse(int num_levels)
+{
+   const int num_seeds = 1000;
+
+   cout << "level    faces   comps: flags    marks   reach: flags    marks"
+        << "    split" << endl;
+
+   srand48(1);
+   for (int level = 0; level <= num_levels; level++) {
+      int n = 8 << level;
+      BMESHptr m = soup(n, 0);
+
+      stop_watch clock;
+      size_t slow_n = flag_components(m).size();
+      double slow = clock.elapsed_time();
+      clock.set();
+      size_t fast_n = m->get_components().size();
+      double fast = clock.elapsed_time();
+
+      vector<Bface*> seeds;
+      for (int i=0; i<num_seeds; i++)
+         seeds.push_back(m->bf(lrand48() % m->nfaces()));
+      clock.set();
+      size_t slow_r = 0;
+      for (auto f : seeds) {
+         m->faces().set_flags(1);
+         Bface_list comp;
+         comp.grow_connected(f);
+         slow_r += comp.size();
+      }
+      double slow_reach = clock.elapsed_time();
+      clock.set();
+      size_t fast_r = 0;
+      for (auto f : seeds)
+         fast_r += Bface_list::reachable_faces(f).size();
+      double fast_reach = clock.elapsed_time();
+
+      sink = slow_n + fast_n + slow_r + fast_r;
+
+      // 16 grids side by side, each with its own vertices:
+      Wpt_list pts;
+      vector<Point3i> tris;
+      grid(n, pts, tris);
+      Wpt_list all_pts;
+      vector<Point3i> all_tris;
+      for (int k=0; k<16; k++) {
+         int base = (int)all_pts.size();
+         for (auto& p : pts)
+            all_pts.push_back(p + Wvec(k*(n+2), 0, 0));
+         for (auto& tri : tris)
+            all_tris.push_back(Point3i(tri[0]+base, tri[1]+base, tri[2]+base));
+      }
+      BMESHptr g = make_shared<BMESH>();
+      g->build(all_pts, all_tris);
+      clock.set();
+      vector<BMESHptr> pieces = g->split_components();
+      double split = clock.elapsed_time();
+
+      printf("%5d %8d       %8.4f %8.4f       %8.4f %8.4f %8.4f\n",
+             level, m->nfaces(), slow, fast, slow_reach, fast_reach, split);
+   }
+}
+
+/*****************************************************************
+ * data:
+ *
+ *   SimplexData lookups on a subdivided icosahedron, by linear
+ *   search on the owner key vs. by registered slot. Each vertex
+ *   gets 4 items keyed by owner address (like the informational
+ *   Memes of several Bbases), then a "boss" item with a slotted
+ *   key, then a UVdata. Times UVdata lookups on every vertex,
+ *   and the lookups of a Bsurface relaxation pass: the boss
+ *   item of every neighbor of every vertex. Each is repeated
+ *   10 times. (test_slots checks the lookups agree.)
+ *****************************************************************/
+static void
+bench_data(int num_levels)
+{
+   const int num_owners = 4, num_reps = 10;
+   static const char owners[num_owners] = {};
+   static const char boss = 0;
+   uintptr_t boss_key  = uintptr_t(&boss);
+   int       boss_slot = SimplexData::register_slot(boss_key);
+   uintptr_t uv_key    = uintptr_t(UVdata::static_name().c_str());
+
+   cout << "level    verts    uv: key     slot   relax: key     slot" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      LMESHptr ctrl = subdiv_icosahedron(level);
+      BMESHptr cur = ctrl->cur_mesh();
+      int nv = cur->nverts();
+
+      for (int i=0; i<nv; i++) {
+         Bvert* v = cur->bv(i);
+         for (int k=0; k<num_owners; k++)
+            new SimplexData(uintptr_t(&owners[k]), v);
+         new SimplexData(boss_key, v);
+         UVdata::get_data(v);
+      }
+
+      // the sums keep the loops from being optimized away:
+      size_t found[4] = {};
+      stop_watch clock;
+      for (int r=0; r<num_reps; r++)
+         for (int i=0; i<nv; i++)
+            found[0] += (cur->bv(i)->find_data(uv_key) != nullptr);
+      double uv_slow = clock.elapsed_time();
+      clock.set();
+      for (int r=0; r<num_reps; r++)
+         for (int i=0; i<nv; i++)
+            found[1] += (UVdata::lookup(cur->bv(i)) != nullptr);
+      double uv_fast = clock.elapsed_time();
+
+      clock.set();
+      for (int r=0; r<num_reps; r++)
+         for (int i=0; i<nv; i++) {
+            Bvert* v = cur->bv(i);
+            for (int j=0; j<v->degree(); j++)
+               found[2] += (v->nbr(j)->find_data(boss_key) != nullptr);
+         }
+      double relax_slow = clock.elapsed_time();
+      clock.set();
+      for (int r=0; r<num_reps; r++)
+         for (int i=0; i<nv; i++) {
+            Bvert* v = cur->bv(i);
+            for (int j=0; j<v->degree(); j++)
+               found[3] += (v->nbr(j)->find_data(boss_key, boss_slot) != nullptr);
+         }
+      double relax_fast = clock.elapsed_time();
+      sink = found[0] + found[1] + found[2] + found[3];
+
+      printf("%5d %8d      %8.4f %8.4f       %8.4f %8.4f\n",
+             level, nv, uv_slow, uv_fast, relax_slow, relax_fast);
+   }
+}
+
+/*****************************************************************
+ * curvature:
+ *
+ *   Curvature data on an animated sphere (a subdivided icosahedron
+ *   copied into a plain BMESH). In each of 20 frames a "brush"
+ *   moving over the sphere pushes out the vertices near it; then
+ *   the curvature is brought up to date incrementally, and also
+ *   computed from scratch. Reports average seconds per frame and
+ *   the average number of vertices recomputed. A last frame moves
+ *   every vertex (so everything is recomputed). (test_curvature
+ *   checks the two match.)
+ *****************************************************************/
+static void
+bench_curvature(int num_levels)
+{
+   const int num_frames = 20;
+
+   cout << "level    verts      full   incremental  recomputed"
+        << "   all moved" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      BMESHptr m = plain_sphere(level);
+      int nv = m->nverts();
+      m->curvature();
+
+      double full = 0, incr = 0;
+      size_t recomputed = 0;
+      for (int frame=0; frame<num_frames; frame++) {
+         brush_stroke(m, frame, num_frames);
+
+         stop_watch clock;
+         BMESHcurvature_data* c = m->curvature();
+         incr += clock.elapsed_time();
+         recomputed += c->num_recomputed();
+
+         clock.set();
+         BMESHcurvature_data scratch(m);
+         full += clock.elapsed_time();
+      }
+
+      for (int i=0; i<nv; i++)
+         m->bv(i)->set_loc(m->bv(i)->loc()*1.01);
+      m->changed(BMESH::VERT_POSITIONS_CHANGED);
+      stop_watch clock;
+      m->curvature();
+      double all = clock.elapsed_time();
+
+      printf("%5d %8d  %8.4f      %8.4f    %8d    %8.4f\n",
+             level, nv, full/num_frames, incr/num_frames,
+             int(recomputed/num_frames), all);
+   }
+}
+
+/*****************************************************************
+ * sils:
+ *
+ *   Silhouette extraction from 16 eye positions around the mesh:
+ *   a serial loop applying the Bedge::is_sil() test to every
+ *   edge (as the brute-force get_sil_strips() did) vs.
+ *   BMESH::find_sil_edges(). Also the per-face zero-crossing test
+ *   of ZcrossPath::has_sil() vs. find_zcross_faces(). Times are
+ *   per eye position. (test_sils checks the results agree.)
+ *****************************************************************/
+static void
+bench_sils(int num_levels)
+{
+   const int num_eyes = 16;
+
+   cout << "level    edges  threads    serial     batch  speedup"
+        << "   zx serial  zx batch  candidates" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      LMESHptr ctrl = subdiv_icosahedron(level);
+      BMESHptr cur = ctrl->cur_mesh();
+      cur->snapshot();
+      cur->update_normals();
+
+      double slow = 0, fast = 0, zx_slow = 0, zx_fast = 0;
+      size_t candidates = 0;
+      vector<int> serial, batch;
+      for (int k=0; k<num_eyes; k++) {
+         double a = 2*M_PI*k/num_eyes;
+         Wpt eye(3*cos(a), 3*sin(a), 1.5*cos(3*a));
+
+         stop_watch clock;
+         serial.clear();
+         for (int i=0; i<cur->nedges(); i++)
+            if (serial_sil(cur->be(i), eye))
+               serial.push_back(i);
+         slow += clock.elapsed_time();
+
+         clock.set();
+         cur->find_sil_edges(eye, batch);
+         fast += clock.elapsed_time();
+
+         clock.set();
+         serial.clear();
+         for (int i=0; i<cur->nfaces(); i++)
+            if (serial_zcross(cur->bf(i), eye))
+               serial.push_back(i);
+         zx_slow += clock.elapsed_time();
+
+         clock.set();
+         cur->find_zcross_faces(eye, batch);
+         zx_fast += clock.elapsed_time();
+         candidates += batch.size();
+      }
+
+      printf("%5d %8d  %7d  %8.4f  %8.4f  %6.2fx    %8.4f  %8.4f  %10d\n",
+             level, cur->nedges(), parallel_num_threads(),
+             slow/num_eyes, fast/num_eyes, slow/max(fast, 1e-9),
+             zx_slow/num_eyes, zx_fast/num_eyes, int(candidates/num_eyes));
+   }
+}
+
+/*****************************************************************
+ * cones:
+ *
+ *   Silhouettes during a fly-through: the camera circles a bumpy
+ *   sphere (a stand-in for a scanned model, with fine detail in
+ *   the normals) for 32 frames, moving in close and back out.
+ *   Compares BMESH::find_sil_edges(), which tests every edge, to
+ *   find_sil_edges_culled(), which tests the edges the normal-cone
+ *   tree can't rule out. Reports average edges tested and seconds
+ *   per frame. The tree is built before the first frame (build
+ *   time shown separately). (test_sil_cones checks both find the
+ *   brute force silhouettes.)
+ *****************************************************************/
+static void
+bench_cones(int num_levels)
+{
+   const int num_frames = 32;
+
+   cout << "level    edges     build  tested(all)  tested(tree)"
+        << "       all      tree     sils" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      BMESHptr m = bumpy_sphere(level);
+
+      stop_watch clock;
+      m->sil_cone_tree();
+      double build = clock.elapsed_time();
+
+      double all = 0, tree = 0;
+      size_t tested = 0, sils = 0;
+      vector<int> brute, culled, cand;
+      for (int frame=0; frame<num_frames; frame++) {
+         double a = 2*M_PI*frame/num_frames;
+         double r = 1.3 + 2*(1 + cos(a));    // 1.3 to 5.3 from center
+         Wpt eye(r*cos(a), r*sin(a), 0.5*sin(2*a));
+
+         clock.set();
+         m->find_sil_edges(eye, brute);
+         all += clock.elapsed_time();
+
+         clock.set();
+         m->find_sil_edges_culled(eye, culled);
+         tree += clock.elapsed_time();
+
+         cand.clear();
+         m->sil_cone_tree().candidates(eye, cand);
+         tested += cand.size();
+         sils   += brute.size();
+      }
+
+      printf("%5d %8d  %8.4f     %8d      %8d  %8.4f  %8.4f  %7d\n",
+             level, m->nedges(), build, m->nedges(),
+             int(tested/num_frames), all/num_frames, tree/num_frames,
+             int(sils/num_frames));
+   }
+}
+
+/*****************************************************************
+ * lines:
+ *
+ *   Object-space feature lines on the bumpy sphere, from 16 eye
+ *   positions. A serial loop over the faces, with the radial
+ *   curvature and suggestive contour test of the line drawing
+ *   shader evaluated per vertex (through the Bvert lookups of
+ *   BMESHcurvature_data), finds the faces a suggestive contour
+ *   crosses, vs. FeatureLines tracing them. Then all four kinds
+ *   of lines together. Times are per eye position, after the
+ *   curvature is computed. (test_lines checks FeatureLines
+ *   traces a segment through each face the serial loop finds.)
+ *****************************************************************/
+static void
+bench_lines(int num_levels)
+{
+   const int num_eyes = 16;
+
+   cout << "level    faces  threads    serial     batch  speedup  sc faces"
+        << "   all kinds     lines    faces" << endl;
+
+   for (int level = 0; level <= num_levels; level++) {
+      BMESHptr m = bumpy_sphere(level);
+      m->curvature();
+      m->update_normals();
+
+      FeatureLines lines;
+      double fs = m->curvature()->feature_size();
+      double sc_thresh = lines.sug_thresh()/(fs*fs);
+
+      double slow = 0, fast = 0, all = 0;
+      size_t sc_faces = 0, num_lines = 0, faces = 0;
+      vector<ZXseg> segs;
+      for (int k=0; k<num_eyes; k++) {
+         double a = 2*M_PI*k/num_eyes;
+         Wpt eye(3*cos(a), 3*sin(a), 1.5*cos(3*a));
+
+         stop_watch clock;
+         int serial = 0;
+         for (int i=0; i<m->nfaces(); i++)
+            if (serial_sc_face(m, m->bf(i), eye, sc_thresh))
+               serial++;
+         slow += clock.elapsed_time();
+
+         segs.clear();
+         clock.set();
+         lines.extract(m, eye, FeatureLines::SUGGESTIVE, segs);
+         fast += clock.elapsed_time();
+         sc_faces += serial;
+
+         segs.clear();
+         clock.set();
+         num_lines += lines.extract(m, eye,
+                                    FeatureLines::SUGGESTIVE |
+                                    FeatureLines::RIDGES |
+                                    FeatureLines::VALLEYS |
+                                    FeatureLines::APPARENT_RIDGES, segs);
+         all += clock.elapsed_time();
+         faces += lines.num_faces();
+      }
+
+      printf("%5d %8d  %7d  %8.4f  %8.4f  %6.2fx  %8d    %8.4f  %8d %8d\n",
+             level, m->nfaces(), parallel_num_threads(),
+             slow/num_eyes, fast/num_eyes, slow/max(fast, 1e-9),
+             int(sc_faces/num_eyes),
+             all/num_eyes, int(num_lines/num_eyes), int(faces/num_eyes));
+   }
+}
+
+/*****************************************************************
+ * stencils:
+ *
+ *   An animated subdivision mesh: every frame all the control
+ *   vertices move, and update_subdivision() brings the levels up
+ *   to date, walking dirty vertices level by level vs. using
+ *   SubdivStencils tables. Done for a Loop mesh (icosahedron)
+ *   and a Catmull-Clark mesh (cube). Reports seconds per frame,
+ *   and the time to build the tables and their size. (test_stencils
+ *   checks the finest levels match.)
+ *****************************************************************/
+static void
+bench_stencils(int num_levels)
+{
+   const int num_frames = 8;
+
+   cout << "scheme  level    faces  threads   walking  stencils  speedup"
+        << "     build   weights" << endl;
+
+   for (int quads = 0; quads < 2; quads++) {
+      for (int level = 1; level <= num_levels; level++) {
+         LMESHptr a = anim_lmesh(quads, level, false);
+         LMESHptr b = anim_lmesh(quads, level, true);
+         Wpt_list rest;
+         for (int i=0; i<a->nverts(); i++)
+            rest.push_back(a->bv(i)->loc());
+
+         stop_watch clock;
+         SubdivStencils tables(b.get(), level);
+         double build = clock.elapsed_time();
+
+         double slow = 0, fast = 0;
+         for (int f=1; f<=num_frames; f++) {
+            wave(a, rest, f);
+            clock.set();
+            a->update_subdivision(level);
+            slow += clock.elapsed_time();
+
+            wave(b, rest, f);
+            clock.set();
+            b->update_subdivision(level);
+            fast += clock.elapsed_time();
+         }
+
+         printf("%6s %6d %8d  %7d  %8.4f  %8.4f  %6.2fx  %8.4f  %8d\n",
+                quads ? "cc" : "loop", level, b->subdiv_mesh(level)->nfaces(),
+                parallel_num_threads(), slow/num_frames, fast/num_frames,
+                slow/max(fast, 1e-9), build, tables.num_weights());
+      }
+   }
+}
+
+/*****************************************************************
+ * adaptive:
+ *
+ *   A camera circling a bumpy sphere (a 320-face Loop control
+ *   mesh), with AdaptiveSubdiv choosing a depth per control face
+ *   each frame (within a budget of half the faces) vs. subdividing
+ *   the whole mesh to the same level.
+ *   Reports faces and seconds: for the uniform mesh, the one-time
+ *   refinement; for the adaptive one, averages per frame, with
+ *   faces refined per frame and released in all. Also reports how
+ *   many contour faces (front-facing with a back-facing neighbor)
+ *   were refined all the way down, out of how many.
+ *****************************************************************/
+static void
+bench_adaptive(int num_levels)
+{
+   const int    num_frames = 24;
+   const double pix_scale  = 4000;      // a 4000 pixel wide view, about
+
+   cout << "level   uniform   seconds   adaptive   seconds  refined"
+        << "  released  contour at max" << endl;
+
+   for (int level = 1; level <= num_levels; level++) {
+      LMESHptr u = bumpy_lmesh();
+      stop_watch clock;
+      u->update_subdivision(level);
+      double uniform = clock.elapsed_time();
+      int nu = u->subdiv_mesh(level)->nfaces();
+
+      LMESHptr a = bumpy_lmesh();
+      AdaptiveSubdiv adapt(a.get());
+      adapt.set_max_level(level);
+      adapt.set_face_budget(nu/2);
+      adapt.set_release_frames(4);
+
+      double secs = 0, faces = 0, refined = 0;
+      int released = 0, contour = 0, at_max = 0;
+      for (int k=0; k<num_frames; k++) {
+         double t = 2*M_PI*k/num_frames;
+         Wpt eye(3*cos(t), 0.5*sin(2*t), 3*sin(t));
+         clock.set();
+         faces += adapt.update(eye, pix_scale);
+         secs  += clock.elapsed_time();
+         refined  += adapt.num_refined();
+         released += adapt.num_released();
+
+         const MeshSnapshot& snap = a->snapshot();
+         for (int f=0; f<snap.nfaces(); f++) {
+            const int* fv = snap.face_verts(f);
+            const int* fe = snap.face_edges(f);
+            if (snap.norm(f)*(eye - snap.loc(fv[0])) <= 0)
+               continue;
+            bool is_contour = false;
+            for (int j=0; j<3; j++) {
+               const int* ef = snap.edge_faces(fe[j]);
+               int g = (ef[0] == f) ? ef[1] : ef[0];
+               if (g >= 0 && snap.norm(g)*(eye - snap.loc(fv[j])) <= 0)
+                  is_contour = true;
+            }
+            if (is_contour) {
+               contour++;
+               if (adapt.depth(f) == level)
+                  at_max++;
+            }
+         }
+      }
+      printf("%5d %9d  %8.4f  %9d  %8.4f  %7d  %8d  %6d / %d\n",
+             level, nu, uniform, int(faces/num_frames), secs/num_frames,
+             int(refined/num_frames), released, at_max, contour);
+   }
+}
+
+/*****************************************************************
+ * limit:
+ *
+ *   Limit positions and normals for every vertex of the level-k
+ *   Loop subdivision of the bumpy sphere, one vertex at a time
+ *   (LMESH::limit_loc() and LoopLoc::limit_normal()) vs. all at
+ *   once with LMESH::limit_data(). Reports seconds for each.
+ *   (test_limit checks the results match.)
+ *****************************************************************/
+static void
+bench_limit(int num_levels)
+{
+   cout << "level    verts  threads    serial     batch  speedup" << endl;
+
+   for (int level = 1; level <= num_levels; level++) {
+      LMESHptr ctrl = bumpy_lmesh();
+      ctrl->update_subdivision(level);
+      LMESHptr m = ctrl->subdiv_mesh(level);
+      int n = m->nverts();
+
+      stop_watch clock;
+      vector<Wpt>  locs(n);
+      vector<Wvec> norms(n);
+      LoopLoc loop;
+      for (int i=0; i<n; i++) {
+         locs [i] = m->limit_loc(m->bv(i));
+         norms[i] = loop.limit_normal(m->bv(i));
+      }
+      double slow = clock.elapsed_time();
+
+      clock.set();
+      vector<Wpt>  blocs;
+      vector<Wvec> bnorms;
+      m->limit_data(m->verts(), &blocs, &bnorms);
+      double fast = clock.elapsed_time();
+
+      printf("%5d %8d  %7d  %8.4f  %8.4f  %6.2fx\n",
+             level, n, parallel_num_threads(), slow, fast,
+             slow/max(fast, 1e-9));
+   }
+}
+
+/*****************************************************************
+ * tris:
+ *
+ *   Drawing order for the vertex cache: triangle strips vs.
+ *   Forsyth-ordered triangle lists (TriList), on an irregular
+ *   "scanned" mesh: a jittered grid (n = 8 << level) cut into
+ *   triangles along random diagonals, with the triangles listed
+ *   in random order, split into 4 patches. Reports the time to
+ *   build each for all patches, the time to send the triangles
+ *   through a StripCB, and ACMR (vertices transformed per
+ *   triangle, for a cache of TriList::cache_size() entries) as
+ *   the average over the patches and the worst patch. (test_tris
+ *   checks both draw each face.)
+ *****************************************************************/
+class CountCB : public StripCB {
+ public:
+   CountCB() : _n(0) {}
+   virtual void faceCB(CBvert* v, CBface*) { _n++; _sum += v->loc() - Wpt::Origin(); }
+   int _n;
+   Wvec _sum;
+};
+
+static void
+bench_tris(int num_levels)
+{
+   cout << "level    faces    strips      lists    draw s    draw l"
+        << "  acmr s  (worst)  acmr l  (worst)" << endl;
+
+   bool use_strips = Patch::use_tri_strips();
+   for (int level = 1; level <= num_levels; level++) {
+      srand48(level);
+      BMESHptr m = scanned_mesh(8 << level);
+      double build[2], draw[2], acmr[2], worst[2];
+      for (int lists = 0; lists < 2; lists++) {
+         Patch::set_use_tri_strips(!lists);
+         m->patches().triangulation_changed();
+
+         stop_watch clock;
+         for (int i=0; i<m->npatches(); i++)
+            if (lists)
+               m->patch(i)->build_tri_list();
+            else
+               m->patch(i)->build_tri_strips();
+         build[lists] = clock.elapsed_time();
+
+         CountCB cb;
+         clock.set();
+         for (int i=0; i<m->npatches(); i++)
+            m->patch(i)->draw_tri_strips(&cb);
+         draw[lists] = clock.elapsed_time();
+
+         acmr[lists] = worst[lists] = 0;
+         for (int i=0; i<m->npatches(); i++) {
+            double a = m->patch(i)->acmr();
+            acmr [lists] += a*m->patch(i)->num_faces()/m->nfaces();
+            worst[lists]  = max(worst[lists], a);
+         }
+      }
+      printf("%5d %8d  %8.4f  %9.4f  %8.4f  %8.4f  %6.3f  (%5.3f)  %6.3f  (%5.3f)\n",
+             level, m->nfaces(), build[0], build[1], draw[0], draw[1],
+             acmr[0], worst[0], acmr[1], worst[1]);
+   }
+   Patch::set_use_tri_strips(use_strips);
+}
+
+/*****************************************************************
+ * binio:
+ *
+ *   Mesh files: write and read back the scanned mesh above (with
+ *   creases, weak edges, vertex colors, UVs and 4 patches) as
+ *   .sm text and in the binary format. Reports file sizes and
+ *   seconds to write and read each. (test_binio checks the
+ *   reloaded meshes match the original.)
+ *****************************************************************/
+static void
+bench_binio(int num_levels)
+{
+   cout << "level    faces   text MB  write t  read t   "
+        << "bin MB  write b  read b   speedup" << endl;
+
+   const string text_file = "bench_binio.sm", bin_file = "bench_binio.jbm";
+   for (int level = 1; level <= num_levels; level++) {
+      srand48(level);
+      int n = 8 << level;
+      BMESHptr m = scanned_mesh(n);
+      for (int i=0; i<m->nedges(); i++) {
+         Bedge* e = m->be(i);
+         if (drand48() < 0.05)
+            e->set_crease();
+         else if (e->nfaces() == 2 && !e->f1()->is_quad() &&
+                  !e->f2()->is_quad() && drand48() < 0.1)
+            m->set_weak_edge(e->v1()->index(), e->v2()->index());
+      }
+      for (int i=0; i<m->nverts(); i++)
+         m->bv(i)->set_color(COLOR(drand48(), drand48(), drand48()));
+      for (int i=0; i<m->nfaces(); i++) {
+         Bface* f = m->bf(i);
+         UVdata::set(f, UVpt(f->v1()->loc()[0]/n, f->v1()->loc()[1]/n),
+                        UVpt(f->v2()->loc()[0]/n, f->v2()->loc()[1]/n),
+                        UVpt(f->v3()->loc()[0]/n, f->v3()->loc()[1]/n));
+      }
+
+      stop_watch clock;
+      m->write_file(text_file.c_str());
+      double write_t = clock.elapsed_time();
+      clock.set();
+      m->write_binary_file(bin_file.c_str());
+      double write_b = clock.elapsed_time();
+
+      clock.set();
+      BMESHptr t = BMESH::read_jot_file(text_file.c_str());
+      double read_t = clock.elapsed_time();
+      clock.set();
+      BMESHptr b = BMESH::read_jot_file(bin_file.c_str());
+      double read_b = clock.elapsed_time();
+
+      struct stat st_t, st_b;
+      stat(text_file.c_str(), &st_t);
+      stat(bin_file.c_str(),  &st_b);
+      printf("%5d %8d  %7.2f %8.4f %8.4f  %7.2f %8.4f %8.4f  %7.1fx\n",
+             level, m->nfaces(), st_t.st_size/1e6, write_t, read_t,
+             st_b.st_size/1e6, write_b, read_b, read_t/max(read_b, 1e-9));
+      remove(text_file.c_str());
+      remove(bin_file.c_str());
+   }
+}
+
+
+/*****************************************************************
+ * decode:
+ *
+ *   Reading the text formats, the old way (istream extraction,
+ *   tags found by comparing names in turn) vs. the new (reads
+ *   from the stream buffer, tags found through a hash table):
+ *
+ *     mesh:    the scanned mesh of the "binio" test written as
+ *              .sm text and read back (mostly numbers, but also
+ *              building the mesh)
+ *     points:  just its vertex positions, read as a Wpt_list
+ *     records: 1000 records per level of a class with as many
+ *              tags as VIEW has (mostly tag names)
+ *     scene:   all the tokens of a scene file (JOT_BENCH_SCENE,
+ *              default: paperdoll.jot in JOT_ROOT), read as
+ *              strings, 100 times
+ *
+ *   Times are the best of 3 runs. (test_decode checks both ways
+ *   read the same.)
+ *****************************************************************/
+static void
+bench_decode(int num_levels)
+{
+   cout << "level    faces     mesh old    new  speedup   "
+        << "points old    new  speedup  records old    new  speedup"
+        << endl;
+
+   bool fast = STDdstream::fast_reads(), hash = DATA_ITEM::use_tag_index();
+   for (int level = 1; level <= num_levels; level++) {
+      srand48(level);
+      BMESHptr m = scanned_mesh(8 << level);
+      ostringstream mesh_text;
+      m->write_stream(mesh_text);
+
+      Wpt_list pts = m->verts().pts();
+      ostringstream pts_text;
+      {
+         STDdstream out(&pts_text);
+         out << pts;
+      }
+
+      int num_items = 1000*level;
+      ostringstream item_text;
+      {
+         STDdstream out(&item_text);
+         TagRecord item;
+         for (int i=0; i<num_items; i++)
+            item.format(out);
+      }
+
+      double mesh_t[2] = { 1e9, 1e9 }, pts_t[2] = { 1e9, 1e9 };
+      double item_t[2] = { 1e9, 1e9 };
+      BMESHptr got[2];
+      Wpt_list got_pts[2];
+      TagRecord item[2];
+      for (int r = 0; r < 3; r++) {
+         for (int k = 0; k < 2; k++) {
+            STDdstream::set_fast_reads(k == 1);
+            DATA_ITEM::set_use_tag_index(k == 1);
+
+            istringstream in(mesh_text.str());
+            stop_watch clock;
+            got[k] = BMESH::read_jot_stream(in);
+            mesh_t[k] = min(mesh_t[k], clock.elapsed_time());
+
+            istringstream pin(pts_text.str());
+            STDdstream pds(&pin);
+            got_pts[k].clear();
+            clock.set();
+            pds >> got_pts[k];
+            pts_t[k] = min(pts_t[k], clock.elapsed_time());
+
+            istringstream items(item_text.str());
+            STDdstream ds(&items);
+            clock.set();
+            for (int i=0; i<num_items; i++) {
+               string name;
+               ds >> name;
+               item[k].decode(ds);
+            }
+            item_t[k] = min(item_t[k], clock.elapsed_time());
+         }
+      }
+      printf("%5d %8d  %8.4f %8.4f %6.1fx  %8.4f %8.4f %6.1fx  %8.4f %8.4f %6.1fx\n",
+             level, m->nfaces(), mesh_t[0], mesh_t[1], mesh_t[0]/mesh_t[1],
+             pts_t[0], pts_t[1], pts_t[0]/pts_t[1],
+             item_t[0], item_t[1], item_t[0]/item_t[1]);
+   }
+
+   // tokens of the scene file:
+   string scene = Config::get_var_str("JOT_BENCH_SCENE",
+                                      Config::JOT_ROOT() + "paperdoll.jot");
+   ifstream file(scene.c_str());
+   if (file) {
+      string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+      double t[2];
+      int num[2];
+      for (int k = 0; k < 2; k++) {
+         STDdstream::set_fast_reads(k == 1);
+         stop_watch clock;
+         for (int r = 0; r < 100; r++) {
+            istringstream in(text);
+            STDdstream ds(&in);
+            string s;
+            num[k] = 0;
+            while (!(ds >> s).fail())
+               num[k]++;
+         }
+         t[k] = clock.elapsed_time();
+      }
+      printf("scene %s: %d tokens (x100): old %.4f  new %.4f  %.1fx\n",
+             scene.c_str(), num[1], t[0], t[1], t[0]/t[1]);
+   }
+   STDdstream::set_fast_reads(fast);
+   DATA_ITEM::set_use_tag_index(hash);
+}
+
+/*****************************************************************
+ * dstream:
+ *
+ *   STDdstream text vs. binary encoding, writing and reading back
+ *   (best of 3 runs, sizes in MB):
+ *
+ *     mesh:    the scanned mesh of the "binio" test as a mesh
+ *              record (the .sm format)
+ *     points:  just its vertex positions, as a Wpt_list
+ *
+ *   (test_dstream checks both read back what was written.)
+ *****************************************************************/
+static void
+bench_dstream(int num_levels)
+{
+   cout << "level    faces  mesh: text MB  write   read  binary MB  write   read  "
+        << "read speedup  points: text  binary  speedup" << endl;
+
+   for (int level = 1; level <= num_levels; level++) {
+      srand48(level);
+      BMESHptr m = scanned_mesh(8 << level);
+      Wpt_list pts = m->verts().pts();
+
+      double write_t[2] = { 1e9, 1e9 }, read_t[2] = { 1e9, 1e9 };
+      double pts_t[2] = { 1e9, 1e9 };
+      size_t size[2] = { 0, 0 };
+      BMESHptr got[2];
+      Wpt_list got_pts[2];
+      for (int r = 0; r < 3; r++) {
+         for (int k = 0; k < 2; k++) {
+            ostringstream os;
+            stop_watch clock;
+            {
+               STDdstream out(&os);
+               if (k == 1)
+                  out.set_binary();
+               m->format(out);
+            }
+            string text = os.str();
+            write_t[k] = min(write_t[k], clock.elapsed_time());
+            size[k] = text.size();
+
+            istringstream in(text);
+            clock.set();
+            got[k] = BMESH::read_jot_stream(in);
+            read_t[k] = min(read_t[k], clock.elapsed_time());
+
+            ostringstream pos;
+            {
+               STDdstream out(&pos);
+               if (k == 1)
+                  out.set_binary();
+               out << pts;
+            }
+            istringstream pin(pos.str());
+            STDdstream pds(&pin);
+            got_pts[k].clear();
+            clock.set();
+            pds >> got_pts[k];
+            pts_t[k] = min(pts_t[k], clock.elapsed_time());
+         }
+      }
+
+      printf("%5d %8d  %13.2f %6.3f %6.3f  %9.2f %6.3f %6.3f  %11.1fx  %12.4f %7.4f %7.1fx\n",
+             level, m->nfaces(), size[0]/1e6, write_t[0], read_t[0],
+             size[1]/1e6, write_t[1], read_t[1], read_t[0]/max(read_t[1], 1e-9),
+             pts_t[0], pts_t[1], pts_t[0]/max(pts_t[1], 1e-9));
+   }
+}
+
+/*****************************************************************
+ * obj:
+ *
+ *   Reading .obj files: OBJReader::read() from an istream vs.
+ *   OBJReader::read_file() (mapped, read on several threads).
+ *   The file is an n x n grid (n = 8 << level) of quads and
+ *   triangles with texture coordinates and normals, 4 materials,
+ *   negative indices, comments, a group and a line continuation.
+ *   Normals differ across one grid line, making creases. Read
+ *   times are the best of 3; "build" is get_mesh(), which is the
+ *   same for both. (test_obj checks both give the same mesh.)
+ *****************************************************************/
+static void
+bench_obj(int num_levels)
+{
+   cout << "threads: " << parallel_num_threads() << endl;
+   cout << "level    faces   file MB  read istream  read_file  speedup    build  "
+        << "creases" << endl;
+
+   for (int level = 1; level <= num_levels; level++) {
+      srand48(level);
+      const string name = "bench_obj.obj";
+      write_obj(name, 8 << level);
+      struct stat st;
+      stat(name.c_str(), &st);
+
+      double read_t[2] = { 1e9, 1e9 }, build_t = 1e9;
+      BMESHptr got[2];
+      for (int r = 0; r < 3; r++) {
+         for (int k = 0; k < 2; k++) {
+            OBJReader reader;
+            stop_watch clock;
+            if (k == 0) {
+               ifstream in(name.c_str());
+               reader.read(in);
+            } else {
+               reader.read_file(name);
+            }
+            read_t[k] = min(read_t[k], clock.elapsed_time());
+            clock.set();
+            got[k] = reader.get_mesh();
+            build_t = min(build_t, clock.elapsed_time());
+         }
+      }
+      int creases = 0;
+      if (got[0])
+         for (int i=0; i<got[0]->nedges(); i++)
+            creases += got[0]->be(i)->is_crease();
+      printf("%5d %8d  %8.2f  %12.4f %10.4f  %6.1fx  %7.3f  %7d\n",
+             level, got[0] ? got[0]->nfaces() : 0, st.st_size/1e6,
+             read_t[0], read_t[1], read_t[0]/max(read_t[1], 1e-9), build_t,
+             creases);
+      remove(name.c_str());
+   }
+}
+
+/*****************************************************************
+ * ply:
+ *
+ *   Loading PLY files directly (BMESH::read_ply_file()) in the
+ *   three formats, vs. reading the .sm file ply2sm would have
+ *   made from them. The file is an n x n grid (n = 8 << level)
+ *   of quads and triangles, with vertex normals, colors and a
+ *   confidence, a face property before the vertex list, and an
+ *   extra element, all of which are skipped. (test_ply checks
+ *   each load gives the mesh ply2sm makes.)
+ *****************************************************************/
+static void
+bench_ply(int num_levels)
+{
+   cout << "threads: " << parallel_num_threads() << endl;
+   cout << "level    faces  ascii MB  bin MB   read ascii  binary le  binary be  "
+        << "read .sm  speedup" << endl;
+
+   static const char* formats[3] = {
+      "ascii", "binary_little_endian", "binary_big_endian"
+   };
+   const string name = "bench_ply.ply", sm_name = "bench_ply.sm";
+   for (int level = 1; level <= num_levels; level++) {
+      srand48(level);
+      int n = 8 << level;
+
+      vector<float> xyz;
+      vector<unsigned char> rgb;
+      vector<vector<int>> faces;
+      BMESHptr m = ply_grid(n, xyz, rgb, faces);
+
+      double read_t[3];
+      double size[3];
+      for (int k = 0; k < 3; k++) {
+         write_ply(name, formats[k], xyz, rgb, faces);
+         struct stat st;
+         stat(name.c_str(), &st);
+         size[k] = st.st_size/1e6;
+         stop_watch clock;
+         BMESHptr got = BMESH::read_jot_file(name.c_str());
+         read_t[k] = clock.elapsed_time();
+         remove(name.c_str());
+      }
+
+      m->write_file(sm_name.c_str());
+      stop_watch clock;
+      BMESHptr sm = BMESH::read_jot_file(sm_name.c_str());
+      double read_sm = clock.elapsed_time();
+      remove(sm_name.c_str());
+
+      printf("%5d %8d  %8.2f %7.2f  %11.4f %10.4f %10.4f  %8.4f  %6.1fx\n",
+             level, m->nfaces(), size[0], size[1], read_t[0], read_t[1],
+             read_t[2], read_sm, read_sm/max(read_t[1], 1e-9));
+   }
+}
+
+/*****************************************************************
+ * scene:
+ *
+ *   Loading the meshes a scene names, as a scene load decodes
+ *   them (one read_file() after another) vs. with the files read
+ *   ahead of time on several threads by IOManager::prefetch(),
+ *   given a scene file naming them with "mesh_data_file" tags,
+ *   and then decoded (as TEXBODY does) with read_data(). The
+ *   scene has 8 jittered grids (n = 8 << level) in .sm files.
+ *   (test_prefetch checks each prefetched file is found, and its
+ *   mesh matches the one read serially.)
+ *****************************************************************/
+static void
+bench_scene(int num_levels)
+{
+   cout << "threads: " << parallel_num_threads() << endl;
+   cout << "level    faces  meshes   serial  prefetch  speedup" << endl;
+
+   // (what TEXBODY registers, which isn't linked in here)
+   IOManager::add_prefetch_tag("mesh_data_file", IOManager::read_bytes);
+
+   const int num_meshes = 8;
+   const string scene = "bench_scene.jot";
+   for (int level = 1; level <= num_levels; level++) {
+      srand48(level);
+      int n = 8 << level;
+      vector<string> names = write_grid_scene(scene, n, num_meshes);
+
+      string prefix = IOManager::load_prefix();
+
+      stop_watch clock;
+      vector<BMESHptr> serial;
+      for (auto& name : names) {
+         serial.push_back(make_shared<LMESH>());
+         serial.back()->read_file((prefix + name).c_str());
+      }
+      double serial_t = clock.elapsed_time();
+
+      clock.set();
+      IOManager::prefetch(scene);
+      vector<BMESHptr> pre;
+      for (auto& name : names) {
+         shared_ptr<string> data = static_pointer_cast<string>(
+            IOManager::take_prefetched(prefix + name));
+         pre.push_back(make_shared<LMESH>());
+         if (!data || !pre.back()->read_data(*data))
+            pre.back() = nullptr;
+      }
+      double pre_t = clock.elapsed_time();
+
+      printf("%5d %8d  %6d  %7.4f  %8.4f  %6.1fx\n",
+             level, serial[0]->nfaces(), num_meshes, serial_t, pre_t,
+             serial_t/max(pre_t, 1e-9));
+
+      for (auto& name : names)
+         remove(name.c_str());
+      remove(scene.c_str());
+   }
+}
+
+/*****************************************************************
+ * main
+ *****************************************************************/
+struct bench_t {
+   const char* _name;
+   void      (*_func)(int num_levels);
+   const char* _desc;
+};
+
+static const bench_t benches[] = {
+   { "alloc",    bench_alloc,     "element allocation and teardown" },
+   { "keys",     bench_keys,      "simplex key assignment and lookup" },
+   { "build",    bench_build,     "topology construction from flat arrays" },
+   { "snapshot", bench_snapshot,  "flat mesh snapshot build and sweep" },
+   { "normals",  bench_normals,   "batched vertex normal recomputation" },
+   { "pick",     bench_pick,      "ray picking: brute force vs. BVH" },
+   { "nearest",  bench_nearest,   "nearest vertex/edge queries: brute force vs. index" },
+   { "weld",     bench_weld,      "vertex welding: pairwise merges vs. one pass" },
+   { "traverse", bench_traverse,  "graph searches: flag clearing vs. traversal marks" },
+   { "data",     bench_data,      "simplex data lookup: by key vs. by slot" },
+   { "curvature", bench_curvature, "curvature on an animated mesh: from scratch vs. incremental" },
+   { "sils",     bench_sils,      "silhouette extraction: serial edge tests vs. batch" },
+   { "cones",    bench_cones,     "silhouettes in a fly-through: all edges vs. normal-cone tree" },
+   { "lines",    bench_lines,     "object-space suggestive contours and ridges: serial vs. batch" },
+   { "stencils", bench_stencils,  "animated subdivision: dirty-vertex walk vs. stencil tables" },
+   { "adaptive", bench_adaptive,  "view-dependent subdivision in a fly-through vs. uniform levels" },
+   { "limit",    bench_limit,     "limit positions and normals: per vertex vs. batch" },
+   { "tris",     bench_tris,      "vertex cache order: triangle strips vs. Forsyth triangle lists" },
+   { "binio",    bench_binio,     "mesh files: .sm text vs. binary, write, read and round trip" },
+   { "decode",   bench_decode,    "text decoding: istream reads and tag search vs. fast reads and tag hash" },
+   { "dstream",  bench_dstream,   "STDdstream encoding: text vs. binary, meshes and point lists" },
+   { "obj",      bench_obj,       ".obj import: istream reader vs. mapped parallel reader" },
+   { "ply",      bench_ply,       "PLY loading (ascii, binary) vs. reading converted .sm" },
+   { "scene",    bench_scene,     "scene mesh files: read while decoding vs. prefetched on threads" },
+};
+static const int num_benches = sizeof(benches)/sizeof(benches[0]);
+
+static void
+usage(const char* prog)
+{
+   err_msg("Usage: %s <test> [ num_levels ]", prog);
+   for (int i=0; i<num_benches; i++)
+      err_msg("  %-10s %s", benches[i]._name, benches[i]._desc);
+}
+
+int
+main(int argc, char *argv[])
+{
+   if (argc < 2 || argc > 3) {
+      usage(argv[0]);
+      return 1;
+   }
+
+   int num_levels = (argc == 3) ? max(atoi(argv[2]), 0) : 6;
+
+   for (int i=0; i<num_benches; i++) {
+      if (string(argv[1]) == benches[i]._name) {
+         benches[i]._func(num_levels);
+         return 0;
+      }
+   }
+   usage(argv[0]);
+   return 1;
+}
@@ -18,6 +18,7 @@
 #include "mesh/patch.hpp"
 #include "mesh/mi.hpp"
 #include "mesh/uv_data.hpp"
+#include "mesh/traversal_marks.hpp"
 
 using namespace mlib;
 
@@ -929,6 +930,52 @@ Bface::redefine(
    return 1;
 }
 
+int
+Bface::redefine(Bvert *a, Bvert *b, Bvert *c)
+{
+   // redefine the face with vertices a, b, c in place of
+   // _v1, _v2, _v3 (any of which may be unchanged)
+
+   // precondition:
+   //    this face has already detached from its edges.
+   //    new edges have already been created appropriately.
+   //    new face will not duplicate an existing face
+
+   if (a == b || b == c || c == a)
+      return 0;
+
+   Bedge* e1 = a->lookup_edge(b);
+   Bedge* e2 = b->lookup_edge(c);
+   Bedge* e3 = c->lookup_edge(a);
+
+   if (!e1 || !e2 || !e3 || lookup_face(a, b, c))
+      return 0;
+
+   // coast is clear -- do it
+   _v1 = a;
+   _v2 = b;
+   _v3 = c;
+
+   _e1 = e1;
+   _e2 = e2;
+   _e3 = e3;
+
+   *_e1 += this;
+   *_e2 += this;
+   *_e3 += this;
+
+   // tell patch strips are invalid:
+   if (_patch)
+      _patch->triangulation_changed();
+   _orient = nullptr;
+
+   // invalidate cached state in this face
+   // and neighboring simplices:
+   geometry_changed();
+
+   return 1;
+}
+
 CWvec&
 Bface::vert_normal(CBvert* v, Wvec& n) const
 {
@@ -1381,24 +1428,50 @@ Bface_list
 Bface_list::reachable_faces(Bface* f, CSimplexFilter& pass)
 {
    // Returns the list of faces reachable from f, crossing
-   // only edges accepted by the filter. It sets needed
-   // flags (on the entire mesh) then calls grow_connected().
+   // only edges accepted by the filter. Only the reachable
+   // faces are touched (see TraversalMarks).
 
    Bface_list ret;
 
    if (!(f && f->mesh()))
       return ret;
 
-   // Ensure all reachable face flags are set to 1:
+   TraversalMarks marks;
+   ret.grow_connected(f, marks, pass);
+   return ret;
+}
+
+bool
+Bface_list::grow_connected(Bface* f, TraversalMarks& marks, CSimplexFilter& pass)
+{
+   // Collect all reachable faces not yet marked, starting at f,
+   // crossing only edges that are accepted by the given filter.
+   // Uses an explicit stack, so big regions can't overflow the
+   // call stack.
 
-   // XXX -
-   //   touches every face in the mesh; a better
-   //   implementation would just touch reachable ones
-   //   (or is that impossible to implement?)
-   f->mesh()->faces().set_flags(1);
+   if (!f || !marks.try_mark(f))
+      return false;
 
-   ret.grow_connected(f, pass);
-   return ret;
+   vector<Bface*> stack(1, f);
+   while (!stack.empty()) {
+      Bface* cur = stack.back();
+      stack.pop_back();
+      push_back(cur);
+
+      // check each neighboring edge:
+      for (int i=1; i<4; i++) {
+         Bedge* e = cur->e(i);
+         if (pass.accept(e)) {
+            for (int j=1; j<=e->num_all_faces(); j++) {
+               Bface* g = e->f(j);
+               if (g && marks.try_mark(g))
+                  stack.push_back(g);
+            }
+         }
+      }
+   }
+
+   return true;
 }
 
 bool
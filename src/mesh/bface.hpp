@@ -25,6 +25,7 @@
 
 class EdgeStrip;
 class Patch;
+class TraversalMarks;
 /**********************************************************************
  * Bface:
  *
@@ -78,6 +79,15 @@ class Bface  : public Bsimplex {
       return _norm;
    }
 
+   // Store a normal and area computed elsewhere (see
+   // BMESH::update_normals()); they stay valid until the next
+   // geometry change, same as ones computed by set_normal():
+   void set_norm(CWvec& n, double a) {
+      set_bit(VALID_NORMAL_BIT,1);
+      _norm = n;
+      _area = a;
+   }
+
    // Vertex normal - average of face normals around vertex, not
    // crossing any crease edges to reach the other faces, starting
    // from this one. 2nd version returns result by copying.
@@ -579,6 +589,7 @@ class Bface  : public Bsimplex {
 
    int  redefine(Bvert *v, Bvert *u);
    int  redefine(Bvert *u, Bvert *nu, Bvert *v, Bvert *nv);
+   int  redefine(Bvert *a, Bvert *b, Bvert *c);  // new v1, v2, v3
 
    // New versions of face redefinition, under development 12/2004:
 
@@ -634,6 +645,7 @@ class Bface  : public Bsimplex {
    //*******************************************************
  protected:
    friend       class Patch;
+   friend       class SubdivStencils;
 
    Bvert*       _v1;            // vertex 1 (vertices listed in CCW order)
    Bvert*       _v2;            // vertex 2
@@ -925,8 +937,7 @@ class Bface_list : public SimplexArray<Bface_list,Bface*> {
    //   Returns the list of faces reachable from f,
    //   crossing only edges accepted by the filter.
    //   (The default filter accepts all edges.)
-   //   It sets needed flags (on the entire mesh)
-   //   then calls grow_connected(), below:
+   //   Calls the TraversalMarks version of grow_connected():
    static Bface_list reachable_faces(Bface* f, CSimplexFilter& =BedgeFilter());
 
    // grow_connected:
@@ -942,6 +953,12 @@ class Bface_list : public SimplexArray<Bface_list,Bface*> {
    //
    bool grow_connected(Bface* f, CSimplexFilter& =BedgeFilter());
 
+   //   Same, but collects faces not yet marked in the given
+   //   TraversalMarks, marking each one collected. Needs no
+   //   flags, so faces outside the search are not touched:
+   bool grow_connected(Bface* f, TraversalMarks& marks,
+                       CSimplexFilter& =BedgeFilter());
+
    //******** PUSH LAYER ********
 
    // Given a set of faces from a single mesh, mark the
@@ -15,10 +15,14 @@
  * You should have received a copy of the GNU General Public License
  * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
  *****************************************************************/
+#include <cstring>
 #include <fstream>
+#include <unordered_map>
+#include <unordered_set>
 #include "std/run_avg.hpp"
 #include "std/stop_watch.hpp"
 #include "std/config.hpp"
+#include "std/parallel.hpp"
 
 #include "disp/ray.hpp"
 #include "net/io_manager.hpp"
@@ -26,9 +30,12 @@
 #include "mesh/patch.hpp"
 #include "mesh/uv_data.hpp"
 #include "mesh/base_ref_image.hpp"
+#include "mesh/feature_lines.hpp"
 #include "mesh/ioblock.hpp"
 #include "mesh/lmesh.hpp"      // because of DECODER_ADD(LMESH) hack, below
 #include "mesh/patch_blend_weight.hpp"
+#include "mesh/proximity_index.hpp"
+#include "mesh/traversal_marks.hpp"
 
 using namespace mlib;
 
@@ -107,6 +114,15 @@ BMESH::BMESH(int num_v, int num_e, int num_f) :
    _pm_stamp(0),
    _eye_local_stamp(0),
    _curv_data(nullptr),
+   _snapshot(nullptr),
+   _normals_dirty(false),
+   _face_bvh(nullptr),
+   _face_bvh_valid(false),
+   _sil_tree(nullptr),
+   _sil_tree_valid(false),
+   _feature_lines(nullptr),
+   _vert_prox(nullptr),
+   _edge_prox(nullptr),
    _avg_edge_len(0),
    _avg_edge_len_valid(0),
    _edit_level(0),
@@ -121,6 +137,8 @@ BMESH::BMESH(int num_v, int num_e, int num_f) :
    _shadow_offset(0.0)
 {
    _drawables.set_unique();
+
+   reserve_elements(num_v, num_e, num_f);
 }
 
 BMESH::BMESH(CBMESH& m) :
@@ -139,6 +157,15 @@ BMESH::BMESH(CBMESH& m) :
    _pm_stamp(0),
    _eye_local_stamp(0),
    _curv_data(nullptr),
+   _snapshot(nullptr),
+   _normals_dirty(false),
+   _face_bvh(nullptr),
+   _face_bvh_valid(false),
+   _sil_tree(nullptr),
+   _sil_tree_valid(false),
+   _feature_lines(nullptr),
+   _vert_prox(nullptr),
+   _edge_prox(nullptr),
    _avg_edge_len(0),
    _avg_edge_len_valid(0),
    _edit_level(0),
@@ -415,6 +442,234 @@ BMESH::add_quad(int i, int j, int k, int l,
       nullptr);
 }
 
+/*****************************************************************
+ * EdgeHash:
+ *
+ *   Maps an unordered pair of vertex indices to an int (an index
+ *   into a list of edges). Open addressing with linear probing.
+ *   Used by BMESH::add_faces().
+ *****************************************************************/
+class EdgeHash {
+ public:
+   EdgeHash(size_t n) : _num(0) { alloc(n + n/2); }
+
+   // Return the value stored for the pair (i,j). If the pair is
+   // new, store val for it and return -1:
+   int find_or_insert(uint i, uint j, int val) {
+      if (4*(_num + 1) > 3*_keys.size())
+         grow();
+      uint64_t k = pair_key(i,j);
+      size_t mask = _keys.size() - 1;
+      for (size_t s = slot(k); ; s = (s + 1) & mask) {
+         if (_keys[s] == k)
+            return _vals[s];
+         if (_keys[s] == EMPTY) {
+            _keys[s] = k;
+            _vals[s] = val;
+            _num++;
+            return -1;
+         }
+      }
+   }
+
+ protected:
+   static const uint64_t EMPTY = ~uint64_t(0);
+
+   vector<uint64_t>  _keys;     // sorted vertex pair, or EMPTY
+   vector<int>       _vals;
+   size_t            _num;      // number of keys stored
+   int               _shift;    // 64 - log2(table size)
+
+   static uint64_t pair_key(uint i, uint j) {
+      return (i < j) ? ((uint64_t(i) << 32) | j) : ((uint64_t(j) << 32) | i);
+   }
+   size_t slot(uint64_t k) const {
+      return size_t((k * 0x9e3779b97f4a7c15ULL) >> _shift);
+   }
+
+   void alloc(size_t n) {
+      size_t size = 16;
+      _shift = 60;
+      while (size < n) {
+         size *= 2;
+         _shift--;
+      }
+      _keys.assign(size, EMPTY);
+      _vals.resize(size);
+      _num = 0;
+   }
+
+   void grow() {
+      vector<uint64_t> keys;
+      vector<int>      vals;
+      keys.swap(_keys);
+      vals.swap(_vals);
+      alloc(2*keys.size());
+      size_t mask = _keys.size() - 1;
+      for (size_t i=0; i<keys.size(); i++) {
+         if (keys[i] == EMPTY)
+            continue;
+         size_t s = slot(keys[i]);
+         while (_keys[s] != EMPTY)
+            s = (s + 1) & mask;
+         _keys[s] = keys[i];
+         _vals[s] = vals[i];
+         _num++;
+      }
+   }
+};
+const uint64_t EdgeHash::EMPTY;
+
+Bface_list
+BMESH::add_faces(const vector<Point3i>& tris, Patch* p)
+{
+   return _add_faces(tris, nullptr, p);
+}
+
+Bface_list
+BMESH::add_faces(const vector<Point3i>& tris, const vector<Patch*>& patches)
+{
+   if (patches.size() != tris.size()) {
+      err_msg("BMESH::add_faces: error: %d patches for %d triangles",
+              patches.size(), tris.size());
+      return Bface_list();
+   }
+   return _add_faces(tris, &patches, nullptr);
+}
+
+Bface_list
+BMESH::build(CWpt_list& pts, const vector<Point3i>& tris, Patch* p)
+{
+   // Indices in tris refer to pts, which are appended after any
+   // vertices the mesh already has:
+   int n = nverts();
+   _verts.reserve(n + pts.size());
+   reserve_elements(pts.size(), 0, 0);
+   for (Wpt_list::size_type i=0; i<pts.size(); i++)
+      add_vertex(pts[i]);
+
+   if (n == 0)
+      return add_faces(tris, p);
+
+   vector<Point3i> shifted(tris);
+   for (auto& tri : shifted)
+      tri = Point3i(tri[0] + n, tri[1] + n, tri[2] + n);
+   return add_faces(shifted, p);
+}
+
+Bface_list
+BMESH::_add_faces(const vector<Point3i>& tris,
+                  const vector<Patch*>* patches, Patch* p)
+{
+   // Bulk version of add_face(i,j,k,p); see comment in bmesh.hpp.
+   // patches (if not null) gives the patch for each triangle,
+   // otherwise p is used for all of them.
+
+   Bface_list ret(tris.size());
+   if (tris.empty())
+      return ret;
+
+   // Pass 1: give each distinct vertex pair an entry in 'pairs',
+   // in order of first use, and record the 3 entries used by each
+   // triangle. An edge that already exists in the mesh is looked
+   // up here (only needed when both vertices already have edges):
+   struct pair_t {
+      int    _i, _j;    // vertex indices, in order of first use
+      Bedge* _e;        // the edge, once it exists
+   };
+   vector<pair_t> pairs;
+   pairs.reserve(tris.size()*3/2 + 3);
+   vector<int> tri_pairs(3*tris.size(), -1);
+   EdgeHash hash(tris.size()*3/2 + 3);
+   int num_tris = 0;
+   for (vector<Point3i>::size_type t=0; t<tris.size(); t++) {
+      const Point3i& tri = tris[t];
+      if (!valid_vert_indices(tri[0],tri[1],tri[2]) ||
+          tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+         continue; // reported below
+      num_tris++;
+      for (int k=0; k<3; k++) {
+         int i = tri[k], j = tri[(k+1)%3];
+         int n = hash.find_or_insert(i, j, pairs.size());
+         if (n < 0) {
+            n = pairs.size();
+            Bedge* e = nullptr;
+            if (_verts[i]->degree() > 0 && _verts[j]->degree() > 0)
+               e = _verts[i]->lookup_edge(_verts[j]);
+            pairs.push_back(pair_t{i, j, e});
+         }
+         tri_pairs[3*t + k] = n;
+      }
+   }
+
+   // Pass 2: size the lists, then create the new edges:
+   int num_edges = 0;
+   for (auto& pr : pairs)
+      if (!pr._e)
+         num_edges++;
+   _edges.reserve(_edges.size() + num_edges);
+   _faces.reserve(_faces.size() + num_tris);
+   reserve_elements(0, num_edges, num_tris);
+
+   BMESHptr self = shared_from_this();
+   for (auto& pr : pairs) {
+      if (!pr._e) {
+         pr._e = new_edge(_verts[pr._i], _verts[pr._j]);
+         pr._e->set_mesh(self);
+         _edges.push_back(pr._e);
+      }
+   }
+
+   // Pass 3: create the faces:
+   Patch* last_patch = nullptr;
+   bool   patch_ok   = false;
+   for (vector<Point3i>::size_type t=0; t<tris.size(); t++) {
+      const Point3i& tri = tris[t];
+      if (tri_pairs[3*t] < 0) {
+         if (!valid_vert_indices(tri[0],tri[1],tri[2]))
+            err_msg("BMESH::add_faces: Error: invalid vertex indices (%d,%d,%d)",
+                    tri[0], tri[1], tri[2]);
+         else
+            err_msg("BMESH::add_faces: Error: repeated vertex");
+         ret.push_back(nullptr);
+         continue;
+      }
+      Bvert* w  = _verts[tri[2]];
+      Bedge* e1 = pairs[tri_pairs[3*t    ]]._e;
+      Bedge* e2 = pairs[tri_pairs[3*t + 1]]._e;
+      Bedge* e3 = pairs[tri_pairs[3*t + 2]]._e;
+
+      // If the face already exists, return it (as in add_face()):
+      Bface* f = e1->lookup_face(w);
+      if (!f) {
+         f = new_face(_verts[tri[0]], _verts[tri[1]], w, e1, e2, e3);
+         f->set_mesh(self);
+         _faces.push_back(f);
+
+         Patch* fp = patches ? (*patches)[t] : p;
+         if (fp && fp != last_patch) {
+            last_patch = fp;
+            patch_ok = (fp->mesh().get() == this);
+            if (!patch_ok)
+               err_msg("BMESH::add_faces: error: patch specified "
+                       "belongs to a different mesh");
+         }
+         if (fp && patch_ok)
+            fp->add(f);
+      }
+      ret.push_back(f);
+   }
+
+   int num_multi = 0;
+   for (auto& pr : pairs)
+      if (pr._e->is_multi())
+         num_multi++;
+   if (num_multi > 0)
+      err_msg("BMESH::add_faces: warning: %d non-manifold edges", num_multi);
+
+   return ret;
+}
+
 Bface*
 BMESH::lookup_face (const Point3i &p)
 {
@@ -896,28 +1151,91 @@ BMESH::pick_face(
    Wpt&         world_hit       // returned: hit point in world space
    ) const
 {
-   // Brute force intersection:
-   //   Given ray in world space, return intersected face (if any)
+   // Given ray in world space, return intersected face (if any)
    //   and intersection point in world space:
 
    static bool debug = Config::get_var_bool("DEBUG_PICK_FACE",false);
    if (debug)
-      err_msg("BMESH::pick_face: doing brute force intersection");
+      err_msg("BMESH::pick_face: doing BVH intersection");
 
    Wpt  p = inv_xform() * world_ray.point();
    Wvec n = inv_xform() * world_ray.direction();
 
-   Bface* ret = nullptr;        // face to return
-   double d, min_d = -1;        // distance, min distance
-   Wpt    h;                    // (temp) hit point
-   for (int i=0; i<nfaces(); i++) {
-      if (bf(i)->ray_intersect(p, n, h, d) && (!ret || d < min_d)) {
-         min_d     = d;
-         ret       = bf(i);
-         world_hit = xform()*h;
-      }
+   const FaceBVH& bvh = face_bvh();
+   Wpt    h;
+   double d;
+   int f = bvh.intersect(snapshot(), p, n, h, d);
+   if (f < 0)
+      return nullptr;
+   world_hit = xform()*h;
+   return bf(f);
+}
+
+void
+BMESH::pick_faces(
+   const vector<Wline>& world_rays,     // rays in world space
+   vector<Bface*>&      faces,          // returned: face hit, or null
+   vector<Wpt>&         world_hits      // returned: hit points
+   ) const
+{
+   vector<Wline> rays;
+   rays.reserve(world_rays.size());
+   for (auto& r : world_rays)
+      rays.push_back(Wline(inv_xform() * r.point(),
+                           inv_xform() * r.direction()));
+
+   const FaceBVH& bvh = face_bvh();
+   vector<int> ids;
+   bvh.intersect(snapshot(), rays, ids, world_hits);
+
+   faces.resize(ids.size());
+   for (size_t i=0; i<ids.size(); i++) {
+      faces[i] = (ids[i] < 0) ? nullptr : bf(ids[i]);
+      if (faces[i])
+         world_hits[i] = xform()*world_hits[i];
    }
-   return ret;
+}
+
+const FaceBVH&
+BMESH::face_bvh() const
+{
+   const MeshSnapshot& snap = snapshot();
+   if (_face_bvh && _face_bvh->nfaces() != snap.nfaces()) {
+      delete _face_bvh;
+      _face_bvh = nullptr;
+   }
+   if (!_face_bvh) {
+      _face_bvh = new FaceBVH(snap);
+   } else if (!_face_bvh_valid) {
+      _face_bvh->refit(snap);
+   }
+   _face_bvh_valid = true;
+   return *_face_bvh;
+}
+
+const SilConeTree&
+BMESH::sil_cone_tree() const
+{
+   const MeshSnapshot& snap = snapshot();
+   if (_sil_tree && _sil_tree->nedges() != snap.nedges()) {
+      delete _sil_tree;
+      _sil_tree = nullptr;
+   }
+   if (!_sil_tree) {
+      _sil_tree = new SilConeTree(snap);
+   } else if (!_sil_tree_valid) {
+      _sil_tree->refit(snap);
+   }
+   _sil_tree_valid = true;
+   return *_sil_tree;
+}
+
+FeatureLines&
+BMESH::feature_lines() const
+{
+   if (!_feature_lines)
+      _feature_lines = new FeatureLines;
+   return *_feature_lines;
 }
 
 int
@@ -1098,6 +1416,18 @@ BMESH::build_vert_strips()
    return _lone_verts->num();
 }
 
+// The patch of mesh m that takes lines found on face f. Faces of
+// finer meshes, as found with adaptive subdivision (see
+// LMESH::adaptive()), give theirs to the control patch:
+inline Patch*
+line_patch(const BMESH* m, Bface* f)
+{
+   Patch* p = f ? f->patch() : nullptr;
+   if (p && p->mesh().get() != m)
+      p = p->ctrl_patch();
+   return p;
+}
+
 int
 BMESH::build_zcross_strips()
 {
@@ -1128,7 +1458,7 @@ BMESH::build_zcross_strips()
    // distribute sils to patches
 
    Patch*  p = nullptr;
-   Patch* lp = _zx_sils.seg(0).f()->patch(); // last p
+   Patch* lp = line_patch(this, _zx_sils.seg(0).f()); // last p
    assert (lp != nullptr);
 
 
@@ -1142,7 +1472,7 @@ BMESH::build_zcross_strips()
       // this accessor is probably less than safe...
       if (f) {
 
-         p = f->patch();
+         p = line_patch(this, f);
          assert(p);
 
          p->zx_sils().add_seg (_zx_sils.seg(k));
@@ -1173,6 +1503,38 @@ BMESH::build_zcross_strips()
    return _zx_sils.num();
 }
 
+/*****************************************************************
+ * MarkedSilEdgeFilter:
+ *
+ *   Like NewSilEdgeFilter, but accepts edges found by
+ *   BMESH::find_sil_edges() (and marked) instead of asking each
+ *   edge whether it is a silhouette.
+ *****************************************************************/
+class MarkedSilEdgeFilter : public SimplexFilter {
+ public:
+   MarkedSilEdgeFilter(const TraversalMarks& marks, uint frame_number,
+                       bool skip_sec=true) :
+      _marks(marks), _stamp(frame_number), _skip_secondary(skip_sec) {}
+
+   virtual bool accept(CBsimplex* s) const {
+      if (!(is_edge(s) && _marks.is_marked(s)))
+         return false;
+      Bedge* e = (Bedge*)s;
+      if (e->sil_stamp() == _stamp)             // reject if previously checked
+         return false;
+      e->set_sil_stamp(_stamp);                 // mark as checked this frame
+      return !(_skip_secondary && e->is_secondary());
+   }
+
+ protected:
+   const TraversalMarks& _marks;
+   uint  _stamp;                // frame number of current frame
+   bool  _skip_secondary;       // if true, skip "secondary" edges
+};
+
+// faces or vertices per thread in the batch silhouette passes:
+static const int SIL_GRAIN = 4096;
+
 RunningAvg<double> rand_secs(0);  // secs per randomized extraction
 RunningAvg<double> brute_secs(0); // secs per brute-force extraction
 RunningAvg<double> zx_secs(0);    // secs per zero-cross extraction (randomized)
@@ -1218,9 +1580,21 @@ BMESH::get_zcross_strips()
        old_segs.empty()                 ||      // or there are no old ones
        !_random_sils || CHECK_ALL) {            // or sposed to do brute force
 
-      // check all edges to find new sils:
-      for (int k = 0; k < n ; k++)
-         _zx_sils.start_sil(_faces[k]);
+      static int batch_min = Config::get_var_int("JOT_BATCH_SILS_MIN_FACES", 4096);
+      if (n < batch_min) {
+         // check all edges to find new sils:
+         for (int k = 0; k < n ; k++)
+            _zx_sils.start_sil(_faces[k]);
+      } else {
+         // Start only from faces that may have sils. Faces without
+         // one are skipped by start_sil() anyway, so the strips come
+         // out the same:
+         update_normals();
+         vector<int> faces;
+         find_zcross_faces(_zx_sils.eye(), faces);
+         for (size_t k = 0; k < faces.size(); k++)
+            _zx_sils.start_sil(_faces[faces[k]]);
+      }
 
    } else {
       size_t i;
@@ -1304,7 +1678,7 @@ BMESH::build_sil_strips()
       // so just take the non-null face:
       if (!f)
          f = e->get_face();
-      if (f && (p = f->patch()))
+      if ((p = line_patch(this, f)))
          p->sils().add(_sils.vert(k), e);
    }
 
@@ -1331,19 +1705,45 @@ BMESH::get_sil_strips()
 
    static int min_rand_edges =
       Config::get_var_int("RANDOMIZED_MIN_EDGES", 4000, true);
+   static int batch_min = Config::get_var_int("JOT_BATCH_SILS_MIN_FACES", 4096);
+
+   // On large meshes the cone tree finds all the sils in about
+   // the time the randomized search takes, so it is used instead:
+   static bool use_tree = Config::get_var_bool("JOT_SIL_CONE_TREE", true);
+   bool culled = use_tree && nfaces() >= batch_min;
 
    if (nedges() < min_rand_edges        ||  // if too few edges
        _sil_stamp < VIEW::stamp() - 1   ||  // or old sils are too old
        old_sils.empty()                 ||  // or there are no old sils
-       !_random_sils) {                     // or we're not doing random sils
+       !_random_sils || culled) {           // or we're not doing random sils
 
       // We'll time it:
       stop_watch clock;
 
-      // Check all edges to find new sils:
-      for (Bedge_list::size_type k=0; k<_edges.size(); k++)
-         if (_edges[k]->is_sil())
-            _sils.build(nullptr, _edges[k], filter);  // get all connected sils
+      if (nfaces() < batch_min) {
+         // Check all edges to find new sils:
+         for (Bedge_list::size_type k=0; k<_edges.size(); k++)
+            if (_edges[k]->is_sil())
+               _sils.build(nullptr, _edges[k], filter);  // get all connected sils
+      } else {
+         // Find them all at once, then chain them in edge order.
+         // Uses the eye that Bface::front_facing() does:
+         static bool ignore_xf =
+            Config::get_var_bool("SILS_IGNORE_MESH_XFORM",false);
+         CWpt& eye = ignore_xf ? VIEW::peek_cam()->data()->from() : eye_local();
+         vector<int> sils;
+         if (culled)
+            find_sil_edges_culled(eye, sils);
+         else
+            find_sil_edges(eye, sils);
+         TraversalMarks marks;
+         for (size_t k=0; k<sils.size(); k++)
+            marks.mark(_edges[sils[k]]);
+         MarkedSilEdgeFilter marked(marks, VIEW::stamp(),
+                                    !show_secondary_faces());
+         for (size_t k=0; k<sils.size(); k++)
+            _sils.build(nullptr, _edges[sils[k]], marked);
+      }
 
       // Record the time taken and number of silhouettes found:
       brute_secs.add(clock.elapsed_time());
@@ -1533,6 +1933,8 @@ BMESH::draw_img(const RefImgDrawer& r)
 
    send_update_notification();
 
+   update_normals();
+
    return r.draw(&_drawables);
 }
 
@@ -1587,6 +1989,11 @@ BMESH::read_jot_file(const char* filename, BMESHptr ret)
       err_msg("BMESH::read_jot_file() - Filename is NULL");
       return nullptr;
    }
+   if (is_binary_file(filename))
+      return read_binary_file(filename, ret);
+   if (is_ply_file(filename))
+      return read_ply_file(filename, ret);
+
    fstream fin;
 #if (defined (WIN32) && (defined(_MSC_VER) && (_MSC_VER <=1300))) /*VS 6.0*/
 
@@ -1620,9 +2027,17 @@ BMESH::read_jot_stream(istream& in, BMESHptr ret)
       in.get();
 
    // If the first character isn't printable, reject it
+   // (unless it starts a binary mesh)
    char firstchar = in.peek();
 
-   if (!isprint(firstchar)) {
+   if (firstchar == '\211') {
+      // First byte of the binary format (see bmesh_binary.cpp):
+      return read_binary_stream(in, ret);
+   } else if (firstchar == 'p') {
+      // PLY (see bmesh_ply.cpp); mesh class names are capitalized:
+      return read_ply_stream(in, ret);
+   } else if (!isprint(firstchar) && firstchar != '\0') {
+      // (a 0 byte starts a binary STDdstream, read below)
       err_msg("BMESH::read_jot_stream() - Unreadable: Non-printable first character.");
       return nullptr;
    } else if (isdigit(firstchar)) {
@@ -1666,8 +2081,17 @@ BMESH::read_jot_stream(istream& in, BMESHptr ret)
             return nullptr;
          }
 
-         // Get the correct type (BMESH or LMESH) as specified in the file:
-         ret = dynamic_cast<BMESH*>(di->dup())->shared_from_this();
+         // Get the correct type (BMESH or LMESH) as specified in the file.
+         // (The new mesh isn't owned by a shared_ptr yet, so make one;
+         // shared_from_this() would throw.)
+         DATA_ITEM* item = di->dup();
+         BMESH* mesh = dynamic_cast<BMESH*>(item);
+         if (mesh) {
+            ret = BMESHptr(mesh);
+         } else {
+            delete item;
+            ret = nullptr;
+         }
          if (!ret) {
             err_msg(
                "BMESH::read_jot_stream() - Error: Class '#%s' is not a BMESH subclass.",
@@ -1699,6 +2123,28 @@ BMESH::read_file(const char* filename)
    return true;
 }
 
+bool
+BMESH::read_data(const string& data)
+{
+   // As read_file(), for a file's contents:
+
+   BMESHptr mesh;
+   if (is_binary_data(data.data(), data.size())) {
+      mesh = read_binary_data(data.data(), data.size(), shared_from_this());
+   } else if (is_ply_data(data.data(), data.size())) {
+      mesh = read_ply_data(data.data(), data.size(), shared_from_this());
+   } else {
+      istringstream in(data);
+      mesh = read_jot_stream(in, shared_from_this());
+   }
+   if (!mesh)
+      return false;
+   if (this != mesh.get())
+      *this = *mesh;
+
+   return true;
+}
+
 // XXX - Deprecated (now TEXBODY's mesh_data_update_file tag
 //       also just uses read_file)
 int
@@ -1929,15 +2375,18 @@ BMESH::read_faces(istream& is)
 
    int ret = 1; // really it's a bool (1 == success)
 
+   // Read all the vertex index triples, then create the faces:
+   vector<Point3i> tris;
+   tris.reserve(max(n,0));
    for ( ; n>0 && !is.eof(); n--) {
-
-      // Read 3 vertex indices:
       is >> i >> j >> k;
+      tris.push_back(Point3i(i,j,k));
+   }
 
-      // Create the face:
-      if (!add_face(i,j,k,nullptr))
+   Bface_list faces = add_faces(tris);
+   for (Bface_list::size_type f=0; f<faces.size(); f++)
+      if (!faces[f])
          ret = 0;       // not success
-   }
 
    return ret;
 }
@@ -2294,6 +2743,22 @@ BMESH::write_polylines(ostream& os) const
    return 1;
 }
 
+void
+BMESH::reserve_elements(int num_v, int num_e, int num_f)
+{
+   _vert_pool.reserve(max(num_v, 0));
+   _edge_pool.reserve(max(num_e, 0));
+   _face_pool.reserve(max(num_f, 0));
+}
+
+void
+BMESH::share_pools(CBMESH& m)
+{
+   _vert_pool.share(m._vert_pool);
+   _edge_pool.share(m._edge_pool);
+   _face_pool.share(m._face_pool);
+}
+
 void
 BMESH::delete_elements()
 {
@@ -2304,9 +2769,36 @@ BMESH::delete_elements()
    // delete mesh elements, faces first,
    // since deleting a vert will also delete adjacent
    // edges and faces.
-   _faces.delete_all();
-   _edges.delete_all();
-   _verts.delete_all();
+   while (!_faces.empty()) {
+      delete_face(_faces.back());
+      _faces.pop_back();
+   }
+   while (!_edges.empty()) {
+      delete_edge(_edges.back());
+      _edges.pop_back();
+   }
+   while (!_verts.empty()) {
+      delete_vert(_verts.back());
+      _verts.pop_back();
+   }
+
+   // every element is gone, so hand the slabs back in bulk:
+   _vert_pool.clear();
+   _edge_pool.clear();
+   _face_pool.clear();
+
+   delete _snapshot;
+   _snapshot = nullptr;
+   delete _face_bvh;
+   _face_bvh = nullptr;
+   delete _sil_tree;
+   _sil_tree = nullptr;
+   delete _feature_lines;
+   _feature_lines = nullptr;
+   delete _vert_prox;
+   _vert_prox = nullptr;
+   delete _edge_prox;
+   _edge_prox = nullptr;
 
    _type = EMPTY_MESH;
    _type_valid = 1;
@@ -2326,6 +2818,7 @@ BMESH::operator =(CBMESH& m)
       _edges.reserve(m._edges.size());
    if (m.nfaces() > 0)
       _faces.reserve(m._faces.size());
+   reserve_elements(m.nverts(), m.nedges(), m.nfaces());
 
    // copy verts
    int k;
@@ -2384,6 +2877,7 @@ BMESH::operator =(BODY& body)
       _verts.reserve(pts.size());
       _faces.reserve(tris.size());
       _edges.reserve(tris.size()*3/2+10);
+      reserve_elements(pts.size(), tris.size()*3/2+10, tris.size());
       size_t i;
       for (i = 0; i < pts.size(); i++)
          add_vertex(pts[i]);
@@ -2493,19 +2987,17 @@ BMESH::fix_orientation()
 
    bool debug = Config::get_var_bool("DEBUG_FIX_ORIENTATION",false);
 
-   _faces.clear_flags();
+   TraversalMarks marks;
 
    vector<Bface*> pos_faces;
    vector<Bface*> neg_faces;
    for (Bface_list::size_type k=0; k<_faces.size(); k++) {
-      if (!_faces[k]->flag()) {
+      if (!marks.is_marked(_faces[k])) {
          if (debug)
             err_msg("fix_orientation: starting on untouched face...");
          pos_faces.clear();
          neg_faces.clear();
-         _faces[k]->set_flag(1);
-         pos_faces.push_back(_faces[k]);
-         grow_oriented_face_lists(_faces[k], pos_faces, neg_faces);
+         grow_oriented_face_lists(_faces[k], marks, pos_faces, neg_faces);
          reverse_faces((pos_faces.size() < neg_faces.size()) ?
                        pos_faces : neg_faces);
       }
@@ -2528,19 +3020,30 @@ BMESH::fix_orientation()
 void
 BMESH::grow_oriented_face_lists(
    Bface* f,
+   TraversalMarks& marks,
    vector<Bface*>& pos_faces,
    vector<Bface*>& neg_faces)
 {
-   for (int i=1; i<=3; i++) {
-      Bface* nbr = f->nbr(i);
-      if (nbr && !nbr->flag()) {
-         nbr->set_flag(1);
-         if (f->e(i)->consistent_orientation()) {
-            pos_faces.push_back(nbr);
-            grow_oriented_face_lists(nbr, pos_faces, neg_faces);
-         } else {
-            neg_faces.push_back(nbr);
-            grow_oriented_face_lists(nbr, neg_faces, pos_faces);
+   // Sort the unmarked faces reachable from f into those
+   // oriented like f (pos_faces) and those oriented the other
+   // way (neg_faces), marking each one:
+
+   if (!marks.try_mark(f))
+      return;
+   pos_faces.push_back(f);
+
+   // each face with whether it is in pos_faces:
+   vector<pair<Bface*,bool> > stack(1, make_pair(f, true));
+   while (!stack.empty()) {
+      Bface* cur = stack.back().first;
+      bool   pos = stack.back().second;
+      stack.pop_back();
+      for (int i=1; i<=3; i++) {
+         Bface* nbr = cur->nbr(i);
+         if (nbr && marks.try_mark(nbr)) {
+            bool nbr_pos = (cur->e(i)->consistent_orientation() == pos);
+            (nbr_pos ? pos_faces : neg_faces).push_back(nbr);
+            stack.push_back(make_pair(nbr, nbr_pos));
          }
       }
    }
@@ -2549,40 +3052,19 @@ BMESH::grow_oriented_face_lists(
 Bedge*
 BMESH::nearest_edge(CWpt &p)
 {
-   if (_edges.empty())
-      return nullptr;
-
-   Wpt q;
-   Bedge *ret = _edges[0];
-   double dist = (p - _edges[0]->project_to_simplex(p, q)).length_sqrd(), d;
-
-   for (Bedge_list::size_type i=1; i<_edges.size(); i++) {
-      if ((d = (p - _edges[i]->project_to_simplex(p, q)).length_sqrd()) < dist) {
-         ret = _edges[i];
-         dist = d;
-      }
-   }
-
-   return ret;
+   if (!_edge_prox)
+      _edge_prox = new ProximityIndex(this, ProximityIndex::EDGES);
+   int i = _edge_prox->nearest(p);
+   return (i < 0) ? nullptr : be(i);
 }
 
 Bvert*
 BMESH::nearest_vert(CWpt &p)
 {
-   if (_verts.empty())
-      return nullptr;
-
-   Bvert *ret = _verts[0];
-   double dist = (p - _verts[0]->loc()).length_sqrd(), d;
-
-   for (Bvert_list::size_type i=1; i<_verts.size(); i++) {
-      if ((d = (p - _verts[i]->loc()).length_sqrd()) < dist) {
-         ret = _verts[i];
-         dist = d;
-      }
-   }
-
-   return ret;
+   if (!_vert_prox)
+      _vert_prox = new ProximityIndex(this, ProximityIndex::VERTS);
+   int i = _vert_prox->nearest(p);
+   return (i < 0) ? nullptr : bv(i);
 }
 
 void
@@ -2754,74 +3236,282 @@ BMESH::merge_vertex(Bvert* v, Bvert* u, bool keep_vert)
 }
 
 
-int
-compare_locs_lexicographically(const Bvert *va, const Bvert *vb)
-{
-   // used in BMESH::remove_duplicate_vertices() below
+//******** VERTEX WELDING ********
 
-   CWpt& a = va->loc();
-   CWpt& b = vb->loc();
+/*****************************************************************
+ * WeldGrid:
+ *
+ *      Hash grid used by BMESH::weld_vertices() to find, for
+ *      each vertex, an earlier vertex within the weld tolerance.
+ *      Cells are tol on a side, so a match lies in one of the 27
+ *      cells around the vertex. Only the representative of each
+ *      cluster is stored. With zero tolerance a "cell" is just
+ *      one exact position.
+ *****************************************************************/
+class WeldGrid {
+ public:
+   WeldGrid(double tol, int n) : _tol(tol) {
+      _head.reserve(n);
+      _next.reserve(n);
+      _locs.reserve(n);
+   }
+
+   // Index of a stored point within tol of p, or -1:
+   int find(CWpt& p) const {
+      if (_tol <= 0)
+         return find(key(p), p);
+      long long c[3];
+      cell(p, c);
+      for (int i=-1; i<=1; i++)
+         for (int j=-1; j<=1; j++)
+            for (int k=-1; k<=1; k++) {
+               int ret = find(hash(c[0]+i, c[1]+j, c[2]+k), p);
+               if (ret >= 0)
+                  return ret;
+            }
+      return -1;
+   }
 
-   return ((a[0] > b[0]) ?  1 :
-           (a[0] < b[0]) ? -1 :
-           (a[1] > b[1]) ?  1 :
-           (a[1] < b[1]) ? -1 :
-           (a[2] > b[2]) ?  1 :
-           (a[2] < b[2]) ? -1 :
-           0);
-}
+   // Store p as point number _locs.size():
+   void add(CWpt& p) {
+      uint64_t k;
+      if (_tol <= 0) {
+         k = key(p);
+      } else {
+         long long c[3];
+         cell(p, c);
+         k = hash(c[0], c[1], c[2]);
+      }
+      int i = (int)_locs.size();
+      auto it = _head.find(k);
+      _next.push_back(it == _head.end() ? -1 : it->second);
+      _head[k] = i;
+      _locs.push_back(p);
+   }
+
+ protected:
+   double                          _tol;
+   unordered_map<uint64_t,int>     _head;   // cell -> first point
+   vector<int>                     _next;   // next point in same cell
+   vector<Wpt>                     _locs;
+
+   int find(uint64_t k, CWpt& p) const {
+      auto it = _head.find(k);
+      for (int i = (it == _head.end()) ? -1 : it->second; i >= 0; i = _next[i])
+         if ((_tol <= 0) ? (_locs[i] == p) : (_locs[i].dist(p) <= _tol))
+            return i;
+      return -1;
+   }
+   void cell(CWpt& p, long long c[3]) const {
+      // Clamp so the conversion is defined for huge quotients (tiny
+      // tolerances) and NaNs; far-off points then share the edge
+      // cells, which find() sorts out by distance:
+      const double MAX_CELL = 4.0e18;
+      for (int k=0; k<3; k++) {
+         double q = floor(p[k]/_tol);
+         c[k] = (q >= -MAX_CELL && q <= MAX_CELL) ? (long long)q :
+                (q > 0) ? (long long)MAX_CELL : (long long)-MAX_CELL;
+      }
+   }
+   static uint64_t hash(long long i, long long j, long long k) {
+      // distinct cells may share a hash; find() checks distances
+      return ((uint64_t)i * 0x9E3779B97F4A7C15ull) ^
+             ((uint64_t)j * 0xC2B2AE3D27D4EB4Full) ^
+             ((uint64_t)k * 0x165667B19E3779F9ull);
+   }
+   static uint64_t key(CWpt& p) {
+      // exact position; adding 0 turns -0 into +0:
+      uint64_t b[3];
+      for (int k=0; k<3; k++) {
+         double x = p[k] + 0.0;
+         memcpy(&b[k], &x, sizeof(x));
+      }
+      return hash(b[0], b[1], b[2]);
+   }
+};
 
-void
-BMESH::remove_duplicate_vertices(bool keep_verts)
+int
+BMESH::weld_vertices(double tol, bool keep_verts, vector<int>* remap)
 {
+   // Merge vertices that lie within distance tol of each other.
+   // Each vertex is merged into the first earlier vertex (in
+   // _verts order) that it is close to, which keeps its position.
+   // Returns the number of vertices merged.
+
+   static bool debug = Config::get_var_bool("DEBUG_WELD",false);
+
    // zero-length edges cause problems -- remove them and their
    // adjacent zero-area faces.  NOTE: because of the way vector
    // deletion works, we have to work backwards.
+   int num_zero = 0;
    for (int j=nedges()-1; j>=0; j--) {
-      if (_edges[j]->length() == 0)
+      if (_edges[j]->length() == 0) {
          remove_edge(_edges[j]);
+         num_zero++;
+      }
    }
 
-   // we need to process vertices in sorted order, but
-   // removing vertices has the side effect
-   // of re-shuffling the order of the _verts array.
-   //
-   // so we make a temporary copy of the _verts array,
-   // which will not be reshuffled, and operate on that:
-   Bvert_list verts = _verts;
-
-   // sort verts by increasing (x,y,z) order:
-   std::sort(verts.begin(), verts.end(), compare_locs_lexicographically);
+   //******** Find the remap ********
 
-   // remove duplicate vertices, which now lie
-   // next to each other in the array:
+   int nv = nverts();
+   vector<int> rep(nv);         // vertex index -> representative
+   vector<int> reps;            // grid point -> vertex index
+   WeldGrid grid(tol, nv);
    int count = 0;
-   Bvert* prev = verts[0];
-   for (Bvert_list::size_type k=1; k<verts.size(); k++) {
-      if (verts[k]->loc() == prev->loc()) {
-         merge_vertex(verts[k], prev, keep_verts);
+   for (int i=0; i<nv; i++) {
+      int g = grid.find(bv(i)->loc());
+      if (g < 0) {
+         rep[i] = i;
+         grid.add(bv(i)->loc());
+         reps.push_back(i);
+      } else {
+         rep[i] = reps[g];
          count++;
-      } else
-         prev = verts[k];
+      }
    }
 
-   if (count > 0) {
-      // if anything happened, invalidate cached data:
-      changed(TRIANGULATION_CHANGED);
+   if (count == 0) {
+      if (num_zero > 0)
+         changed(TOPOLOGY_CHANGED);
+      if (remap) {
+         remap->resize(nv);
+         for (int i=0; i<nv; i++)
+            (*remap)[i] = i;
+      }
+      return 0;
+   }
 
-      // this mesh was effed up -- better fix face normals
-      // to consistent orientation or else the triangle
-      // stripping code will crash:
+   // merged vertices and their representatives:
+   unordered_map<Bvert*,Bvert*> moved;
+   moved.reserve(count);
+   for (int i=0; i<nv; i++)
+      if (rep[i] != i)
+         moved[bv(i)] = bv(rep[i]);
+   auto to = [&](Bvert* v) {
+      auto it = moved.find(v);
+      return (it == moved.end()) ? v : it->second;
+   };
+
+   //******** Rewire edges and faces in one sweep ********
+
+   // Detach every face touching a merged vertex, so the edges
+   // around merged vertices can be redefined:
+   unordered_set<Bsimplex*> touched;
+   for (auto& m : moved) {
+      for (auto& e : m.first->get_adj()) {
+         touched.insert(e);
+         for (int j=1; j<=2; j++)
+            if (e->f(j))
+               touched.insert(e->f(j));
+         if (e->adj())
+            for (auto& f : *e->adj())
+               touched.insert(f);
+      }
+   }
+   // Keep them in mesh order, so which of two duplicates
+   // survives doesn't depend on where they were allocated:
+   vector<Bface*> faces;
+   vector<Bedge*> edges;
+   for (auto& f : _faces)
+      if (touched.count(f))
+         faces.push_back(f);
+   for (auto& e : _edges)
+      if (touched.count(e))
+         edges.push_back(e);
+   for (auto& f : faces)
+      f->detach();
+
+   // Move edges onto the representatives. Edges that collapse,
+   // or that would duplicate an edge already there or earlier
+   // in the mesh, are removed (Bedge::redefine() passes crease
+   // values to the duplicate):
+   set<Bsimplex*> dead;
+   for (auto& e : edges) {
+      Bvert* a = e->v1();
+      Bvert* b = e->v2();
+      Bvert* na = to(a);
+      Bvert* nb = to(b);
+      if (na == nb ||
+          (na != a && !e->redefine(a, na)) ||
+          (nb != b && !e->redefine(b, nb)))
+         dead.insert(e);
+   }
+
+   // Put faces back on the new edges. Faces that collapse, or
+   // that would duplicate another face, are removed:
+   for (auto& f : faces) {
+      if (!f->redefine(to(f->v1()), to(f->v2()), to(f->v3())))
+         dead.insert(f);
+   }
+
+   //******** Remove what's left over ********
+
+   // Faces, then edges, then vertices, so that nothing being
+   // deleted still has neighbors to remove (which would search
+   // the lists one at a time):
+   int num_faces = nfaces(), num_edges = nedges();
+   auto is_dead = [&](Bsimplex* s) { return dead.count(s) > 0; };
+   for (auto& f : faces)
+      if (is_dead(f))
+         delete_face(f);
+   _faces.erase(remove_if(_faces.begin(), _faces.end(), is_dead),
+                _faces.end());
+   for (auto& e : edges)
+      if (is_dead(e))
+         delete_edge(e);
+   _edges.erase(remove_if(_edges.begin(), _edges.end(), is_dead),
+                _edges.end());
+   num_faces -= nfaces();
+   num_edges -= nedges();
+
+   if (remap)
+      remap->resize(nv);
+   if (!keep_verts) {
+      vector<int> index(nv);
+      int n = 0;
+      for (int i=0; i<nv; i++)
+         index[i] = (rep[i] == i) ? n++ : -1;
+      for (int i=0; i<nv; i++)
+         if (remap)
+            (*remap)[i] = index[rep[i]];
+      for (int i=nv-1; i>=0; i--) {
+         if (rep[i] != i) {
+            assert(bv(i)->degree() == 0);
+            delete_vert(bv(i));
+         }
+      }
+      _verts.erase(remove_if(_verts.begin(), _verts.end(),
+                             [&](Bvert* v) { return moved.count(v) > 0; }),
+                   _verts.end());
+   } else if (remap) {
+      *remap = rep;
+   }
 
-      int fixed = fix_orientation()
-         ;
+   // if anything happened, invalidate cached data:
+   changed(TOPOLOGY_CHANGED);
 
-      // tell the humans:
-      err_msg("BMESH::remove_duplicate_vertices:");
-      err_msg("       removed %d verts", count);
-      err_msg("       %s orientation", fixed ? "fixed" : "warning: can't fix")
-         ;
-   }
+   // this mesh was effed up -- better fix face normals
+   // to consistent orientation or else the triangle
+   // stripping code will crash:
+
+   int fixed = fix_orientation();
+
+   // tell the humans:
+   err_msg("BMESH::weld_vertices:");
+   err_msg("       merged %d verts (tolerance %g)", count, tol);
+   err_msg("       removed %d edges, %d faces", num_edges, num_faces);
+   err_msg("       %s orientation", fixed ? "fixed" : "warning: can't fix");
+   err_adv(debug, "       %d verts remain", nverts());
+
+   return count;
+}
+
+void
+BMESH::remove_duplicate_vertices(bool keep_verts)
+{
+   // Vertices at the same position are merged, or within
+   // JOT_WELD_TOL of each other if that is set:
+   weld_vertices(Config::get_var_dbl("JOT_WELD_TOL", 0, true), keep_verts);
 }
 
 
@@ -3270,6 +3960,16 @@ BMESH::changed(change_t change)
 
     case TRIANGULATION_CHANGED:
 
+      delete _snapshot;
+      _snapshot = nullptr;
+      delete _face_bvh;
+      _face_bvh = nullptr;
+      delete _sil_tree;
+      _sil_tree = nullptr;
+
+      delete _curv_data;
+      _curv_data = nullptr;
+
       // mark various edge strips invalid:
       _sil_stamp = 0;
       _sils.reset();
@@ -3302,9 +4002,15 @@ BMESH::changed(change_t change)
       _bb.reset();
       _avg_edge_len_valid = 0;
       
-      // invalidate curvature data:
-      delete _curv_data;
-      _curv_data = nullptr;
+      // curvature data is updated on next use:
+      if (_curv_data)
+         _curv_data->positions_changed();
+
+      if (_snapshot)
+         _snapshot->positions_changed();
+      _normals_dirty = true;
+      _face_bvh_valid = false;
+      _sil_tree_valid = false;
       
       break;
 
@@ -3324,6 +4030,234 @@ BMESH::changed(change_t change)
    _version++;
 }
 
+const MeshSnapshot&
+BMESH::snapshot() const
+{
+   // Counts are checked too, to catch edits not followed by
+   // a call to changed():
+   if (_snapshot && !_snapshot->matches(*this)) {
+      delete _snapshot;
+      _snapshot = nullptr;
+   }
+   if (!_snapshot)
+      _snapshot = new MeshSnapshot(*this);
+   else if (!_snapshot->positions_valid())
+      _snapshot->update_positions(*this);
+   return *_snapshot;
+}
+
+void
+BMESH::update_normals()
+{
+   // Smaller meshes are left to Bface::norm() and Bvert::norm(),
+   // which compute each normal when it is first asked for:
+   static const int min_faces =
+      Config::get_var_int("JOT_BATCH_NORMALS_MIN_FACES", 4096);
+
+   if (!_normals_dirty)
+      return;
+   _normals_dirty = false;
+   if (nfaces() < min_faces)
+      return;
+
+   const MeshSnapshot& snap = snapshot();
+   const int grain = 1024;
+
+   // Faces: take the normal and area from the snapshot.
+   parallel_for(nfaces(), grain, [&](int begin, int end) {
+      for (int i=begin; i<end; i++) {
+         Bface* f = _faces[i];
+         if (!f->is_set(Bface::VALID_NORMAL_BIT))
+            f->set_norm(snap.norm(i), snap.area(i));
+      }
+   });
+
+   // Vertices: same weighting as Bvert::compute_normal(), summed
+   // over the faces around each vertex. Each face is reached via
+   // the edge leaving the vertex in its winding order, so it is
+   // counted once. Normals set explicitly (e.g. read from a file)
+   // are kept, and non-manifold vertices use the lazy path since
+   // their faces are chosen by Bvert::get_manifold_edges():
+   parallel_for(nverts(), grain, [&](int begin, int end) {
+      for (int i=begin; i<end; i++) {
+         Bvert* v = _verts[i];
+         if (v->is_set(Bvert::VALID_NORMAL_BIT) || !v->is_manifold())
+            continue;
+         Wpt p = snap.loc(i);
+         Wvec ret;
+         bool found = false;
+         const int* ve = snap.vert_edges(i);
+         for (int j=0; j<snap.degree(i); j++) {
+            const int* ef = snap.edge_faces(ve[j]);
+            for (int n=0; n<2; n++) {
+               int f = ef[n];
+               if (f < 0)
+                  continue;
+               const int* fv = snap.face_verts(f);
+               int k = (fv[0] == i) ? 0 : (fv[1] == i) ? 1 : 2;
+               if (snap.face_edges(f)[k] != ve[j])
+                  continue;
+               Wvec a = snap.loc(fv[(k+1)%3]) - p;
+               Wvec b = snap.loc(fv[(k+2)%3]) - p;
+               ret += snap.norm(f)*(2*snap.area(f))/
+                  (a.length_sqrd()*b.length_sqrd());
+               found = true;
+            }
+         }
+         if (found)
+            v->set_norm(ret);
+      }
+   });
+}
+
+// Bits per face for the silhouette tests below: whether it faces
+// the eye (as in Bface::front_facing()), and whether its normal
+// is null:
+enum { SIL_FRONT = 1, SIL_NULL_NORM = 2 };
+
+static inline int
+sil_face_bits(const MeshSnapshot& snap, CWpt& eye, int f)
+{
+   const int v = snap.face_verts(f)[0];
+   double d = ((eye[0] - snap.x()[v])*snap.nx()[f] +
+               (eye[1] - snap.y()[v])*snap.ny()[f] +
+               (eye[2] - snap.z()[v])*snap.nz()[f]);
+   double l = (snap.nx()[f]*snap.nx()[f] + snap.ny()[f]*snap.ny()[f] +
+               snap.nz()[f]*snap.nz()[f]);
+   return (d > 0 ? SIL_FRONT : 0) | (l <= epsNorSqrdMath() ? SIL_NULL_NORM : 0);
+}
+
+template <class F>
+static inline int
+sil_edge_code(const MeshSnapshot& snap, int e, F bits)
+{
+   // Same cases as Bedge::is_sil(), given the bits of each face:
+   // 1 if the edge is a silhouette, 2 if it has exactly one null
+   // face and needs a closer look (see null_face_sil()), else 0:
+   const int* ef = snap.edge_faces(e);
+   int a = ef[0], b = ef[1];
+   if (a < 0 || b < 0)
+      return (a >= 0 || b >= 0);        // border yes, polyline no
+   int fa = bits(a), fb = bits(b);
+   int nulls = (fa & SIL_NULL_NORM) + (fb & SIL_NULL_NORM);
+   return (nulls == 0) ? ((fa ^ fb) & SIL_FRONT) :
+          (nulls == SIL_NULL_NORM) ? 2 : 0;
+}
+
+template <class F>
+static inline bool
+null_face_sil(CBMESH& mesh, const MeshSnapshot& snap, int e, F bits)
+{
+   // One face of edge e has zero area. As in Bedge::is_sil(): if it
+   // is half of a quad (and the edge is not the quad diagonal), use
+   // the other half of the quad instead:
+   if (mesh.be(e)->is_weak())
+      return false;
+   const int* ef = snap.edge_faces(e);
+   int good = ef[0], bad = ef[1];
+   if (bits(good) & SIL_NULL_NORM)
+      swap(good, bad);
+   Bface* partner = mesh.bf(bad)->quad_partner();
+   int p = partner ? snap.index(partner) : -1;
+   return (p >= 0 && !(bits(p) & SIL_NULL_NORM) &&
+           ((bits(good) ^ bits(p)) & SIL_FRONT));
+}
+
+void
+BMESH::find_sil_edges(CWpt& eye, vector<int>& ret) const
+{
+   ret.clear();
+   const MeshSnapshot& snap = snapshot();
+   const int nf = snap.nfaces(), ne = snap.nedges();
+
+   // Classify the faces, then the edges:
+   vector<unsigned char> face(nf);
+   parallel_for(nf, SIL_GRAIN, [&](int begin, int end) {
+      for (int f=begin; f<end; f++)
+         face[f] = sil_face_bits(snap, eye, f);
+   });
+   auto bits = [&](int f) { return face[f]; };
+   vector<unsigned char> edge(ne);
+   parallel_for(ne, SIL_GRAIN, [&](int begin, int end) {
+      for (int e=begin; e<end; e++)
+         edge[e] = sil_edge_code(snap, e, bits);
+   });
+
+   for (int e=0; e<ne; e++)
+      if (edge[e] == 1 || (edge[e] == 2 && null_face_sil(*this, snap, e, bits)))
+         ret.push_back(e);
+}
+
+void
+BMESH::find_sil_edges_culled(CWpt& eye, vector<int>& ret) const
+{
+   // Test only the edges sil_cone_tree() can't rule out, in edge
+   // order, computing face bits as needed:
+   ret.clear();
+   const SilConeTree& tree = sil_cone_tree();
+   const MeshSnapshot& snap = snapshot();
+   vector<int> edges;
+   tree.candidates(eye, edges);
+   sort(edges.begin(), edges.end());
+
+   auto bits = [&](int f) { return sil_face_bits(snap, eye, f); };
+   for (size_t k=0; k<edges.size(); k++) {
+      int e = edges[k];
+      int code = sil_edge_code(snap, e, bits);
+      if (code == 1 || (code == 2 && null_face_sil(*this, snap, e, bits)))
+         ret.push_back(e);
+   }
+}
+
+void
+BMESH::find_zcross_faces(CWpt& eye, vector<int>& ret) const
+{
+   // Sign of (eye - p) * n at each vertex, as in ZcrossPath::has_sil().
+   // Crease vertices use a different normal in each face, and signs
+   // too close to call are not trusted, so those are UNKNOWN; a face
+   // is a candidate if its vertices are not all POS or all NEG:
+   enum { POS = 1, NEG = 2, UNKNOWN = 3, NEEDS_NORMAL = 4 };
+
+   ret.clear();
+   const MeshSnapshot& snap = snapshot();
+   const int nv = snap.nverts(), nf = snap.nfaces();
+
+   vector<unsigned char> sign(nv);
+   auto vert_sign = [&](int i, CWvec& n) -> unsigned char {
+      Wvec d = eye - snap.loc(i);
+      double g = d * n;
+      if (fabs(g) <= 1e-9 * d.length())
+         return UNKNOWN;
+      return (g > 0) ? POS : NEG;
+   };
+   parallel_for(nv, SIL_GRAIN, [&](int begin, int end) {
+      for (int i=begin; i<end; i++) {
+         Bvert* v = _verts[i];
+         if (v->is_crease())
+            sign[i] = UNKNOWN;
+         else if (!v->is_set(Bvert::VALID_NORMAL_BIT))
+            sign[i] = NEEDS_NORMAL;
+         else
+            sign[i] = vert_sign(i, v->norm());
+      }
+   });
+   // normals computed on demand aren't safe to compute in parallel:
+   for (int i=0; i<nv; i++)
+      if (sign[i] == NEEDS_NORMAL)
+         sign[i] = vert_sign(i, _verts[i]->norm());
+
+   vector<unsigned char> cand(nf);
+   parallel_for(nf, SIL_GRAIN, [&](int begin, int end) {
+      const int* fv = snap.face_verts(0);
+      for (int f=begin; f<end; f++)
+         cand[f] = ((sign[fv[3*f]] | sign[fv[3*f+1]] | sign[fv[3*f+2]]) == UNKNOWN);
+   });
+
+   for (int f=0; f<nf; f++)
+      if (cand[f])
+         ret.push_back(f);
+}
+
 const BBOX &
 BMESH::get_bb()
 {
@@ -3417,7 +4351,9 @@ BMESH::tags() const
 void
 BMESH::put_vertices(TAGformat &d) const
 {
-   Wpt_list verts(nverts());
+   // (Wpt_list(n) only reserves space)
+   Wpt_list verts;
+   verts.resize(nverts());
 
    if (Config::get_var_bool("JOT_SAVE_XFORMED_MESH",false))
       for (int i = 0; i< nverts(); i++)
@@ -3430,6 +4366,12 @@ BMESH::put_vertices(TAGformat &d) const
    //       want to avoid super long lines that may be
    //       causing bugs...
    d.id();
+   if ((*d).binary_out()) {
+      // one block of coordinates (see net_types.hpp):
+      (*d) << verts;
+      d.end_id();
+      return;
+   }
    (*d) << "{";
    for (Wpt_list::size_type i=0; i<verts.size();i++) {
       (*d) << " " << verts[i];
@@ -3443,8 +4385,11 @@ BMESH::put_vertices(TAGformat &d) const
 void
 BMESH::put_faces(TAGformat &d) const
 {
-   vector<vector<int> > faces(nfaces());
-   
+   // Only the faces written go in the list (others would be
+   // read back as 0-gons):
+   vector<vector<int> > faces;
+   faces.reserve(nfaces());
+
    for (int i=0; i<nfaces(); i++) {
       vector<int> face;
       Bface *f = bf(i);
@@ -3458,7 +4403,7 @@ BMESH::put_faces(TAGformat &d) const
             face.push_back(f->v1()->index());
             face.push_back(f->v2()->index());
             face.push_back(f->v3()->index());
-            faces[i] = face;
+            faces.push_back(face);
          } else if (f->quad_rep() == f) {
             // Write a quad:
             Bvert *a=nullptr, *b=nullptr, *c=nullptr, *d=nullptr;
@@ -3468,14 +4413,14 @@ BMESH::put_faces(TAGformat &d) const
             face.push_back(b->index());
             face.push_back(c->index());
             face.push_back(d->index());
-            faces[i] = face;
+            faces.push_back(face);
          }
       } else {
          // Old I/O: write a plain triangle
          face.push_back(f->v1()->index());
          face.push_back(f->v2()->index());
          face.push_back(f->v3()->index());
-         faces[i] = face;
+         faces.push_back(face);
       }
    }
 
@@ -3483,6 +4428,12 @@ BMESH::put_faces(TAGformat &d) const
    //       want to avoid super long lines that may be
    //       causing bugs...
    d.id();
+   if ((*d).binary_out()) {
+      // blocks of face sizes and indices (see net_types.hpp):
+      (*d) << faces;
+      d.end_id();
+      return;
+   }
    (*d) << "{";
    for (auto & face : faces) {
       (*d) << " " << face;
@@ -3605,7 +4556,11 @@ BMESH::get_uvfaces(TAGformat &d)
    if (uvs.empty())
       return;
 
+   // Build all the faces at once (quads split into 2 triangles),
+   // then assign UVs and mark quad diagonals weak:
    Patch* p = nullptr;
+   vector<Point3i> tris;
+   tris.reserve(uvs.size());
    for (const UVforIO2& uv : uvs) {
       if (!uv.is_good()) {
          err_msg("BMESH::get_uvfaces: skipping bad face:");
@@ -3617,18 +4572,38 @@ BMESH::get_uvfaces(TAGformat &d)
       switch(uv.num()) {
        case 3:
          // triangle
-         add_face(uv._face[0], uv._face[1], uv._face[2],
-                  uv._uvs[0],  uv._uvs[1],  uv._uvs[2], p);
+         tris.push_back(Point3i(uv._face[0], uv._face[1], uv._face[2]));
          break;
        case 4:
          // quad
-         add_quad(uv._face[0], uv._face[1], uv._face[2], uv._face[3],
-                  uv._uvs[0],  uv._uvs[1],  uv._uvs[2],  uv._uvs[3], p);
+         tris.push_back(Point3i(uv._face[0], uv._face[1], uv._face[2]));
+         tris.push_back(Point3i(uv._face[0], uv._face[2], uv._face[3]));
          break;
        default:
          assert(0);
       }
    }
+   Bface_list faces = add_faces(tris, p);
+
+   Bface_list::size_type t = 0;
+   for (const UVforIO2& uv : uvs) {
+      const vector<int>&   v = uv._face;
+      const vector<UVpt>& tc = uv._uvs;
+      if (uv.num() == 3) {
+         if (faces[t])
+            UVdata::set(faces[t], bv(v[0]), bv(v[1]), bv(v[2]),
+                        tc[0], tc[1], tc[2]);
+         t++;
+      } else if (uv.num() == 4) {
+         if (faces[t] && faces[t+1]) {
+            set_weak_edge(v[0], v[2]);
+            if (!UVdata::set(bv(v[0]), bv(v[1]), bv(v[2]), bv(v[3]),
+                             tc[0], tc[1], tc[2], tc[3]))
+               err_msg("BMESH::get_uvfaces: Error: could not set UV coordinates");
+         }
+         t += 2;
+      }
+   }
 
    changed(TOPOLOGY_CHANGED);
 }
@@ -3884,15 +4859,23 @@ BMESH::get_faces(TAGformat &d)
    // be re-sorted into their correct patches and this default
    // patch will be removed:
    Patch* p = nullptr;  //new_patch();
+
+   // Split quads into 2 triangles and build them all at once. The
+   // diagonal of each quad is marked weak afterward:
+   vector<Point3i> tris;
+   vector<Point2i> weak;
+   tris.reserve(faces.size());
    for (const vector<int>& face : faces) {
       switch (face.size()) {
        case 3:
          // triangle
-         add_face(face[0], face[1], face[2], p);
+         tris.push_back(Point3i(face[0], face[1], face[2]));
          break;
        case 4:
          // quad
-         add_quad(face[0], face[1], face[2], face[3], p);
+         tris.push_back(Point3i(face[0], face[1], face[2]));
+         tris.push_back(Point3i(face[0], face[2], face[3]));
+         weak.push_back(Point2i(face[0], face[2]));
          break;
 
        default: {
@@ -3909,6 +4892,9 @@ BMESH::get_faces(TAGformat &d)
        }
       }
    }
+   add_faces(tris, p);
+   for (auto& w : weak)
+      set_weak_edge(w[0], w[1]);
 
    changed(TOPOLOGY_CHANGED);
 }
@@ -4219,7 +5205,9 @@ BMESH::_merge(BMESHptr m)
 
    assert(m);
 
-   // Suck in verts, edges and faces:
+   // Suck in verts, edges and faces, keeping the
+   // slabs they live in:
+   share_pools(*m);
    _verts.append(m->_verts);
    _edges.append(m->_edges);
    _faces.append(m->_faces);
@@ -4267,39 +5255,44 @@ BMESH::_merge(BMESHptr m)
    BMESHobs::broadcast_merge(shared_from_this(), m);
 }
 
-// assumes flags were cleared previously
 void
 BMESH::grow_mesh_equivalence_class(
    Bvert* v,
+   TraversalMarks& marks,
    vector<Bface*> &faces,
    vector<Bedge*> &edges,
    vector<Bvert*> &verts)
 {
-   if (v->flag() == 0)
+   // Collect the vertices, edges and (primary) faces reachable
+   // from v that are not yet marked, marking each one. v itself
+   // is included if it was not marked.
+
+   if (!marks.try_mark(v))
       return;
+   verts.push_back(v);
 
-   for (int i=0; i<v->degree(); i++) {
-      Bedge* nbr_e = v->e(i);
-      Bvert* nbr_v = v->nbr(i);
+   vector<Bvert*> stack(1, v);
+   while (!stack.empty()) {
+      Bvert* cur = stack.back();
+      stack.pop_back();
 
-      for (int j=1; j<=2; j++) {
-         Bface *f = nbr_e->f(j);
-         if (f && !f->flag()) {
-            f->set_flag();
-            faces.push_back(f);
-         }
-      }
+      for (int i=0; i<cur->degree(); i++) {
+         Bedge* nbr_e = cur->e(i);
+         Bvert* nbr_v = cur->nbr(i);
 
-      if (!nbr_e->flag()) {
-         nbr_e->set_flag();
-         edges.push_back(nbr_e);
-      }
+         for (int j=1; j<=2; j++) {
+            Bface *f = nbr_e->f(j);
+            if (f && marks.try_mark(f))
+               faces.push_back(f);
+         }
 
-      if (!nbr_v->flag()) {
-         nbr_v->set_flag();
-         verts.push_back(nbr_v);
+         if (marks.try_mark(nbr_e))
+            edges.push_back(nbr_e);
 
-         grow_mesh_equivalence_class(nbr_v, faces, edges, verts);
+         if (marks.try_mark(nbr_v)) {
+            verts.push_back(nbr_v);
+            stack.push_back(nbr_v);
+         }
       }
    }
 }
@@ -4321,7 +5314,8 @@ BMESH::split_components()
 
    vector<BMESHptr> new_meshes;
 
-   clear_flags();
+   // Elements found so far, and those moved to new meshes:
+   TraversalMarks marks, moved;
 
    // split up
 
@@ -4331,43 +5325,37 @@ BMESH::split_components()
 
    for (Bvert_list::size_type i=0; i<tmp_verts.size(); i++) {
       Bvert* v = tmp_verts[i];
-      if (!v->flag()) {
+      if (!marks.is_marked(v)) {
 
          // Mesh elements reachable from v:
          vector<Bface*> faces;
          vector<Bedge*> edges;
          vector<Bvert*> verts;
 
-         // The flag being set means the vertex (or edge or face)
-         // is in the list:
-         v->set_flag();
-         verts.push_back(v);
-
          // Collect all reachable elements:
-         grow_mesh_equivalence_class(v, faces, edges, verts);
+         grow_mesh_equivalence_class(v, marks, faces, edges, verts);
 
          // The 1st mesh is us... leave it alone.
          if (i == 0)
             continue;
 
          // Make a new mesh after the first time.
-         BMESHptr m = dynamic_cast<BMESH*>(dup())->shared_from_this();
+         BMESHptr m(dynamic_cast<BMESH*>(dup()));
          new_meshes.push_back(m);
 
+         // The elements moving over live in our slabs:
+         m->share_pools(*this);
+
+         // add to the new mesh; they are taken out of
+         // our lists all at once, below:
          size_t t;
          for (t=0; t<verts.size(); t++) {
-            // remove from this mesh and add to the new mesh
-            Bvert_list::iterator it;
-            it = std::find(_verts.begin(), _verts.end(), verts[t]);
-            _verts.erase(it);
+            moved.mark(verts[t]);
             m->add_vertex(verts[t]);
          }
 
          for (t=0; t<edges.size(); t++) {
-            // remove from this mesh and add to the new mesh
-            Bedge_list::iterator it;
-            it = std::find(_edges.begin(), _edges.end(), edges[t]);
-            _edges.erase(it);
+            moved.mark(edges[t]);
             m->add_edge(edges[t]);
          }
 
@@ -4375,10 +5363,7 @@ BMESH::split_components()
          // current patch, if any.
          Patch* p = m->new_patch();
          for (t=0; t<faces.size(); t++) {
-            // remove from this mesh and add to the new mesh
-            Bface_list::iterator it;
-            it = std::find(_faces.begin(), _faces.end(), faces[t]);
-            _faces.erase(it);
+            moved.mark(faces[t]);
             m->add_face(faces[t],p);
          }
 
@@ -4387,6 +5372,13 @@ BMESH::split_components()
       }
    }
 
+   // Remove the moved elements from our lists, in one pass each
+   // (erasing them one at a time is quadratic):
+   auto was_moved = [&moved](Bsimplex* s) { return moved.is_marked(s); };
+   _verts.erase(remove_if(_verts.begin(), _verts.end(), was_moved), _verts.end());
+   _edges.erase(remove_if(_edges.begin(), _edges.end(), was_moved), _edges.end());
+   _faces.erase(remove_if(_faces.begin(), _faces.end(), was_moved), _faces.end());
+
    // Remove empty patches:
    clean_patches();
 
@@ -4441,15 +5433,12 @@ BMESH::get_components() const
 
    vector<Bface_list> ret;
 
-   // before calling Bface_list::grow_connected(),
-   // must set all face flags to 1:
-   _faces.set_flags(1);
-
+   TraversalMarks marks;
    for (Bface_list::size_type i=0; i<_faces.size(); i++) {
       Bface* f = bf(i);
-      if (f->flag() == 1) {
+      if (!marks.is_marked(f)) {
          Bface_list component;
-         component.grow_connected(f);
+         component.grow_connected(f, marks);
          assert(!component.empty());
          ret.push_back(component);
       }
@@ -4518,22 +5507,18 @@ BMESH::kill_component(Bvert *start_vert)
    vector<Bedge*> edges;
    vector<Bvert*> verts;
 
-   int i;
-   for (i=0; i<nfaces(); i++)
-      _faces[i]->clear_flag();
-   for (i=0; i<nedges(); i++)
-      _edges[i]->clear_flag();
-   for (i=0; i<nverts(); i++)
-      _verts[i]->clear_flag();
-
-   start_vert->set_flag();
-   verts.push_back(start_vert);
-
-   grow_mesh_equivalence_class(start_vert, faces, edges, verts);
+   TraversalMarks marks;
+   grow_mesh_equivalence_class(start_vert, marks, faces, edges, verts);
 
    cerr << "removed " << faces.size() << " faces, "
         << edges.size() << " edges, " << verts.size() << " vertices" << endl;
 
+   // Take them out of our lists before deleting them:
+   auto dead = [&marks](Bsimplex* s) { return marks.is_marked(s); };
+   _faces.erase(remove_if(_faces.begin(), _faces.end(), dead), _faces.end());
+   _edges.erase(remove_if(_edges.begin(), _edges.end(), dead), _edges.end());
+   _verts.erase(remove_if(_verts.begin(), _verts.end(), dead), _verts.end());
+
    size_t t;
    for (t=0; t<faces.size(); t++)
       delete_face(faces[t]);
@@ -28,7 +28,11 @@
 
 #include "mesh/bmesh_curvature.hpp"
 #include "mesh/edge_strip.hpp"
+#include "mesh/mesh_snapshot.hpp"
+#include "mesh/face_bvh.hpp"
+#include "mesh/sil_cone_tree.hpp"
 #include "mesh/patch.hpp"
+#include "mesh/simplex_pool.hpp"
 #include "mesh/tri_strip.hpp"
 #include "mesh/vert_strip.hpp"
 #include "mesh/zcross_path.hpp"
@@ -37,7 +41,10 @@
 #include <set>
 #include <vector>
 
+class FeatureLines;
 class Patch;
+class ProximityIndex;
+class TraversalMarks;
 /**********************************************************************/
 /*!BMESH:
  *
@@ -192,7 +199,8 @@ class BMESH : public BODY, public NameLookup<BMESH> {
 
    //******** STRIPS ********
 
-   int get_sil_strips       (); ///< extracts silhouette edge strips
+   /// extracts silhouette edge strips (LMESH over-rides this)
+   virtual int get_sil_strips();
    int build_sil_strips     (); ///< distributes them to patches
 
    /// extract silhouette edge strip and return a copy of it:
@@ -200,7 +208,7 @@ class BMESH : public BODY, public NameLookup<BMESH> {
 
    /// finds "strips" for zero-set definition of silhouettes (as in
    /// WYSIWYG NPR, Siggraph 2002):
-   int get_zcross_strips    ();
+   virtual int get_zcross_strips();
    int build_zcross_strips  ();
 
    // deals with "strips" for isolated edges and vertices:
@@ -268,14 +276,18 @@ class BMESH : public BODY, public NameLookup<BMESH> {
    CBedge_list& get_borders() const { return get_border_strip()->edges(); }
 
    //******** FACTORY METHODS ********
+   // Vertices, edges and faces are allocated from per-mesh slabs
+   // (see SimplexPool). Subclasses that override these must
+   // allocate from the same pools, so delete_vert() etc. work.
+
    /// Convert the given world-space point to a vertex
    virtual Bvert*  new_vert(CWpt& p=mlib::Wpt::Origin()) const {
-      return new Bvert(p);
+      return new (_vert_pool.alloc(sizeof(Bvert))) Bvert(p);
    }
 
    /// NB: caller should first check u,v doesn't have an edge already
    virtual Bedge*  new_edge(Bvert* u, Bvert* v)   const {
-      return new Bedge(u,v);
+      return new (_edge_pool.alloc(sizeof(Bedge))) Bedge(u,v);
    }
 
    /// NB: caller should first check requested face doesn't exist already
@@ -285,9 +297,12 @@ class BMESH : public BODY, public NameLookup<BMESH> {
                             Bedge* e,
                             Bedge* f,
                             Bedge* g) const {
-      return new Bface(u,v,w,e,f,g);
+      return new (_face_pool.alloc(sizeof(Bface))) Bface(u,v,w,e,f,g);
    }
 
+   /// Pre-size the element pools for a mesh of (roughly) the given size
+   void reserve_elements(int num_v, int num_e, int num_f);
+
    virtual TriStrip*    new_tri_strip()   const { return new TriStrip; }
    virtual EdgeStrip*   new_edge_strip()  const { return new EdgeStrip;}
    virtual VertStrip*   new_vert_strip()  const { return new VertStrip;}
@@ -338,14 +353,38 @@ class BMESH : public BODY, public NameLookup<BMESH> {
    Bface* add_quad(int    i, int    j, int    k, int    l,
                    CUVpt& a, mlib::CUVpt& b, mlib::CUVpt& c, mlib::CUVpt& d, Patch* p=nullptr);
 
+   //******** BULK CONSTRUCTION ********
+
+   /*! Add many triangles at once, each given as 3 indices into the
+    * vertex list. The result is the same as calling add_face(i,j,k,p)
+    * on each triangle in turn (same checks, same creation order), but
+    * edges are found through a hash on sorted vertex pairs instead of
+    * by walking vertex adjacency lists, and the edge and face lists
+    * are sized exactly before anything is created. Non-manifold edges
+    * are reported. Returns the face for each triangle (null where
+    * add_face() would fail). Loaders should use this. */
+   Bface_list add_faces(const vector<Point3i>& tris, Patch* p=nullptr);
+   /// Same, with a patch given per triangle (null entries for none):
+   Bface_list add_faces(const vector<Point3i>& tris,
+                        const vector<Patch*>& patches);
+   /// Build from flat arrays: a vertex for each point, then add_faces():
+   Bface_list build(CWpt_list& pts, const vector<Point3i>& tris,
+                    Patch* p=nullptr);
+
    //******** DELETING ELEMENTS ********
 
-   /// Simply releases memory allocated to the vertex by calling delete
-   virtual void delete_vert(Bvert* v) const   { delete v; }
-   /// Simply releases memory allocated to the edge by calling delete
-   virtual void delete_edge(Bedge* e) const   { delete e; }
-   /// Simply releases memory allocated to the face by calling delete
-   virtual void delete_face(Bface* f) const   { delete f; }
+   /// Destroys the vertex and returns its memory to the vertex pool
+   virtual void delete_vert(Bvert* v) const {
+      if (v) { v->~Bvert(); _vert_pool.release(v); }
+   }
+   /// Destroys the edge and returns its memory to the edge pool
+   virtual void delete_edge(Bedge* e) const {
+      if (e) { e->~Bedge(); _edge_pool.release(e); }
+   }
+   /// Destroys the face and returns its memory to the face pool
+   virtual void delete_face(Bface* f) const {
+      if (f) { f->~Bface(); _face_pool.release(f); }
+   }
 
    virtual void delete_elements();
    virtual void delete_patches();
@@ -432,6 +471,15 @@ class BMESH : public BODY, public NameLookup<BMESH> {
 
    void remove_duplicate_vertices(bool keep_vert=1);
 
+   /// Merge vertices within distance tol of each other (0 means
+   /// identical positions), fixing up edges and faces in one
+   /// pass. Degenerate and duplicate edges and faces are removed.
+   /// Merged vertices are deleted unless keep_verts is true. If
+   /// remap is given, it is filled in with each old vertex's new
+   /// index. Returns the number of vertices merged:
+   int weld_vertices(double tol, bool keep_verts=false,
+                     vector<int>* remap=nullptr);
+
    /// Returns separate Bface_lists, one for each connected component
    /// of the mesh:
    vector<Bface_list> get_components() const;
@@ -491,12 +539,22 @@ class BMESH : public BODY, public NameLookup<BMESH> {
 
    //******** PICKING ********
 
-   /*! Brute force intersection:
-    *   Given ray in world space, return intersected face (if any)
-    *   and intersection point in world space:
+   /*! Given ray in world space, return intersected face (if any)
+    *   and intersection point in world space. Uses face_bvh():
     */
    Bface* pick_face(CWline& world_ray, mlib::Wpt& world_hit) const;
 
+   /*! Batched pick_face(): one face (or null) and hit point per
+    *   ray, with the rays split across threads:
+    */
+   void pick_faces(const vector<mlib::Wline>& world_rays,
+                   vector<Bface*>& faces, vector<mlib::Wpt>& world_hits) const;
+
+   /// Bounding volume hierarchy over the faces (see face_bvh.hpp).
+   /// Built on first use, rebuilt after the topology changes, and
+   /// refit after vertices move. Face indices are snapshot() ones:
+   const FaceBVH& face_bvh() const;
+
    //******** DIAGNOSTIC ********
 
    // Return the approximate memory used for this mesh.
@@ -548,6 +606,40 @@ class BMESH : public BODY, public NameLookup<BMESH> {
 
    // Read a mesh file into *this* mesh:
    bool read_file(const char* filename);
+   // Same, for the contents of a mesh file already in memory:
+   bool read_data(const string& data);
+
+   //******** I/O - BINARY ********
+
+   // Binary mesh files hold the vertices, faces, creases, weak
+   // edges, polylines, colors, UVs and patches of a mesh as arrays
+   // that load without parsing (see bmesh_binary.cpp). Files are
+   // mapped into memory to read them. read_jot_file() and
+   // read_jot_stream() recognize them, so read_file() does too:
+   static bool is_binary_file(const char* filename);
+   static bool is_binary_data(const char* data, size_t size);
+
+   static BMESHptr read_binary_file  (const char* filename, BMESHptr ret=nullptr);
+   static BMESHptr read_binary_stream(istream& is, BMESHptr ret=nullptr);
+   static BMESHptr read_binary_data  (const char* data, size_t size,
+                                      BMESHptr ret=nullptr);
+
+   int write_binary_file  (const char* filename) const;
+   int write_binary_stream(ostream& os) const;
+
+   //******** I/O - PLY ********
+
+   // Ascii and binary PLY files, read straight into a mesh (an
+   // LMESH if ret is null) the way ply2sm converts them (see
+   // bmesh_ply.cpp). Files are mapped into memory to read them.
+   // read_jot_file() and read_jot_stream() recognize them too:
+   static bool is_ply_file(const char* filename);
+   static bool is_ply_data(const char* data, size_t size);
+
+   static BMESHptr read_ply_file  (const char* filename, BMESHptr ret=nullptr);
+   static BMESHptr read_ply_stream(istream& is, BMESHptr ret=nullptr);
+   static BMESHptr read_ply_data  (const char* data, size_t size,
+                                   BMESHptr ret=nullptr);
 
    // XXX - the following are all deprecated in favor of the
    //       new I/O using tags:
@@ -690,18 +782,60 @@ class BMESH : public BODY, public NameLookup<BMESH> {
       if (!_curv_data)
          // FIXME: const
          _curv_data = new BMESHcurvature_data(const_pointer_cast<BMESH>(shared_from_this()));
+      else
+         _curv_data->update();
       return _curv_data;
    }
         
+   //******** SNAPSHOT ********
+
+   /// Flat read-only copy of this mesh for analysis loops (see
+   /// mesh_snapshot.hpp). Built on first use, rebuilt after the
+   /// topology changes, with positions refreshed after vertices move:
+   const MeshSnapshot& snapshot() const;
+
+   /// Recompute stale face and vertex normals in one pass over
+   /// the snapshot, split across threads. Called before drawing;
+   /// does nothing unless positions changed since the last call,
+   /// and leaves small meshes to the lazy per-element path:
+   virtual void update_normals();
+
+   /// Indices of the silhouette edges as seen from eye (in object
+   /// space), in edge list order. Same test as Bedge::is_sil(), run
+   /// in one pass over the snapshot split across threads:
+   void find_sil_edges(CWpt& eye, vector<int>& ret) const;
+
+   /// Same result as find_sil_edges(), but only tests the edges
+   /// that sil_cone_tree() can't rule out. Not threaded; it is
+   /// meant for views where few edges are silhouettes:
+   void find_sil_edges_culled(CWpt& eye, vector<int>& ret) const;
+
+   /// Normal-cone hierarchy over the edges (see sil_cone_tree.hpp).
+   /// Built on first use, rebuilt after the topology changes, and
+   /// refit after vertices move. Edge indices are snapshot() ones:
+   const SilConeTree& sil_cone_tree() const;
+
+   /// Suggestive contours, ridges and valleys (see feature_lines.hpp),
+   /// shared by the patches so the whole-mesh work is done once
+   /// per frame. Created on first use:
+   FeatureLines& feature_lines() const;
+
+   /// Indices of the faces that may hold a zero-crossing silhouette
+   /// (see ZcrossPath::has_sil()) as seen from eye, in face list
+   /// order. Includes every face has_sil() would accept, plus faces
+   /// at creases or too close to call:
+   void find_zcross_faces(CWpt& eye, vector<int>& ret) const;
+
    //******** OBSOLETE STUFF ********
 
    uint   version()     const   { return _version; }
 
    // XXX - static function in bmesh.cpp, unused elsewhere
-   static void grow_oriented_face_lists(Bface*, vector<Bface*>&,
-                                        vector<Bface*>&);
+   static void grow_oriented_face_lists(Bface*, TraversalMarks&,
+                                        vector<Bface*>&, vector<Bface*>&);
 
-   // XXX - not used by anyone, brute force approach
+   // Nearest edge or vertex to a point in object space, found
+   // with a ProximityIndex kept for each (see proximity_index.hpp):
    Bedge* nearest_edge(CWpt&);
    Bvert* nearest_vert(CWpt&);
 
@@ -719,6 +853,14 @@ class BMESH : public BODY, public NameLookup<BMESH> {
    Bedge_list   _edges;    ///< list of edges
    Bface_list   _faces;    ///< list of faces
 
+   // Memory for the elements (see new_vert(), delete_vert()):
+   mutable SimplexPool  _vert_pool;     ///< slabs of vertices
+   mutable SimplexPool  _edge_pool;     ///< slabs of edges
+   mutable SimplexPool  _face_pool;     ///< slabs of faces
+
+   /// Share element slabs with m, whose elements are moving into this mesh
+   void share_pools(CBMESH& m);
+
    //******** PATCHES ********
    Patch_list   _patches;  ///< list of patches
    uint         _version;  ///< increment to invalidate display lists
@@ -768,6 +910,19 @@ class BMESH : public BODY, public NameLookup<BMESH> {
    //******** CURVATURE STUFF ********
    mutable BMESHcurvature_data *_curv_data;
 
+   //******** SNAPSHOT ********
+   mutable MeshSnapshot*        _snapshot;
+   bool                         _normals_dirty;  ///< see update_normals()
+
+   //******** PICKING ********
+   mutable FaceBVH*             _face_bvh;
+   mutable bool                 _face_bvh_valid;  ///< false: needs refit
+   mutable SilConeTree*         _sil_tree;
+   mutable bool                 _sil_tree_valid;  ///< false: needs refit
+   mutable FeatureLines*        _feature_lines;   ///< see feature_lines()
+   ProximityIndex*              _vert_prox;       ///< for nearest_vert()
+   ProximityIndex*              _edge_prox;       ///< for nearest_edge()
+
    //******** I/O ********
    /// Full set of tags
    static TAGlist*      _bmesh_tags;
@@ -833,13 +988,18 @@ class BMESH : public BODY, public NameLookup<BMESH> {
    /// internal version of merge(), after error checking:
    virtual void _merge(BMESHptr mesh);
 
+   /// shared implementation of add_faces(); patches may be null:
+   Bface_list _add_faces(const vector<Point3i>& tris,
+                         const vector<Patch*>* patches, Patch* p);
+
    /*! In BMESH, just calls BMESHobs::broadcast_update_request(this),
     * but in LMESH also updates subdivision meshes: */
    virtual void send_update_notification();
 
-   // obsolete?
+   // Collects unmarked elements reachable from a vertex
+   // (used by split_components() and kill_component()):
    void grow_mesh_equivalence_class(
-      Bvert*, 
+      Bvert*, TraversalMarks&,
       vector<Bface*>&, vector<Bedge*>&, vector<Bvert*>&
       );
 };
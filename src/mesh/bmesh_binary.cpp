@@ -0,0 +1,566 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * bmesh_binary.cpp:
+ *
+ *    Binary mesh files: BMESH::read_binary_data() and friends.
+ *
+ *    The file is a header, a table of sections, and the sections,
+ *    each an array of fixed-size records at an 8-byte aligned
+ *    offset, in the byte order of the machine that wrote it:
+ *
+ *       header:    magic "\211JOTMESH", version, byte order mark,
+ *                  mesh class name ("BMESH", "LMESH"), section count
+ *       sections:  type, record size, record count, offset
+ *
+ *    Section types (see sect_t below) hold vertex positions,
+ *    triangles, weak edges, creases (with crease values),
+ *    polylines, vertex colors, face UVs, the patch of each face,
+ *    and the patches' other data (names, textures, colors) in the
+ *    text format, which is small. The mesh's remaining tags (BODY
+ *    tags, secondary faces, render style, shadow settings, and any
+ *    a subclass adds) go in one more text section, so nothing the
+ *    text format saves is lost. Readers skip sections of types
+ *    they don't know, so sections can be added without changing
+ *    the version; the version changes only if a known section's
+ *    records change.
+ *
+ *    Records are copied out of the file with memcpy, so sections
+ *    need not be aligned in memory (e.g. when read from a stream).
+ *
+ *    Faces are the mesh's triangles in mesh order (quads are two
+ *    triangles and a weak edge), so face indices in the UV and
+ *    patch sections are mesh face indices, and faces are stored
+ *    exactly (unlike the text format, which writes quads as 4-gons
+ *    and so can renumber faces). Loading decodes the patches, then
+ *    copies the arrays out and builds the mesh with add_faces(),
+ *    each face going straight to its patch. Writing takes element
+ *    indices from the mesh snapshot (see mesh_snapshot.hpp).
+ **********************************************************************/
+#include "std/config.hpp"
+#include "std/file.hpp"
+#include "mesh/lmesh.hpp"
+#include "mesh/patch.hpp"
+#include "mesh/uv_data.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace mlib;
+
+static const char     BINARY_MAGIC[8] = { '\211','J','O','T','M','E','S','H' };
+static const uint32_t BINARY_VERSION  = 1;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// Positions and triangles are copied straight into these:
+static_assert(sizeof(Wpt) == 3*sizeof(double), "Wpt is not 3 doubles");
+static_assert(sizeof(Point3i) == 3*sizeof(int32_t), "Point3i is not 3 ints");
+
+namespace {
+
+struct file_header_t {
+   char     _magic[8];
+   uint32_t _version;
+   uint32_t _byte_order;
+   char     _class_name[32];
+   uint32_t _num_sections;
+   uint32_t _reserved;
+};
+
+struct section_t {
+   uint32_t _type;
+   uint32_t _rec_size;
+   uint64_t _count;
+   uint64_t _offset;
+};
+
+enum sect_t {
+   VERTS_SECT = 1,      // double[3] per vertex
+   FACES_SECT,          // int32[3] per face
+   WEAK_SECT,           // int32[2] per weak edge
+   CREASE_SECT,         // int32[3] per crease edge: vertices, crease value
+   POLYLINE_SECT,       // int32[2] per polyline edge
+   COLOR_SECT,          // double[4] per vertex: rgb, alpha (< 0: no color)
+   UV_SECT,             // uv_rec_t per face with UVs
+   FACE_PATCH_SECT,     // int32 per face: patch index (-1: none)
+   PATCH_SECT,          // patch records as text, preceded by their number
+   MESH_TAGS_SECT,      // the mesh's other tags as text
+   NUM_SECT
+};
+
+struct uv_rec_t {
+   int32_t _face;
+   int32_t _pad;
+   double  _uv[6];
+};
+
+// Record size of each known section type:
+inline uint32_t
+rec_size(uint32_t type)
+{
+   switch (type) {
+    case VERTS_SECT:      return 3*sizeof(double);
+    case FACES_SECT:      return 3*sizeof(int32_t);
+    case WEAK_SECT:       return 2*sizeof(int32_t);
+    case CREASE_SECT:     return 3*sizeof(int32_t);
+    case POLYLINE_SECT:   return 2*sizeof(int32_t);
+    case COLOR_SECT:      return 4*sizeof(double);
+    case UV_SECT:         return sizeof(uv_rec_t);
+    case FACE_PATCH_SECT: return sizeof(int32_t);
+    case PATCH_SECT:      return 1;
+    case MESH_TAGS_SECT:  return 1;
+   }
+   return 0;
+}
+
+// A section being written: its records, as bytes:
+struct out_sect_t {
+   uint32_t     _type;
+   vector<char> _data;
+   out_sect_t(uint32_t t) : _type(t) {}
+   template <class T>
+   void push(const T& rec) {
+      const char* c = (const char*)&rec;
+      _data.insert(_data.end(), c, c + sizeof(T));
+   }
+   uint64_t count() const { return _data.size()/rec_size(_type); }
+};
+
+inline uint64_t
+align8(uint64_t n)
+{
+   return (n + 7) & ~uint64_t(7);
+}
+
+// Copies record i of a section into rec:
+template <class T, size_t N>
+inline void
+get_rec(const char* sect, uint64_t i, T (&rec)[N])
+{
+   memcpy(rec, sect + i*sizeof(rec), sizeof(rec));
+}
+
+// Mesh tags kept in sections of their own, so not in MESH_TAGS_SECT:
+inline bool
+is_binary_tag(const string& name)
+{
+   static const char* names[] = {
+      "vertices", "faces", "uvfaces", "creases", "polylines",
+      "weak_edges", "colors", "texcoords2", "patch"
+   };
+   for (auto& n : names)
+      if (name == n)
+         return true;
+   return false;
+}
+
+} // namespace
+
+bool
+BMESH::is_binary_data(const char* data, size_t size)
+{
+   return data && size >= sizeof(BINARY_MAGIC) &&
+      memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
+
+bool
+BMESH::is_binary_file(const char* filename)
+{
+   if (!filename)
+      return false;
+   ifstream in(filename, ios::in | ios::binary);
+   char magic[sizeof(BINARY_MAGIC)];
+   return (in.read(magic, sizeof(magic)) &&
+           is_binary_data(magic, sizeof(magic)));
+}
+
+BMESHptr
+BMESH::read_binary_file(const char* filename, BMESHptr ret)
+{
+   if (!filename) {
+      err_msg("BMESH::read_binary_file() - Filename is NULL");
+      return nullptr;
+   }
+   MappedFile file;
+   if (!file.open(filename)) {
+      err_mesg(ERR_LEV_WARN,
+               "BMESH::read_binary_file() - Could not open file '%s'", filename);
+      return nullptr;
+   }
+   return read_binary_data(file.data(), file.size(), ret);
+}
+
+BMESHptr
+BMESH::read_binary_stream(istream& in, BMESHptr ret)
+{
+   // Streams can't be mapped; read it all, then load from memory:
+   string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+   return read_binary_data(data.data(), data.size(), ret);
+}
+
+BMESHptr
+BMESH::read_binary_data(const char* data, size_t size, BMESHptr ret)
+{
+   // Check the header and the section table:
+
+   if (!is_binary_data(data, size) || size < sizeof(file_header_t)) {
+      err_msg("BMESH::read_binary_data() - Error: Not a binary mesh.");
+      return nullptr;
+   }
+   file_header_t header;
+   memcpy(&header, data, sizeof(header));
+   if (header._byte_order != BYTE_ORDER_MARK) {
+      err_msg("BMESH::read_binary_data() - Error: Written with a different byte order.");
+      return nullptr;
+   }
+   if (header._version != BINARY_VERSION) {
+      err_msg("BMESH::read_binary_data() - Error: Version %d (can read %d).",
+              header._version, BINARY_VERSION);
+      return nullptr;
+   }
+   uint64_t table_end = sizeof(header) + uint64_t(header._num_sections)*sizeof(section_t);
+   if (table_end > size) {
+      err_msg("BMESH::read_binary_data() - Error: Truncated section table.");
+      return nullptr;
+   }
+   const char* sect[NUM_SECT] = {};
+   uint64_t    count[NUM_SECT] = {};
+   for (uint32_t i = 0; i < header._num_sections; i++) {
+      section_t s;
+      memcpy(&s, data + sizeof(header) + i*sizeof(section_t), sizeof(s));
+      if (s._type < VERTS_SECT || s._type >= NUM_SECT)
+         continue;      // a newer kind of section
+      if (s._rec_size != rec_size(s._type) ||
+          s._offset > size || s._count > (size - s._offset)/s._rec_size) {
+         err_msg("BMESH::read_binary_data() - Error: Bad section %d.", s._type);
+         return nullptr;
+      }
+      sect [s._type] = data + s._offset;
+      count[s._type] = s._count;
+   }
+
+   // Get a mesh of the type given in the file, as read_jot_stream() does:
+
+   header._class_name[sizeof(header._class_name) - 1] = 0;
+   string class_name(header._class_name);
+   if (!(ret && ret->static_name() == class_name)) {
+      DATA_ITEM* di = DATA_ITEM::lookup(class_name);
+      DATA_ITEM* item = di ? di->dup() : nullptr;
+      BMESH* m = dynamic_cast<BMESH*>(item);
+      if (!m) {
+         err_msg("BMESH::read_binary_data() - Error: '%s' is not a mesh class.",
+                 class_name.c_str());
+         delete item;
+         return nullptr;
+      }
+      ret = BMESHptr(m);
+   }
+   BMESH& mesh = *ret;
+
+   // A file of just vertex positions updates a mesh that has the
+   // same number of vertices, as with the text format:
+   if (mesh.nverts() > 0 && count[FACES_SECT] == 0 &&
+       count[VERTS_SECT] == (uint64_t)mesh.nverts()) {
+      for (int i = 0; i < mesh.nverts(); i++) {
+         double p[3];
+         get_rec(sect[VERTS_SECT], i, p);
+         mesh.bv(i)->set_loc(Wpt(p[0], p[1], p[2]));
+      }
+      mesh.changed(VERT_POSITIONS_CHANGED);
+      return ret;
+   }
+   mesh.delete_elements();
+
+   // Patches first, while there are no faces (a patch decoded
+   // without faces takes all the mesh has):
+
+   if (count[PATCH_SECT]) {
+      string text(sect[PATCH_SECT], count[PATCH_SECT]);
+      istringstream in(text);
+      STDdstream stream(&in);
+      int num = 0;
+      stream >> num;
+      for (int i = 0; i < num; i++) {
+         string patchname;
+         stream >> patchname;
+         mesh.new_patch()->decode(stream);
+      }
+      mesh.changed(PATCHES_CHANGED);
+   }
+
+   // Vertices and faces, each face going straight to its patch:
+
+   Wpt_list pts;
+   pts.resize(count[VERTS_SECT]);
+   if (!pts.empty())
+      memcpy(&pts[0], sect[VERTS_SECT], pts.size()*sizeof(Wpt));
+   vector<Point3i> tris(count[FACES_SECT]);
+   if (!tris.empty())
+      memcpy(&tris[0], sect[FACES_SECT], tris.size()*sizeof(Point3i));
+   vector<Patch*> patches;
+   if (count[FACE_PATCH_SECT] == tris.size()) {
+      patches.resize(tris.size(), nullptr);
+      for (size_t i = 0; i < tris.size(); i++) {
+         int32_t fp[1];
+         get_rec(sect[FACE_PATCH_SECT], i, fp);
+         if (0 <= fp[0] && fp[0] < mesh.npatches())
+            patches[i] = mesh.patch(fp[0]);
+      }
+   }
+   mesh.build(pts, vector<Point3i>());
+   Bface_list faces = (patches.empty() ? mesh.add_faces(tris) :
+                       mesh.add_faces(tris, patches));
+   int nf = faces.size();
+
+   // Edges:
+
+   for (uint64_t i = 0; i < count[POLYLINE_SECT]; i++) {
+      int32_t e[2];
+      get_rec(sect[POLYLINE_SECT], i, e);
+      mesh.add_edge(e[0], e[1]);
+   }
+   for (uint64_t i = 0; i < count[WEAK_SECT]; i++) {
+      int32_t e[2];
+      get_rec(sect[WEAK_SECT], i, e);
+      mesh.set_weak_edge(e[0], e[1]);
+   }
+   // as get_faces() does, so the mesh type is worked out anew:
+   mesh.changed(TOPOLOGY_CHANGED);
+
+   for (uint64_t i = 0; i < count[CREASE_SECT]; i++) {
+      int32_t e[3];
+      get_rec(sect[CREASE_SECT], i, e);
+      Bedge* edge = (mesh.valid_vert_indices(e[0], e[1]) ?
+                     mesh.bv(e[0])->lookup_edge(mesh.bv(e[1])) : nullptr);
+      if (edge)
+         edge->set_crease((unsigned short)e[2]);
+   }
+   if (count[CREASE_SECT])
+      mesh.changed(CREASES_CHANGED);
+
+   // Vertex colors:
+
+   if (count[COLOR_SECT] == (uint64_t)mesh.nverts()) {
+      for (int i = 0; i < mesh.nverts(); i++) {
+         double c[4];
+         get_rec(sect[COLOR_SECT], i, c);
+         if (c[3] >= 0)
+            mesh.bv(i)->set_color(COLOR(c[0], c[1], c[2]), c[3]);
+      }
+      mesh.changed(VERT_COLORS_CHANGED);
+   } else if (count[COLOR_SECT]) {
+      err_msg("BMESH::read_binary_data: warning: %d colors for %d verts",
+              (int)count[COLOR_SECT], mesh.nverts());
+   }
+
+   // UVs:
+
+   for (uint64_t i = 0; i < count[UV_SECT]; i++) {
+      uv_rec_t uv;
+      memcpy(&uv, sect[UV_SECT] + i*sizeof(uv), sizeof(uv));
+      if (0 <= uv._face && uv._face < nf && faces[uv._face])
+         UVdata::set(faces[uv._face], UVpt(uv._uv[0], uv._uv[1]),
+                     UVpt(uv._uv[2], uv._uv[3]), UVpt(uv._uv[4], uv._uv[5]));
+   }
+
+   // The mesh's other tags, now that the faces they refer to
+   // (e.g. secondary faces) exist:
+
+   if (count[MESH_TAGS_SECT]) {
+      string text(sect[MESH_TAGS_SECT], count[MESH_TAGS_SECT]);
+      istringstream in(text);
+      STDdstream stream(&in);
+      // the class name, as read_jot_stream() reads it:
+      string class_name;
+      stream >> class_name;
+      mesh.DATA_ITEM::decode(stream);
+   }
+
+   // As BMESH::decode() does:
+   mesh.make_patch_if_needed();
+   if (mesh.is_points() && Config::get_var_bool("BMESH_BUILD_VERT_STRIPS",false))
+      mesh.build_vert_strips();
+
+   return ret;
+}
+
+int
+BMESH::write_binary_file(const char* filename) const
+{
+   ofstream fout(filename, ios::out | ios::binary);
+   if (!fout) {
+      err_msg("BMESH::write_binary_file: error: could not open file: %s", filename);
+      return 0;
+   }
+   return write_binary_stream(fout);
+}
+
+int
+BMESH::write_binary_stream(ostream& os) const
+{
+   vector<out_sect_t> sects;
+
+   // Element indices come from the snapshot (Bsimplex::index()
+   // searches the mesh's list):
+   const MeshSnapshot& snap = snapshot();
+
+   // Vertices and faces:
+
+   sects.push_back(out_sect_t(VERTS_SECT));
+   bool xformed = Config::get_var_bool("JOT_SAVE_XFORMED_MESH",false);
+   for (int i = 0; i < nverts(); i++)
+      sects.back().push(xformed ? bv(i)->wloc() : bv(i)->loc());
+
+   sects.push_back(out_sect_t(FACES_SECT));
+   for (int i = 0; i < nfaces(); i++) {
+      const int* fv = snap.face_verts(i);
+      int32_t v[3] = { fv[0], fv[1], fv[2] };
+      sects.back().push(v);
+   }
+
+   // Edges:
+
+   out_sect_t weak(WEAK_SECT), crease(CREASE_SECT), poly(POLYLINE_SECT);
+   for (int i = 0; i < nedges(); i++) {
+      Bedge* e = be(i);
+      const int* ev = snap.edge_verts(i);
+      int32_t v[3] = { ev[0], ev[1], e->crease_val() };
+      if (e->is_weak())
+         weak.push(v[0]), weak.push(v[1]);
+      if (e->is_crease())
+         crease.push(v);
+      if (e->is_polyline())
+         poly.push(v[0]), poly.push(v[1]);
+   }
+   if (!poly._data.empty())
+      sects.push_back(poly);
+   if (!weak._data.empty())
+      sects.push_back(weak);
+   if (!crease._data.empty())
+      sects.push_back(crease);
+
+   // Vertex colors, if any vertex has one:
+
+   int i = 0;
+   while (i < nverts() && !bv(i)->has_color())
+      i++;
+   if (i < nverts()) {
+      sects.push_back(out_sect_t(COLOR_SECT));
+      for (i = 0; i < nverts(); i++) {
+         Bvert* v = bv(i);
+         double c[4] = { v->color()[0], v->color()[1], v->color()[2],
+                         v->has_color() ? v->alpha() : -1.0 };
+         sects.back().push(c);
+      }
+   }
+
+   // UVs:
+
+   out_sect_t uvs(UV_SECT);
+   for (i = 0; i < nfaces(); i++) {
+      UVdata* uvd = UVdata::lookup(bf(i));
+      if (!uvd)
+         continue;
+      uv_rec_t uv = { i, 0, { uvd->uv(1)[0], uvd->uv(1)[1], uvd->uv(2)[0],
+                              uvd->uv(2)[1], uvd->uv(3)[0], uvd->uv(3)[1] } };
+      uvs.push(uv);
+   }
+   if (!uvs._data.empty())
+      sects.push_back(uvs);
+
+   // Patches: the patch of each face, and the patches' other tags
+   // as text (the faces are what make the text format slow):
+
+   if (npatches() > 0) {
+      vector<int32_t> face_patch(nfaces(), -1);
+      for (i = 0; i < npatches(); i++)
+         for (auto& f : _patches[i]->faces())
+            face_patch[snap.index(f)] = i;
+      sects.push_back(out_sect_t(FACE_PATCH_SECT));
+      for (auto& k : face_patch)
+         sects.back().push(k);
+      ostringstream text;
+      STDdstream out(&text);
+      out << npatches();
+      for (i = 0; i < npatches(); i++) {
+         Patch* p = _patches[i];
+         TAGformat d(&out, p->class_name(), 1);
+         d.id();
+         for (auto& tag : p->tags())
+            if (tag->name() != "faces")
+               tag->format(p, *d);
+         out.write_newline();
+         d.end_id();
+      }
+      string s = text.str();
+      sects.push_back(out_sect_t(PATCH_SECT));
+      sects.back()._data.assign(s.begin(), s.end());
+   }
+
+   // The mesh's other tags as text, as format() writes them:
+
+   ostringstream text;
+   STDdstream out(&text);
+   TAGformat d(&out, class_name(), 1);
+   d.id();
+   for (auto& tag : tags())
+      if (!is_binary_tag(tag->name()))
+         tag->format(this, *d);
+   out.write_newline();
+   d.end_id();
+   string s = text.str();
+   sects.push_back(out_sect_t(MESH_TAGS_SECT));
+   sects.back()._data.assign(s.begin(), s.end());
+
+   // Header, section table, then the sections:
+
+   file_header_t header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header._magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+   header._version      = BINARY_VERSION;
+   header._byte_order   = BYTE_ORDER_MARK;
+   strncpy(header._class_name, static_name().c_str(),
+           sizeof(header._class_name) - 1);
+   header._num_sections = sects.size();
+   os.write((const char*)&header, sizeof(header));
+
+   uint64_t offset = align8(sizeof(header) + sects.size()*sizeof(section_t));
+   for (auto& s : sects) {
+      section_t rec = { s._type, rec_size(s._type), s.count(), offset };
+      os.write((const char*)&rec, sizeof(rec));
+      offset = align8(offset + s._data.size());
+   }
+   uint64_t pos = sizeof(header) + sects.size()*sizeof(section_t);
+   static const char zeros[8] = {};
+   for (auto& s : sects) {
+      os.write(zeros, align8(pos) - pos);
+      pos = align8(pos);
+      if (!s._data.empty())
+         os.write(&s._data[0], s._data.size());
+      pos += s._data.size();
+   }
+   os.flush();
+   if (!os) {
+      err_msg("BMESH::write_binary_stream: error: write failed");
+      return 0;
+   }
+   return 1;
+}
@@ -41,6 +41,7 @@ using namespace mlib;
 #include "mesh/bvert.hpp"
 #include "mesh/bface.hpp"
 #include "mesh/bmesh.hpp"
+#include "std/parallel.hpp"
 
 /* Helper Functions for Computing Curvature */
 
@@ -61,8 +62,6 @@ void diagonalize_curv(const Wvec &old_u, const Wvec &old_v,
 
 inline void compute_edge_vectors(const BMESHptr mesh, int face_idx, Wvec edges[3]);
 inline void compute_ntb_coord_sys(const Wvec edges[3], Wvec &n, Wvec &t, Wvec &b);
-inline void compute_initial_vertex_coord_sys(const BMESHptr mesh,
-                                             vector<Wvec> &pdir1, vector<Wvec> &pdir2);
 
 /* BMESHcurvature_data Constructors */
 
@@ -71,17 +70,11 @@ inline void compute_initial_vertex_coord_sys(const BMESHptr mesh,
  *
  */
 BMESHcurvature_data::BMESHcurvature_data(const BMESHptr mesh_in)
-   : mesh(mesh_in), mesh_feature_size(0.0)
+   : mesh(mesh_in), mesh_feature_size(0.0), positions_dirty(false),
+     last_num_recomputed(0)
 {
    
-   compute_corner_areas();
-   compute_vertex_areas();
-   compute_face_curvatures();
-   compute_vertex_curvatures();
-   diagonalize_vertex_curvatures();
-   compute_face_dcurv();
-   compute_vertex_dcurv();
-   compute_feature_size();
+   compute_all();
    
 }
 
@@ -91,7 +84,7 @@ BMESHcurvature_data::curv_tensor_t
 BMESHcurvature_data::curv_tensor(const Bvert *v)
 {
    
-   return vertex_curv[v->index()];
+   return vertex_curv[mesh->snapshot().index(v)];
    
 }
       
@@ -99,7 +92,7 @@ BMESHcurvature_data::diag_curv_t
 BMESHcurvature_data::diag_curv(const Bvert *v)
 {
    
-   return diag_vertex_curv[v->index()];
+   return diag_vertex_curv[mesh->snapshot().index(v)];
    
 }
 
@@ -107,7 +100,7 @@ double
 BMESHcurvature_data::k1(const Bvert *v)
 {
    
-   return diag_vertex_curv[v->index()].k1();
+   return diag_vertex_curv[mesh->snapshot().index(v)].k1();
    
 }
 
@@ -115,7 +108,7 @@ double
 BMESHcurvature_data::k2(const Bvert *v)
 {
    
-   return diag_vertex_curv[v->index()].k2();
+   return diag_vertex_curv[mesh->snapshot().index(v)].k2();
    
 }
 
@@ -123,7 +116,7 @@ Wvec
 BMESHcurvature_data::pdir1(const Bvert *v)
 {
    
-   return diag_vertex_curv[v->index()].pdir1();
+   return diag_vertex_curv[mesh->snapshot().index(v)].pdir1();
    
 }
 
@@ -131,7 +124,7 @@ Wvec
 BMESHcurvature_data::pdir2(const Bvert *v)
 {
    
-   return diag_vertex_curv[v->index()].pdir2();
+   return diag_vertex_curv[mesh->snapshot().index(v)].pdir2();
    
 }
 
@@ -139,360 +132,465 @@ BMESHcurvature_data::dcurv_tensor_t
 BMESHcurvature_data::dcurv_tensor(const Bvert *v)
 {
    
-   return vertex_dcurv[v->index()];
+   return vertex_dcurv[mesh->snapshot().index(v)];
    
 }
 
-/* BMESHcurvature_data Curvature Computation Functions */
+/* BMESHcurvature_data Updating */
+
+//! Faces or vertices per thread:
+static const int CURV_GRAIN = 1024;
 
 /*!
- *  Computes the corner areas for all faces in the given BMESH.  These are used
- *  for weighting purposes when computing the curvatures for the BMESH's vertices.
+ *  \brief Calls f(i) for each of the n indices in list (or for 0..n-1 if
+ *  list is null), split across threads.
  *
  */
-void
-BMESHcurvature_data::compute_corner_areas()
+template <class F>
+static void
+for_each_index(const int *list, int n, const F &f)
 {
-
-   int nf = mesh->nfaces();
    
-   corner_areas.clear();
-   corner_areas.resize(nf);
-
-   for (int i = 0; i < nf; i++) {
-      
-      Wvec e[3];
-      compute_edge_vectors(mesh, i, e);
-
-      // Compute corner weights
-      double area = mesh->bf(i)->area();// 0.5 * cross(e[0],e[1]).length();
-      double l2[3] = { e[0].length_sqrd(), e[1].length_sqrd(), e[2].length_sqrd() };
-      double ew[3] = { l2[0] * (l2[1] + l2[2] - l2[0]),
-                       l2[1] * (l2[2] + l2[0] - l2[1]),
-                       l2[2] * (l2[0] + l2[1] - l2[2]) };
-                       
-      if (ew[0] <= 0.0f) {
-         
-         corner_areas[i][1] = -0.25f * l2[2] * area / (e[0] * e[2]);
-         corner_areas[i][2] = -0.25f * l2[1] * area / (e[0] * e[1]);
-         corner_areas[i][0] = area - corner_areas[i][1] - corner_areas[i][2];
-         
-      } else if (ew[1] <= 0.0f) {
-         
-         corner_areas[i][2] = -0.25f * l2[0] * area / (e[1] * e[0]);
-         corner_areas[i][0] = -0.25f * l2[2] * area / (e[1] * e[2]);
-         corner_areas[i][1] = area - corner_areas[i][2] - corner_areas[i][0];
-         
-      } else if (ew[2] <= 0.0f) {
-         
-         corner_areas[i][0] = -0.25f * l2[1] * area / (e[2] * e[1]);
-         corner_areas[i][1] = -0.25f * l2[0] * area / (e[2] * e[0]);
-         corner_areas[i][2] = area - corner_areas[i][0] - corner_areas[i][1];
-         
-      } else {
-         
-         double ewscale = 0.5f * area / (ew[0] + ew[1] + ew[2]);
-         for (int j = 0; j < 3; j++)
-            corner_areas[i][j] = ewscale * (ew[(j+1)%3] + ew[(j+2)%3]);
-            
-      }
-      
-   }
+   parallel_for(n, CURV_GRAIN, [&](int begin, int end) {
+      for (int k = begin; k < end; k++)
+         f(list ? list[k] : k);
+   });
    
 }
 
 /*!
- *  Computes vertex areas for all vertices in the given BMESH.  These are used for
- *  weighting purposes when computing the curvatures for the BMESH's vertices.
+ *  Brings the curvature data up to date after vertices moved.  The moved
+ *  vertices are found by comparing positions with those of the last
+ *  computation, and the affected faces and vertices are found by growing
+ *  that set one ring at a time:
+ *
+ *    - vertex normals change on the moved vertices and their 1-ring,
+ *    - face curvatures on the faces touching those,
+ *    - vertex curvatures on the vertices of those faces,
+ *    - face derivatives on the faces touching those,
+ *    - vertex derivatives on the vertices of those faces.
+ *
+ *  If more than a quarter of the vertices are affected, everything is
+ *  recomputed instead.
  *
  */
 void
-BMESHcurvature_data::compute_vertex_areas()
+BMESHcurvature_data::update()
 {
    
+   if (!positions_dirty)
+      return;
+   positions_dirty = false;
+   
+   int nv = mesh->nverts();
    int nf = mesh->nfaces();
    
-   vertex_areas.clear();
-   vertex_areas.resize(mesh->nverts());
-
-   for (int i = 0; i < nf; i++) {
-      
-      vertex_areas[mesh->bf(i)->v1()->index()] += corner_areas[i][0];
-      vertex_areas[mesh->bf(i)->v2()->index()] += corner_areas[i][1];
-      vertex_areas[mesh->bf(i)->v3()->index()] += corner_areas[i][2];
-      
+   // The element counts changed without a TOPOLOGY_CHANGED:
+   if (nv != (int)vertex_locs.size() || nf != (int)corner_areas.size()) {
+      compute_all();
+      return;
+   }
+   
+   const MeshSnapshot& snap = mesh->snapshot();
+   const double *x = snap.x(), *y = snap.y(), *z = snap.z();
+   
+   vector<int> verts, faces;
+   vector<char> vert_in(nv, 0), face_in(nf, 0);
+   for (int i = 0; i < nv; i++) {
+      if (x[i] != vertex_locs[i][0] || y[i] != vertex_locs[i][1] ||
+          z[i] != vertex_locs[i][2]) {
+         vert_in[i] = 1;
+         verts.push_back(i);
+      }
    }
    
+   last_num_recomputed = 0;
+   if (verts.empty())
+      return;
+   
+   // Add the faces touching verts[begin..], and the vertices of
+   // faces[begin..]:
+   auto add_faces = [&](size_t begin) {
+      size_t end = verts.size();
+      for (size_t k = begin; k < end; k++) {
+         int v = verts[k];
+         for (int c = vert_corner_off[v]; c < vert_corner_off[v+1]; c++) {
+            int f = vert_corners[c] / 3;
+            if (!face_in[f]) {
+               face_in[f] = 1;
+               faces.push_back(f);
+            }
+         }
+      }
+   };
+   auto add_verts = [&](size_t begin) {
+      size_t end = faces.size();
+      for (size_t k = begin; k < end; k++) {
+         const int *fv = snap.face_verts(faces[k]);
+         for (int j = 0; j < 3; j++) {
+            if (!vert_in[fv[j]]) {
+               vert_in[fv[j]] = 1;
+               verts.push_back(fv[j]);
+            }
+         }
+      }
+   };
+   
+   size_t num_moved = verts.size();
+   add_faces(0);
+   size_t num_f0 = faces.size();      // faces touching the moved vertices
+   add_verts(0);
+   size_t num_n1 = verts.size();      // verts[0..num_n1): new normals
+   add_faces(num_moved);
+   size_t num_fa = faces.size();      // faces[0..num_fa): face curvatures
+   add_verts(num_f0);
+   size_t num_vb = verts.size();      // verts[0..num_vb): vertex curvatures
+   add_faces(num_n1);
+   size_t num_fc = faces.size();      // faces[0..num_fc): face derivatives
+   add_verts(num_fa);                 // verts: vertex derivatives
+   
+   if (verts.size() > size_t(nv / 4)) {
+      compute_all();
+      return;
+   }
+   
+   // Bvert::norm() and Bface::area() cache what they compute, so
+   // compute them here before the threads read them:
+   for (size_t k = 0; k < num_vb; k++)
+      mesh->bv(verts[k])->norm();
+   for (size_t k = 0; k < num_fa; k++)
+      mesh->bf(faces[k])->area();
+   
+   for_each_index(faces.data(), int(num_fa),
+                  [this](int f) { compute_face_curvature(f); });
+   for_each_index(verts.data(), int(num_vb),
+                  [this, &snap](int v) { compute_vertex_curvature(snap, v); });
+   for_each_index(faces.data(), int(num_fc),
+                  [this, &snap](int f) { compute_face_dcurv(snap, f); });
+   for_each_index(verts.data(), int(verts.size()),
+                  [this](int v) { compute_vertex_dcurv(v); });
+   compute_feature_size();
+   
+   for (size_t k = 0; k < num_moved; k++)
+      vertex_locs[verts[k]] = snap.loc(verts[k]);
+   last_num_recomputed = int(verts.size());
+   
 }
 
+/* BMESHcurvature_data Curvature Computation Functions */
+
 /*!
- *  Computes the curvatures per face for all faces in the given BMESH.  Each
- *  face's curvature is estimated based on the variation of normals along its
- *  edges.
+ *  Computes all curvature data for the mesh, splitting each stage across
+ *  threads.
  *
  */
 void
-BMESHcurvature_data::compute_face_curvatures()
+BMESHcurvature_data::compute_all()
 {
    
+   int nv = mesh->nverts();
    int nf = mesh->nfaces();
    
-   face_curv.clear();
-   face_curv.resize(nf);
+   const MeshSnapshot& snap = mesh->snapshot();
+   
+   // Bvert::norm() and Bface::area() cache what they compute, so
+   // compute them here before the threads read them:
+   for (int i = 0; i < nv; i++)
+      mesh->bv(i)->norm();
+   for (int i = 0; i < nf; i++)
+      mesh->bf(i)->area();
+   
+   corner_areas.assign(nf, corner_areas_t());
+   face_curv.assign(nf, curv_tensor_t());
+   face_dcurv.assign(nf, dcurv_tensor_t());
+   face_t.assign(nf, Wvec());
+   face_b.assign(nf, Wvec());
+   vertex_areas.assign(nv, 0.0);
+   vertex_curv.assign(nv, curv_tensor_t());
+   diag_vertex_curv.assign(nv, diag_curv_t());
+   vertex_dcurv.assign(nv, dcurv_tensor_t());
+   
+   compute_vertex_corners();
+   
+   for_each_index(nullptr, nf, [this](int f) { compute_face_curvature(f); });
+   for_each_index(nullptr, nv,
+                  [this, &snap](int v) { compute_vertex_curvature(snap, v); });
+   for_each_index(nullptr, nf,
+                  [this, &snap](int f) { compute_face_dcurv(snap, f); });
+   for_each_index(nullptr, nv, [this](int v) { compute_vertex_dcurv(v); });
+   compute_feature_size();
    
-   // Compute curvature per-face
-   for (int i = 0; i < nf; ++i) {
-      
-      Wvec e[3];
-      compute_edge_vectors(mesh, i, e);
-
-      Wvec n, t, b;
-      compute_ntb_coord_sys(e, n, t, b);
-
-      // Estimate curvature based on variation of normals
-      // along edges
-      double m[3] = { 0, 0, 0 };
-      double w[3][3] = { {0,0,0}, {0,0,0}, {0,0,0} };
-      for (int j = 0; j < 3; ++j) {
-         
-         double u = e[j] * t;
-         double v = e[j] * b;
-         w[0][0] += u*u;
-         w[0][1] += u*v;
-         //w[1][1] += v*v + u*u; 
-         //w[1][2] += u*v; 
-         w[2][2] += v*v;
-         Wvec dn = mesh->bf(i)->v(((j+2)%3)+1)->norm()
-                 - mesh->bf(i)->v(((j+1)%3)+1)->norm();
-         double dnu = dn * t;
-         double dnv = dn * b;
-         m[0] += dnu*u;
-         m[1] += dnu*v + dnv*u;
-         m[2] += dnv*v;
-         
-      }
-      
-      w[1][1] = w[0][0] + w[2][2];
-      w[1][2] = w[0][1];
-
-      // Least squares solution
-      double diag[3];
-      if (!ldltdc<double,3>(w, diag)) {
-         //fprintf(stderr, "ldltdc failed!\n");
-         continue;
-      }
-      ldltsl<double,3>(w, diag, m, m);
-      
-      face_curv[i][0] = m[0];
-      face_curv[i][1] = m[1];
-      face_curv[i][2] = m[2];
-
-   }
+   vertex_locs.resize(nv);
+   for (int i = 0; i < nv; i++)
+      vertex_locs[i] = snap.loc(i);
+   positions_dirty = false;
+   last_num_recomputed = nv;
    
 }
 
 /*!
- *  Computes the curvatures per vertex for all vertices in the given BMESH.  The
- *  curvature of each vertex is estimated based on the weighted average of
- *  curvatures for each face surrounding that vertex.
+ *  Lists the face corners at each vertex, in face order, so per-vertex sums
+ *  add up in the same order as a loop over the faces.
  *
  */
 void
-BMESHcurvature_data::compute_vertex_curvatures()
+BMESHcurvature_data::compute_vertex_corners()
 {
    
    int nv = mesh->nverts();
+   int nf = mesh->nfaces();
    
-   vertex_curv.clear();
-   vertex_curv.resize(nv);
+   const MeshSnapshot& snap = mesh->snapshot();
    
-   // Set up an initial coordinate system per vertex
-   vector<Wvec> pdir1(nv), pdir2(nv);
+   vert_corner_off.assign(nv + 1, 0);
+   for (int i = 0; i < nf; i++)
+      for (int j = 0; j < 3; j++)
+         vert_corner_off[snap.face_verts(i)[j] + 1]++;
+   for (int v = 0; v < nv; v++)
+      vert_corner_off[v+1] += vert_corner_off[v];
    
-   compute_initial_vertex_coord_sys(mesh, pdir1, pdir2);
+   vert_corners.resize(3*nf);
+   vector<int> next(vert_corner_off.begin(), vert_corner_off.end() - 1);
+   for (int i = 0; i < nf; i++)
+      for (int j = 0; j < 3; j++)
+         vert_corners[next[snap.face_verts(i)[j]]++] = 3*i + j;
+   
+}
+
+/*!
+ *  Computes the "Voronoi" corner areas of a face, used for weighting when
+ *  computing the curvatures of its vertices, and the face's curvature,
+ *  estimated from the variation of normals along its edges.
+ *
+ */
+void
+BMESHcurvature_data::compute_face_curvature(int i)
+{
    
-   for(int i = 0; i < mesh->nfaces(); ++i) {
+   Wvec e[3];
+   compute_edge_vectors(mesh, i, e);
+
+   // Compute corner weights
+   double area = mesh->bf(i)->area();// 0.5 * cross(e[0],e[1]).length();
+   double l2[3] = { e[0].length_sqrd(), e[1].length_sqrd(), e[2].length_sqrd() };
+   double ew[3] = { l2[0] * (l2[1] + l2[2] - l2[0]),
+                    l2[1] * (l2[2] + l2[0] - l2[1]),
+                    l2[2] * (l2[0] + l2[1] - l2[2]) };
+                    
+   if (ew[0] <= 0.0f) {
       
-      Wvec e[3];
-      compute_edge_vectors(mesh, i, e);
+      corner_areas[i][1] = -0.25f * l2[2] * area / (e[0] * e[2]);
+      corner_areas[i][2] = -0.25f * l2[1] * area / (e[0] * e[1]);
+      corner_areas[i][0] = area - corner_areas[i][1] - corner_areas[i][2];
+      
+   } else if (ew[1] <= 0.0f) {
+      
+      corner_areas[i][2] = -0.25f * l2[0] * area / (e[1] * e[0]);
+      corner_areas[i][0] = -0.25f * l2[2] * area / (e[1] * e[2]);
+      corner_areas[i][1] = area - corner_areas[i][2] - corner_areas[i][0];
+      
+   } else if (ew[2] <= 0.0f) {
+      
+      corner_areas[i][0] = -0.25f * l2[1] * area / (e[2] * e[1]);
+      corner_areas[i][1] = -0.25f * l2[0] * area / (e[2] * e[0]);
+      corner_areas[i][2] = area - corner_areas[i][0] - corner_areas[i][1];
+      
+   } else {
+      
+      double ewscale = 0.5f * area / (ew[0] + ew[1] + ew[2]);
+      for (int j = 0; j < 3; j++)
+         corner_areas[i][j] = ewscale * (ew[(j+1)%3] + ew[(j+2)%3]);
+         
+   }
 
-      Wvec n, t, b;
-      compute_ntb_coord_sys(e, n, t, b);
+   Wvec n, t, b;
+   compute_ntb_coord_sys(e, n, t, b);
+   face_t[i] = t;
+   face_b[i] = b;
 
-      // Compute curvature per vertex:
-      for(int j = 0; j < 3; ++j){
-         
-         int vj = mesh->bf(i)->v(j+1)->index();
-         double c1, c12, c2;
-         proj_curv(t, b, face_curv[i][0], face_curv[i][1], face_curv[i][2],
-                   pdir1[vj], pdir2[vj], c1, c12, c2);
-         double wt = corner_areas[i][j] / vertex_areas[vj];
-         vertex_curv[vj][0] += wt * c1;
-         vertex_curv[vj][1] += wt * c12;
-         vertex_curv[vj][2] += wt * c2;
-         
-      }
+   // Estimate curvature based on variation of normals
+   // along edges
+   double m[3] = { 0, 0, 0 };
+   double w[3][3] = { {0,0,0}, {0,0,0}, {0,0,0} };
+   for (int j = 0; j < 3; ++j) {
+      
+      double u = e[j] * t;
+      double v = e[j] * b;
+      w[0][0] += u*u;
+      w[0][1] += u*v;
+      //w[1][1] += v*v + u*u; 
+      //w[1][2] += u*v; 
+      w[2][2] += v*v;
+      Wvec dn = mesh->bf(i)->v(((j+2)%3)+1)->norm()
+              - mesh->bf(i)->v(((j+1)%3)+1)->norm();
+      double dnu = dn * t;
+      double dnv = dn * b;
+      m[0] += dnu*u;
+      m[1] += dnu*v + dnv*u;
+      m[2] += dnv*v;
       
    }
    
+   w[1][1] = w[0][0] + w[2][2];
+   w[1][2] = w[0][1];
+
+   face_curv[i] = curv_tensor_t();
+
+   // Least squares solution
+   double diag[3];
+   if (!ldltdc<double,3>(w, diag)) {
+      //fprintf(stderr, "ldltdc failed!\n");
+      return;
+   }
+   ldltsl<double,3>(w, diag, m, m);
+   
+   face_curv[i][0] = m[0];
+   face_curv[i][1] = m[1];
+   face_curv[i][2] = m[2];
+   
 }
 
 /*!
- *  Computes the principal directions and curvatures per vertex for the given
- *  BMESH.  These values are computed based on precomputed per vertex curvature
- *  tensors from the compute_vertex_curvature() function.
+ *  Computes the "Voronoi" area of a vertex, its curvature (the weighted
+ *  average of the curvatures of the faces around it), and from that its
+ *  principal directions and curvatures.
  *
  */
 void
-BMESHcurvature_data::diagonalize_vertex_curvatures()
+BMESHcurvature_data::compute_vertex_curvature(const MeshSnapshot &snap, int v)
 {
    
-   int nv = mesh->nverts();
-   
-   diag_vertex_curv.clear();
-   diag_vertex_curv.resize(nv);
-   
-   vector<Wvec> pdir1(nv), pdir2(nv);
-   compute_initial_vertex_coord_sys(mesh, pdir1, pdir2);
-   
-   // Compute principal directions and curvatures at each vertex
-   vector<double> k1(nv), k2(nv);
+   int begin = vert_corner_off[v], end = vert_corner_off[v+1];
+   
+   double area = 0.0;
+   for (int c = begin; c < end; c++)
+      area += corner_areas[vert_corners[c]/3][vert_corners[c]%3];
+   vertex_areas[v] = area;
+   
+   // Set up an initial coordinate system, from the edge leaving the
+   // vertex in the last face around it:
+   Wvec norm = mesh->bv(v)->norm();
+   Wvec pdir1, pdir2;
+   if (begin < end) {
+      int f = vert_corners[end-1]/3, j = vert_corners[end-1]%3;
+      const int *fv = snap.face_verts(f);
+      pdir1 = snap.loc(fv[(j+1)%3]) - snap.loc(fv[j]);
+   }
+   pdir1 = cross(pdir1, norm).normalized();
+   pdir2 = cross(norm, pdir1);
    
-   for (int i = 0; i < nv; i++){
+   curv_tensor_t curv;
+   for (int c = begin; c < end; c++) {
       
-      diagonalize_curv(pdir1[i], pdir2[i],
-                       vertex_curv[i][0], vertex_curv[i][1], vertex_curv[i][2],
-                       mesh->bv(i)->norm(), pdir1[i], pdir2[i],
-                       k1[i], k2[i]);
+      int f = vert_corners[c]/3, j = vert_corners[c]%3;
+      double c1, c12, c2;
+      proj_curv(face_t[f], face_b[f], face_curv[f][0], face_curv[f][1], face_curv[f][2],
+                pdir1, pdir2, c1, c12, c2);
+      double wt = corner_areas[f][j] / vertex_areas[v];
+      curv[0] += wt * c1;
+      curv[1] += wt * c12;
+      curv[2] += wt * c2;
       
-      diag_vertex_curv[i]._k1 = k1[i];
-      diag_vertex_curv[i]._k2 = k2[i];
-      diag_vertex_curv[i]._pdir1 = pdir1[i];
-      diag_vertex_curv[i]._pdir2 = pdir2[i];
-                       
-//       diag_vertex_curv[i].curv1 = pdir1[i]*k1[i];
-//       diag_vertex_curv[i].curv2 = pdir2[i]*k2[i];
-                       
    }
+   vertex_curv[v] = curv;
+   
+   // Compute principal directions and curvatures
+   diag_curv_t &d = diag_vertex_curv[v];
+   diagonalize_curv(pdir1, pdir2, curv[0], curv[1], curv[2], norm,
+                    d._pdir1, d._pdir2, d._k1, d._k2);
    
 }
 
 /*!
- *  Computes the derivative of curvature per face for all faces in the given
- *  BMESH.  Each face's curvature derivative is estimated based on the variation
- *  of the per vertex curvatures along its edges.
+ *  Computes the derivative of curvature for a face, estimated from the
+ *  variation of the per vertex curvatures along its edges.
  *
  */
 void
-BMESHcurvature_data::compute_face_dcurv()
+BMESHcurvature_data::compute_face_dcurv(const MeshSnapshot &snap, int i)
 {
    
-   int nf = mesh->nfaces();
-   
-   face_dcurv.clear();
-   face_dcurv.resize(nf);
-   
-   // Compute dcurv per-face
-   for(int i = 0; i < nf; ++i){
-      
-      Wvec e[3];
-      compute_edge_vectors(mesh, i, e);
+   Wvec e[3];
+   compute_edge_vectors(mesh, i, e);
 
-      Wvec n, t, b;
-      compute_ntb_coord_sys(e, n, t, b);
+   const Wvec &t = face_t[i], &b = face_b[i];
 
-      // Project curvature tensor from each vertex into this
-      // face's coordinate system
-      curv_tensor_t fcurv[3];
-      for(int j = 0; j < 3; ++j){
-         int vj = mesh->bf(i)->v(j+1)->index();
-         proj_curv(diag_vertex_curv[vj].pdir1(), diag_vertex_curv[vj].pdir2(),
-                   diag_vertex_curv[vj].k1(), 0, diag_vertex_curv[vj].k2(),
-                   t, b, fcurv[j][0], fcurv[j][1], fcurv[j][2]);
+   // Project curvature tensor from each vertex into this
+   // face's coordinate system
+   curv_tensor_t fcurv[3];
+   for(int j = 0; j < 3; ++j){
+      int vj = snap.face_verts(i)[j];
+      proj_curv(diag_vertex_curv[vj].pdir1(), diag_vertex_curv[vj].pdir2(),
+                diag_vertex_curv[vj].k1(), 0, diag_vertex_curv[vj].k2(),
+                t, b, fcurv[j][0], fcurv[j][1], fcurv[j][2]);
 
-      }
+   }
 
-      // Estimate dcurv based on variation of curvature along edges
-      double m[4] = { 0, 0, 0, 0 };
-      double w[4][4] = { {0,0,0,0}, {0,0,0,0}, {0,0,0,0}, {0,0,0,0} };
-      for(int j = 0; j < 3; ++j){
-         // Variation of curvature along each edge
-         curv_tensor_t dfcurv = fcurv[(j+2)%3] - fcurv[(j+1)%3];
-         double u = e[j] * t;
-         double v = e[j] * b;
-         double u2 = u*u, v2 = v*v, uv = u*v;
-         w[0][0] += u2;
-         w[0][1] += uv;
-         //w[1][1] += 2.0f*u2 + v2;
-         //w[1][2] += 2.0f*uv;
-         //w[2][2] += u2 + 2.0f*v2;
-         //w[2][3] += uv;
-         w[3][3] += v2;
-         m[0] += u*dfcurv[0];
-         m[1] += v*dfcurv[0] + 2.0f*u*dfcurv[1];
-         m[2] += 2.0f*v*dfcurv[1] + u*dfcurv[2];
-         m[3] += v*dfcurv[2];
-      }
-      w[1][1] = 2.0f * w[0][0] + w[3][3];
-      w[1][2] = 2.0f * w[0][1];
-      w[2][2] = w[0][0] + 2.0f * w[3][3];
-      w[2][3] = w[0][1];
-
-      // Least squares solution
-      double d[4];
-      if(!ldltdc<double,4>(w, d)){
-         //fprintf(stderr, "ldltdc failed!\n");
-         continue;
-      }
-      ldltsl<double,4>(w, d, m, m);
-      
-      face_dcurv[i][0] = m[0];
-      face_dcurv[i][1] = m[1];
-      face_dcurv[i][2] = m[2];
-      face_dcurv[i][3] = m[3];
+   // Estimate dcurv based on variation of curvature along edges
+   double m[4] = { 0, 0, 0, 0 };
+   double w[4][4] = { {0,0,0,0}, {0,0,0,0}, {0,0,0,0}, {0,0,0,0} };
+   for(int j = 0; j < 3; ++j){
+      // Variation of curvature along each edge
+      curv_tensor_t dfcurv = fcurv[(j+2)%3] - fcurv[(j+1)%3];
+      double u = e[j] * t;
+      double v = e[j] * b;
+      double u2 = u*u, v2 = v*v, uv = u*v;
+      w[0][0] += u2;
+      w[0][1] += uv;
+      //w[1][1] += 2.0f*u2 + v2;
+      //w[1][2] += 2.0f*uv;
+      //w[2][2] += u2 + 2.0f*v2;
+      //w[2][3] += uv;
+      w[3][3] += v2;
+      m[0] += u*dfcurv[0];
+      m[1] += v*dfcurv[0] + 2.0f*u*dfcurv[1];
+      m[2] += 2.0f*v*dfcurv[1] + u*dfcurv[2];
+      m[3] += v*dfcurv[2];
+   }
+   w[1][1] = 2.0f * w[0][0] + w[3][3];
+   w[1][2] = 2.0f * w[0][1];
+   w[2][2] = w[0][0] + 2.0f * w[3][3];
+   w[2][3] = w[0][1];
 
+   face_dcurv[i] = dcurv_tensor_t();
+
+   // Least squares solution
+   double d[4];
+   if(!ldltdc<double,4>(w, d)){
+      //fprintf(stderr, "ldltdc failed!\n");
+      return;
    }
+   ldltsl<double,4>(w, d, m, m);
+   
+   face_dcurv[i][0] = m[0];
+   face_dcurv[i][1] = m[1];
+   face_dcurv[i][2] = m[2];
+   face_dcurv[i][3] = m[3];
    
 }
 
 /*!
- *  Computes the derivative of curvature per vertex for all vertices in the given
- *  BMESH.  The curvature derivative of each vertex is estimated based on the
- *  weighted average of curvature derivatives for each face surrounding that vertex.
+ *  Computes the derivative of curvature for a vertex: the weighted average
+ *  of the curvature derivatives of the faces around it.
  *
  */
 void
-BMESHcurvature_data::compute_vertex_dcurv()
+BMESHcurvature_data::compute_vertex_dcurv(int v)
 {
    
-   int nv = mesh->nverts();
-   int nf = mesh->nfaces();
-   
-   vertex_dcurv.clear();
-   vertex_dcurv.resize(nv);
-   
-   for(int i = 0; i < nf; ++i){
+   dcurv_tensor_t dcurv;
+   for (int c = vert_corner_off[v]; c < vert_corner_off[v+1]; c++) {
       
-      Wvec e[3];
-      compute_edge_vectors(mesh, i, e);
-
-      Wvec n, t, b;
-      compute_ntb_coord_sys(e, n, t, b);
-
-      // Compute dcurv per vertex:
-      for(int j = 0; j < 3; ++j){
-         
-         int vj = mesh->bf(i)->v(j+1)->index();
-         dcurv_tensor_t this_vert_dcurv;
-         proj_dcurv(t, b, face_dcurv[i],
-                    diag_vertex_curv[vj].pdir1(), diag_vertex_curv[vj].pdir2(),
-                    this_vert_dcurv);
-         double wt = corner_areas[i][j] / vertex_areas[vj];
-         vertex_dcurv[vj] += wt * this_vert_dcurv;
-         
-      }
+      int f = vert_corners[c]/3, j = vert_corners[c]%3;
+      dcurv_tensor_t this_vert_dcurv;
+      proj_dcurv(face_t[f], face_b[f], face_dcurv[f],
+                 diag_vertex_curv[v].pdir1(), diag_vertex_curv[v].pdir2(),
+                 this_vert_dcurv);
+      double wt = corner_areas[f][j] / vertex_areas[v];
+      dcurv += wt * this_vert_dcurv;
       
    }
+   vertex_dcurv[v] = dcurv;
    
 }
 
@@ -511,10 +609,12 @@ BMESHcurvature_data::compute_feature_size()
    vector<double> samples;
    samples.reserve(nsamp * 2);
 
+   // Quick 'n dirty portable random number generator (restarted
+   // each time, so recomputing gives the same answer)
+   unsigned randq = 0;
+
    for(int i = 0; i < nsamp; ++i){
       
-      // Quick 'n dirty portable random number generator 
-      static unsigned randq = 0;
       randq = unsigned(1664525) * randq + unsigned(1013904223);
 
       int ind = randq % nv;
@@ -523,6 +623,9 @@ BMESHcurvature_data::compute_feature_size()
       
    }
    
+   if (samples.empty())
+      return;
+   
    const double frac = 0.1f;
    const double mult = 0.01f;
    int which = int(frac * samples.size());
@@ -681,31 +784,3 @@ compute_ntb_coord_sys(const Wvec edges[3], Wvec &n, Wvec &t, Wvec &b)
    b = cross(n, t).normalized();
    
 }
-
-inline
-void
-compute_initial_vertex_coord_sys(const BMESHptr mesh,
-                                 vector<Wvec> &pdir1, vector<Wvec> &pdir2)
-{
-   
-   // Set up an initial coordinate system per vertex
-      
-   for(int i = 0; i < mesh->nfaces(); ++i){
-      
-      pdir1[mesh->bf(i)->v1()->index()] = mesh->bf(i)->v2()->loc()
-                                        - mesh->bf(i)->v1()->loc();
-      pdir1[mesh->bf(i)->v2()->index()] = mesh->bf(i)->v3()->loc()
-                                        - mesh->bf(i)->v2()->loc();
-      pdir1[mesh->bf(i)->v3()->index()] = mesh->bf(i)->v1()->loc()
-                                        - mesh->bf(i)->v3()->loc();
-      
-   }
-   
-   for(int i = 0; i < mesh->nverts(); i++){
-      
-      pdir1[i] = cross(pdir1[i], mesh->bv(i)->norm()).normalized();
-      pdir2[i] = cross(mesh->bv(i)->norm(), pdir1[i]);
-      
-   }
-   
-}
@@ -34,6 +34,7 @@
 using namespace mlib;
 
 class Bvert;
+class MeshSnapshot;
 MAKE_SHARED_PTR(BMESH);
 
 /*!
@@ -195,10 +196,37 @@ class BMESHcurvature_data {
       Wvec pdir1(const Bvert *v);
       Wvec pdir2(const Bvert *v);
       dcurv_tensor_t dcurv_tensor(const Bvert *v);
+      
+      //! \brief The same, by vertex index in the mesh's snapshot.  These
+      //! don't look up the vertex, so they are safe to call from several
+      //! threads at once.
+      const diag_curv_t &diag_curv(int v) const
+         { return diag_vertex_curv[v]; }
+      const dcurv_tensor_t &dcurv_tensor(int v) const
+         { return vertex_dcurv[v]; }
       double feature_size()
          { return mesh_feature_size; }
       
       //@}
+      
+      //! \name Updating
+      //! BMESH::changed() calls positions_changed() after vertices move,
+      //! and BMESH::curvature() calls update() before handing out the data.
+      //! update() finds the vertices that moved and recomputes only what
+      //! depends on them, i.e. their neighborhoods out to three rings (or
+      //! everything, if too much of the mesh moved). Results are the same
+      //! as computing from scratch, and the same for any number of threads.
+      //@{
+      
+      void positions_changed()
+         { positions_dirty = true; }
+      void update();
+      
+      //! \brief Number of vertices recomputed by the last computation.
+      int num_recomputed() const
+         { return last_num_recomputed; }
+      
+      //@}
    
    private:
    
@@ -212,17 +240,25 @@ class BMESHcurvature_data {
       std::vector<dcurv_tensor_t> face_dcurv;     //!< Per-face curvature derivative tensors.
       std::vector<dcurv_tensor_t> vertex_dcurv;   //!< Per-vertex curvature derivative tensors.
       double mesh_feature_size;                   //!< Feature size of the mesh.
+      std::vector<Wvec> face_t, face_b;           //!< Per-face tangent frames.
+      std::vector<int> vert_corner_off;           //!< Offsets into vert_corners, per vertex.
+      std::vector<int> vert_corners;              //!< Face corners (3*face + j) at each vertex, in face order.
+      std::vector<Wpt> vertex_locs;               //!< Vertex positions at the last computation.
+      bool positions_dirty;                       //!< Vertices may have moved since then.
+      int last_num_recomputed;
       
       //! \name Curvature Computation Functions
+      //! Each computes the values for one face or vertex, so a set of them
+      //! can be split across threads. Vertex values are summed over the
+      //! vertex's face corners in face order.
       //@{
       
-      void compute_corner_areas();
-      void compute_vertex_areas();
-      void compute_face_curvatures();
-      void compute_vertex_curvatures();
-      void diagonalize_vertex_curvatures();
-      void compute_face_dcurv();
-      void compute_vertex_dcurv();
+      void compute_all();
+      void compute_vertex_corners();
+      void compute_face_curvature(int f);
+      void compute_vertex_curvature(const MeshSnapshot &snap, int v);
+      void compute_face_dcurv(const MeshSnapshot &snap, int f);
+      void compute_vertex_dcurv(int v);
       void compute_feature_size();
       
       //@}
@@ -0,0 +1,651 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * bmesh_ply.cpp:
+ *
+ *    PLY files: BMESH::read_ply_data() and friends.
+ *
+ *    Reads ascii and binary (little- and big-endian) PLY straight
+ *    into a mesh. The header lists the elements and their
+ *    properties. Vertices come from the "vertex" element: x, y, z
+ *    and, if present, colors (r, g, b or red, green, blue; integer
+ *    channels are scaled from 0..255). Faces come from the
+ *    vertex_indices (or vertex_index) list of the "face" element.
+ *    Other elements and properties are skipped.
+ *
+ *    Binary vertices without list properties have a fixed size, so
+ *    each property is copied out with a loop over the element
+ *    stride in the file's type, on several threads. Faces have
+ *    lists, so they are walked in order.
+ *
+ *    As ply2sm always did, face vertex order is reversed, quads
+ *    become two triangles with a weak diagonal, and other polygons
+ *    are skipped with a warning.
+ **********************************************************************/
+#include "std/file.hpp"
+#include "std/parallel.hpp"
+#include "mesh/lmesh.hpp"
+
+#include <algorithm>
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+using namespace mlib;
+
+static_assert(sizeof(Wpt) == 3*sizeof(double), "Wpt is not 3 doubles");
+
+namespace {
+
+enum ply_type_t {
+   PLY_NONE = 0,
+   PLY_INT8,
+   PLY_UINT8,
+   PLY_INT16,
+   PLY_UINT16,
+   PLY_INT32,
+   PLY_UINT32,
+   PLY_FLOAT32,
+   PLY_FLOAT64
+};
+
+enum ply_format_t {
+   PLY_ASCII,
+   PLY_BINARY_LE,
+   PLY_BINARY_BE
+};
+
+// Type names, both the sized ones and the old ones:
+ply_type_t
+ply_type(const string& name)
+{
+   static const struct { const char* _name; ply_type_t _type; } names[] = {
+      { "int8",    PLY_INT8    }, { "char",   PLY_INT8    },
+      { "uint8",   PLY_UINT8   }, { "uchar",  PLY_UINT8   },
+      { "int16",   PLY_INT16   }, { "short",  PLY_INT16   },
+      { "uint16",  PLY_UINT16  }, { "ushort", PLY_UINT16  },
+      { "int32",   PLY_INT32   }, { "int",    PLY_INT32   },
+      { "uint32",  PLY_UINT32  }, { "uint",   PLY_UINT32  },
+      { "float32", PLY_FLOAT32 }, { "float",  PLY_FLOAT32 },
+      { "float64", PLY_FLOAT64 }, { "double", PLY_FLOAT64 }
+   };
+   for (auto& n : names)
+      if (name == n._name)
+         return n._type;
+   return PLY_NONE;
+}
+
+inline size_t
+ply_size(ply_type_t t)
+{
+   static const size_t sizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+   return sizes[t];
+}
+
+inline bool
+ply_is_int(ply_type_t t)
+{
+   return t != PLY_FLOAT32 && t != PLY_FLOAT64;
+}
+
+struct ply_prop_t {
+   string     _name;
+   ply_type_t _type;            // of the elements, for a list
+   ply_type_t _count_type;      // PLY_NONE unless a list
+};
+
+struct ply_elem_t {
+   string             _name;
+   uint64_t           _count;
+   vector<ply_prop_t> _props;
+
+   int find(const char* name) const {
+      for (size_t i = 0; i < _props.size(); i++)
+         if (_props[i]._name == name)
+            return i;
+      return -1;
+   }
+   // Binary size of each element, or 0 if it has lists:
+   size_t stride() const {
+      size_t ret = 0;
+      for (auto& p : _props) {
+         if (p._count_type != PLY_NONE)
+            return 0;
+         ret += ply_size(p._type);
+      }
+      return ret;
+   }
+   // Offset of a property in fixed-size elements:
+   size_t offset(int prop) const {
+      size_t ret = 0;
+      for (int i = 0; i < prop; i++)
+         ret += ply_size(_props[i]._type);
+      return ret;
+   }
+};
+
+inline bool
+big_endian_host()
+{
+   const uint16_t one = 1;
+   return *(const char*)&one == 0;
+}
+
+// The binary value of type T at p, with its bytes reversed if
+// the file has the other byte order:
+template <class T>
+inline T
+bin_val(const char* p, bool swap)
+{
+   char b[sizeof(T)];
+   memcpy(b, p, sizeof(T));
+   if (swap)
+      std::reverse(b, b + sizeof(T));
+   T ret;
+   memcpy(&ret, b, sizeof(T));
+   return ret;
+}
+
+double
+bin_val(const char* p, ply_type_t t, bool swap)
+{
+   switch (t) {
+    case PLY_INT8:    return bin_val<int8_t  >(p, swap);
+    case PLY_UINT8:   return bin_val<uint8_t >(p, swap);
+    case PLY_INT16:   return bin_val<int16_t >(p, swap);
+    case PLY_UINT16:  return bin_val<uint16_t>(p, swap);
+    case PLY_INT32:   return bin_val<int32_t >(p, swap);
+    case PLY_UINT32:  return bin_val<uint32_t>(p, swap);
+    case PLY_FLOAT32: return bin_val<float   >(p, swap);
+    case PLY_FLOAT64: return bin_val<double  >(p, swap);
+    case PLY_NONE:    break;
+   }
+   return 0;
+}
+
+// Copies n values of type T, 'stride' bytes apart in the file,
+// to every 'dst_stride'th double of dst:
+template <class T>
+void
+copy_strided(const char* src, size_t stride, int n, bool swap,
+             double* dst, size_t dst_stride)
+{
+   parallel_for(n, 1 << 14, [&](int begin, int end) {
+      for (int i = begin; i < end; i++)
+         dst[i*dst_stride] = bin_val<T>(src + i*stride, swap);
+   });
+}
+
+void
+copy_strided(ply_type_t t, const char* src, size_t stride, int n, bool swap,
+             double* dst, size_t dst_stride)
+{
+   switch (t) {
+    case PLY_INT8:    copy_strided<int8_t  >(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_UINT8:   copy_strided<uint8_t >(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_INT16:   copy_strided<int16_t >(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_UINT16:  copy_strided<uint16_t>(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_INT32:   copy_strided<int32_t >(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_UINT32:  copy_strided<uint32_t>(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_FLOAT32: copy_strided<float   >(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_FLOAT64: copy_strided<double  >(src, stride, n, swap, dst, dst_stride); break;
+    case PLY_NONE:    break;
+   }
+}
+
+/*****************************************************************
+ * PlyInput:
+ *
+ *   The data after the header, read one value at a time, in
+ *   either format. Reading past the end sets failed().
+ *****************************************************************/
+class PlyInput {
+ public:
+   PlyInput(const char* p, const char* end, ply_format_t format) :
+      _p(p), _end(end), _ascii(format == PLY_ASCII),
+      _swap(format != PLY_ASCII &&
+            (format == PLY_BINARY_BE) != big_endian_host()),
+      _fail(false) {
+      // ascii numbers use '.', whatever the locale:
+      _point = *localeconv()->decimal_point;
+   }
+
+   bool        failed()        const { return _fail; }
+   void        fail()                { _fail = true; }
+   bool        ascii()         const { return _ascii; }
+   bool        swap()          const { return _swap; }
+   const char* pos()           const { return _p; }
+   size_t      left()          const { return _end - _p; }
+   void        advance(size_t n)     { _p += n; }
+
+   double value(ply_type_t t) {
+      if (_ascii) {
+         // rounded to the type, as if it were binary:
+         double val = token(ply_is_int(t));
+         return (t == PLY_FLOAT32) ? (double)(float)val : val;
+      }
+      size_t n = ply_size(t);
+      if (_fail || left() < n) {
+         _fail = true;
+         return 0;
+      }
+      double ret = bin_val(_p, t, _swap);
+      _p += n;
+      return ret;
+   }
+
+   void skip(const ply_prop_t& p) {
+      if (p._count_type == PLY_NONE) {
+         skip(p._type, 1);
+         return;
+      }
+      double n = value(p._count_type);
+      if (n < 0)
+         _fail = true;
+      if (_fail)
+         return;
+      skip(p._type, (size_t)n);
+   }
+
+   void skip(const ply_elem_t& e) {
+      size_t stride = e.stride();
+      if (!_ascii && stride > 0) {
+         if (e._count > left()/stride)
+            _fail = true;
+         else
+            _p += e._count*stride;
+         return;
+      }
+      for (uint64_t i = 0; i < e._count && !_fail; i++)
+         for (auto& p : e._props)
+            skip(p);
+   }
+
+ protected:
+   const char*  _p;
+   const char*  _end;
+   bool         _ascii;
+   bool         _swap;
+   bool         _fail;
+   char         _point;
+
+   void skip(ply_type_t t, size_t n) {
+      if (!_ascii) {
+         if (n > left()/ply_size(t))
+            _fail = true;
+         else
+            _p += n*ply_size(t);
+         return;
+      }
+      for (size_t i = 0; i < n && !_fail; i++)
+         token(false);
+   }
+
+   // The next ascii number (the data isn't 0-terminated, so it's
+   // copied out before strtod/strtol see it):
+   double token(bool integer) {
+      while (_p < _end && isspace((unsigned char)*_p))
+         _p++;
+      char buf[64];
+      size_t n = 0;
+      for (; _p < _end && !isspace((unsigned char)*_p); _p++)
+         if (n < sizeof(buf) - 1)
+            buf[n++] = (*_p == '.') ? _point : *_p;
+      buf[n] = 0;
+      char* end = nullptr;
+      double ret = integer ? (double)strtol(buf, &end, 10) : strtod(buf, &end);
+      if (n == 0 || *end != 0)
+         _fail = true;
+      return ret;
+   }
+};
+
+// Reads the header; returns false (with a message) if it's bad,
+// else points 'data' at what follows it:
+bool
+read_ply_header(const char*& data, const char* end, ply_format_t& format,
+                vector<ply_elem_t>& elems)
+{
+   const char* p = data;
+   bool has_format = false;
+   for (int line = 0; ; line++) {
+      const char* eol = (const char*)memchr(p, '\n', end - p);
+      if (!eol) {
+         err_msg("BMESH::read_ply_data() - Error: Header has no end_header.");
+         return false;
+      }
+      istringstream in(string(p, eol));
+      p = eol + 1;
+      string key;
+      in >> key;
+      if (line == 0) {
+         if (key != "ply") {
+            err_msg("BMESH::read_ply_data() - Error: Not a PLY file.");
+            return false;
+         }
+      } else if (key == "format") {
+         string name;
+         in >> name;
+         if (name == "ascii")
+            format = PLY_ASCII;
+         else if (name == "binary_little_endian")
+            format = PLY_BINARY_LE;
+         else if (name == "binary_big_endian")
+            format = PLY_BINARY_BE;
+         else {
+            err_msg("BMESH::read_ply_data() - Error: Unknown format '%s'.",
+                    name.c_str());
+            return false;
+         }
+         has_format = true;
+      } else if (key == "element") {
+         ply_elem_t e;
+         in >> e._name >> e._count;
+         if (!in) {
+            err_msg("BMESH::read_ply_data() - Error: Bad element line %d.", line + 1);
+            return false;
+         }
+         elems.push_back(e);
+      } else if (key == "property") {
+         string type;
+         ply_prop_t prop;
+         prop._count_type = PLY_NONE;
+         in >> type;
+         if (type == "list") {
+            in >> type;
+            prop._count_type = ply_type(type);
+            in >> type;
+         }
+         prop._type = ply_type(type);
+         in >> prop._name;
+         if (!in || elems.empty() || prop._type == PLY_NONE ||
+             (prop._count_type == PLY_NONE && type == "list")) {
+            err_msg("BMESH::read_ply_data() - Error: Bad property line %d.", line + 1);
+            return false;
+         }
+         elems.back()._props.push_back(prop);
+      } else if (key == "end_header") {
+         break;
+      } else if (key != "comment" && key != "obj_info" && !key.empty()) {
+         err_msg("BMESH::read_ply_data() - Error: Unknown header line '%s'.",
+                 key.c_str());
+         return false;
+      }
+   }
+   if (!has_format) {
+      err_msg("BMESH::read_ply_data() - Error: Header has no format.");
+      return false;
+   }
+   data = p;
+   return true;
+}
+
+// Vertex positions and colors (1, 1, 1 where missing):
+bool
+read_ply_verts(PlyInput& in, const ply_elem_t& e, Wpt_list& pts,
+               vector<double>& rgb, bool& has_color)
+{
+   static const char* pos_names[3]   = { "x", "y", "z" };
+   static const char* color_names[6] = { "r", "g", "b", "red", "green", "blue" };
+
+   int n = (int)e._count;
+   int pos[3], color[3];
+   for (int c = 0; c < 3; c++) {
+      pos[c] = e.find(pos_names[c]);
+      color[c] = e.find(color_names[c]);
+      if (color[c] < 0)
+         color[c] = e.find(color_names[c + 3]);
+      if (color[c] >= 0)
+         has_color = true;
+   }
+   if (pos[0] < 0 || pos[1] < 0 || pos[2] < 0) {
+      err_msg("BMESH::read_ply_data() - Error: Vertices have no x, y, z.");
+      return false;
+   }
+   pts.resize(n);
+   double* dst = n ? (double*)&pts[0] : nullptr;
+   if (has_color)
+      rgb.assign(3*size_t(n), 1.0);
+
+   size_t stride = e.stride();
+   if (!in.ascii() && stride > 0) {
+      // Fixed size: each property is a strided array of its type
+      if (e._count > in.left()/stride) {
+         in.fail();
+         return false;
+      }
+      for (int c = 0; c < 3; c++) {
+         const ply_prop_t& p = e._props[pos[c]];
+         copy_strided(p._type, in.pos() + e.offset(pos[c]), stride, n,
+                      in.swap(), dst + c, 3);
+         if (color[c] >= 0) {
+            const ply_prop_t& q = e._props[color[c]];
+            copy_strided(q._type, in.pos() + e.offset(color[c]), stride, n,
+                         in.swap(), &rgb[c], 3);
+         }
+      }
+      in.advance(n*stride);
+   } else {
+      for (int i = 0; i < n && !in.failed(); i++) {
+         for (int k = 0; k < (int)e._props.size(); k++) {
+            const ply_prop_t& p = e._props[k];
+            if (p._count_type != PLY_NONE) {
+               in.skip(p);
+               continue;
+            }
+            double val = in.value(p._type);
+            for (int c = 0; c < 3; c++) {
+               if (k == pos[c])
+                  dst[3*i + c] = val;
+               if (k == color[c])
+                  rgb[3*i + c] = val;
+            }
+         }
+      }
+      if (in.failed())
+         return false;
+   }
+   for (int c = 0; c < 3; c++)
+      if (color[c] >= 0 && ply_is_int(e._props[color[c]]._type))
+         for (int i = 0; i < n; i++)
+            rgb[3*i + c] /= 255;
+   return true;
+}
+
+// Triangles (and weak edges, for quads) from the face lists:
+bool
+read_ply_faces(PlyInput& in, const ply_elem_t& e, int nverts,
+               vector<Point3i>& tris, vector<Point2i>& weak)
+{
+   int list = e.find("vertex_indices");
+   if (list < 0)
+      list = e.find("vertex_index");
+   if (list < 0 || e._props[list]._count_type == PLY_NONE) {
+      err_msg("BMESH::read_ply_data() - Error: Faces have no vertex list.");
+      return false;
+   }
+   tris.reserve(e._count);
+   int other = 0, bad = 0;
+   int v[4];
+   for (uint64_t i = 0; i < e._count && !in.failed(); i++) {
+      for (int k = 0; k < (int)e._props.size(); k++) {
+         const ply_prop_t& p = e._props[k];
+         if (k != list) {
+            in.skip(p);
+            continue;
+         }
+         double num = in.value(p._count_type);
+         if (num != 3 && num != 4) {
+            // XXX - should convert these to triangles
+            if (num < 0)
+               in.fail();
+            for (int j = 0; j < num && !in.failed(); j++)
+               in.value(p._type);
+            other++;
+            continue;
+         }
+         for (int j = 0; j < num; j++) {
+            double val = in.value(p._type);
+            if (val < 0 || val >= nverts) {
+               val = 0;
+               bad++;
+            }
+            v[j] = (int)val;
+         }
+         if (num == 3) {
+            tris.push_back(Point3i(v[2], v[1], v[0]));
+         } else {
+            tris.push_back(Point3i(v[3], v[2], v[1]));
+            tris.push_back(Point3i(v[3], v[1], v[0]));
+            weak.push_back(Point2i(v[3], v[1]));
+         }
+      }
+   }
+   if (in.failed())
+      return false;
+   if (bad) {
+      err_msg("BMESH::read_ply_data() - Error: %d bad vertex indices.", bad);
+      return false;
+   }
+   if (other)
+      err_msg("BMESH::read_ply_data() - Warning: Skipped %d faces that aren't "
+              "triangles or quads.", other);
+   return true;
+}
+
+} // namespace
+
+bool
+BMESH::is_ply_data(const char* data, size_t size)
+{
+   return data && size >= 4 && memcmp(data, "ply", 3) == 0 &&
+      (data[3] == '\n' || data[3] == '\r');
+}
+
+bool
+BMESH::is_ply_file(const char* filename)
+{
+   if (!filename)
+      return false;
+   ifstream in(filename, ios::in | ios::binary);
+   char magic[4];
+   return (in.read(magic, sizeof(magic)) &&
+           is_ply_data(magic, sizeof(magic)));
+}
+
+BMESHptr
+BMESH::read_ply_file(const char* filename, BMESHptr ret)
+{
+   if (!filename) {
+      err_msg("BMESH::read_ply_file() - Filename is NULL");
+      return nullptr;
+   }
+   MappedFile file;
+   if (!file.open(filename)) {
+      err_mesg(ERR_LEV_WARN,
+               "BMESH::read_ply_file() - Could not open file '%s'", filename);
+      return nullptr;
+   }
+   return read_ply_data(file.data(), file.size(), ret);
+}
+
+BMESHptr
+BMESH::read_ply_stream(istream& in, BMESHptr ret)
+{
+   // Streams can't be mapped; read it all, then load from memory:
+   vector<char> data;
+   const size_t chunk = 1 << 20;
+   while (in) {
+      size_t n = data.size();
+      data.resize(n + chunk);
+      in.read(&data[n], chunk);
+      data.resize(n + in.gcount());
+   }
+   return read_ply_data(data.empty() ? nullptr : &data[0], data.size(), ret);
+}
+
+BMESHptr
+BMESH::read_ply_data(const char* data, size_t size, BMESHptr ret)
+{
+   if (!is_ply_data(data, size)) {
+      err_msg("BMESH::read_ply_data() - Error: Not a PLY file.");
+      return nullptr;
+   }
+   const char* end = data + size;
+   ply_format_t format = PLY_ASCII;
+   vector<ply_elem_t> elems;
+   if (!read_ply_header(data, end, format, elems))
+      return nullptr;
+
+   // Read the elements in order, keeping vertices and faces:
+
+   PlyInput in(data, end, format);
+   Wpt_list pts;
+   vector<double> rgb;
+   bool has_color = false, has_verts = false;
+   vector<Point3i> tris;
+   vector<Point2i> weak;
+   for (auto& e : elems) {
+      if (e._count > (uint64_t)numeric_limits<int>::max()) {
+         err_msg("BMESH::read_ply_data() - Error: Too many %s elements.",
+                 e._name.c_str());
+         return nullptr;
+      }
+      bool ok = true;
+      if (e._name == "vertex" && !has_verts) {
+         ok = read_ply_verts(in, e, pts, rgb, has_color);
+         has_verts = true;
+      } else if (e._name == "face" && tris.empty()) {
+         ok = read_ply_faces(in, e, pts.size(), tris, weak);
+      } else {
+         in.skip(e);
+      }
+      if (in.failed())
+         err_msg("BMESH::read_ply_data() - Error: Truncated or bad %s data.",
+                 e._name.c_str());
+      if (!ok || in.failed())
+         return nullptr;
+   }
+
+   // Build the mesh (an LMESH by default, as for old .sm files):
+
+   if (!ret)
+      ret = make_shared<LMESH>();
+   BMESH& mesh = *ret;
+   mesh.delete_elements();
+   mesh.build(pts, tris);
+   for (auto& w : weak)
+      mesh.set_weak_edge(w[0], w[1]);
+   mesh.changed(TOPOLOGY_CHANGED);
+   if (has_color) {
+      for (int i = 0; i < mesh.nverts(); i++)
+         mesh.bv(i)->set_color(COLOR(rgb[3*i], rgb[3*i + 1], rgb[3*i + 2]));
+      mesh.changed(VERT_COLORS_CHANGED);
+   }
+
+   // As BMESH::decode() does:
+   mesh.make_patch_if_needed();
+   if (mesh.is_points() && Config::get_var_bool("BMESH_BUILD_VERT_STRIPS",false))
+      mesh.build_vert_strips();
+
+   return ret;
+}
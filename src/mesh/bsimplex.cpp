@@ -18,8 +18,6 @@
 #include "mesh/bsimplex.hpp"
 #include "mesh/simplex_array.hpp"
 
-Bsimplex::IDtable Bsimplex::_table(1<<14);
-
 Bsimplex::~Bsimplex()
 {
    if (_data_list) {
@@ -27,6 +25,10 @@ Bsimplex::~Bsimplex()
       delete _data_list;
       _data_list = nullptr;
    }
+   if (_key) {
+      table().remove(_key);
+      _key = 0;
+   }
 }
 
 uintptr_t
@@ -35,17 +37,62 @@ Bsimplex::generate_key()
    // called once to generate the "key" for this simplex 
    // (first time _key is accessed)
 
-   // XXX - change back to 1<<24 after verifying highest bit is no
-   // longer being used in some hacky code somewhere like it was at
-   // one point
-   if (_table.size() >= ((1<<23) - 1)) {
-      // can't allocate > 8 million IDs
-      err_msg("Bsimplex::generate_key: error: key table is full");
+   _key = table().add(this);
+   return _key;
+}
+
+/*****************************************************************
+ * Bsimplex::IDtable
+ *****************************************************************/
+Bsimplex::IDtable::IDtable(int max) : _num_retired(0)
+{
+   _slots.reserve(max);
+   _gen.reserve(max);
+   _slots.push_back(nullptr);
+   _gen.push_back(0);
+}
+
+uintptr_t
+Bsimplex::IDtable::add(Bsimplex* s)
+{
+   assert(s);
+
+   // Recycle the oldest free slot once enough have accumulated
+   // (or when there is no room left to grow):
+   uint i = 0;
+   if (_free.size() >= MIN_FREE ||
+       (!_free.empty() && _slots.size() > INDEX_MASK)) {
+      i = _free.front();
+      _free.pop_front();
+   } else if (_slots.size() <= INDEX_MASK) {
+      i = _slots.size();
+      _slots.push_back(nullptr);
+      _gen.push_back(0);
    } else {
-      _key = _table.size();
-      _table.push_back(this);
+      // can't allocate > 16 million live IDs
+      err_msg("Bsimplex::IDtable::add: error: key table is full");
+      return 0;
    }
-   return _key;
+   _slots[i] = s;
+   return (uintptr_t(_gen[i]) << INDEX_BITS) | i;
+}
+
+void
+Bsimplex::IDtable::remove(uintptr_t k)
+{
+   uint i = uint(k & INDEX_MASK);
+   assert(i > 0 && i < _slots.size() && _slots[i] && _slots[i]->_key == k);
+
+   // Bump the generation so old copies of k no longer match.
+   // Once every generation has been used, wrapping around would
+   // let an old key match again, so the slot is retired instead:
+   _slots[i] = nullptr;
+   if (_gen[i] == GEN_MASK) {
+      _num_retired++;
+      return;
+   }
+   _gen[i]++;
+   _free.push_back(i);
 }
 
 void 
@@ -57,7 +104,7 @@ Bsimplex::notify_split(Bsimplex *new_simp)
    // (i.e. this one) about the new simplex. that way the data or its
    // owner can decide to put some relevant data onto the new simplex
    // if that's appropriate.
-   if (_data_list)
+   if (has_data())
       _data_list->notify_split(new_simp);
 }
 
@@ -65,7 +112,7 @@ void
 Bsimplex::notify_xform(CWtransf& xf)
 {
    // a transform was applied to the vertices ... pass it on.
-   if (_data_list)
+   if (has_data())
       _data_list->notify_simplex_xformed(xf);
 }
 
@@ -80,7 +127,7 @@ Bsimplex::geometry_changed()
    //      Its shape changed. I.e. one of its vertices moved.
 
    // Notify associated data in case any of them care:
-   if (_data_list)
+   if (has_data())
       _data_list->notify_simplex_changed();
 }
 
@@ -95,7 +142,7 @@ Bsimplex::normal_changed()
    //      An adjacent face changed shape, or was added or removed.
 
    // Notify associated data in case any of them care:
-   if (_data_list)
+   if (has_data())
       _data_list->notify_normal_changed();
 }
 
@@ -122,7 +169,7 @@ Bsimplex::add_simplex_data(SimplexData* sd)
    if (!_data_list) _data_list = new SimplexDataList(); assert(_data_list);
 
    // Now go ahead:
-   _data_list->push_back(sd);
+   _data_list->add(sd);
 }
 
 Bsimplex* 
@@ -20,6 +20,7 @@
 
 #include "simplex_data.hpp"
 
+#include <deque>
 #include <vector>
 
 class Bsimplex;
@@ -73,22 +74,35 @@ class Bsimplex {
       NEXT_AVAILABLE_BIT        // next available bit for derived classes
    };
 
+   // Number of traversal mark slots (see traversal_marks.hpp):
+   enum { NUM_MARK_SLOTS = 2 };
+
    //******** MANAGERS ********
 
-   Bsimplex() : _key(0), _flag(0), _mesh(), _data_list(nullptr) {}
+   Bsimplex() : _key(0), _flag(0), _marks(), _mesh(), _data_list(nullptr) {}
    virtual ~Bsimplex();
 
    //******** ACCESSORS ********
 
-   void     set_mesh(BMESHptr mesh)       { _mesh = mesh; }
+   void     set_mesh(CBMESHptr& mesh)     { _mesh = mesh; }
    BMESHptr mesh()                const   { return _mesh.lock(); }
 
    //******** KEY/LOOKUP ********
 
+   // The key is assigned on first access and released when the
+   // simplex is destroyed. Its low 24 bits index the key table and
+   // the next 7 bits hold the generation of that slot, so a key
+   // held past the death of its simplex looks up null rather than
+   // whatever simplex later recycles the slot. The top bit is never
+   // set (ID images use it for non-simplex ids).
    uintptr_t key() const { return _key ? _key : ((Bsimplex*)this)->generate_key();}
-   static Bsimplex* lookup(uintptr_t k) {
-      return (k<_table.size()) ? _table[k] : nullptr;
-   }
+   static Bsimplex* lookup(uintptr_t k) { return table().lookup(k); }
+
+   // diagnostic: number of live keys, retired slots, and slots in
+   // the key table:
+   static size_t num_keys()       { return table().num_keys(); }
+   static size_t num_retired()    { return table().num_retired(); }
+   static size_t key_table_size() { return table().size(); }
 
    //******** DIMENSION ********
    //   vertex: 0
@@ -137,14 +151,24 @@ class Bsimplex {
 
    SimplexData* find_data(const string& s) const { return find_data((uintptr_t)s.c_str());}
    SimplexData* find_data(void *key)   const { return find_data((uintptr_t)key);}
+
+   // Lookup given the slot registered for the key (see
+   // SimplexData::register_slot()); takes no search:
+   SimplexData* find_data(uintptr_t key, int slot) const {
+      return _data_list ? _data_list->get_item(key, slot) : nullptr;
+   }
+
+   // Is there any data on this simplex?
+   bool has_data() const { return _data_list && !_data_list->empty(); }
    
    void add_simplex_data(SimplexData* sd);
    void rem_simplex_data(SimplexData* sd) {
-      if (_data_list) {
-         SimplexDataList::iterator it;
-         it = std::find(_data_list->begin(), _data_list->end(), sd);
-         _data_list->erase(it);
-      }
+      if (_data_list)
+         _data_list->remove(sd);
+   }
+   void rekey_simplex_data(SimplexData* sd, uintptr_t id) {
+      assert(_data_list);
+      _data_list->rekey(sd, id);
    }
 
    // For debugging only
@@ -263,9 +287,12 @@ class Bsimplex {
  protected:
    uintptr_t         _key;       // unique id for looking up this simplex
    uint              _flag;      // for graph searching and boolean states
+   mutable uint      _marks[NUM_MARK_SLOTS]; // stamps set by TraversalMarks
    weak_ptr<BMESH>   _mesh;      // mesh containing this simplex
    SimplexDataList*  _data_list; // optional simplex data list
 
+   friend class TraversalMarks;
+
    //******** INTERNAL METHODS ********
 
    // called once (first time _key is accessed):
@@ -273,13 +300,56 @@ class Bsimplex {
 
    // Table for looking up a Bsimplex from its "key" value. First slot
    // contains a null item, so index of 0 always looks up a null item.
+   // Slots freed by dead simplices go on a FIFO queue and are reused
+   // once enough of them have piled up, so the table stays dense
+   // while a recycled slot is rarely reused soon after it is freed.
+   // Each reuse bumps the slot's generation, which is part of the
+   // key; a slot whose generation has run out is retired rather
+   // than wrapped, so a stale key can never match a newer simplex.
  public:
-   class IDtable : public vector<Bsimplex*> {
+   class IDtable {
     public:
-      IDtable(int max) : vector<Bsimplex*>() { reserve(max); this->push_back(nullptr); }
+      enum {
+         INDEX_BITS = 24,
+         GEN_BITS   = 7,
+         INDEX_MASK = (1 << INDEX_BITS) - 1,
+         GEN_MASK   = (1 << GEN_BITS) - 1,
+         MIN_FREE   = 1 << 10   // free slots held back before reuse
+      };
+
+      IDtable(int max);
+
+      // assign a key to s; returns 0 if the table is full:
+      uintptr_t add(Bsimplex* s);
+
+      // free the slot for key k (called when the simplex dies):
+      void remove(uintptr_t k);
+
+      Bsimplex* lookup(uintptr_t k) const {
+         uintptr_t i = (k & INDEX_MASK);
+         Bsimplex* s = (i < _slots.size()) ? _slots[i] : nullptr;
+         return (s && s->_key == k) ? s : nullptr;
+      }
+
+      size_t size()     const { return _slots.size(); }
+      size_t num_keys() const {
+         return _slots.size() - 1 - _free.size() - _num_retired;
+      }
+      size_t num_retired() const { return _num_retired; }
+
+    protected:
+      vector<Bsimplex*>     _slots; // simplex for each index, or null
+      vector<unsigned char> _gen;   // current generation of each slot
+      deque<uint>           _free;  // freed slots, oldest first
+      size_t                _num_retired; // slots out of generations
    };
  protected:
-   static IDtable       _table;
+   // Never destroyed, so simplices that outlive static
+   // destruction can still release their keys:
+   static IDtable& table() {
+      static IDtable* t = new IDtable(1<<14);
+      return *t;
+   }
 
    enum { FLAG_MASK = ((1 << FLAG_BITS) - 1) };
 
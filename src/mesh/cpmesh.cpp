@@ -21,17 +21,27 @@
 int 
 main(int argc, char *argv[])
 {
-   if (argc != 1) {
-      err_msg("Usage: %s < input.sm > output.sm", argv[0]);
+   // Input is .sm text or the binary format (told apart by the
+   // first bytes); -b writes the binary format, else text:
+   const char* prog = argv[0];
+   bool binary = (argc > 1 && string(argv[1]) == "-b");
+   if (binary) {
+      argc--;
+      argv++;
+   }
+   if (argc > 3) {
+      err_msg("Usage: %s [ -b ] [ input [ output ] ]", prog);
+      err_msg("   (default: %s [ -b ] < input.sm > output.sm)", prog);
       return 1;
    }
 
-   BMESHptr mesh = BMESH::read_jot_stream(cin);
+   BMESHptr mesh = (argc > 1) ? BMESH::read_jot_file(argv[1]) :
+      BMESH::read_jot_stream(cin);
    if (!mesh || mesh->empty())
       return 1; // didn't work
 
-   // Remove duplicate vertices
-   mesh->remove_duplicate_vertices(false); // don't keep the bastards
+   // Weld duplicate vertices, or ones within JOT_WELD_TOL if set
+   mesh->weld_vertices(Config::get_var_dbl("JOT_WELD_TOL", 0, true));
 
    bool is_bad = false;
    for (int i=0; i<mesh->nedges(); i++)
@@ -49,6 +59,11 @@ main(int argc, char *argv[])
    if (Config::get_var_bool("JOT_PRINT_MESH"))
       mesh->print();
 
+   if (argc > 2)
+      return (binary ? mesh->write_binary_file(argv[2]) :
+              mesh->write_file(argv[2])) ? 0 : 1;
+   if (binary)
+      return mesh->write_binary_stream(cout) ? 0 : 1;
    mesh->write_stream(cout);
 
    return 0;
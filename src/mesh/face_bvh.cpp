@@ -0,0 +1,267 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "std/parallel.hpp"
+#include "mesh/mesh_snapshot.hpp"
+#include "mesh/face_bvh.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace mlib;
+
+// faces per leaf:
+static const int LEAF_SIZE = 4;
+
+// the tree is balanced, so this is deeper than any tree can be:
+static const int MAX_DEPTH = 64;
+
+FaceBVH::FaceBVH(const MeshSnapshot& snap) :
+   _pad(0)
+{
+   int nf = snap.nfaces();
+   if (nf == 0)
+      return;
+
+   vector<Wpt> centers(nf);
+   _faces.resize(nf);
+   for (int f=0; f<nf; f++) {
+      const int* fv = snap.face_verts(f);
+      centers[f] = (snap.loc(fv[0]) + snap.loc(fv[1]) + snap.loc(fv[2]))/3;
+      _faces[f] = f;
+   }
+   _nodes.reserve(2*(nf/LEAF_SIZE + 1));
+   build(snap, centers, 0, nf);
+   refit(snap);
+}
+
+int
+FaceBVH::build(const MeshSnapshot& snap, vector<Wpt>& centers, int begin, int end)
+{
+   // Make a node for faces begin..end-1 of _faces, and the nodes
+   // below it. Returns its index. Boxes are filled in by refit().
+
+   int n = (int)_nodes.size();
+   _nodes.push_back(Node());
+
+   if (end - begin <= LEAF_SIZE) {
+      _nodes[n]._first = begin;
+      _nodes[n]._count = end - begin;
+      return n;
+   }
+
+   // split at the median center along the axis where the
+   // centers are most spread out:
+   Wpt lo = centers[_faces[begin]], hi = lo;
+   for (int i=begin+1; i<end; i++) {
+      CWpt& c = centers[_faces[i]];
+      for (int k=0; k<3; k++) {
+         lo[k] = min(lo[k], c[k]);
+         hi[k] = max(hi[k], c[k]);
+      }
+   }
+   Wvec ext = hi - lo;
+   int axis = (ext[0] > ext[1]) ? (ext[0] > ext[2] ? 0 : 2) :
+                                  (ext[1] > ext[2] ? 1 : 2);
+   int mid = (begin + end)/2;
+   nth_element(_faces.begin() + begin, _faces.begin() + mid,
+               _faces.begin() + end,
+               [&](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+   build(snap, centers, begin, mid);
+   int right = build(snap, centers, mid, end);
+   _nodes[n]._first = right;
+   _nodes[n]._count = 0;
+   return n;
+}
+
+void
+FaceBVH::fit_leaf(const MeshSnapshot& snap, Node& node) const
+{
+   for (int k=0; k<3; k++) {
+      node._lo[k] =  numeric_limits<double>::max();
+      node._hi[k] = -numeric_limits<double>::max();
+   }
+   for (int i=node._first; i<node._first + node._count; i++) {
+      const int* fv = snap.face_verts(_faces[i]);
+      for (int j=0; j<3; j++) {
+         Wpt p = snap.loc(fv[j]);
+         for (int k=0; k<3; k++) {
+            node._lo[k] = min(node._lo[k], p[k]);
+            node._hi[k] = max(node._hi[k], p[k]);
+         }
+      }
+   }
+}
+
+void
+FaceBVH::refit(const MeshSnapshot& snap)
+{
+   // Children come after their parents, so go in reverse:
+   for (int i=nnodes()-1; i>=0; i--) {
+      Node& node = _nodes[i];
+      if (node._count > 0) {
+         fit_leaf(snap, node);
+      } else {
+         const Node& a = _nodes[i + 1];
+         const Node& b = _nodes[node._first];
+         for (int k=0; k<3; k++) {
+            node._lo[k] = min(a._lo[k], b._lo[k]);
+            node._hi[k] = max(a._hi[k], b._hi[k]);
+         }
+      }
+   }
+   if (_nodes.empty())
+      return;
+   const Node& root = _nodes[0];
+   _pad = 1e-9 * Wvec(root._hi[0] - root._lo[0],
+                      root._hi[1] - root._lo[1],
+                      root._hi[2] - root._lo[2]).length();
+}
+
+bool
+FaceBVH::hit_box(const Node& node, CWpt& p, CWvec& d, double& t) const
+{
+   // Does the line p + d*t cross the box? If so, t is returned
+   // as the smallest |t| inside the box:
+   double tmin = -numeric_limits<double>::max();
+   double tmax =  numeric_limits<double>::max();
+   for (int k=0; k<3; k++) {
+      double lo = node._lo[k] - _pad, hi = node._hi[k] + _pad;
+      if (d[k] == 0) {
+         if (p[k] < lo || p[k] > hi)
+            return false;
+         continue;
+      }
+      double t1 = (lo - p[k])/d[k], t2 = (hi - p[k])/d[k];
+      if (t1 > t2)
+         swap(t1, t2);
+      tmin = max(tmin, t1);
+      tmax = min(tmax, t2);
+      if (tmin > tmax)
+         return false;
+   }
+   t = (tmin <= 0 && tmax >= 0) ? 0 : min(fabs(tmin), fabs(tmax));
+   return true;
+}
+
+bool
+FaceBVH::hit_face(
+   const MeshSnapshot& snap,
+   int    f,
+   CWpt&  p,
+   CWvec& r,
+   Wpt&   hit,
+   double& depth)
+{
+   // Same as Bface::ray_intersect(), on snapshot data:
+   const int* fv = snap.face_verts(f);
+   Wpt  a = snap.loc(fv[0]), b = snap.loc(fv[1]), c = snap.loc(fv[2]);
+   Wvec n = snap.norm(f);
+
+   double dot = r * n;
+   if (fabs(dot) < 1e-16)
+      return false;
+
+   double t = ((a - p) * n) / dot;
+   Wpt d = p + (r * t);
+
+   Wvec da = d-a;
+   Wvec ba = b-a;
+   Wvec db = d-b;
+   if ((cross(da,ba) * cross(da,c-a) <= 0) &&
+       (cross(db,ba) * cross(db,c-b) > 0)) {
+      hit = d;
+      depth = (hit - p).length();
+      return true;
+   }
+   return false;
+}
+
+int
+FaceBVH::intersect(
+   const MeshSnapshot& snap,
+   CWpt&   p,
+   CWvec&  d,
+   Wpt&    hit,
+   double& depth) const
+{
+   double len = d.length();
+   double t;
+   if (_nodes.empty() || len == 0 || !hit_box(_nodes[0], p, d, t))
+      return -1;
+
+   // depth-first, nearer child first; boxes farther than the
+   // best hit so far are skipped:
+   struct entry_t { int _node; double _t; };
+   entry_t stack[MAX_DEPTH + 1];
+   int top = 0;
+   stack[top++] = { 0, t };
+
+   int    ret  = -1;
+   double best = 0;
+   Wpt    h;
+   double dep;
+   while (top > 0) {
+      const entry_t cur = stack[--top];
+      if (ret >= 0 && cur._t*len > best)
+         continue;
+      const Node& node = _nodes[cur._node];
+      if (node._count > 0) {
+         for (int i=node._first; i<node._first + node._count; i++) {
+            if (hit_face(snap, _faces[i], p, d, h, dep) && (ret < 0 || dep < best)) {
+               ret   = _faces[i];
+               best  = dep;
+               hit   = h;
+               depth = dep;
+            }
+         }
+         continue;
+      }
+      int a = cur._node + 1, b = node._first;
+      double ta, tb;
+      bool ha = hit_box(_nodes[a], p, d, ta);
+      bool hb = hit_box(_nodes[b], p, d, tb);
+      if (ha && hb && ta > tb) {
+         swap(a, b);
+         swap(ta, tb);
+      }
+      // push the farther one first so the nearer is popped first:
+      if (hb) stack[top++] = { b, tb };
+      if (ha) stack[top++] = { a, ta };
+      assert(top <= MAX_DEPTH);
+   }
+   return ret;
+}
+
+void
+FaceBVH::intersect(
+   const MeshSnapshot& snap,
+   const vector<Wline>& rays,
+   vector<int>& faces,
+   vector<Wpt>& hits) const
+{
+   int n = (int)rays.size();
+   faces.resize(n);
+   hits.resize(n);
+   parallel_for(n, 64, [&](int begin, int end) {
+      double depth;
+      for (int i=begin; i<end; i++)
+         faces[i] = intersect(snap, rays[i].point(), rays[i].direction(),
+                              hits[i], depth);
+   });
+}
@@ -0,0 +1,105 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef FACE_BVH_H_IS_INCLUDED
+#define FACE_BVH_H_IS_INCLUDED
+
+#include "mlib/points.hpp"
+
+#include <vector>
+
+class MeshSnapshot;
+
+/*****************************************************************
+ * FaceBVH:
+ *
+ *      Bounding volume hierarchy over the faces of a mesh, for
+ *      ray picking. Built from a MeshSnapshot, and refers to
+ *      faces and vertices by their snapshot indices.
+ *
+ *      Boxes are axis-aligned and split at the median face
+ *      centroid along the longest axis. When vertices move, the
+ *      tree is refit (boxes recomputed bottom up, same shape);
+ *      when the topology changes it must be rebuilt.
+ *
+ *      Rays are tested against faces with the same arithmetic
+ *      as Bface::ray_intersect(), including hits "behind" the
+ *      ray origin, so results match a brute force search. The
+ *      tree and snapshot are only read during a query, so
+ *      intersect() may be called from several threads at once.
+ *
+ *      Get one from BMESH::face_bvh().
+ *****************************************************************/
+class FaceBVH {
+ public:
+
+   //******** MANAGERS ********
+
+   FaceBVH(const MeshSnapshot& snap);
+
+   //******** ACCESSORS ********
+
+   int nfaces() const { return (int)_faces.size(); }
+   int nnodes() const { return (int)_nodes.size(); }
+
+   //******** UPDATING ********
+
+   // Recompute the boxes after vertex positions changed:
+   void refit(const MeshSnapshot& snap);
+
+   //******** INTERSECTION ********
+
+   // Nearest face hit by the line through p with direction d,
+   // or -1 if none. Returns the hit point, and its distance from
+   // p, as in Bface::ray_intersect():
+   int intersect(const MeshSnapshot& snap, mlib::CWpt& p, mlib::CWvec& d,
+                 mlib::Wpt& hit, double& depth) const;
+
+   // Same for a batch of rays, split across threads. Fills in a
+   // face index (or -1) and hit point per ray:
+   void intersect(const MeshSnapshot& snap,
+                  const std::vector<mlib::Wline>& rays,
+                  std::vector<int>& faces,
+                  std::vector<mlib::Wpt>& hits) const;
+
+ protected:
+   // A node is a leaf iff _count > 0: its faces are _faces[_first]
+   // through _faces[_first + _count - 1]. Otherwise its children
+   // are the next node and node _first:
+   struct Node {
+      double _lo[3], _hi[3];
+      int    _first;
+      int    _count;
+   };
+
+   std::vector<Node> _nodes;
+   std::vector<int>  _faces;    // face indices, grouped by leaf
+   double            _pad;      // added to boxes to absorb round-off
+
+   //******** INTERNAL METHODS ********
+
+   int  build(const MeshSnapshot& snap, std::vector<mlib::Wpt>& centers,
+              int begin, int end);
+   void fit_leaf(const MeshSnapshot& snap, Node& node) const;
+   bool hit_box(const Node& node, mlib::CWpt& p, mlib::CWvec& d,
+                double& t) const;
+   static bool hit_face(const MeshSnapshot& snap, int f,
+                        mlib::CWpt& p, mlib::CWvec& d,
+                        mlib::Wpt& hit, double& depth);
+};
+
+#endif // FACE_BVH_H_IS_INCLUDED
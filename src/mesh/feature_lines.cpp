@@ -0,0 +1,429 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "std/parallel.hpp"
+#include "mesh/mesh_snapshot.hpp"
+#include "mesh/zcross_extractor.hpp"
+#include "mesh/feature_lines.hpp"
+
+using namespace mlib;
+
+typedef BMESHcurvature_data::diag_curv_t    diag_curv_t;
+typedef BMESHcurvature_data::dcurv_tensor_t dcurv_tensor_t;
+
+// vertices or faces per thread:
+static const int LINES_GRAIN = 2048;
+
+/*****************************************************************
+ * FaceField:
+ *
+ *   ZCrossExtractor scalar field that hands out the per-face
+ *   values worked out by FeatureLines::test_faces(). Values at
+ *   a vertex can differ from face to face, so the vertex form
+ *   is not used.
+ *****************************************************************/
+class FaceField : public ZCrossScalarFieldInterface {
+ public:
+   FaceField(const MeshSnapshot* snap = nullptr,
+             const vector<double>* vals = nullptr,
+             const vector<unsigned char>* ok = nullptr) :
+      _snap(snap), _vals(vals), _ok(ok) {}
+
+   virtual double operator()(const Bvert*) { return 0; }
+   virtual bool operator()(const Bface* f, double vals[3]) {
+      int i = _snap->index(f);
+      if (i < 0 || !(*_ok)[i])
+         return false;
+      for (int j=0; j<3; j++)
+         vals[j] = (*_vals)[3*i + j];
+      return true;
+   }
+
+ protected:
+   const MeshSnapshot*          _snap;
+   const vector<double>*        _vals;
+   const vector<unsigned char>* _ok;
+};
+
+/*****************************************************************
+ * FullConfidence:
+ *
+ *   Faces that fail their test hold no lines at all, so every
+ *   point that is extracted is kept.
+ *****************************************************************/
+class FullConfidence : public ZCrossConfidenceInterface {
+ public:
+   virtual double operator()(const Bvert*) { return 1.0; }
+};
+
+typedef ZCrossExtractor<FaceField, FullConfidence, ZCrossListFaceGenerator>
+        FeatureLineExtractor;
+
+FeatureLines::FeatureLines() :
+   _sug_thresh(0.05),
+   _ridge_thresh(0.1),
+   _app_thresh(0.1),
+   _num_faces(0),
+   _mesh(nullptr),
+   _stamp(0),
+   _kinds(0)
+{
+}
+
+static inline Wvec
+face_gradient(CWpt& p0, CWpt& p1, CWpt& p2, const double f[3])
+{
+   // Gradient of the linear function on the triangle that takes
+   // values f at the vertices:
+   Wvec n = cross(p1 - p0, p2 - p0);
+   double l = n.length_sqrd();
+   if (l == 0)
+      return Wvec();
+   return (cross(n, p2 - p1)*f[0] +
+           cross(n, p0 - p2)*f[1] +
+           cross(n, p1 - p0)*f[2]) / l;
+}
+
+void
+FeatureLines::compute_verts(BMESHptr mesh, CWpt& eye, int kinds)
+{
+   // Per-vertex quantities as in the line drawing shaders (radial
+   // curvature and its derivative) and in rtsc (view-dependent
+   // curvature):
+
+   BMESHcurvature_data* curv = mesh->curvature();
+   const MeshSnapshot& snap = mesh->snapshot();
+   const int nv = snap.nverts();
+   const double fs  = curv->feature_size();
+   const double fs2 = fs*fs;
+   const double sc_thresh = (fs2 > 0) ? _sug_thresh/fs2 : 0;
+
+   // Normals computed on demand aren't safe to compute in
+   // parallel, so any that are missing are filled in after:
+   vector<unsigned char> missing(nv);
+   _norms.resize(nv);
+   parallel_for(nv, LINES_GRAIN, [&](int begin, int end) {
+      for (int i=begin; i<end; i++) {
+         Bvert* v = mesh->bv(i);
+         if ((missing[i] = !v->is_set(Bvert::VALID_NORMAL_BIT)) == 0)
+            _norms[i] = v->norm();
+      }
+   });
+   for (int i=0; i<nv; i++)
+      if (missing[i])
+         _norms[i] = mesh->bv(i)->norm();
+
+   _ndotv.resize(nv);
+   _kr.resize(nv);
+   _sc_num.resize(nv);
+   if (kinds & APPARENT_RIDGES) {
+      _q1.resize(nv);
+      _t1.resize(nv);
+   }
+   parallel_for(nv, LINES_GRAIN, [&](int begin, int end) {
+      for (int i=begin; i<end; i++) {
+         Wvec w = (eye - snap.loc(i)).normalized();
+         double ndotv = _norms[i] * w;
+         _ndotv[i] = ndotv;
+
+         const diag_curv_t& dc = curv->diag_curv(i);
+         double k1 = dc.k1(), k2 = dc.k2();
+         double u  = dc.pdir1() * w, u2 = u*u;
+         double v  = dc.pdir2() * w, v2 = v*v;
+
+         // radial curvature (times sin^2 of the view angle), and
+         // the suggestive contour test: its derivative toward the
+         // eye, less the threshold:
+         _kr[i] = k1*u2 + k2*v2;
+         double num = 0;
+         if (u2 + v2 > 0) {
+            const dcurv_tensor_t& d = curv->dcurv_tensor(i);
+            double csc2theta = 1.0/(u2 + v2);
+            num = (u*u2*d[0] + 3*u2*v*d[1] + 3*v2*u*d[2] + v*v2*d[3])*csc2theta;
+            double tr = (k2 - k1)*u*v*csc2theta;
+            num -= 2*ndotv*tr*tr;
+         }
+         _sc_num[i] = num - ndotv*sc_thresh;
+
+         if (!(kinds & APPARENT_RIDGES))
+            continue;
+
+         // View-dependent curvature Q = S P^-1, where P projects
+         // the tangent plane to the view plane, in the principal
+         // frame. Foreshortening is along w, the view direction
+         // in the tangent plane:
+         double wu = 1, wv = 0;
+         if (u2 + v2 > 0) {
+            double l = sqrt(u2 + v2);
+            wu = u/l;
+            wv = v/l;
+         }
+         double sec1 = 1/max(fabs(ndotv), 1e-6) - 1;
+         double Q11 = k1*(1 + sec1*wu*wu), Q12 = k1*sec1*wu*wv;
+         double Q21 = k2*sec1*wu*wv,       Q22 = k2*(1 + sec1*wv*wv);
+
+         // q1 is the largest singular value, t1 its direction:
+         double A = Q11*Q11 + Q21*Q21;
+         double B = Q11*Q12 + Q21*Q22;
+         double C = Q12*Q12 + Q22*Q22;
+         double lambda = (A + C)/2 + sqrt(sqr((A - C)/2) + B*B);
+         _q1[i] = sqrt(lambda);
+         double tu = 1, tv = 0;
+         if (B != 0) {
+            if (A >= C) { tu = lambda - C; tv = B; }
+            else        { tu = B; tv = lambda - A; }
+         } else if (C > A) {
+            tu = 0; tv = 1;
+         }
+         _t1[i] = (dc.pdir1()*tu + dc.pdir2()*tv).normalized();
+      }
+   });
+}
+
+void
+FeatureLines::compute_dt1q1(const MeshSnapshot& snap)
+{
+   // Derivative of q1 along t1 at each vertex, from the gradients
+   // of q1 over the faces around it (area weighted):
+   const int nv = snap.nverts(), nf = snap.nfaces();
+
+   _grad.resize(nf);
+   parallel_for(nf, LINES_GRAIN, [&](int begin, int end) {
+      for (int f=begin; f<end; f++) {
+         const int* fv = snap.face_verts(f);
+         double q[3] = { _q1[fv[0]], _q1[fv[1]], _q1[fv[2]] };
+         _grad[f] = face_gradient(snap.loc(fv[0]), snap.loc(fv[1]),
+                                  snap.loc(fv[2]), q);
+      }
+   });
+
+   _dt1q1.resize(nv);
+   parallel_for(nv, LINES_GRAIN, [&](int begin, int end) {
+      for (int i=begin; i<end; i++) {
+         // Each face around the vertex is reached through the edge
+         // to the vertex that follows this one in the face:
+         Wvec   g;
+         double total = 0;
+         const int* ve = snap.vert_edges(i);
+         for (int k=0; k<snap.degree(i); k++) {
+            const int* ev = snap.edge_verts(ve[k]);
+            int other = (ev[0] == i) ? ev[1] : ev[0];
+            const int* ef = snap.edge_faces(ve[k]);
+            for (int j=0; j<2; j++) {
+               int f = ef[j];
+               if (f < 0)
+                  continue;
+               const int* fv = snap.face_verts(f);
+               int c = (fv[0] == i) ? 0 : (fv[1] == i) ? 1 : 2;
+               if (fv[(c + 1)%3] != other)
+                  continue;
+               double area = cross(snap.loc(fv[1]) - snap.loc(fv[0]),
+                                   snap.loc(fv[2]) - snap.loc(fv[0])).length();
+               g     += _grad[f]*area;
+               total += area;
+            }
+         }
+         _dt1q1[i] = (total > 0) ? (g * _t1[i])/total : 0;
+      }
+   });
+}
+
+void
+FeatureLines::test_faces(BMESHptr mesh, int k)
+{
+   // Fill in the field values of each face for kind number k of
+   // line, and whether the face passes the test for that kind:
+
+   const MeshSnapshot& snap = mesh->snapshot();
+   const int nf = snap.nfaces();
+   const int kind = 1 << k;
+   BMESHcurvature_data* curv = mesh->curvature();
+   const double fs = curv->feature_size();
+
+   vector<double>&        kvals = _vals[k];
+   vector<unsigned char>& ok    = _ok[k];
+   kvals.resize(3*nf);
+   ok.resize(nf);
+   parallel_for(nf, LINES_GRAIN, [&](int begin, int end) {
+      for (int f=begin; f<end; f++) {
+         ok[f] = 0;
+         Bface* face = mesh->bf(f);
+         if (face->is_secondary())
+            continue;
+         const int* fv = snap.face_verts(f);
+         double* vals = &kvals[3*f];
+
+         if (kind == SUGGESTIVE) {
+            // Zero crossings of radial curvature, on front faces,
+            // where (test numerator)/(n . v) > 0 somewhere:
+            if (_ndotv[fv[0]] <= 0 && _ndotv[fv[1]] <= 0 && _ndotv[fv[2]] <= 0)
+               continue;
+            bool all_neg = true, all_pos = true;
+            for (int j=0; j<3; j++) {
+               double num = _sc_num[fv[j]], den = _ndotv[fv[j]];
+               all_neg = all_neg && (num <= 0 && den >= 0);
+               all_pos = all_pos && (num >= 0 && den <= 0);
+               vals[j] = _kr[fv[j]];
+            }
+            ok[f] = !(all_neg || all_pos);
+            continue;
+         }
+
+         // Ridges, valleys and apparent ridges: zero crossings of
+         // the derivative of a curvature along its direction. The
+         // direction is only known up to sign at each vertex, so
+         // signs are made to agree with the first vertex:
+         Wvec   dir[3];
+         double k[3];
+         for (int j=0; j<3; j++) {
+            if (kind == APPARENT_RIDGES) {
+               dir[j]  = _t1[fv[j]];
+               k[j]    = _q1[fv[j]];
+               vals[j] = _dt1q1[fv[j]];
+            } else {
+               const diag_curv_t& dc = curv->diag_curv(fv[j]);
+               dir[j]  = dc.pdir1();
+               k[j]    = dc.k1();
+               vals[j] = curv->dcurv_tensor(fv[j])[0];
+            }
+            if (j > 0 && dir[j] * dir[0] < 0)
+               vals[j] = -vals[j];
+         }
+         if ((vals[0] > 0) == (vals[1] > 0) && (vals[0] > 0) == (vals[2] > 0))
+            continue;
+
+         double strength = (fabs(k[0]) + fabs(k[1]) + fabs(k[2]))*fs/3;
+         if (kind == RIDGES) {
+            if (k[0] <= 0 || k[1] <= 0 || k[2] <= 0 || strength < _ridge_thresh)
+               continue;
+         } else if (kind == VALLEYS) {
+            if (k[0] >= 0 || k[1] >= 0 || k[2] >= 0 || strength < _ridge_thresh)
+               continue;
+         } else {
+            if (_ndotv[fv[0]] <= 0 && _ndotv[fv[1]] <= 0 && _ndotv[fv[2]] <= 0)
+               continue;
+            if (strength < _app_thresh)
+               continue;
+         }
+
+         // A maximum of the curvature along its direction (minimum,
+         // for valleys) has the derivative going from + to - (- to
+         // +) along that direction:
+         Wvec g = face_gradient(snap.loc(fv[0]), snap.loc(fv[1]),
+                                snap.loc(fv[2]), vals);
+         double slope = g * dir[0];
+         ok[f] = (kind == VALLEYS) ? (slope > 0) : (slope < 0);
+      }
+   });
+}
+
+int
+FeatureLines::trace(BMESHptr mesh, int k, Patch* p, CSimplexFilter* faces,
+                    vector<ZXseg>& ret)
+{
+   // Trace the lines through the faces that passed. To keep to a
+   // patch (or filter), the other faces are turned off meanwhile:
+
+   vector<unsigned char>& ok = _ok[k];
+   _others.clear();
+   int n = (int)_faces[k].size();
+   if (p || faces) {
+      for (auto& f : _faces[k]) {
+         Bface* face = mesh->bf(f);
+         if ((p && face->patch() != p) || (faces && !faces->accept(face))) {
+            _others.push_back(f);
+            ok[f] = 0;
+         }
+      }
+      n -= (int)_others.size();
+   }
+   _num_faces += n;
+
+   int ret_n = 0;
+   if (n > 0) {
+      vector<int> faces;
+      const vector<int>* gen = &_faces[k];
+      if (!_others.empty()) {
+         faces.reserve(n);
+         for (auto& f : _faces[k])
+            if (ok[f])
+               faces.push_back(f);
+         gen = &faces;
+      }
+      FaceField field(&mesh->snapshot(), &_vals[k], &ok);
+      FeatureLineExtractor extractor(mesh, field, FullConfidence(),
+                                     ZCrossListFaceGenerator(gen));
+      extractor.extract();
+
+      for (auto& seg : extractor.segs()) {
+         ret.push_back(seg);
+         if (seg.end())
+            ret_n++;
+      }
+   }
+
+   for (auto& f : _others)
+      ok[f] = 1;
+   return ret_n;
+}
+
+int
+FeatureLines::extract(BMESHptr mesh, CWpt& eye, int kinds,
+                      vector<ZXseg>& ret, Patch* p, uint stamp,
+                      CSimplexFilter* faces)
+{
+   _num_faces = 0;
+   if (!mesh || mesh->nfaces() == 0 || !kinds)
+      return 0;
+
+   // Bring curvature, normals and the snapshot up to date before
+   // going parallel:
+   mesh->curvature();
+   mesh->update_normals();
+   const MeshSnapshot& snap = mesh->snapshot();
+
+   // Recompute the fields and face tests unless they were found
+   // for the same stamp, mesh, view and kinds:
+   bool fresh = (stamp == 0 || stamp != _stamp || mesh.get() != _mesh ||
+                 eye != _eye || kinds != _kinds);
+   for (int k=0; k<NUM_KINDS && !fresh; k++)
+      fresh = ((kinds & (1 << k)) && (int)_ok[k].size() != snap.nfaces());
+   if (fresh) {
+      compute_verts(mesh, eye, kinds);
+      if (kinds & APPARENT_RIDGES)
+         compute_dt1q1(snap);
+      for (int k=0; k<NUM_KINDS; k++) {
+         _faces[k].clear();
+         if (!(kinds & (1 << k)))
+            continue;
+         test_faces(mesh, k);
+         for (int f=0; f<(int)_ok[k].size(); f++)
+            if (_ok[k][f])
+               _faces[k].push_back(f);
+      }
+      _mesh  = mesh.get();
+      _stamp = stamp;
+      _eye   = eye;
+      _kinds = kinds;
+   }
+
+   int n = 0;
+   for (int k=0; k<NUM_KINDS; k++)
+      if (kinds & (1 << k))
+         n += trace(mesh, k, p, faces, ret);
+   return n;
+}
@@ -0,0 +1,145 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef FEATURE_LINES_H_IS_INCLUDED
+#define FEATURE_LINES_H_IS_INCLUDED
+
+#include "mesh/bmesh.hpp"
+#include "mesh/zcross_path.hpp"
+
+#include <vector>
+
+class Patch;
+
+/*****************************************************************
+ * FeatureLines:
+ *
+ *      Extracts suggestive contours, ridges, valleys and apparent
+ *      ridges in object space, as polylines on the mesh, from the
+ *      curvature data of BMESH::curvature(). These are the lines
+ *      the line drawing shaders (see gtex/line_drawing.cpp) find
+ *      per pixel; here they come out in ZcrossPath form, ready
+ *      for the stroke pipeline (ZXedgeStrokeTexture).
+ *
+ *      Each kind of line is the zero set of a scalar field, kept
+ *      to the faces that pass a test for that kind:
+ *
+ *        suggestive contours: radial curvature, on front faces
+ *          where its derivative toward the eye is positive
+ *          (DeCarlo et al. 2003);
+ *        ridges (valleys): derivative of the max curvature k1
+ *          along its direction, where k1 > 0 (< 0) and is a max
+ *          (min) along its direction (Ohtake et al. 2004);
+ *        apparent ridges: the same, for the max view-dependent
+ *          curvature q1, on front faces (Judd et al. 2007).
+ *
+ *      Thresholds drop weak lines. They are measured against the
+ *      mesh's feature size, as in the shaders.
+ *
+ *      Fields and face tests are computed across threads, over
+ *      ranges of vertices and then faces; the lines are traced
+ *      by a ZCrossExtractor through the faces that passed.
+ *
+ *      Holds scratch space between calls, and no reference to
+ *      any mesh.
+ *****************************************************************/
+class FeatureLines {
+ public:
+
+   // kinds of lines, as bits:
+   enum {
+      SUGGESTIVE      = 1,
+      RIDGES          = 2,
+      VALLEYS         = 4,
+      APPARENT_RIDGES = 8
+   };
+
+   //******** MANAGERS ********
+
+   FeatureLines();
+
+   //******** THRESHOLDS ********
+
+   double sug_thresh()                   const { return _sug_thresh;   }
+   double ridge_thresh()                 const { return _ridge_thresh; }
+   double app_ridge_thresh()             const { return _app_thresh;   }
+   void   set_sug_thresh(double t)             { _sug_thresh   = t;    }
+   void   set_ridge_thresh(double t)           { _ridge_thresh = t;    }
+   void   set_app_ridge_thresh(double t)       { _app_thresh   = t;    }
+
+   //******** EXTRACTION ********
+
+   // Append to ret the lines of the given kinds on mesh, seen
+   // from eye (in the mesh's object space). Each line is a run
+   // of ZXsegs of type STYPE_SUGLINE; the last one has the end
+   // flag set. If p is not null, lines are kept to the faces of
+   // p, and if faces is, to the faces it accepts. Returns the
+   // number of lines added.
+   //
+   // The fields and face tests cover the whole mesh. Given a
+   // nonzero stamp (e.g. the frame number), they are kept, and
+   // later calls with the same stamp, mesh, eye and kinds (say,
+   // for the other patches) only trace their lines:
+   int extract(BMESHptr mesh, mlib::CWpt& eye, int kinds,
+               vector<ZXseg>& ret, Patch* p = nullptr, uint stamp = 0,
+               CSimplexFilter* faces = nullptr);
+
+   // Number of faces that held lines in the last call:
+   int num_faces() const { return _num_faces; }
+
+ protected:
+   double _sug_thresh;
+   double _ridge_thresh;
+   double _app_thresh;
+   int    _num_faces;
+
+   // per vertex, by snapshot index:
+   vector<Wvec>          _norms;     // vertex normals
+   vector<double>        _ndotv;     // normal . unit vector to eye
+   vector<double>        _kr;        // radial curvature
+   vector<double>        _sc_num;    // suggestive contour test
+   vector<double>        _q1;        // max view-dependent curvature
+   vector<Wvec>          _t1;        // ... and its direction
+   vector<double>        _dt1q1;     // derivative of q1 along t1
+
+   // per face:
+   vector<Wvec>          _grad;      // gradient of q1
+
+   // per kind of line (SUGGESTIVE etc., by bit number):
+   enum { NUM_KINDS = 4 };
+   vector<double>        _vals[NUM_KINDS];  // field values, 3 per face
+   vector<unsigned char> _ok[NUM_KINDS];    // 1 if the face may hold lines
+   vector<int>           _faces[NUM_KINDS]; // faces with _ok set
+   vector<int>           _others;           // of those, not on the patch
+                                            // (or not taken by the filter)
+
+   // what the above were computed for:
+   const BMESH*          _mesh;
+   uint                  _stamp;
+   mlib::Wpt             _eye;
+   int                   _kinds;
+
+   //******** INTERNAL METHODS ********
+
+   void compute_verts(BMESHptr mesh, mlib::CWpt& eye, int kinds);
+   void compute_dt1q1(const MeshSnapshot& snap);
+   void test_faces(BMESHptr mesh, int k);
+   int  trace(BMESHptr mesh, int k, Patch* p, CSimplexFilter* faces,
+              vector<ZXseg>& ret);
+};
+
+#endif // FEATURE_LINES_H_IS_INCLUDED
@@ -71,10 +71,8 @@ fit(LMESHptr& mesh, bool do_gauss_seidel)
       } else {
          // compute the new offsets from the offsets computed in the
          // previous iteration
-         int j;
-         for (j=0; j<n; j++)
-            mesh->lv(j)->limit_loc(L[j]);
-         for (j=0; j<n; j++) {
+         mesh->limit_data(mesh->verts(), &L);
+         for (int j=0; j<n; j++) {
             Wvec delt = C[j] - L[j];
             err += delt.length();
             mesh->bv(j)->offset_loc(delt);
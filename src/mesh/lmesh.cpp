@@ -15,10 +15,15 @@
  * You should have received a copy of the GNU General Public License
  * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
  *****************************************************************/
+#include "std/parallel.hpp"
 #include "disp/ray.hpp"
 #include "geom/world.hpp"   // XXX - for debugging
 #include "mlib/statistics.hpp"
 #include "lpatch.hpp"
+#include "subdiv_stencils.hpp"
+#include "adaptive_subdiv.hpp"
+
+#include <typeinfo>
 
 using namespace mlib;
 
@@ -46,7 +51,10 @@ LMESH::LMESH(int num_v, int num_e, int num_f) :
    _subdiv_mesh(nullptr),
    _subdiv_level(0),
    _loc_calc(new HybridLoc),    // use hybrid rules by default
-   _color_calc(new LoopColor)   // for colors we're not so choosy
+   _color_calc(new LoopColor),  // for colors we're not so choosy
+   _stencils(nullptr),
+   _use_stencils(Config::get_var_bool("JOT_SUBDIV_STENCILS", false)),
+   _adaptive(nullptr)
 {
    // Some compilers complain if 'this' is used in
    // member variable initialization section above
@@ -59,6 +67,10 @@ LMESH::~LMESH()
    delete_elements();
    delete _loc_calc;
    delete _color_calc;
+   delete _stencils;
+   _stencils = nullptr;
+   delete _adaptive;
+   _adaptive = nullptr;
 }
 
 LMESHptr
@@ -113,6 +125,7 @@ LMESH::set_subdiv_loc_calc(SubdivLocCalc* c)
    // Mark all vertices "dirty" to force recomputation
    // next time the mesh is used for anything:
    mark_all_dirty();
+   stencils_changed();
 
    // If there is a subdivision mesh already allocated,
    // change its subdiv_loc too:
@@ -166,8 +179,12 @@ LMESH::draw(CVIEWptr &v)
    // Only called on control mesh...
    assert(is_control_mesh());
 
-   // Update subdivision if needed (down to current level):
-   update();
+   // Update subdivision if needed (down to current level, or
+   // to the depths the adaptive driver picks for this view):
+   if (_adaptive)
+      _adaptive->update();
+   else
+      update();
 
    // BMESH functionality handles it...
    return BMESH::draw(v);
@@ -235,13 +252,13 @@ LMESH::new_patch()
 Bedge*
 LMESH::new_edge(Bvert* u, Bvert* v) const
 {
-   return new Ledge((Lvert*)u, (Lvert*)v);
+   return new (_edge_pool.alloc(sizeof(Ledge))) Ledge((Lvert*)u, (Lvert*)v);
 }
 
 Bvert*
 LMESH::new_vert(CWpt& p) const
 {
-   return new Lvert(p);
+   return new (_vert_pool.alloc(sizeof(Lvert))) Lvert(p);
 }
 
 Bface*
@@ -253,8 +270,9 @@ LMESH::new_face(
    Bedge* f,
    Bedge* g) const
 {
-   return new Lface((Lvert*)u, (Lvert*)v, (Lvert*)w,
-                    (Ledge*)e, (Ledge*)f, (Ledge*)g);
+   return new (_face_pool.alloc(sizeof(Lface)))
+      Lface((Lvert*)u, (Lvert*)v, (Lvert*)w,
+            (Ledge*)e, (Ledge*)f, (Ledge*)g);
 }
 
 int
@@ -360,6 +378,12 @@ LMESH::changed(change_t change)
    for (LMESHptr m = _subdiv_mesh; m; m = m->_subdiv_mesh)
       m->BMESH::changed(change);
 
+   // stencil tables only survive changes in vertex positions:
+   if (change == TOPOLOGY_CHANGED      ||
+       change == TRIANGULATION_CHANGED ||
+       change == CREASES_CHANGED)
+      stencils_changed();
+
    // ensure control mesh knows to invalidate display lists etc.
    // (if this *is* the control mesh, the first line took care of it)
    if (!is_control_mesh())
@@ -581,7 +605,8 @@ LMESH::allocate_subdiv_mesh()
    if (_subdiv_mesh)
       return 1; // It was easy
 
-   // Actually have to do it:
+   // Actually have to do it. The expected element counts
+   // pre-size the element lists and slabs of the new mesh:
    _subdiv_mesh = make_shared<LMESH>(
       nverts()     + nedges(),       // number of vertices
       2*nedges() + 3*nfaces(),       // number of edges
@@ -698,6 +723,16 @@ LMESH::update_subdivision(int level)
       return true;
    }
 
+   // If only control vertex positions changed, the stencil
+   // tables (if any) compute all the levels at once:
+   if (_stencils && _use_stencils && _stencils->update(this, level)) {
+      LMESH* m = subdiv_mesh(level).get();
+      if (_cur_mesh != m)
+         set_cur_mesh(m);
+      changed(RENDERING_CHANGED);
+      return true;
+   }
+
    // Debugging:
    static bool debug = Config::get_var_bool("DEBUG_SUBDIVISION",false);
    static uint fnum = 0;
@@ -757,11 +792,70 @@ LMESH::update_subdivision(int level)
 
    ret = _subdiv_mesh->update_subdivision(level-1) || ret;
 
-   if (ret && is_control_mesh())
+   if (ret && is_control_mesh()) {
       changed(RENDERING_CHANGED);
+
+      // Now that all levels are up to date, make stencil tables
+      // if needed. (If they can't be made, the failed tables are
+      // kept so it isn't tried again until something changes):
+      if (_use_stencils && (!_stencils || _stencils->levels() < level)) {
+         stencils_changed();
+         _stencils = new SubdivStencils(this, level);
+      }
+   }
    return ret;
 }
 
+void
+LMESH::set_use_stencils(bool b)
+{
+   LMESH* m = control_mesh().get();
+   m->_use_stencils = b;
+   if (!b)
+      m->stencils_changed();
+}
+
+void
+LMESH::set_adaptive(AdaptiveSubdiv* a)
+{
+   LMESH* m = control_mesh().get();
+   if (m->_adaptive == a)
+      return;
+   delete m->_adaptive;
+   m->_adaptive = a;
+
+   // the adaptive faces are drawn by the control patches:
+   if (a)
+      m->set_cur_mesh(m);
+   m->changed(RENDERING_CHANGED);
+}
+
+int
+LMESH::get_sil_strips()
+{
+   if (_adaptive)
+      return _adaptive->get_sil_strips(_sils);
+   return BMESH::get_sil_strips();
+}
+
+int
+LMESH::get_zcross_strips()
+{
+   if (_adaptive)
+      return _adaptive->get_zcross_strips(_zx_sils);
+   return BMESH::get_zcross_strips();
+}
+
+void
+LMESH::stencils_changed()
+{
+   LMESH* m = this;
+   while (m->_parent_mesh)
+      m = m->_parent_mesh;
+   delete m->_stencils;
+   m->_stencils = nullptr;
+}
+
 inline void
 update_verts(CBvert_list& verts)
 {
@@ -879,6 +973,7 @@ LMESH::delete_subdiv_mesh()
    if (is_control_mesh())
       set_cur_mesh(this);
    _subdiv_mesh = nullptr;    // deletes _subdiv_mesh thru ref-counting
+   stencils_changed();
 }
 
 void
@@ -1004,6 +1099,65 @@ LMESH::mark_all_dirty()
       _subdiv_mesh->mark_all_dirty();
 }
 
+// vertices per task in limit_data():
+static const int LIMIT_GRAIN = 512;
+
+void
+LMESH::limit_data(CBvert_list& verts, vector<Wpt>* locs,
+                  vector<Wvec>* norms, vector<Wvec>* tans) const
+{
+   // Limit positions of verts (as in limit_loc()), and limit
+   // normals and unit tangents (as in LoopLoc::limit_normal()),
+   // across threads. Each vertex's one-ring is gathered once, in
+   // CCW order, and serves for all three.
+
+   int n = verts.size();
+   if (locs)  locs ->resize(n);
+   if (norms) norms->resize(n);
+   if (tans)  tans ->resize(n);
+
+   // vertex masks are computed lazily, using shared scratch
+   // space; compute them here so the threads just read them:
+   for (auto& v : verts)
+      ((Lvert*)v)->subdiv_mask();
+
+   // for Loop meshes, smooth vertices use the gathered ring:
+   bool loop = (typeid(*_loc_calc) == typeid(LoopLoc));
+   bool frames = (norms || tans);
+
+   parallel_for(n, LIMIT_GRAIN, [&](int begin, int end) {
+      for (int i = begin; i < end; i++) {
+         CLvert* v = (CLvert*)verts[i];
+
+         Bvert_list nbrs;
+         bool ring = v->is_manifold() && v->face_degree(BfaceFilter()) > 0;
+         if (ring && (frames || (loop && v->is_smooth())))
+            nbrs = v->get_ccw_nbrs();
+         ring = ring && ((int)nbrs.size() == v->degree());
+
+         if (locs) {
+            if (loop && ring && v->is_smooth()) {
+               Wvec c;
+               for (auto& nbr : nbrs)
+                  c += nbr->loc() - Wpt::Origin();
+               Wpt centroid = Wpt::Origin() + c/nbrs.size();
+               double w = LoopLoc::smooth_limit_weight(nbrs.size());
+               (*locs)[i] = interp(centroid, v->loc(), w);
+            } else {
+               (*locs)[i] = _loc_calc->limit_val(v);
+            }
+         }
+         if (frames) {
+            Wvec t1, t2;
+            if (!(ring && LoopLoc::limit_tangents(v, nbrs, t1, t2)))
+               t1 = t2 = Wvec::null();
+            if (norms) (*norms)[i] = cross(t1, t2).normalized();
+            if (tans)  (*tans) [i] = t1.normalized();
+         }
+      }
+   });
+}
+
 void
 LMESH::fit(vector<Lvert*>& verts, bool do_gauss_seidel)
 {
@@ -1022,6 +1176,12 @@ LMESH::fit(vector<Lvert*>& verts, bool do_gauss_seidel)
 
    double max_err = box.dim().length() * 1e-5;
 
+   // the Jacobi iteration finds all the limit points at once:
+   Bvert_list bverts(verts.size());
+   for (auto& v : verts)
+      bverts.push_back(v);
+   LMESHptr lmesh = verts[0]->lmesh();
+
    size_t n = verts.size();
 
    // get original control point locations
@@ -1065,11 +1225,10 @@ LMESH::fit(vector<Lvert*>& verts, bool do_gauss_seidel)
       } else {
          // compute the new offsets from the offsets computed in the
          // previous iteration
-         size_t j;
-         for (j=0; j<n; j++)
-            verts[j]->limit_loc(L[j]);
+         if (lmesh)
+            lmesh->limit_data(bverts, &L);
 
-         for (j=0; j<n; j++) {
+         for (size_t j=0; j<n; j++) {
             Wvec delt = C[j] - L[j];
 
             err += delt.length();
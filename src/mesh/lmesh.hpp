@@ -23,6 +23,9 @@
 #include "lvert_strip.hpp"
 #include "subdiv_calc.hpp"
 
+class SubdivStencils;
+class AdaptiveSubdiv;
+
 /*****************************************************************
  * LMESH:
  *
@@ -31,6 +34,7 @@
 #define CLMESH const LMESH
 MAKE_SHARED_PTR(LMESH);
 class LMESH : public BMESH {
+   friend class SubdivStencils;
 
   public:
    //******** MANAGERS ********
@@ -127,6 +131,15 @@ class LMESH : public BMESH {
    COLOR subdiv_color(CBvert* v) const { return _color_calc->subdiv_val(v); }
    COLOR subdiv_color(CBedge* e) const { return _color_calc->subdiv_val(e); }
 
+   // Limit positions of the given vertices (as limit_loc()), plus
+   // limit normals and unit tangents (as LoopLoc::limit_normal()),
+   // computed for all of them at once across threads. Any output
+   // may be null; the others are resized to verts.size():
+   void limit_data(CBvert_list& verts,
+                   vector<Wpt>*  locs,
+                   vector<Wvec>* norms = nullptr,
+                   vector<Wvec>* tans  = nullptr) const;
+
    //******** SUBDIVISION ********
    void refine();       // switch to finer subdivision mesh
    void unrefine();     // switch to coarser subdivision mesh
@@ -187,6 +200,38 @@ class LMESH : public BMESH {
    // the subdivision locations of the given vertices.
    static Bvert_list get_subdiv_inputs(CBvert_list& verts);
 
+   //******** SUBDIVISION STENCILS ********
+
+   // With stencils on, the control mesh keeps tables of
+   // subdivision weights (see subdiv_stencils.hpp) and uses them
+   // in update_subdivision() when only vertex positions changed.
+   // Off by default; JOT_SUBDIV_STENCILS turns it on for new
+   // meshes:
+   bool use_stencils() const { return control_mesh()->_use_stencils; }
+   void set_use_stencils(bool b);
+
+   // The tables, if built (control mesh only):
+   const SubdivStencils* stencils() const { return _stencils; }
+
+   // Discard the tables of the control mesh. Called when anything
+   // other than vertex positions changes (topology, creases,
+   // corners, offsets, subdivision rules):
+   void stencils_changed();
+
+   //******** ADAPTIVE SUBDIVISION ********
+
+   // With an AdaptiveSubdiv set, draw() refines each control face
+   // to a depth chosen for the current view, instead of the whole
+   // mesh to cur_level(), and the control patches draw those
+   // faces. The control mesh owns it; set null to go back to the
+   // global level:
+   AdaptiveSubdiv* adaptive() const { return control_mesh()->_adaptive; }
+   void set_adaptive(AdaptiveSubdiv* a);
+
+   // The silhouettes then come from the faces drawn:
+   virtual int get_sil_strips();
+   virtual int get_zcross_strips();
+
    //******** I/O - READ ********
 
    // Read an LMESH from a file and return it.  
@@ -270,6 +315,15 @@ class LMESH : public BMESH {
    virtual void changed(change_t);
    virtual void changed() { changed(TOPOLOGY_CHANGED); }
 
+   // The current subdivision mesh is the one drawn, so its
+   // normals are the ones batched (see BMESH::update_normals()):
+   virtual void update_normals() {
+      if (_cur_mesh && _cur_mesh != this)
+         _cur_mesh->BMESH::update_normals();
+      else
+         BMESH::update_normals();
+   }
+
    //******** DIAGNOSTIC ********
 
    // Return the approximate memory used for this mesh.
@@ -342,6 +396,10 @@ class LMESH : public BMESH {
    SubdivLocCalc*       _loc_calc;
    SubdivColorCalc*     _color_calc;
 
+   SubdivStencils*      _stencils;      // tables for the levels below
+   bool                 _use_stencils;  // build and use _stencils
+   AdaptiveSubdiv*      _adaptive;      // per-face depths for the view
+
    //******** INTERNAL METHODS ********
 
    void set_parent(LMESH* parent);
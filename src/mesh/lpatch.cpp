@@ -16,6 +16,7 @@
  * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
  *****************************************************************/
 #include "lpatch.hpp"
+#include "adaptive_subdiv.hpp"
 
 
 static bool debug = Config::get_var_bool("DEBUG_LPATCH",false);
@@ -135,15 +136,47 @@ Lpatch::draw(CVIEWptr& v)
 int
 Lpatch::draw_tri_strips(StripCB* cb)
 {
+   // With adaptive subdivision, draw this control patch's faces
+   // at the depths chosen for the view:
+   AdaptiveSubdiv* a = _mesh ? lmesh()->adaptive() : nullptr;
+   if (a && is_ctrl_patch())
+      return a->draw_triangles(cb, this);
+
    return cur_patch()->Patch::draw_tri_strips(cb);
 }
 
+const TriList*
+Lpatch::cur_tri_list()
+{
+   // adaptive subdivision draws its own triangles:
+   if (_mesh && lmesh()->adaptive() && is_ctrl_patch())
+      return nullptr;
+
+   return cur_patch()->Patch::cur_tri_list();
+}
+
 int
 Lpatch::draw_sil_strips(StripCB* cb)
 {
    return cur_patch()->Patch::draw_sil_strips(cb);
 }
 
+EdgeStrip*
+Lpatch::build_creases()
+{
+   AdaptiveSubdiv* a = _mesh ? lmesh()->adaptive() : nullptr;
+   EdgeStrip* ret = (a && is_ctrl_patch()) ? a->creases(this) : nullptr;
+   return ret ? ret : Patch::build_creases();
+}
+
+EdgeStrip*
+Lpatch::build_borders()
+{
+   AdaptiveSubdiv* a = _mesh ? lmesh()->adaptive() : nullptr;
+   EdgeStrip* ret = (a && is_ctrl_patch()) ? a->borders(this) : nullptr;
+   return ret ? ret : Patch::build_borders();
+}
+
 int 
 Lpatch::num_faces() const 
 {
@@ -159,6 +192,13 @@ Lpatch::tris_per_strip() const
    return ((Lpatch*)this)->cur_patch()->Patch::tris_per_strip();
 }
 
+double
+Lpatch::acmr()
+{
+   // Diagnostic:
+   return cur_patch()->Patch::acmr();
+}
+
 CBface_list& 
 Lpatch::cur_faces() const
 {
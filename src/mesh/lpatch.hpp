@@ -123,10 +123,20 @@ class Lpatch : public Patch {
 
    // Diagnostic:
    virtual double tris_per_strip() const;
+   virtual double acmr();
 
    virtual int  draw_tri_strips(StripCB*);
+   virtual const TriList* cur_tri_list();
    virtual int  draw_sil_strips(StripCB*);
 
+ protected:
+   // With adaptive subdivision, the creases and borders of the
+   // faces drawn:
+   virtual EdgeStrip* build_creases();
+   virtual EdgeStrip* build_borders();
+
+ public:
+
    //******** VERSIONING/CACHING ********
    virtual void triangulation_changed();
 
@@ -262,6 +262,7 @@ Lvert::set_offset(double d)
       err_msg("Lvert::set_offset: error: called on control vert");
    } else if (_offset != d) {
       _offset = d;
+      lmesh()->stencils_changed();
       set_loc(detail_loc_from_parent());
    }
 }
@@ -381,6 +382,10 @@ Lvert::mask_changed()
    clear_bit(MASK_VALID_BIT);
    subdiv_loc_changed();
    subdiv_color_changed();
+   // (there's no mesh while it deletes its elements in its destructor)
+   LMESHptr m = is_set(DEAD_BIT) ? nullptr : lmesh();
+   if (m)
+      m->stencils_changed();
 
    // Edge masks depend on vertex masks.
    //
@@ -41,6 +41,7 @@ typedef SubdivCalc<Wpt> LocCalc;
 class Lvert : public Bvert {
    friend class REPARENT_CMD;
    friend class Ledge;
+   friend class SubdivStencils;
  public:
 
    //******** MASK VALUES ********
@@ -0,0 +1,772 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/uv_data.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace mlib;
+
+/*****************************************************************
+ * Checks
+ *****************************************************************/
+static int num_failed = 0;
+
+void
+check(bool ok, const string& what)
+{
+   if (!ok) {
+      cerr << "FAILED: " << what << endl;
+      num_failed++;
+   }
+}
+
+int
+check_summary()
+{
+   if (num_failed) {
+      cerr << num_failed << " check(s) failed" << endl;
+      return 1;
+   }
+   cerr << "all checks passed" << endl;
+   return 0;
+}
+
+/*****************************************************************
+ * Meshes
+ *****************************************************************/
+void
+grid(int n, Wpt_list& pts, vector<Point3i>& tris)
+{
+   for (int y=0; y<=n; y++)
+      for (int x=0; x<=n; x++)
+         pts.push_back(Wpt(x, y, 0));
+   for (int y=0; y<n; y++) {
+      for (int x=0; x<n; x++) {
+         int i = y*(n+1) + x;
+         tris.push_back(Point3i(i, i+1, i+n+2));
+         tris.push_back(Point3i(i, i+n+2, i+n+1));
+      }
+   }
+}
+
+BMESHptr
+soup(int n, double jitter)
+{
+   Wpt_list pts, soup_pts;
+   vector<Point3i> tris, soup_tris;
+   grid(n, pts, tris);
+   for (auto& tri : tris) {
+      int k = (int)soup_pts.size();
+      for (int j=0; j<3; j++)
+         soup_pts.push_back(pts[tri[j]] + Wvec(drand48(), drand48(), 0)*jitter);
+      soup_tris.push_back(Point3i(k, k+1, k+2));
+   }
+   BMESHptr ret = make_shared<BMESH>();
+   ret->build(soup_pts, soup_tris);
+   return ret;
+}
+
+LMESHptr
+subdiv_icosahedron(int level)
+{
+   LMESHptr ctrl = make_shared<LMESH>();
+   ctrl->Icosahedron();
+   ctrl->set_subdiv_loc_calc(new LoopLoc());
+   ctrl->update_subdivision(level);
+   return ctrl;
+}
+
+LMESHptr
+anim_lmesh(bool quads, int level, bool stencils)
+{
+   LMESHptr ctrl = make_shared<LMESH>();
+   if (quads) {
+      ctrl->Cube();
+      ctrl->set_subdiv_loc_calc(new CatmullClarkLoc());
+   } else {
+      ctrl->Icosahedron();
+      ctrl->set_subdiv_loc_calc(new LoopLoc());
+   }
+   ctrl->set_use_stencils(stencils);
+   ctrl->update_subdivision(level);
+   return ctrl;
+}
+
+void
+wave(LMESHptr ctrl, const Wpt_list& rest, int frame)
+{
+   for (int i=0; i<ctrl->nverts(); i++) {
+      Wpt p = rest[i];
+      ctrl->bv(i)->set_loc(p + Wvec(0, 0.2*sin(0.5*frame + 3*p[0]), 0));
+   }
+   ctrl->changed(BMESH::VERT_POSITIONS_CHANGED);
+}
+
+BMESHptr
+plain_sphere(int level)
+{
+   // the subdivided icosahedron, copied into a plain BMESH:
+   LMESHptr ctrl = subdiv_icosahedron(level);
+   const MeshSnapshot& snap = ctrl->cur_mesh()->snapshot();
+   Wpt_list pts;
+   vector<Point3i> tris;
+   for (int i=0; i<snap.nverts(); i++)
+      pts.push_back(snap.loc(i));
+   for (int i=0; i<snap.nfaces(); i++) {
+      const int* fv = snap.face_verts(i);
+      tris.push_back(Point3i(fv[0], fv[1], fv[2]));
+   }
+   BMESHptr ret = make_shared<BMESH>();
+   ret->build(pts, tris);
+   return ret;
+}
+
+BMESHptr
+bumpy_sphere(int level)
+{
+   // plain_sphere() with bumps pushed in and out:
+   BMESHptr ret = plain_sphere(level);
+   for (int i=0; i<ret->nverts(); i++) {
+      Wpt  p = ret->bv(i)->loc();
+      double bump = sin(13*p[0])*sin(17*p[1])*sin(19*p[2]);
+      ret->bv(i)->set_loc(p + (p - Wpt::Origin())*(0.03*bump));
+   }
+   ret->changed(BMESH::VERT_POSITIONS_CHANGED);
+   return ret;
+}
+
+LMESHptr
+bumpy_lmesh()
+{
+   BMESHptr m = bumpy_sphere(2);
+   const MeshSnapshot& snap = m->snapshot();
+   Wpt_list pts;
+   vector<Point3i> tris;
+   for (int i=0; i<snap.nverts(); i++)
+      pts.push_back(snap.loc(i));
+   for (int i=0; i<snap.nfaces(); i++) {
+      const int* fv = snap.face_verts(i);
+      tris.push_back(Point3i(fv[0], fv[1], fv[2]));
+   }
+   LMESHptr ret = make_shared<LMESH>();
+   ret->build(pts, tris, ret->new_patch());
+   ret->set_subdiv_loc_calc(new LoopLoc());
+   return ret;
+}
+
+BMESHptr
+scanned_mesh(int n)
+{
+   Wpt_list pts;
+   for (int y=0; y<=n; y++)
+      for (int x=0; x<=n; x++)
+         pts.push_back(Wpt(x + 0.3*(drand48()-0.5), y + 0.3*(drand48()-0.5), 0));
+   vector<Point3i> tris;
+   for (int y=0; y<n; y++) {
+      for (int x=0; x<n; x++) {
+         int i = y*(n+1) + x;
+         if (drand48() < 0.5) {
+            tris.push_back(Point3i(i, i+1, i+n+2));
+            tris.push_back(Point3i(i, i+n+2, i+n+1));
+         } else {
+            tris.push_back(Point3i(i, i+1, i+n+1));
+            tris.push_back(Point3i(i+1, i+n+2, i+n+1));
+         }
+      }
+   }
+   for (int i=(int)tris.size()-1; i>0; i--)
+      swap(tris[i], tris[lrand48() % (i+1)]);
+
+   BMESHptr ret = make_shared<BMESH>();
+   Patch* quad[4];
+   for (auto& p : quad)
+      p = ret->new_patch();
+   for (auto& p : pts)
+      ret->add_vertex(p);
+   for (auto& t : tris) {
+      Wpt c = pts[t[0]];
+      int q = (c[0] < n/2.0 ? 0 : 1) + (c[1] < n/2.0 ? 0 : 2);
+      ret->add_face(t[0], t[1], t[2], quad[q]);
+   }
+   ret->changed(BMESH::TOPOLOGY_CHANGED);
+   return ret;
+}
+
+void
+write_obj(const string& name, int n)
+{
+   FILE* out = fopen(name.c_str(), "w");
+   fprintf(out, "# mesh_fixtures obj test\ng grid\n");
+   int nv = (n+1)*(n+1);
+   for (int y=0; y<=n; y++)
+      for (int x=0; x<=n; x++)
+         fprintf(out, "v %.17g %.17g %.17g\n",
+                 x + 0.3*(drand48()-0.5), y + 0.3*(drand48()-0.5), 0.1*drand48());
+   for (int y=0; y<=n; y++)
+      for (int x=0; x<=n; x++)
+         fprintf(out, "vt %.9g %.9g\n", double(x)/n, double(y)/n);
+   fprintf(out, "vn 0 0 1\nvn 0 0.6 0.8\n");
+
+   int cur = -1;
+   for (int y=0; y<n; y++) {
+      for (int x=0; x<n; x++) {
+         int q = (x < n/2 ? 0 : 1) + (y < n/2 ? 0 : 2);
+         if (q != cur)
+            fprintf(out, "usemtl quadrant_%d\n", cur = q);
+         int i = y*(n+1) + x + 1;
+         int c[4] = { i, i+1, i+n+2, i+n+1 };
+         int nrm = (y < n/2) ? 1 : 2;
+         if ((x + y) % 7 == 0) {
+            // negative (relative) indices:
+            fprintf(out, "f %d/%d/-%d %d/%d/-%d %d/%d/-%d %d/%d/-%d\n",
+                    c[0]-nv-1, c[0]-nv-1, 3-nrm, c[1]-nv-1, c[1]-nv-1, 3-nrm,
+                    c[2]-nv-1, c[2]-nv-1, 3-nrm, c[3]-nv-1, c[3]-nv-1, 3-nrm);
+         } else if (drand48() < 0.5) {
+            fprintf(out, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                    c[0], c[0], nrm, c[1], c[1], nrm, c[2], c[2], nrm, c[3], c[3], nrm);
+         } else {
+            fprintf(out, "f %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                    c[0], c[0], nrm, c[1], c[1], nrm, c[2], c[2], nrm);
+            if (x == 1)
+               fprintf(out, "f %d/%d/%d \\\n %d/%d/%d %d/%d/%d\n",
+                       c[0], c[0], nrm, c[2], c[2], nrm, c[3], c[3], nrm);
+            else
+               fprintf(out, "f %d/%d/%d %d/%d/%d %d/%d/%d  # second half\n",
+                       c[0], c[0], nrm, c[2], c[2], nrm, c[3], c[3], nrm);
+         }
+      }
+   }
+   fclose(out);
+}
+
+// One PLY value, as text or in binary (bytes reversed if swap):
+template <class T>
+static void
+put_ply(ostream& out, T val, bool ascii, bool swap)
+{
+   if (ascii) {
+      out << ' ' << +val;
+      return;
+   }
+   char b[sizeof(T)];
+   memcpy(b, &val, sizeof(T));
+   if (swap)
+      reverse(b, b + sizeof(T));
+   out.write(b, sizeof(T));
+}
+
+void
+write_ply(const string& name, const char* format,
+          const vector<float>& xyz, const vector<unsigned char>& rgb,
+          const vector<vector<int>>& faces)
+{
+   ofstream out(name.c_str(), ios::out | ios::binary);
+   bool ascii = !strcmp(format, "ascii");
+   const uint16_t one = 1;
+   bool swap = !ascii &&
+      (!strcmp(format, "binary_big_endian") == (*(const char*)&one == 1));
+   int nv = xyz.size()/3;
+   out << "ply\nformat " << format << " 1.0\ncomment mesh_fixtures ply test\n"
+       << "element vertex " << nv << "\n"
+       << "property float x\nproperty float y\nproperty float z\n"
+       << "property float nx\nproperty float ny\nproperty float nz\n"
+       << "property uchar red\nproperty uchar green\nproperty uchar blue\n"
+       << "property float confidence\n"
+       << "element face " << faces.size() << "\n"
+       << "property uchar flags\nproperty list uchar int vertex_indices\n"
+       << "element edge 1\nproperty int vertex1\nproperty int vertex2\n"
+       << "end_header\n";
+   out.precision(9);
+   for (int i = 0; i < nv; i++) {
+      for (int c = 0; c < 3; c++)
+         put_ply(out, xyz[3*i + c], ascii, swap);
+      put_ply(out, 0.0f, ascii, swap);
+      put_ply(out, 0.0f, ascii, swap);
+      put_ply(out, 1.0f, ascii, swap);
+      for (int c = 0; c < 3; c++)
+         put_ply(out, rgb[3*i + c], ascii, swap);
+      put_ply(out, 0.5f, ascii, swap);
+      if (ascii)
+         out << "\n";
+   }
+   for (auto& f : faces) {
+      put_ply(out, (unsigned char)7, ascii, swap);
+      put_ply(out, (unsigned char)f.size(), ascii, swap);
+      for (auto& v : f)
+         put_ply(out, (int32_t)v, ascii, swap);
+      if (ascii)
+         out << "\n";
+   }
+   put_ply(out, (int32_t)0, ascii, swap);
+   put_ply(out, (int32_t)1, ascii, swap);
+   if (ascii)
+      out << "\n";
+}
+
+BMESHptr
+ply_grid(int n, vector<float>& xyz, vector<unsigned char>& rgb,
+         vector<vector<int>>& faces)
+{
+   for (int y=0; y<=n; y++) {
+      for (int x=0; x<=n; x++) {
+         xyz.push_back(x + 0.3*(drand48()-0.5));
+         xyz.push_back(y + 0.3*(drand48()-0.5));
+         xyz.push_back(0.1*drand48());
+         for (int c = 0; c < 3; c++)
+            rgb.push_back(lrand48() % 256);
+      }
+   }
+   for (int y=0; y<n; y++) {
+      for (int x=0; x<n; x++) {
+         int i = y*(n+1) + x;
+         if (drand48() < 0.5) {
+            faces.push_back({ i, i+1, i+n+2, i+n+1 });
+         } else {
+            faces.push_back({ i, i+1, i+n+2 });
+            faces.push_back({ i, i+n+2, i+n+1 });
+         }
+      }
+   }
+
+   // what ply2sm makes of it (faces reversed, quads split along
+   // a weak edge):
+   Wpt_list pts;
+   for (size_t i = 0; i < xyz.size(); i += 3)
+      pts.push_back(Wpt(xyz[i], xyz[i+1], xyz[i+2]));
+   vector<Point3i> tris;
+   vector<Point2i> weak;
+   for (auto& f : faces) {
+      if (f.size() == 3) {
+         tris.push_back(Point3i(f[2], f[1], f[0]));
+      } else {
+         tris.push_back(Point3i(f[3], f[2], f[1]));
+         tris.push_back(Point3i(f[3], f[1], f[0]));
+         weak.push_back(Point2i(f[3], f[1]));
+      }
+   }
+   BMESHptr ret = make_shared<LMESH>();
+   ret->build(pts, tris);
+   for (auto& w : weak)
+      ret->set_weak_edge(w[0], w[1]);
+   ret->changed(BMESH::TOPOLOGY_CHANGED);
+   for (int i=0; i<ret->nverts(); i++)
+      ret->bv(i)->set_color(COLOR(rgb[3*i]/255.0, rgb[3*i+1]/255.0, rgb[3*i+2]/255.0));
+   return ret;
+}
+
+vector<string>
+write_grid_scene(const string& scene, int n, int num_meshes)
+{
+   vector<string> ret;
+   string base = scene.substr(0, scene.rfind('.'));
+   ofstream out(scene.c_str());
+   out << "#jot\n";
+   for (int k = 0; k < num_meshes; k++) {
+      Wpt_list pts;
+      vector<Point3i> tris;
+      grid(n, pts, tris);
+      for (auto& p : pts)
+         p = p + Wvec(0, 0, drand48());
+      BMESHptr m = make_shared<LMESH>();
+      m->build(pts, tris);
+      ret.push_back(base + "_" + to_string(k) + ".sm");
+      m->write_file(ret.back().c_str());
+      out << "TEXBODY {\n\tname mesh" << k
+          << "\n\tmesh_data_file { " << ret.back() << " }\n\t}\n";
+   }
+   return ret;
+}
+
+void
+brush_stroke(BMESHptr m, int frame, int num_frames)
+{
+   double a = 2*M_PI*frame/num_frames;
+   Wvec brush(cos(a), sin(a), 0.3);
+   brush = brush.normalized();
+   for (int i=0; i<m->nverts(); i++) {
+      Bvert* v = m->bv(i);
+      Wvec d = v->loc() - Wpt::Origin();
+      double t = 1 - (d.normalized() - brush).length()/0.25;
+      if (t > 0)
+         v->set_loc(v->loc() + d*(0.02*t));
+   }
+   m->changed(BMESH::VERT_POSITIONS_CHANGED);
+}
+
+/*****************************************************************
+ * Comparisons
+ *****************************************************************/
+bool
+same_locs(CBMESHptr& a, CBMESHptr& b)
+{
+   if (!a || !b || a->nverts() != b->nverts() || a->nfaces() != b->nfaces())
+      return false;
+   for (int i=0; i<a->nverts(); i++)
+      if (a->bv(i)->loc() != b->bv(i)->loc())
+         return false;
+   return true;
+}
+
+bool
+same_curvature(BMESHcurvature_data* a, BMESHcurvature_data* b, CBvert* v)
+{
+   BMESHcurvature_data::diag_curv_t   da = a->diag_curv(v),    db = b->diag_curv(v);
+   BMESHcurvature_data::dcurv_tensor_t ta = a->dcurv_tensor(v), tb = b->dcurv_tensor(v);
+   if (da.k1() != db.k1() || da.k2() != db.k2())
+      return false;
+   for (int k=0; k<3; k++)
+      if (da.pdir1()[k] != db.pdir1()[k] || da.pdir2()[k] != db.pdir2()[k])
+         return false;
+   for (int k=0; k<4; k++)
+      if (ta[k] != tb[k])
+         return false;
+   return true;
+}
+
+bool
+same_mesh(CBMESHptr& a, CBMESHptr& b, double tol, bool check_patches)
+{
+   auto differ = [](const string& what) {
+      cerr << "  meshes differ in " << what << endl;
+      return false;
+   };
+   if (a->nverts() != b->nverts() || a->nfaces() != b->nfaces() ||
+       a->nedges() != b->nedges() || a->npatches() != b->npatches())
+      return differ("size");
+   if (a->type() != b->type())
+      return differ("type");
+   if (a->occluder() != b->occluder() ||
+       fabs(a->shadow_scale()  - b->shadow_scale())  > tol ||
+       fabs(a->shadow_offset() - b->shadow_offset()) > tol)
+      return differ("shadow settings");
+   for (int i=0; i<a->nverts(); i++) {
+      Bvert* u = a->bv(i), *v = b->bv(i);
+      if (u->loc().dist(v->loc()) > tol || u->has_color() != v->has_color() ||
+          (u->has_color() && u->color().dist(v->color()) > tol))
+         return differ("vertex " + to_string(i));
+   }
+   for (int i=0; i<a->nfaces(); i++) {
+      Bface* f = a->bf(i);
+      Bface* g = b->lookup_face(Point3i(f->v1()->index(), f->v2()->index(),
+                                        f->v3()->index()));
+      if (!g || f->is_secondary() != g->is_secondary() ||
+          (check_patches && a->patches().get_index(f->patch()) !=
+           b->patches().get_index(g->patch())))
+         return differ("face " + to_string(i));
+      if (UVdata::has_uv(f) != UVdata::has_uv(g))
+         return differ("UVs of face " + to_string(i));
+      if (UVdata::has_uv(f))
+         for (int k=1; k<=3; k++)
+            if (UVdata::get_uv(f->v(k), f).dist(
+                   UVdata::get_uv(b->bv(f->v(k)->index()), g)) > tol)
+               return differ("UVs of face " + to_string(i));
+   }
+   for (int i=0; i<a->nedges(); i++) {
+      Bedge* e = a->be(i);
+      Bedge* d = b->bv(e->v1()->index())->lookup_edge(b->bv(e->v2()->index()));
+      if (!d || d->is_crease() != e->is_crease() || d->is_weak() != e->is_weak())
+         return differ("edge " + to_string(i));
+   }
+   return true;
+}
+
+bool
+same_obj_mesh(CBMESHptr& a, CBMESHptr& b)
+{
+   if (!same_locs(a, b) || a->nedges() != b->nedges() ||
+       a->patches().num() != b->patches().num())
+      return false;
+   for (int i=0; i<a->nfaces(); i++) {
+      Bface* f = a->bf(i);
+      Bface* g = b->bf(i);
+      UVpt fuv[3], guv[3];
+      bool fhas = UVdata::get_uvs(f, fuv[0], fuv[1], fuv[2]);
+      bool ghas = UVdata::get_uvs(g, guv[0], guv[1], guv[2]);
+      if (fhas != ghas || (fhas && (fuv[0] != guv[0] || fuv[1] != guv[1] ||
+                                    fuv[2] != guv[2])))
+         return false;
+      for (int c = 1; c <= 3; c++)
+         if (f->v(c)->loc() != g->v(c)->loc())
+            return false;
+      if (f->patch()->name() != g->patch()->name() ||
+          f->patch()->num_faces() != g->patch()->num_faces())
+         return false;
+   }
+   for (int i=0; i<a->nedges(); i++)
+      if (a->be(i)->is_crease() != b->be(i)->is_crease() ||
+          a->be(i)->is_weak() != b->be(i)->is_weak())
+         return false;
+   return true;
+}
+
+bool
+same_ply_mesh(CBMESHptr& a, CBMESHptr& b)
+{
+   if (!same_locs(a, b) || a->nedges() != b->nedges() || a->type() != b->type())
+      return false;
+   const MeshSnapshot& sa = a->snapshot();
+   const MeshSnapshot& sb = b->snapshot();
+   for (int i=0; i<a->nfaces(); i++)
+      for (int k=0; k<3; k++)
+         if (sa.face_verts(i)[k] != sb.face_verts(i)[k])
+            return false;
+   for (int i=0; i<a->nedges(); i++)
+      if (sa.edge_verts(i)[0] != sb.edge_verts(i)[0] ||
+          sa.edge_verts(i)[1] != sb.edge_verts(i)[1] ||
+          a->be(i)->is_weak() != b->be(i)->is_weak())
+         return false;
+   for (int i=0; i<a->nverts(); i++)
+      if (a->bv(i)->has_color() != b->bv(i)->has_color() ||
+          a->bv(i)->color() != b->bv(i)->color())
+         return false;
+   return true;
+}
+
+/*****************************************************************
+ * Reference results
+ *****************************************************************/
+Bface*
+brute_pick(CBMESHptr& m, CWline& ray, Wpt& hit)
+{
+   Bface* ret = nullptr;
+   double d, min_d = -1;
+   Wpt    h;
+   for (int i=0; i<m->nfaces(); i++) {
+      if (m->bf(i)->ray_intersect(ray, h, d) && (!ret || d < min_d)) {
+         min_d = d;
+         ret   = m->bf(i);
+         hit   = h;
+      }
+   }
+   return ret;
+}
+
+Bvert*
+brute_nearest_vert(CBMESHptr& m, CWpt& p)
+{
+   Bvert* ret = nullptr;
+   double dist = 0, d;
+   for (int i=0; i<m->nverts(); i++) {
+      if ((d = (p - m->bv(i)->loc()).length_sqrd()) < dist || !ret) {
+         ret  = m->bv(i);
+         dist = d;
+      }
+   }
+   return ret;
+}
+
+Bedge*
+brute_nearest_edge(CBMESHptr& m, CWpt& p)
+{
+   Bedge* ret = nullptr;
+   double dist = 0, d;
+   Wpt q;
+   for (int i=0; i<m->nedges(); i++) {
+      if ((d = (p - m->be(i)->project_to_simplex(p, q)).length_sqrd()) < dist
+          || !ret) {
+         ret  = m->be(i);
+         dist = d;
+      }
+   }
+   return ret;
+}
+
+static int
+compare_locs(const Bvert* va, const Bvert* vb)
+{
+   return va->loc()[0] < vb->loc()[0] ||
+      (va->loc()[0] == vb->loc()[0] && (va->loc()[1] < vb->loc()[1] ||
+      (va->loc()[1] == vb->loc()[1] && va->loc()[2] < vb->loc()[2])));
+}
+
+void
+pairwise_weld(BMESHptr m)
+{
+   // the old remove_duplicate_vertices(), minus its messages:
+   Bvert_list verts = m->verts();
+   std::sort(verts.begin(), verts.end(), compare_locs);
+   Bvert* prev = verts[0];
+   for (Bvert_list::size_type k=1; k<verts.size(); k++) {
+      if (verts[k]->loc() == prev->loc())
+         m->merge_vertex(verts[k], prev, false);
+      else
+         prev = verts[k];
+   }
+   m->changed(BMESH::TRIANGULATION_CHANGED);
+}
+
+vector<Bface_list>
+flag_components(BMESHptr m)
+{
+   vector<Bface_list> ret;
+   m->faces().set_flags(1);
+   for (int i=0; i<m->nfaces(); i++) {
+      if (m->bf(i)->flag() == 1) {
+         ret.push_back(Bface_list());
+         ret.back().grow_connected(m->bf(i));
+      }
+   }
+   return ret;
+}
+
+bool
+serial_sil(Bedge* e, CWpt& eye)
+{
+   // Bedge::is_sil() for a mesh with no degenerate faces, with
+   // the eye given instead of taken from the VIEW:
+   if (e->is_border())
+      return true;
+   if (e->is_polyline())
+      return false;
+   return (((eye - e->f1()->v1()->loc()) * e->f1()->norm()) > 0) !=
+          (((eye - e->f2()->v1()->loc()) * e->f2()->norm()) > 0);
+}
+
+bool
+serial_zcross(Bface* f, CWpt& eye)
+{
+   // ZcrossPath::has_sil(), minus the per-frame face marks:
+   double g[3];
+   Wvec n;
+   for (int i=0; i<3; i++) {
+      g[i] = (eye - f->v(i+1)->loc()).normalized() * f->vert_normal(f->v(i+1), n);
+      if (g[i] == 0)
+         g[i] = -1e-8;
+   }
+   return ((g[0] > 0 && (g[1] < 0 || g[2] < 0)) ||
+           (g[0] < 0 && (g[1] > 0 || g[2] > 0)));
+}
+
+bool
+serial_sc_face(BMESHptr m, Bface* f, CWpt& eye, double sc_thresh)
+{
+   double kr[3], num[3], den[3];
+   BMESHcurvature_data* curv = m->curvature();
+   for (int j=0; j<3; j++) {
+      Bvert* v = f->v(j+1);
+      Wvec w = (eye - v->loc()).normalized();
+      double ndotv = v->norm() * w;
+      BMESHcurvature_data::diag_curv_t    dc = curv->diag_curv(v);
+      BMESHcurvature_data::dcurv_tensor_t d  = curv->dcurv_tensor(v);
+      double u = dc.pdir1() * w, u2 = u*u;
+      double s = dc.pdir2() * w, s2 = s*s;
+      kr[j] = dc.k1()*u2 + dc.k2()*s2;
+      num[j] = 0;
+      if (u2 + s2 > 0) {
+         double csc2theta = 1.0/(u2 + s2);
+         num[j] = (u*u2*d[0] + 3*u2*s*d[1] + 3*s2*u*d[2] + s*s2*d[3])*csc2theta;
+         double tr = (dc.k2() - dc.k1())*u*s*csc2theta;
+         num[j] -= 2*ndotv*tr*tr;
+      }
+      num[j] -= ndotv*sc_thresh;
+      den[j] = ndotv;
+      if (kr[j] == 0)
+         kr[j] = 1e-8;
+   }
+   if (den[0] <= 0 && den[1] <= 0 && den[2] <= 0)
+      return false;
+   bool all_neg = true, all_pos = true;
+   for (int j=0; j<3; j++) {
+      all_neg = all_neg && (num[j] <= 0 && den[j] >= 0);
+      all_pos = all_pos && (num[j] >= 0 && den[j] <= 0);
+   }
+   if (all_neg || all_pos)
+      return false;
+   return (kr[0] > 0) != (kr[1] > 0) || (kr[0] > 0) != (kr[2] > 0);
+}
+
+/*****************************************************************
+ * Records
+ *****************************************************************/
+class TagRecordTag : public TAG {
+ public:
+   TagRecordTag(const string& name, int i) : _name(name), _i(i) {}
+   virtual STDdstream& format(CDATA_ITEM* me, STDdstream& ds) {
+      TAGformat d(&ds, _name, 0);
+      d.id() << ((const TagRecord*)me)->_v[_i];
+      return ds;
+   }
+   virtual STDdstream& decode(CDATA_ITEM* me, STDdstream& ds) {
+      return ds >> ((TagRecord*)me)->_v[_i];
+   }
+   virtual const string& name() const { return _name; }
+ protected:
+   string _name;
+   int    _i;
+};
+
+TagRecord::TagRecord()
+{
+   for (auto& v : _v)
+      v = drand48();
+}
+
+CTAGlist&
+TagRecord::tags() const
+{
+   static TAGlist* tags = nullptr;
+   if (!tags) {
+      tags = new TAGlist;
+      for (int i=0; i<NUM_TAGS; i++) {
+         char name[64];
+         sprintf(name, "light_attribute_%d", i);
+         tags->push_back(new TagRecordTag(name, i));
+      }
+   }
+   return *tags;
+}
+
+/*****************************************************************
+ * Keys
+ *****************************************************************/
+vector<uintptr_t>
+key_all(CBMESHptr& m, const string& what)
+{
+   vector<uintptr_t> ret;
+   bool ok = true;
+   for (int i=0; i<m->nverts(); i++)
+      ret.push_back(m->bv(i)->key());
+   for (int i=0; i<m->nedges(); i++)
+      ret.push_back(m->be(i)->key());
+   for (int i=0; i<m->nfaces(); i++)
+      ret.push_back(m->bf(i)->key());
+   size_t k = 0;
+   for (int i=0; i<m->nverts(); i++)
+      ok = ok && Bsimplex::lookup(ret[k++]) == m->bv(i);
+   for (int i=0; i<m->nedges(); i++)
+      ok = ok && Bsimplex::lookup(ret[k++]) == m->be(i);
+   for (int i=0; i<m->nfaces(); i++)
+      ok = ok && Bsimplex::lookup(ret[k++]) == m->bf(i);
+   check(ok, what + ": keys find their elements");
+   return ret;
+}
+
+void
+check_stale(BMESHptr& m, const vector<uintptr_t>& keys, const string& what)
+{
+   // (patches hold their mesh, so they go first)
+   m->delete_patches();
+   m.reset();
+   bool ok = true;
+   for (auto k : keys)
+      ok = ok && !Bsimplex::lookup(k);
+   check(ok, what + ": keys find nothing once the mesh is gone");
+}
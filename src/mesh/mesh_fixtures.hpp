@@ -0,0 +1,208 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef MESH_FIXTURES_H_IS_INCLUDED
+#define MESH_FIXTURES_H_IS_INCLUDED
+
+#include "mesh/lmesh.hpp"
+
+/*****************************************************************
+ * mesh_fixtures:
+ *
+ *      What the regression tests in this directory (test_*.cpp)
+ *      and bench_mesh share: checks, the meshes they run on, and
+ *      ways to compare results.
+ *****************************************************************/
+
+//******** CHECKS ********
+
+// Counts a failed check, printing what failed:
+void check(bool ok, const string& what);
+
+// Prints how many checks failed, and returns the exit status
+// for main():
+int  check_summary();
+
+//******** MESHES ********
+
+// A regular grid of 2*n*n triangles, as flat arrays:
+void grid(int n, Wpt_list& pts, vector<Point3i>& tris);
+
+// The grid with every triangle given its own 3 vertices (each
+// moved by up to jitter in x and y), as a BMESH:
+BMESHptr soup(int n, double jitter);
+
+// The subdivided icosahedron, copied into a plain BMESH:
+BMESHptr plain_sphere(int level);
+
+// plain_sphere() with bumps pushed in and out (a stand-in for a
+// scanned model, with fine detail in the normals):
+BMESHptr bumpy_sphere(int level);
+
+// bumpy_sphere(2), as a Loop control mesh (not yet subdivided):
+LMESHptr bumpy_lmesh();
+
+// An irregular "scanned" mesh: a jittered n x n grid cut into
+// triangles along random diagonals, with the triangles added in
+// random order, split into 4 patches (by quadrant):
+BMESHptr scanned_mesh(int n);
+
+// Writes an .obj file of an n x n jittered grid of quads and
+// triangles, with texture coordinates (x/n, y/n) and normals,
+// 4 materials (by quadrant), negative indices, comments, a group
+// and line continuations. Normals differ across the middle row
+// of vertices, making creases there:
+void write_obj(const string& name, int n);
+
+// An n x n jittered grid of quads and triangles with random
+// vertex colors, as PLY data (positions, colors, and faces), and
+// the mesh ply2sm makes of it: faces reversed, quads split
+// along a weak edge:
+BMESHptr ply_grid(int n, vector<float>& xyz, vector<unsigned char>& rgb,
+                  vector<vector<int>>& faces);
+
+// Writes a PLY file of the given data in the given format
+// ("ascii", "binary_little_endian" or "binary_big_endian"), with
+// vertex normals, a confidence, a face property before the
+// vertex list and an extra element, for a reader to skip:
+void write_ply(const string& name, const char* format,
+               const vector<float>& xyz, const vector<unsigned char>& rgb,
+               const vector<vector<int>>& faces);
+
+// Writes num_meshes jittered n x n grids to .sm files (named
+// after the scene file), and a scene file naming each with a
+// "mesh_data_file" tag of a TEXBODY. Returns the .sm file names:
+vector<string> write_grid_scene(const string& scene, int n, int num_meshes);
+
+// Pushes out the vertices of a sphere near a "brush" that goes
+// around it in num_frames frames (this is the given one), then
+// tells the mesh they moved:
+void brush_stroke(BMESHptr m, int frame, int num_frames);
+
+// BMESH::Icosahedron() with Loop subdivision, subdivided to the
+// given level:
+LMESHptr subdiv_icosahedron(int level);
+
+// A control mesh, subdivided to the given level: a cube with
+// Catmull-Clark subdivision if quads is set, otherwise an
+// icosahedron with Loop subdivision. Updates go through the
+// SubdivStencils tables if stencils is set:
+LMESHptr anim_lmesh(bool quads, int level, bool stencils);
+
+// Moves each control vertex of ctrl from its rest position by a
+// wave that travels with the frame number, then tells the mesh
+// they moved:
+void wave(LMESHptr ctrl, const Wpt_list& rest, int frame);
+
+//******** COMPARISONS ********
+
+// Same number of vertices and faces, and vertices (exactly) in
+// the same places:
+bool same_locs(CBMESHptr& a, CBMESHptr& b);
+
+// Same curvature (exactly) at v:
+bool same_curvature(BMESHcurvature_data* a, BMESHcurvature_data* b, CBvert* v);
+
+// Same type, elements (by their vertices), UVs, creases, weak
+// edges, colors, secondary faces and shadow settings, to within
+// tol, and if check_patches is set, faces in the same patches.
+// Prints the first difference.
+//
+// (The .sm text format numbers a patch's faces in the original
+// face order, but writes each quad as one 4-gon that is read
+// back as 2 consecutive faces; with quads made of scattered
+// triangles those numbers end up naming other faces. So patches
+// can only be checked for binary files.)
+bool same_mesh(CBMESHptr& a, CBMESHptr& b, double tol, bool check_patches);
+
+// Same vertices, faces (in order), UVs, patches (by name and
+// size), creases and weak edges, exactly, as two OBJReaders
+// must build from the same file:
+bool same_obj_mesh(CBMESHptr& a, CBMESHptr& b);
+
+// Same type, vertices, faces and edges (in order), weak edges
+// and colors, exactly, as meshes loaded from PLY files must be
+// (and meshes decoded from the same file):
+bool same_ply_mesh(CBMESHptr& a, CBMESHptr& b);
+
+//******** REFERENCE RESULTS ********
+
+// The straightforward way to compute what an optimized routine
+// computes, to check it against (and time it against):
+
+// Nearest face hit by the ray, by a loop over all faces (as
+// BMESH::pick_face() used to do):
+Bface* brute_pick(CBMESHptr& m, CWline& ray, Wpt& hit);
+
+// Nearest vertex and edge to p, by a loop over all of them (as
+// BMESH::nearest_vert() and nearest_edge() used to do):
+Bvert* brute_nearest_vert(CBMESHptr& m, CWpt& p);
+Bedge* brute_nearest_edge(CBMESHptr& m, CWpt& p);
+
+// Merges vertices at identical positions one pair at a time (as
+// remove_duplicate_vertices() used to do before weld_vertices()):
+void pairwise_weld(BMESHptr m);
+
+// Connected components, found by clearing face flags and growing
+// from each face still flagged (as get_components() used to do):
+vector<Bface_list> flag_components(BMESHptr m);
+
+// Bedge::is_sil() for a mesh with no degenerate faces, with the
+// eye given instead of taken from the VIEW (as the brute-force
+// get_sil_strips() used it):
+bool serial_sil(Bedge* e, CWpt& eye);
+
+// ZcrossPath::has_sil(), minus the per-frame face marks:
+bool serial_zcross(Bface* f, CWpt& eye);
+
+// Whether a suggestive contour crosses f, seen from eye: the
+// radial curvature and suggestive contour test of the line
+// drawing shader, evaluated per vertex through the Bvert lookups
+// of BMESHcurvature_data (sc_thresh is FeatureLines::sug_thresh(),
+// divided by the squared feature size):
+bool serial_sc_face(BMESHptr m, Bface* f, CWpt& eye, double sc_thresh);
+
+//******** RECORDS ********
+
+// A DATA_ITEM with a double under each of NUM_TAGS tags (as many
+// as VIEW has), starting out random, to read and write records
+// made mostly of tag names:
+class TagRecord : public DATA_ITEM {
+ public:
+   enum { NUM_TAGS = 40 };
+
+   TagRecord();
+
+   DEFINE_RTTI_METHODS2("TagRecord", DATA_ITEM, CDATA_ITEM*);
+   virtual DATA_ITEM* dup() const { return new TagRecord; }
+   virtual CTAGlist&  tags() const;
+
+   double _v[NUM_TAGS];
+};
+
+//******** KEYS ********
+
+// Keys every element of m, checking each finds its element,
+// and returns the keys:
+vector<uintptr_t> key_all(CBMESHptr& m, const string& what);
+
+// Drops the last reference to m, then checks its keys find
+// nothing:
+void check_stale(BMESHptr& m, const vector<uintptr_t>& keys,
+                 const string& what);
+
+#endif // MESH_FIXTURES_H_IS_INCLUDED
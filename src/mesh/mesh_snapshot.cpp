@@ -0,0 +1,152 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "std/parallel.hpp"
+#include "mesh/bmesh.hpp"
+#include "mesh/mesh_snapshot.hpp"
+
+#include <algorithm>
+
+MeshSnapshot::MeshSnapshot(CBMESH& mesh) :
+   _nv(mesh.nverts()),
+   _ne(mesh.nedges()),
+   _nf(mesh.nfaces()),
+   _positions_valid(false)
+{
+   build_index(mesh.verts(), _vert_index);
+   build_index(mesh.edges(), _edge_index);
+   build_index(mesh.faces(), _face_index);
+
+   // faces:
+   _face_verts.resize(3*_nf);
+   _face_edges.resize(3*_nf);
+   for (int f=0; f<_nf; f++) {
+      Bface* face = mesh.bf(f);
+      for (int k=0; k<3; k++) {
+         _face_verts[3*f + k] = index(face->v(k+1));
+         _face_edges[3*f + k] = index(face->e(k+1));
+      }
+   }
+
+   // edges, and the count of edges at each vertex:
+   _edge_verts.resize(2*_ne);
+   _edge_faces.resize(2*_ne);
+   _vert_edge_off.assign(_nv + 1, 0);
+   for (int e=0; e<_ne; e++) {
+      Bedge* edge = mesh.be(e);
+      int v1 = index(edge->v1()), v2 = index(edge->v2());
+      _edge_verts[2*e    ] = v1;
+      _edge_verts[2*e + 1] = v2;
+      _edge_faces[2*e    ] = edge->f1() ? index(edge->f1()) : -1;
+      _edge_faces[2*e + 1] = edge->f2() ? index(edge->f2()) : -1;
+      _vert_edge_off[v1 + 1]++;
+      _vert_edge_off[v2 + 1]++;
+   }
+   for (int v=0; v<_nv; v++)
+      _vert_edge_off[v + 1] += _vert_edge_off[v];
+
+   // edges around each vertex, in adjacency list order:
+   _vert_edges.resize(_vert_edge_off[_nv]);
+   for (int v=0; v<_nv; v++) {
+      CBedge_list& adj = mesh.bv(v)->get_adj();
+      int* out = _vert_edges.data() + _vert_edge_off[v];
+      for (Bedge_list::size_type k=0; k<adj.size(); k++)
+         out[k] = index(adj[k]);
+   }
+
+   update_positions(mesh);
+}
+
+template <class L>
+void
+MeshSnapshot::build_index(const L& list, index_map_t& ret)
+{
+   ret.resize(list.size());
+   for (typename L::size_type i=0; i<list.size(); i++)
+      ret[i] = make_pair((CBsimplex*)list[i], int(i));
+   sort(ret.begin(), ret.end());
+}
+
+int
+MeshSnapshot::lookup(const index_map_t& m, CBsimplex* s)
+{
+   index_map_t::const_iterator it =
+      lower_bound(m.begin(), m.end(), make_pair(s, -1));
+   return (it != m.end() && it->first == s) ? it->second : -1;
+}
+
+bool
+MeshSnapshot::matches(CBMESH& mesh) const
+{
+   return (_nv == mesh.nverts() &&
+           _ne == mesh.nedges() &&
+           _nf == mesh.nfaces());
+}
+
+void
+MeshSnapshot::update_positions(CBMESH& mesh)
+{
+   assert(matches(mesh));
+
+   const int grain = 4096;
+
+   _x.resize(_nv);
+   _y.resize(_nv);
+   _z.resize(_nv);
+   parallel_for(_nv, grain, [&](int begin, int end) {
+      for (int v=begin; v<end; v++) {
+         CWpt& p = mesh.bv(v)->loc();
+         _x[v] = p[0];
+         _y[v] = p[1];
+         _z[v] = p[2];
+      }
+   });
+
+   _nx.resize(_nf);
+   _ny.resize(_nf);
+   _nz.resize(_nf);
+   _area.resize(_nf);
+   parallel_for(_nf, grain, [this](int begin, int end) {
+      compute_normals(begin, end);
+   });
+   _positions_valid = true;
+}
+
+void
+MeshSnapshot::compute_normals(int begin, int end)
+{
+   // Same as Bface::set_normal(): the normal is cross(v2 - v1, v3 - v1),
+   // normalized, and the area is half the length of the cross product.
+   const int* fv = _face_verts.data() + 3*begin;
+   for (int f=begin; f<end; f++, fv += 3) {
+      double ax = _x[fv[1]] - _x[fv[0]];
+      double ay = _y[fv[1]] - _y[fv[0]];
+      double az = _z[fv[1]] - _z[fv[0]];
+      double bx = _x[fv[2]] - _x[fv[0]];
+      double by = _y[fv[2]] - _y[fv[0]];
+      double bz = _z[fv[2]] - _z[fv[0]];
+      double nx = ay*bz - az*by;
+      double ny = az*bx - ax*bz;
+      double nz = ax*by - ay*bx;
+      double l  = sqrt(nx*nx + ny*ny + nz*nz);
+      double s  = (l > 0) ? 1/l : 0;
+      _nx[f] = nx*s;
+      _ny[f] = ny*s;
+      _nz[f] = nz*s;
+      _area[f] = 0.5*l;
+   }
+}
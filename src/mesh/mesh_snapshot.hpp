@@ -0,0 +1,142 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef MESH_SNAPSHOT_H_IS_INCLUDED
+#define MESH_SNAPSHOT_H_IS_INCLUDED
+
+#include "mesh/bsimplex.hpp"
+#include "mlib/points.hpp"
+
+#include <utility>
+#include <vector>
+
+class BMESH;
+typedef const BMESH CBMESH;
+
+/*****************************************************************
+ * MeshSnapshot:
+ *
+ *      Read-only copy of a BMESH in flat arrays, for analysis
+ *      loops (normals, silhouettes, curvature, picking) that
+ *      would otherwise chase Bvert/Bedge/Bface pointers.
+ *
+ *      Elements are named by their index in the mesh's vertex,
+ *      edge and face lists. Topology is kept as index arrays,
+ *      with the edges around each vertex in CSR form (an offset
+ *      per vertex into one packed list). Vertex positions and
+ *      unit face normals are kept as one array per coordinate.
+ *
+ *      Get one from BMESH::snapshot(). The mesh throws it away
+ *      when its topology or triangulation changes, and re-reads
+ *      positions after VERT_POSITIONS_CHANGED. Subsystems opt in
+ *      by calling BMESH::snapshot() instead of walking elements.
+ *****************************************************************/
+class MeshSnapshot {
+ public:
+
+   //******** MANAGERS ********
+
+   MeshSnapshot(CBMESH& mesh);
+
+   //******** SIZES ********
+
+   int nverts() const { return _nv; }
+   int nedges() const { return _ne; }
+   int nfaces() const { return _nf; }
+
+   //******** ELEMENT INDICES ********
+
+   // Index of a simplex in its mesh list, or -1 if not found:
+   int index(CBvert* v) const { return lookup(_vert_index, (CBsimplex*)v); }
+   int index(CBedge* e) const { return lookup(_edge_index, (CBsimplex*)e); }
+   int index(CBface* f) const { return lookup(_face_index, (CBsimplex*)f); }
+
+   //******** TOPOLOGY ********
+
+   // Vertices (v1, v2, v3) and edges (e1, e2, e3) of a face:
+   const int* face_verts(int f) const { return &_face_verts[3*f]; }
+   const int* face_edges(int f) const { return &_face_edges[3*f]; }
+
+   // Vertices (v1, v2) of an edge, and its primary faces (f1, f2),
+   // with -1 for a missing face. Secondary faces of non-manifold
+   // edges are not included:
+   const int* edge_verts(int e) const { return &_edge_verts[2*e]; }
+   const int* edge_faces(int e) const { return &_edge_faces[2*e]; }
+
+   // Edges adjacent to a vertex, in the order of Bvert::get_adj():
+   int degree(int v) const { return _vert_edge_off[v+1] - _vert_edge_off[v]; }
+   const int* vert_edges(int v) const { return _vert_edges.data() + _vert_edge_off[v]; }
+
+   //******** GEOMETRY ********
+
+   // Vertex positions:
+   const double* x() const { return _x.data(); }
+   const double* y() const { return _y.data(); }
+   const double* z() const { return _z.data(); }
+   Wpt loc(int v) const { return Wpt(_x[v], _y[v], _z[v]); }
+
+   // Unit face normals (zero for degenerate faces):
+   const double* nx() const { return _nx.data(); }
+   const double* ny() const { return _ny.data(); }
+   const double* nz() const { return _nz.data(); }
+   Wvec norm(int f) const { return Wvec(_nx[f], _ny[f], _nz[f]); }
+
+   // Face areas:
+   const double* areas() const { return _area.data(); }
+   double area(int f)    const { return _area[f]; }
+
+   // Vertex positions moved; positions and normals are stale
+   // until update_positions() is called (BMESH::snapshot() does):
+   void positions_changed()        { _positions_valid = false; }
+   bool positions_valid()    const { return _positions_valid; }
+   void update_positions(CBMESH& mesh);
+
+   // Do the element counts still match the mesh?
+   bool matches(CBMESH& mesh) const;
+
+ protected:
+   typedef vector<pair<CBsimplex*,int> > index_map_t;
+
+   int          _nv, _ne, _nf;
+
+   // sorted (simplex, index) pairs for index():
+   index_map_t  _vert_index;
+   index_map_t  _edge_index;
+   index_map_t  _face_index;
+
+   vector<int>  _face_verts;    // 3 per face
+   vector<int>  _face_edges;    // 3 per face
+   vector<int>  _edge_verts;    // 2 per edge
+   vector<int>  _edge_faces;    // 2 per edge
+   vector<int>  _vert_edge_off; // nverts + 1 offsets into _vert_edges
+   vector<int>  _vert_edges;    // 2 per edge
+
+   vector<double> _x, _y, _z;       // vertex positions
+   vector<double> _nx, _ny, _nz;    // face normals
+   vector<double> _area;            // face areas
+   bool           _positions_valid;
+
+   //******** INTERNAL METHODS ********
+
+   template <class L>
+   static void build_index(const L& list, index_map_t& ret);
+   static int  lookup(const index_map_t& m, CBsimplex* s);
+
+   void compute_normals(int begin, int end);
+};
+
+#endif // MESH_SNAPSHOT_H_IS_INCLUDED
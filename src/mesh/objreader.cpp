@@ -30,11 +30,19 @@
 #include <map>
 #include <limits>
 #include <algorithm>
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
 
 using namespace std;
 
+#include "std/file.hpp"
+#include "std/parallel.hpp"
 #include "geom/texturegl.hpp"
 #include "mesh/bmesh.hpp"
+#include "mesh/lmesh.hpp"
+#include "mesh/uv_data.hpp"
 
 using namespace mlib;
 
@@ -288,6 +296,8 @@ class OBJFace {
    bool has_texcoords() const { return num_texcoords() > 0; }
    bool has_normals() const { return num_normals() > 0; }
       
+   long get_mtl_index() const { return mtl_index; }
+      
    bool add_vertex(long vertex, unsigned long total_vertices);
    bool add_texcoord(long texcoord, unsigned long total_texcoords);
    bool add_normal(long normal, unsigned long total_normals);
@@ -755,6 +765,8 @@ class OBJReaderImpl {
       
    bool read(istream &in);
       
+   bool read(const char *data, size_t size);
+      
    BMESHptr get_mesh() const;
       
    void get_mesh(BMESHptr mesh) const;
@@ -765,6 +777,8 @@ class OBJReaderImpl {
       
    Reader<OBJReaderImpl> reader;
       
+   void reset();
+      
    bool read_mtl_files();
       
    //! \name Element Reading Functions
@@ -809,11 +823,13 @@ class OBJReaderImpl {
 
    void set_vert_normals(BMESHptr mesh) const;
       
-   void add_face(BMESHptr mesh, Patch *patch, unsigned long index) const;
+   void add_face(Patch *patch, unsigned long index) const;
       
-   void add_tri(BMESHptr mesh, Patch *patch, const OBJFace &face,
+   void add_tri(Patch *patch, const OBJFace &face,
                 unsigned long idx0, unsigned long idx1, unsigned long idx2) const;
       
+   void build_faces(BMESHptr mesh) const;
+      
    void add_creases(BMESHptr mesh) const;
       
    //@}
@@ -824,6 +840,15 @@ class OBJReaderImpl {
    //! Lookup .obj face index from mesh face index:
    mutable vector<unsigned long> mesh_faces2obj_faces;
       
+   //! Triangles gathered for BMESH::add_faces(), with the patch and
+   //! (1-based) texture coordinate indices of each (0 if none):
+   mutable vector<Point3i> mesh_tris;
+   mutable vector<Patch*>  mesh_tri_patches;
+   mutable vector<Point3i> mesh_tri_texcoords;
+      
+   //! Quad diagonals to mark as weak (vertex indices):
+   mutable vector<Point2i> mesh_weak_edges;
+      
    //@}
 
 };
@@ -847,7 +872,22 @@ bool
 OBJReaderImpl::read(istream &in)
 {
    
-   // Reset reader state:
+   reset();
+   
+   read_succeeded = reader.read(in, this);
+   
+   // Make sure we have a face list for each material:
+   assert(materials.size() == material_faces.size());
+   
+   read_succeeded = read_succeeded && read_mtl_files();
+   
+   return read_succeeded;
+   
+}
+      
+void
+OBJReaderImpl::reset()
+{
    
    read_succeeded = false;
    
@@ -857,6 +897,7 @@ OBJReaderImpl::read(istream &in)
    faces.clear();
    mtl_files.clear();
    materials.clear();
+   material_faces.clear();
    mtl_name2id.clear();
    
    // Create default material (note that it is not in the name to id map because
@@ -865,17 +906,8 @@ OBJReaderImpl::read(istream &in)
    material_faces.push_back(vector<long>());
    current_material = 0;
    
-   read_succeeded = reader.read(in, this);
-   
-   // Make sure we have a face list for each material:
-   assert(materials.size() == material_faces.size());
-   
-   read_succeeded = read_succeeded && read_mtl_files();
-   
-   return read_succeeded;
-   
 }
-      
+
 BMESHptr
 OBJReaderImpl::get_mesh() const
 {
@@ -903,6 +935,10 @@ OBJReaderImpl::get_mesh(BMESHptr mesh) const
    
    // Clear mesh builder state:
    mesh_faces2obj_faces.clear();
+   mesh_tris.clear();
+   mesh_tri_patches.clear();
+   mesh_tri_texcoords.clear();
+   mesh_weak_edges.clear();
    
    // Fill the mesh with the new data:
    
@@ -1183,9 +1219,51 @@ OBJReaderImpl::add_patches(BMESHptr mesh) const
       }
 */      
       for (auto & face : material_faces[i])
-         add_face(mesh, patch, face);
+         add_face(patch, face);
       
    }
+   
+   build_faces(mesh);
+}
+
+/*!
+ *  \brief Creates the triangles gathered by add_face() in one pass with
+ *  BMESH::add_faces(), then assigns texture coordinates and marks quad
+ *  diagonals as "weak".
+ *
+ */
+void
+OBJReaderImpl::build_faces(BMESHptr mesh) const
+{
+   
+   Bface_list mesh_faces = mesh->add_faces(mesh_tris, mesh_tri_patches);
+   
+   for(Bface_list::size_type t = 0; t < mesh_faces.size(); ++t){
+      
+      const Point3i &tc = mesh_tri_texcoords[t];
+      
+      if(mesh_faces[t] && tc[0] > 0){
+         
+         const Point3i &tri = mesh_tris[t];
+         
+         UVdata::set(mesh_faces[t],
+                     mesh->bv(tri[0]), mesh->bv(tri[1]), mesh->bv(tri[2]),
+                     texcoords[tc[0] - 1],
+                     texcoords[tc[1] - 1],
+                     texcoords[tc[2] - 1]);
+         
+      }
+      
+   }
+   
+   for (auto & weak : mesh_weak_edges) {
+      
+      Bedge* e = lookup_edge(mesh->bv(weak[0]), mesh->bv(weak[1]));
+      assert(e);
+      e->set_bit(Bedge::WEAK_BIT);
+      
+   }
+   
 }
 
 void
@@ -1204,38 +1282,37 @@ OBJReaderImpl::set_vert_normals(BMESHptr mesh) const
 }
 
 void
-OBJReaderImpl::add_face(BMESHptr mesh, Patch *patch, unsigned long index) const
+OBJReaderImpl::add_face(Patch *patch, unsigned long index) const
 {
    
    assert(faces[index].good());
 
    for(unsigned long k = 2; k < faces[index].num_vertices(); ++k){
       
-      add_tri(mesh, patch, faces[index], 0, k-1, k);
+      add_tri(patch, faces[index], 0, k-1, k);
       mesh_faces2obj_faces.push_back(index);
       
    }
    
-   // If the face is a quad, mark the quad diagonal as "weak":
+   // If the face is a quad, the quad diagonal will be marked "weak":
    if (faces[index].num_vertices() == 4) {
       
-      Bedge* e = lookup_edge(mesh->bv(faces[index].get_vertex_idx(0) - 1),
-                             mesh->bv(faces[index].get_vertex_idx(2) - 1));
-      assert(e);
-      e->set_bit(Bedge::WEAK_BIT);
+      mesh_weak_edges.push_back(Point2i(faces[index].get_vertex_idx(0) - 1,
+                                        faces[index].get_vertex_idx(2) - 1));
       
    }
    
 }
 
 /*!
- *  \brief Adds a triangle to BMESH \p mesh and Patch \p patch from the OBJFace
- *  \p face.  \p idx0, \p idx1 and \p idx2 are the indices (with respect to the
- *  face) of the three vertices that make up the triangle.
+ *  \brief Gathers a triangle for Patch \p patch from the OBJFace \p face,
+ *  to be created later by build_faces().  \p idx0, \p idx1 and \p idx2 are
+ *  the indices (with respect to the face) of the three vertices that make up
+ *  the triangle.
  *
  */
 void
-OBJReaderImpl::add_tri(BMESHptr mesh, Patch *patch, const OBJFace &face,
+OBJReaderImpl::add_tri(Patch *patch, const OBJFace &face,
                        unsigned long idx0, unsigned long idx1, unsigned long idx2) const
 {
    
@@ -1265,22 +1342,20 @@ OBJReaderImpl::add_tri(BMESHptr mesh, Patch *patch, const OBJFace &face,
            (face.get_normal_idx(idx2) > 0) &&
            (face.get_normal_idx(idx2) <= normals.size())));
    
+   mesh_tris.push_back(Point3i(face.get_vertex_idx(idx0) - 1,
+                               face.get_vertex_idx(idx1) - 1,
+                               face.get_vertex_idx(idx2) - 1));
+   mesh_tri_patches.push_back(patch);
+   
    if(face.has_texcoords()){
       
-      mesh->add_face(face.get_vertex_idx(idx0) - 1,
-                     face.get_vertex_idx(idx1) - 1,
-                     face.get_vertex_idx(idx2) - 1,
-                     texcoords[face.get_texcoord_idx(idx0) - 1],
-                     texcoords[face.get_texcoord_idx(idx1) - 1],
-                     texcoords[face.get_texcoord_idx(idx2) - 1],
-                     patch);
+      mesh_tri_texcoords.push_back(Point3i(face.get_texcoord_idx(idx0),
+                                           face.get_texcoord_idx(idx1),
+                                           face.get_texcoord_idx(idx2)));
       
    } else {
       
-      mesh->add_face(face.get_vertex_idx(idx0) - 1,
-                     face.get_vertex_idx(idx1) - 1,
-                     face.get_vertex_idx(idx2) - 1,
-                     patch);
+      mesh_tri_texcoords.push_back(Point3i(0, 0, 0));
       
    }
    
@@ -1290,6 +1365,12 @@ void
 OBJReaderImpl::add_creases(BMESHptr mesh) const
 {
    
+   // Element indices come from the snapshot (Bsimplex::index() searches
+   // the mesh's lists), and creases are set after it's no longer needed:
+   const MeshSnapshot &snap = mesh->snapshot();
+   
+   Bedge_list creases;
+   
    for(int ei = 0; ei < mesh->nedges(); ++ei){
       
       Bedge *cur_edge = mesh->be(ei);
@@ -1299,25 +1380,23 @@ OBJReaderImpl::add_creases(BMESHptr mesh) const
          continue;
       
       // Skip edges that inside a single obj face:
-      if(mesh_faces2obj_faces[cur_edge->f1()->index()] ==
-         mesh_faces2obj_faces[cur_edge->f2()->index()])
+      if(mesh_faces2obj_faces[snap.index(cur_edge->f1())] ==
+         mesh_faces2obj_faces[snap.index(cur_edge->f2())])
          continue;
       
       // Skip edges adjacent to faces that have no normals:
-      if(!faces[mesh_faces2obj_faces[cur_edge->f1()->index()]].has_normals() ||
-         !faces[mesh_faces2obj_faces[cur_edge->f2()->index()]].has_normals())
+      if(!faces[mesh_faces2obj_faces[snap.index(cur_edge->f1())]].has_normals() ||
+         !faces[mesh_faces2obj_faces[snap.index(cur_edge->f2())]].has_normals())
          continue;
       
-      int vertex_indices[2];
-      vertex_indices[0] = cur_edge->v1()->index();
-      vertex_indices[1] = cur_edge->v2()->index();
+      const int *vertex_indices = snap.edge_verts(ei);
       
       // Indexed by vertex, then by face:
       int normal_indices[2][2] = {{-1, -1}, {-1, -1}};
       
       for(int fi = 0; fi < 2; ++fi){
          
-         unsigned long obj_face_idx = mesh_faces2obj_faces[cur_edge->f(fi + 1)->index()];
+         unsigned long obj_face_idx = mesh_faces2obj_faces[snap.index(cur_edge->f(fi + 1))];
          
          for (uint vi = 0; vi < faces[obj_face_idx].num_vertices(); ++vi){
             
@@ -1346,12 +1425,582 @@ OBJReaderImpl::add_creases(BMESHptr mesh) const
       if((normal_indices[0][0] != normal_indices[0][1]) ||
          (normal_indices[1][0] != normal_indices[1][1])){
          
-         cur_edge->set_crease();
+         creases.push_back(cur_edge);
          
       }
       
    }
    
+   for (auto &e : creases)
+      e->set_crease();
+   
+}
+
+//----------------------------------------------------------------------------//
+
+/*!
+ *  \brief Helpers for reading .obj data held in memory (see OBJChunk).  Each
+ *  takes characters from \p p up to \p end, advancing \p p.
+ *
+ */
+inline bool
+is_space(char c)
+{
+   
+   return isspace(static_cast<unsigned char>(c)) != 0;
+   
+}
+
+/*!
+ *  \brief Reads a number the way istream extraction does: skips white space,
+ *  takes a sign, digits and (if \p real) a decimal point and exponent, then
+ *  converts them, failing if there were no digits or the conversion doesn't
+ *  take them all.  \p point is the decimal point strtod() expects (the C
+ *  locale's), so the file's '.' is read right whatever the locale.
+ *
+ */
+static bool
+parse_number(const char *&p, const char *end, bool real, char point,
+             double *dval, long *lval)
+{
+   
+   while((p < end) && is_space(*p))
+      ++p;
+   
+   char buf[128];
+   int n = 0;
+   bool digits = false, dot = false, exp = false;
+   
+   auto take = [&](char c) {
+      if(n < int(sizeof(buf)) - 1)
+         buf[n++] = c;
+      ++p;
+   };
+   
+   if((p < end) && ((*p == '+') || (*p == '-')))
+      take(*p);
+   
+   while(p < end){
+      
+      if(isdigit(static_cast<unsigned char>(*p))){
+         digits = true;
+         take(*p);
+      } else if(real && (*p == '.') && !dot && !exp){
+         dot = true;
+         take(point);
+      } else if(real && ((*p == 'e') || (*p == 'E')) && digits && !exp){
+         exp = true;
+         take(*p);
+         if((p < end) && ((*p == '+') || (*p == '-')))
+            take(*p);
+      } else {
+         break;
+      }
+      
+   }
+   
+   buf[n] = '\0';
+   
+   if(!digits)
+      return false;
+   
+   char *conv_end = nullptr;
+   errno = 0;
+   
+   if(real)
+      *dval = strtod(buf, &conv_end);
+   else
+      *lval = strtol(buf, &conv_end, 10);
+   
+   return (*conv_end == '\0') && (errno != ERANGE);
+   
+}
+
+inline bool
+parse_double(const char *&p, const char *end, char point, double &val)
+{
+   
+   return parse_number(p, end, true, point, &val, nullptr);
+   
+}
+
+inline bool
+parse_long(const char *&p, const char *end, long &val)
+{
+   
+   return parse_number(p, end, false, '.', nullptr, &val);
+   
+}
+
+/*!
+ *  \brief Takes the next white space delimited word (empty if there is none).
+ *
+ */
+inline string
+parse_word(const char *&p, const char *end)
+{
+   
+   while((p < end) && is_space(*p))
+      ++p;
+   
+   const char *start = p;
+   
+   while((p < end) && !is_space(*p))
+      ++p;
+   
+   return string(start, p);
+   
+}
+
+/*!
+ *  \brief Moves \p p past the next new-line (like eat_line()).
+ *
+ */
+inline void
+skip_line(const char *&p, const char *end)
+{
+   
+   const char *nl = static_cast<const char*>(memchr(p, '\n', end - p));
+   
+   p = nl ? nl + 1 : end;
+   
+}
+
+/*!
+ *  \brief The elements of one piece of a .obj file held in memory, read on
+ *  its own thread by OBJReaderImpl::read(const char*, size_t).
+ *
+ *  Elements are recognized and read as Reader and the OBJReaderImpl element
+ *  reading functions do, but what depends on the rest of the file is only
+ *  recorded: face indices are kept as written, with the numbers of vertices,
+ *  texture coordinates and normals read so far in this piece, and materials
+ *  are kept by name.  OBJReaderImpl puts the pieces together in order.
+ *
+ */
+class OBJChunk {
+   
+ public:
+      
+   OBJChunk()
+      : failed(false)
+      { }
+      
+   void parse(const char *begin, const char *end, char point);
+      
+   //! One corner of a face, with indices as written (0 if not given):
+   struct corner_t {
+      long vertex, texcoord, normal;
+   };
+      
+   //! A face: its corners, material (index into usemtls, or -1 for the one
+   //! in use when the piece starts), and how many vertices, texture
+   //! coordinates and normals came before it in this piece:
+   struct face_t {
+      size_t first_corner;
+      unsigned long num_corners;
+      long mtl;
+      unsigned long num_vertices, num_texcoords, num_normals;
+   };
+      
+   vector<Wpt> vertices;
+   vector<Wvec> normals;
+   vector<UVpt> texcoords;
+   vector<face_t> faces;
+   vector<corner_t> corners;
+      
+   vector<string> usemtls;        //!< Names in 'usemtl' elements, in order
+   vector<string> mtl_files;
+   vector<string> skipped;        //!< Tokens of elements that were skipped
+      
+   bool failed;                   //!< Stopped at an element that failed
+   string failed_token;
+      
+ private:
+      
+   bool read_element(const string &token, const char *p, const char *end,
+                     char point);
+   
+};
+
+void
+OBJChunk::parse(const char *p, const char *end, char point)
+{
+   
+   string line;
+   
+   while(!failed){
+      
+      // Get the next token, skipping comments (Reader::get_next_token()):
+      string token = parse_word(p, end);
+      
+      if(token.empty())
+         break;
+      
+      if(token[0] == '#'){
+         skip_line(p, end);
+         continue;
+      }
+      
+      if((token != "v") && (token != "vn") && (token != "vt") && (token != "f") &&
+         (token != "mtllib") && (token != "usemtl")){
+         
+         // Skip the element (Reader::ignore_element()):
+         while(p < end){
+            char c = *p++;
+            if(c == '\\')
+               skip_line(p, end);
+            else if(c == '\n')
+               break;
+         }
+         
+         skipped.push_back(token);
+         
+         continue;
+         
+      }
+      
+      // The rest of the line, joined with the next if it has a line
+      // continuation (Reader::extract_line()):
+      const char *nl = static_cast<const char*>(memchr(p, '\n', end - p));
+      const char *line_end = nl ? nl : end;
+      
+      if(!memchr(p, '\\', line_end - p)){
+         
+         failed = !read_element(token, p, line_end, point);
+         p = nl ? nl + 1 : end;
+         
+      } else {
+         
+         line.clear();
+         
+         while(p < end){
+            
+            nl = static_cast<const char*>(memchr(p, '\n', end - p));
+            line_end = nl ? nl : end;
+            
+            const char *cont = line_end;
+            while((cont > p) && (cont[-1] != '\\'))
+               --cont;
+            
+            if(cont > p){
+               line.push_back(' ');
+               line.append(p, cont - 1);
+               p = nl ? nl + 1 : end;
+            } else {
+               line.append(p, line_end);
+               p = nl ? nl + 1 : end;
+               break;
+            }
+            
+         }
+         
+         failed = !read_element(token, line.data(), line.data() + line.size(),
+                                point);
+         
+      }
+      
+      if(failed)
+         failed_token = token;
+      
+   }
+   
+}
+
+bool
+OBJChunk::read_element(const string &token, const char *p, const char *end,
+                       char point)
+{
+   
+   if(token == "v"){
+      
+      double vals[3];
+      
+      if(!(parse_double(p, end, point, vals[0]) &&
+           parse_double(p, end, point, vals[1]) &&
+           parse_double(p, end, point, vals[2])))
+         return false;
+      
+      vertices.push_back(Wpt(vals[0], vals[1], vals[2]));
+      
+   } else if(token == "vn"){
+      
+      double vals[3];
+      
+      if(!(parse_double(p, end, point, vals[0]) &&
+           parse_double(p, end, point, vals[1]) &&
+           parse_double(p, end, point, vals[2])))
+         return false;
+      
+      normals.push_back(Wvec(vals[0], vals[1], vals[2]));
+      
+   } else if(token == "vt"){
+      
+      double vals[2];
+      
+      if(!(parse_double(p, end, point, vals[0]) &&
+           parse_double(p, end, point, vals[1])))
+         return false;
+      
+      texcoords.push_back(UVpt(vals[0], vals[1]));
+      
+   } else if(token == "f"){
+      
+      // As in OBJReaderImpl::read_f(); a number that fails to read
+      // ends the face (and counts as 0, an invalid index):
+      face_t face;
+      face.first_corner = corners.size();
+      face.mtl = long(usemtls.size()) - 1;
+      face.num_vertices = vertices.size();
+      face.num_texcoords = texcoords.size();
+      face.num_normals = normals.size();
+      
+      corner_t corner;
+      bool done = false;
+      
+      while(!done && parse_long(p, end, corner.vertex)){
+         
+         corner.texcoord = corner.normal = 0;
+         
+         if((p < end) && (*p == '/')){
+            
+            ++p;
+            
+            if((p >= end) || (*p != '/')){
+               
+               if(!parse_long(p, end, corner.texcoord)){
+                  corner.texcoord = 0;
+                  done = true;
+               }
+               
+            }
+            
+            if(!done && (p < end) && (*p == '/')){
+               
+               ++p;
+               
+               if(!parse_long(p, end, corner.normal)){
+                  corner.normal = 0;
+                  done = true;
+               }
+               
+            }
+            
+         }
+         
+         corners.push_back(corner);
+         
+      }
+      
+      face.num_corners = corners.size() - face.first_corner;
+      faces.push_back(face);
+      
+   } else if(token == "mtllib"){
+      
+      bool valid = false;
+      
+      for(string file; !(file = parse_word(p, end)).empty(); ){
+         
+         if(file[0] == '#')
+            break;
+         
+         mtl_files.push_back(file);
+         valid = true;
+         
+      }
+      
+      return valid;
+      
+   } else if(token == "usemtl"){
+      
+      string name = parse_word(p, end);
+      
+      if(name.empty() || (name[0] == '#'))
+         return false;
+      
+      usemtls.push_back(name);
+      
+   }
+   
+   return true;
+   
+}
+
+/*!
+ *  \brief Reads .obj data held in memory (e.g. a mapped file), with the same
+ *  results as read(istream&), but faster: the data is split at line
+ *  boundaries into pieces that are read on parallel_num_threads() threads,
+ *  without istreams, then put together in order.
+ *
+ */
+bool
+OBJReaderImpl::read(const char *data, size_t size)
+{
+   
+   reset();
+   
+   // Split at new-lines ending lines without a line continuation, so each
+   // piece starts a new element:
+   int num_chunks = int(min<size_t>(size/(256 << 10) + 1,
+                                    8*parallel_num_threads()));
+   vector<size_t> bounds(1, 0);
+   
+   for(int i = 1; i < num_chunks; ++i){
+      
+      size_t b = max(bounds.back(), size_t((unsigned long long)size*i/num_chunks));
+      
+      while(b < size){
+         
+         const char *nl = static_cast<const char*>(memchr(data + b, '\n', size - b));
+         
+         if(!nl){
+            b = size;
+            break;
+         }
+         
+         const char *line = nl;
+         while((line > data) && (line[-1] != '\n') && (line[-1] != '\\'))
+            --line;
+         
+         b = nl + 1 - data;
+         
+         if((line == data) || (line[-1] == '\n'))
+            break;
+         
+      }
+      
+      bounds.push_back(b);
+      
+   }
+   
+   bounds.push_back(size);
+   num_chunks = bounds.size() - 1;
+   
+   const char point = *localeconv()->decimal_point;
+   
+   vector<OBJChunk> chunks(num_chunks);
+   
+   parallel_for(num_chunks, 1, [&](int begin, int end) {
+      for(int c = begin; c < end; ++c)
+         chunks[c].parse(data + bounds[c], data + bounds[c + 1], point);
+   });
+   
+   // Materials, in the order they are first used, and where each piece
+   // starts in the whole file's lists:
+   vector< vector<long> > chunk_mtls(num_chunks);
+   vector<long> start_mtl(num_chunks);
+   vector<unsigned long> start_vertices(num_chunks), start_texcoords(num_chunks),
+      start_normals(num_chunks);
+   unsigned long nv = 0, nt = 0, nn = 0;
+   
+   for(int c = 0; c < num_chunks; ++c){
+      
+      start_mtl[c] = current_material;
+      
+      for(auto &name : chunks[c].usemtls){
+         
+         mtl_name2id_map_t::iterator name2id_itor = mtl_name2id.find(name);
+         
+         if(name2id_itor == mtl_name2id.end()){
+            
+            materials.push_back(OBJMtl(name));
+            material_faces.push_back(vector<long>());
+            
+            name2id_itor =
+               mtl_name2id.insert(make_pair(name, materials.size() - 1)).first;
+            
+         }
+         
+         current_material = name2id_itor->second;
+         chunk_mtls[c].push_back(current_material);
+         
+      }
+      
+      start_vertices[c] = nv;
+      start_texcoords[c] = nt;
+      start_normals[c] = nn;
+      nv += chunks[c].vertices.size();
+      nt += chunks[c].texcoords.size();
+      nn += chunks[c].normals.size();
+      
+   }
+   
+   // Make the faces, checking indices against what was read before each:
+   vector< vector<OBJFace> > chunk_faces(num_chunks);
+   vector<long> first_bad(num_chunks, -1);
+   
+   parallel_for(num_chunks, 1, [&](int begin, int end) {
+      for(int c = begin; c < end; ++c){
+         const OBJChunk &chunk = chunks[c];
+         chunk_faces[c].reserve(chunk.faces.size());
+         for(auto &f : chunk.faces){
+            OBJFace face((f.mtl < 0) ? start_mtl[c] : chunk_mtls[c][f.mtl]);
+            for(unsigned long k = 0; k < f.num_corners; ++k){
+               const OBJChunk::corner_t &corner = chunk.corners[f.first_corner + k];
+               face.add_vertex(corner.vertex, start_vertices[c] + f.num_vertices);
+               if(corner.texcoord != 0)
+                  face.add_texcoord(corner.texcoord,
+                                    start_texcoords[c] + f.num_texcoords);
+               if(corner.normal != 0)
+                  face.add_normal(corner.normal, start_normals[c] + f.num_normals);
+            }
+            if(!face.good()){
+               first_bad[c] = chunk_faces[c].size();
+               break;
+            }
+            chunk_faces[c].push_back(face);
+         }
+      }
+   });
+   
+   // Put the pieces together, stopping where the serial reader would:
+   read_succeeded = true;
+   
+   vertices.reserve(nv);
+   normals.reserve(nn);
+   texcoords.reserve(nt);
+   
+   for(int c = 0; c < num_chunks; ++c){
+      
+      OBJChunk &chunk = chunks[c];
+      
+      for(auto &token : chunk.skipped)
+         cerr << "Reader::read() - Warning:  Skipped element with token "
+              << token << endl;
+      
+      if((first_bad[c] >= 0) || chunk.failed){
+         
+         cerr << "Reader::read() - Error:  Failed while reading element with token "
+              << ((first_bad[c] >= 0) ? string("f") : chunk.failed_token) << endl;
+         
+         read_succeeded = false;
+         break;
+         
+      }
+      
+      vertices.insert(vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+      normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+      texcoords.insert(texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+      mtl_files.insert(mtl_files.end(), chunk.mtl_files.begin(), chunk.mtl_files.end());
+      
+      for(auto &face : chunk_faces[c]){
+         
+         material_faces[face.get_mtl_index()].push_back(faces.size());
+         faces.push_back(std::move(face));
+         
+      }
+      
+      chunk = OBJChunk();
+      vector<OBJFace>().swap(chunk_faces[c]);
+      
+   }
+   
+   // Make sure we have a face list for each material:
+   assert(materials.size() == material_faces.size());
+   
+   read_succeeded = read_succeeded && read_mtl_files();
+   
+   return read_succeeded;
+   
 }
 
 //----------------------------------------------------------------------------//
@@ -1384,6 +2033,43 @@ OBJReader::read(istream &in)
    
 }
 
+/*!
+ *  \return \c true if the .obj file data held in memory was read successfully
+ *  and \c false otherwise.
+ *
+ */
+bool
+OBJReader::read(const char *data, size_t size)
+{
+   
+   return impl->read(data, size);
+   
+}
+
+/*!
+ *  \return \c true if the .obj file \p filename was read successfully and
+ *  \c false otherwise.
+ *
+ */
+bool
+OBJReader::read_file(const string &filename)
+{
+   
+   MappedFile file;
+   
+   if(!file.open(filename)){
+      
+      cerr << "OBJReader::read_file() - Error:  Couldn't open file "
+           << filename << endl;
+      
+      return false;
+      
+   }
+   
+   return impl->read(file.data(), file.size());
+   
+}
+
 BMESHptr
 OBJReader::get_mesh() const
 {
@@ -28,6 +28,7 @@
  */
 
 #include <iostream>
+#include <string>
 
 MAKE_SHARED_PTR(BMESH);
 
@@ -49,6 +50,16 @@ class OBJReader {
    //! \p in.
    bool read(std::istream &in);
       
+   //! \brief Attempt to read the contents of a .obj file held in memory
+   //! (\p size characters at \p data).  Reads the same data as read() from a
+   //! stream would, but splits the work across threads (see
+   //! parallel_num_threads()) and doesn't use iostreams.
+   bool read(const char *data, size_t size);
+      
+   //! \brief Attempt to read the .obj file \p filename, mapped into memory
+   //! and read as above.
+   bool read_file(const std::string &filename);
+      
    //! \brief Create a new BMESH object containing the data read in with the
    //! read function.
    BMESHptr get_mesh() const;
@@ -34,6 +34,7 @@ init_fade_func_t Patch::_init_fade = nullptr;
 TAGlist*        Patch::_patch_tags      = nullptr;
 int             Patch::_next_stencil_id = 0;
 Patch*          Patch::_focus           = nullptr;
+int             Patch::_use_tri_strips  = -1;
 
 // permits d2d stuff to be written out to file when saving:
 static const bool patch_d2d =
@@ -56,6 +57,7 @@ Patch::Patch(BMESHptr mesh) :
    _stamp(0),
    _mesh_version(0),
    _tri_strips_dirty(1),
+   _tri_list_dirty(1),
    _tex_coord_gen(nullptr),
    _data(nullptr),
    _stencil_id(0),
@@ -202,6 +204,7 @@ void
 Patch::triangulation_changed() 
 {
    _tri_strips_dirty = 1;
+   _tri_list_dirty = 1;
    _d2d_samples_valid = false;
 
    creases_changed();
@@ -419,16 +422,11 @@ Patch::build_tri_strips()
          delete _tri_strips[k];
       _tri_strips.clear();
 
-      // clear face flags before finding triangle strips
-      for (k=0; k<_faces.size(); k++) {
-         _faces[k]->clear_flag();
+      // clear face orientations and flags before finding
+      // triangle strips:
+      for (k=0; k<_faces.size(); k++)
          _faces[k]->orient_strip(nullptr);
-      }
-
-      // If secondary faces shouldn't be drawn, set their flags
-      // so they won't be drawn:
-      if (!BMESH::show_secondary_faces())
-         _faces.secondary_faces().set_flags(1);
+      flag_hidden_faces();
 
       for (k=0; k<_faces.size(); k++)
          if (!_faces[k]->flag())
@@ -440,6 +438,60 @@ Patch::build_tri_strips()
    }
 }
 
+void
+Patch::flag_hidden_faces()
+{
+   // secondary faces aren't drawn unless they're shown:
+
+   _faces.clear_flags();
+   if (!BMESH::show_secondary_faces())
+      _faces.secondary_faces().set_flags(1);
+}
+
+void
+Patch::build_tri_list()
+{
+   if (_tri_list_dirty) {
+      _tri_list_dirty = 0;
+
+      flag_hidden_faces();
+      _tri_list.build(_faces);
+
+      static bool debug = Config::get_var_bool("PRINT_PATCH_ACMR",false);
+      if (debug)
+         err_msg("Patch::build_tri_list: %d triangles, ACMR: %1.3f",
+                 _tri_list.num(), _tri_list.acmr());
+   }
+}
+
+bool
+Patch::use_tri_strips()
+{
+   if (_use_tri_strips < 0)
+      _use_tri_strips = Config::get_var_bool("JOT_USE_TRI_STRIPS",false) ? 1 : 0;
+   return _use_tri_strips == 1;
+}
+
+const TriList*
+Patch::cur_tri_list()
+{
+   if (use_tri_strips())
+      return nullptr;
+   build_tri_list();
+   return &_tri_list;
+}
+
+double
+Patch::acmr()
+{
+   if (use_tri_strips()) {
+      build_tri_strips();
+      return TriList::acmr(_tri_strips, TriList::cache_size());
+   }
+   build_tri_list();
+   return _tri_list.acmr();
+}
+
 //********************** DRAWING **********************
 int
 Patch::draw(CVIEWptr& v)
@@ -462,6 +514,12 @@ Patch::draw(CVIEWptr& v)
 int
 Patch::draw_tri_strips(StripCB* cb)
 {
+   if (!use_tri_strips() && !cb->needs_tri_strips()) {
+      build_tri_list();
+      _tri_list.draw(cb);
+      return _faces.size();
+   }
+
    build_tri_strips();
 
    for (auto & strip : _tri_strips)
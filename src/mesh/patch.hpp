@@ -33,6 +33,7 @@
 #include "mesh/edge_strip.hpp"
 #include "mesh/gtexture.hpp"
 #include "mesh/tex_coord_gen.hpp"
+#include "mesh/tri_list.hpp"
 #include "mesh/zcross_path.hpp"
 
 #include <vector>
@@ -204,9 +205,9 @@ class Patch : public DATA_ITEM, public APPEAR, public RefImageClient {
    //! \copydoc Patch::build_sils()
    ZcrossPath&  build_zx_sils();
    //! \copydoc Patch::build_sils()
-   EdgeStrip*   build_creases();
+   virtual EdgeStrip* build_creases();
    //! \copydoc Patch::build_sils()
-   EdgeStrip*   build_borders();
+   virtual EdgeStrip* build_borders();
 
  public:
 
@@ -307,6 +308,27 @@ class Patch : public DATA_ITEM, public APPEAR, public RefImageClient {
       return _tri_strips.empty() ? 0.0 :
          double(_faces.size())/_tri_strips.size();
    }
+
+   // The faces as a triangle list ordered for the vertex cache
+   // (see TriList). Drawn in place of the triangle strips unless
+   // use_tri_strips() is set or the callback needs strips (see
+   // StripCB::needs_tri_strips()); like the strips, rebuilt only
+   // after triangulation_changed():
+   void build_tri_list();
+   const TriList& tri_list() const { return _tri_list; }
+
+   // The triangle list draw_tri_strips() draws, brought up to
+   // date, or null if it draws something else (e.g. strips):
+   virtual const TriList* cur_tri_list();
+
+   // Average cache miss ratio of the triangles as drawn (list or
+   // strips), for a cache of TriList::cache_size() vertices:
+   virtual double acmr();
+
+   // Draw triangle strips instead of triangle lists (for
+   // comparison). Set with JOT_USE_TRI_STRIPS; off by default:
+   static bool use_tri_strips();
+   static void set_use_tri_strips(bool b) { _use_tri_strips = b ? 1 : 0; }
       
    //@}
 
@@ -560,6 +582,8 @@ class Patch : public DATA_ITEM, public APPEAR, public RefImageClient {
    uint              _stamp;            //!< version number
    uint              _mesh_version;     //!< last recorded mesh version
    bool              _tri_strips_dirty; //!< used to rebuild _tri_strips
+   TriList           _tri_list;         //!< faces in vertex cache order
+   bool              _tri_list_dirty;   //!< used to rebuild _tri_list
    
    string            _name;             //!< name
    string            _texture_file;     //!< name of texture map image file
@@ -569,6 +593,7 @@ class Patch : public DATA_ITEM, public APPEAR, public RefImageClient {
    
    int               _stencil_id;
    static int        _next_stencil_id;
+   static int        _use_tri_strips;   //!< -1 until read from config
    
    //! \name Dynamic Samples Variables
    //@{
@@ -633,6 +658,10 @@ class Patch : public DATA_ITEM, public APPEAR, public RefImageClient {
    Patch(BMESHptr = nullptr);
    friend class BMESH;
 
+   // Clear face flags, then flag the faces not to be drawn
+   // (used when building strips or the triangle list):
+   void flag_hidden_faces();
+
    //! \name Serialization Methods
    //@{
       
@@ -80,9 +80,15 @@ class PatchBlendWeight : public SimplexData {
       return uintptr_t(static_name().c_str());
    }
 
+   // the lookup slot for the ID (see SimplexData::register_slot()):
+   static int slot() {
+      static int ret = register_slot(key());
+      return ret;
+   }
+
    // Lookup a PatchBlendWeight* from a Bvert
    static PatchBlendWeight* lookup(CBvert* v) {
-      return v ? dynamic_cast<PatchBlendWeight*>(v->find_data(key())) : nullptr;
+      return v ? dynamic_cast<PatchBlendWeight*>(v->find_data(key(), slot())) : nullptr;
    }
    // Similar to lookup, but creates a PatchBlendWeight if it wasn't found
    static PatchBlendWeight* get_data(Bvert* v) {
@@ -0,0 +1,337 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "mesh/proximity_index.hpp"
+
+#include <algorithm>
+#include <limits>
+
+// elements per leaf:
+static const int LEAF_SIZE = 8;
+
+// the tree is balanced, so this is deeper than any tree can be:
+static const int MAX_DEPTH = 64;
+
+ProximityIndex::ProximityIndex(BMESH* mesh, elem_t type) :
+   _mesh(mesh),
+   _type(type),
+   _state(NEEDS_BUILD),
+   _snap(nullptr)
+{
+   // Subscribe by pointer: the mesh may not be held by a
+   // shared_ptr yet (e.g. while it is being built):
+   if (_mesh)
+      bmesh_obs_list(_mesh).insert(this);
+}
+
+ProximityIndex::~ProximityIndex()
+{
+   if (_mesh)
+      bmesh_obs_list(_mesh).erase(this);
+}
+
+void
+ProximityIndex::notify_change(BMESHptr, BMESH::change_t change)
+{
+   switch (change) {
+    case BMESH::TOPOLOGY_CHANGED:
+    case BMESH::TRIANGULATION_CHANGED:
+      _state = NEEDS_BUILD;
+      break;
+    case BMESH::VERT_POSITIONS_CHANGED:
+      if (_state == VALID)
+         _state = NEEDS_REFIT;
+      break;
+    default:
+      ;
+   }
+}
+
+void
+ProximityIndex::notify_delete(BMESH* m)
+{
+   assert(m == _mesh);
+   bmesh_obs_list(_mesh).erase(this);
+   _mesh  = nullptr;
+   _snap  = nullptr;
+   _state = NEEDS_BUILD;
+   _nodes.clear();
+   _elems.clear();
+}
+
+int
+ProximityIndex::size() const
+{
+   if (!_snap)
+      return 0;
+   return (_type == VERTS) ? _snap->nverts() : _snap->nedges();
+}
+
+void
+ProximityIndex::ends(int i, int& a, int& b) const
+{
+   // endpoints of element i (a == b for a vertex):
+   if (_type == VERTS) {
+      a = b = i;
+   } else {
+      const int* ev = _snap->edge_verts(i);
+      a = ev[0];
+      b = ev[1];
+   }
+}
+
+void
+ProximityIndex::update()
+{
+   // Bring the tree up to date before a query. The snapshot is
+   // looked up each time since the mesh may have replaced it:
+   if (!_mesh) {
+      _snap = nullptr;
+      return;
+   }
+   _snap = &_mesh->snapshot();
+
+   // Counts are checked too, to catch edits not followed by
+   // a call to changed():
+   if (size() != (int)_elems.size())
+      _state = NEEDS_BUILD;
+
+   if (_state == NEEDS_BUILD) {
+      int n = size();
+      _elems.resize(n);
+      for (int i=0; i<n; i++)
+         _elems[i] = i;
+      _nodes.clear();
+      _nodes.reserve(2*(n/LEAF_SIZE + 1));
+      if (n > 0)
+         build(0, n);
+      refit();
+   } else if (_state == NEEDS_REFIT) {
+      refit();
+   }
+   _state = VALID;
+}
+
+int
+ProximityIndex::build(int begin, int end)
+{
+   // Make a node for elements begin..end-1 of _elems, and the
+   // nodes below it. Returns its index. Boxes are filled in by
+   // refit().
+
+   int n = (int)_nodes.size();
+   _nodes.push_back(Node());
+
+   if (end - begin <= LEAF_SIZE) {
+      _nodes[n]._first = begin;
+      _nodes[n]._count = end - begin;
+      return n;
+   }
+
+   // centers are stored doubled (a + b) -- only their order matters:
+   auto center = [this](int i, int k) {
+      int a, b;
+      ends(i, a, b);
+      const double* x = (k == 0) ? _snap->x() : (k == 1) ? _snap->y() : _snap->z();
+      return x[a] + x[b];
+   };
+
+   // split at the median center along the axis where the
+   // centers are most spread out:
+   double lo[3], hi[3];
+   for (int k=0; k<3; k++)
+      lo[k] = hi[k] = center(_elems[begin], k);
+   for (int i=begin+1; i<end; i++) {
+      for (int k=0; k<3; k++) {
+         double c = center(_elems[i], k);
+         lo[k] = min(lo[k], c);
+         hi[k] = max(hi[k], c);
+      }
+   }
+   int axis = 0;
+   for (int k=1; k<3; k++)
+      if (hi[k] - lo[k] > hi[axis] - lo[axis])
+         axis = k;
+   int mid = (begin + end)/2;
+   nth_element(_elems.begin() + begin, _elems.begin() + mid,
+               _elems.begin() + end,
+               [&](int a, int b) { return center(a, axis) < center(b, axis); });
+
+   build(begin, mid);
+   int right = build(mid, end);
+   _nodes[n]._first = right;
+   _nodes[n]._count = 0;
+   return n;
+}
+
+void
+ProximityIndex::refit()
+{
+   // Children come after their parents, so go in reverse:
+   for (int i=(int)_nodes.size()-1; i>=0; i--) {
+      Node& node = _nodes[i];
+      if (node._count > 0) {
+         for (int k=0; k<3; k++) {
+            node._lo[k] =  numeric_limits<double>::max();
+            node._hi[k] = -numeric_limits<double>::max();
+         }
+         for (int j=node._first; j<node._first + node._count; j++) {
+            int a, b;
+            ends(_elems[j], a, b);
+            Wpt pa = _snap->loc(a), pb = _snap->loc(b);
+            for (int k=0; k<3; k++) {
+               node._lo[k] = min(node._lo[k], min(pa[k], pb[k]));
+               node._hi[k] = max(node._hi[k], max(pa[k], pb[k]));
+            }
+         }
+      } else {
+         const Node& a = _nodes[i + 1];
+         const Node& b = _nodes[node._first];
+         for (int k=0; k<3; k++) {
+            node._lo[k] = min(a._lo[k], b._lo[k]);
+            node._hi[k] = max(a._hi[k], b._hi[k]);
+         }
+      }
+   }
+}
+
+double
+ProximityIndex::dist_sqrd(CWpt& p, int i, Wpt& q) const
+{
+   // Squared distance from p to element i, and the closest
+   // point q on it:
+   int a, b;
+   ends(i, a, b);
+   Wpt pa = _snap->loc(a);
+   if (a == b) {
+      q = pa;
+   } else {
+      Wvec ab = _snap->loc(b) - pa;
+      double l = ab.length_sqrd();
+      double t = (l > 0) ? ((p - pa)*ab)/l : 0;
+      q = pa + ab*max(0.0, min(1.0, t));
+   }
+   return (p - q).length_sqrd();
+}
+
+double
+ProximityIndex::dist_sqrd(CWpt& p, const Node& n)
+{
+   // Squared distance from p to the node's box:
+   double ret = 0;
+   for (int k=0; k<3; k++) {
+      double d = max(max(n._lo[k] - p[k], p[k] - n._hi[k]), 0.0);
+      ret += d*d;
+   }
+   return ret;
+}
+
+void
+ProximityIndex::k_nearest(CWpt& p, int k, vector<int>& ret)
+{
+   ret.clear();
+   update();
+   if (_nodes.empty() || k <= 0)
+      return;
+
+   // max-heap of the best k so far, by squared distance:
+   typedef pair<double,int> hit_t;
+   vector<hit_t> heap;
+   heap.reserve(k + 1);
+
+   // depth-first, nearer child first; boxes farther than the
+   // k-th best so far are skipped:
+   struct entry_t { int _node; double _d; };
+   entry_t stack[MAX_DEPTH + 1];
+   int top = 0;
+   stack[top++] = { 0, dist_sqrd(p, _nodes[0]) };
+   Wpt q;
+   while (top > 0) {
+      const entry_t cur = stack[--top];
+      if ((int)heap.size() == k && cur._d >= heap.front().first)
+         continue;
+      const Node& node = _nodes[cur._node];
+      if (node._count > 0) {
+         for (int j=node._first; j<node._first + node._count; j++) {
+            double d = dist_sqrd(p, _elems[j], q);
+            if ((int)heap.size() < k) {
+               heap.push_back(hit_t(d, _elems[j]));
+               push_heap(heap.begin(), heap.end());
+            } else if (d < heap.front().first) {
+               pop_heap(heap.begin(), heap.end());
+               heap.back() = hit_t(d, _elems[j]);
+               push_heap(heap.begin(), heap.end());
+            }
+         }
+         continue;
+      }
+      int a = cur._node + 1, b = node._first;
+      double da = dist_sqrd(p, _nodes[a]), db = dist_sqrd(p, _nodes[b]);
+      if (da > db) {
+         swap(a, b);
+         swap(da, db);
+      }
+      // push the farther one first so the nearer is popped first:
+      stack[top++] = { b, db };
+      stack[top++] = { a, da };
+      assert(top <= MAX_DEPTH);
+   }
+
+   sort_heap(heap.begin(), heap.end());
+   for (auto& h : heap)
+      ret.push_back(h.second);
+}
+
+int
+ProximityIndex::nearest(CWpt& p, Wpt& q)
+{
+   vector<int> ret;
+   k_nearest(p, 1, ret);
+   if (ret.empty())
+      return -1;
+   dist_sqrd(p, ret[0], q);
+   return ret[0];
+}
+
+void
+ProximityIndex::within(CWpt& p, double r, vector<int>& ret)
+{
+   ret.clear();
+   update();
+   if (_nodes.empty() || r < 0)
+      return;
+
+   double r2 = r*r;
+   int stack[MAX_DEPTH + 1];
+   int top = 0;
+   stack[top++] = 0;
+   Wpt q;
+   while (top > 0) {
+      const Node& node = _nodes[stack[--top]];
+      if (dist_sqrd(p, node) > r2)
+         continue;
+      if (node._count > 0) {
+         for (int j=node._first; j<node._first + node._count; j++)
+            if (dist_sqrd(p, _elems[j], q) <= r2)
+               ret.push_back(_elems[j]);
+         continue;
+      }
+      stack[top++] = node._first;
+      stack[top++] = (int)(&node - &_nodes[0]) + 1;
+      assert(top <= MAX_DEPTH);
+   }
+}
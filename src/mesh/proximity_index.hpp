@@ -0,0 +1,112 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef PROXIMITY_INDEX_H_IS_INCLUDED
+#define PROXIMITY_INDEX_H_IS_INCLUDED
+
+#include "mesh/bmesh.hpp"
+
+/*****************************************************************
+ * ProximityIndex:
+ *
+ *      Spatial index over the vertices or the edges of a BMESH,
+ *      for nearest, k-nearest and radius queries around a point
+ *      in object space. Distances are measured to the closest
+ *      point on each element, as in Bsimplex::project_to_simplex().
+ *
+ *      The index is a kd-tree of axis-aligned boxes, built from
+ *      the mesh snapshot on the first query. It watches the mesh
+ *      through BMESHobs notifications: after the vertices move it
+ *      is refit (boxes recomputed, same tree), and after the
+ *      topology changes it is rebuilt. Queries return indices
+ *      into the mesh vertex or edge list.
+ *
+ *      BMESH::nearest_vert() and BMESH::nearest_edge() keep one
+ *      of each; tools that query a mesh often can make their own.
+ *****************************************************************/
+class ProximityIndex : public BMESHobs {
+ public:
+   enum elem_t {
+      VERTS = 0,
+      EDGES
+   };
+
+   //******** MANAGERS ********
+
+   ProximityIndex(BMESH* mesh, elem_t type);
+   virtual ~ProximityIndex();
+
+   //******** ACCESSORS ********
+
+   BMESH* mesh()  const { return _mesh; }
+   elem_t type()  const { return _type; }
+
+   //******** QUERIES ********
+
+   // Nearest element to p, or -1 if there are none. Also returns
+   // the closest point on it:
+   int  nearest(CWpt& p, Wpt& q);
+   int  nearest(CWpt& p) { Wpt q; return nearest(p, q); }
+
+   // The k elements nearest to p, nearest first:
+   void k_nearest(CWpt& p, int k, vector<int>& ret);
+
+   // All elements within distance r of p, in no particular order:
+   void within(CWpt& p, double r, vector<int>& ret);
+
+   //******** BMESHobs METHODS ********
+
+   virtual void notify_change(BMESHptr, BMESH::change_t);
+   virtual void notify_delete(BMESH*);
+   virtual string name() const { return "proximity_index"; }
+
+ protected:
+   enum state_t {
+      VALID = 0,
+      NEEDS_REFIT,
+      NEEDS_BUILD
+   };
+
+   // A node is a leaf iff _count > 0: its elements are _elems[_first]
+   // through _elems[_first + _count - 1]. Otherwise its children
+   // are the next node and node _first:
+   struct Node {
+      double _lo[3], _hi[3];
+      int    _first;
+      int    _count;
+   };
+
+   BMESH*               _mesh;
+   elem_t               _type;
+   state_t              _state;
+   const MeshSnapshot*  _snap;     // of _mesh, set by update()
+   vector<Node>         _nodes;
+   vector<int>          _elems;    // element indices, grouped by leaf
+
+   //******** INTERNAL METHODS ********
+
+   void update();
+   int  build(int begin, int end);
+   void refit();
+
+   int  size() const;
+   void ends(int i, int& a, int& b) const;
+   double dist_sqrd(CWpt& p, int i, Wpt& q) const;
+   static double dist_sqrd(CWpt& p, const Node& n);
+};
+
+#endif // PROXIMITY_INDEX_H_IS_INCLUDED
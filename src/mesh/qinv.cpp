@@ -21,30 +21,24 @@
 #include "std/config.hpp"
 #include "mi.hpp"
 
-inline Wpt
-qinv_loc(CBvert* v)
-{
-   return v->loc() + (v->loc() - LoopLoc().limit_val(v));
-}
-
 inline Wpt_list
-qinv_locs(LMESHptr mesh)
+limit_locs(LMESHptr mesh)
 {
+   // the mesh uses LoopLoc (see main()), so its limit points are
+   // the Loop limit points, found for all vertices at once:
    assert(mesh);
    Wpt_list ret(mesh->nverts());
-   for (int i=0; i<mesh->nverts(); i++) {
-      ret.push_back(qinv_loc(mesh->bv(i)));
-   }
+   mesh->limit_data(mesh->verts(), &ret);
    return ret;
 }
 
 inline Wpt_list
-limit_locs(LMESHptr mesh)
+qinv_locs(LMESHptr mesh)
 {
    assert(mesh);
-   Wpt_list ret(mesh->nverts());
+   Wpt_list ret = limit_locs(mesh);
    for (int i=0; i<mesh->nverts(); i++) {
-      ret.push_back(LoopLoc().limit_val(mesh->bv(i)));
+      ret[i] = mesh->bv(i)->loc() + (mesh->bv(i)->loc() - ret[i]);
    }
    return ret;
 }
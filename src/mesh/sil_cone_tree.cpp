@@ -0,0 +1,276 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "std/parallel.hpp"
+#include "mesh/mesh_snapshot.hpp"
+#include "mesh/sil_cone_tree.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace mlib;
+
+// edges per leaf:
+static const int LEAF_SIZE = 16;
+
+// the tree is balanced, so this is deeper than any tree can be:
+static const int MAX_DEPTH = 64;
+
+// angle (radians) added to every test, to absorb round-off in the
+// normals and in the facing test itself:
+static const double MARGIN = 1e-6;
+
+// per edge build keys: midpoint, then average normal
+static const int NUM_KEYS = 6;
+
+SilConeTree::SilConeTree(const MeshSnapshot& snap)
+{
+   int ne = snap.nedges();
+   if (ne == 0)
+      return;
+
+   vector<double> keys(NUM_KEYS*ne);
+   _edges.resize(ne);
+   for (int e=0; e<ne; e++) {
+      const int* ev = snap.edge_verts(e);
+      const int* ef = snap.edge_faces(e);
+      Wpt  c = (snap.loc(ev[0]) + snap.loc(ev[1]))/2;
+      Wvec n;
+      for (int j=0; j<2; j++)
+         if (ef[j] >= 0)
+            n += snap.norm(ef[j]);
+      n /= 2;
+      for (int k=0; k<3; k++) {
+         keys[NUM_KEYS*e + k    ] = c[k];
+         keys[NUM_KEYS*e + k + 3] = n[k];
+      }
+      _edges[e] = e;
+   }
+   _nodes.reserve(2*(ne/LEAF_SIZE + 1));
+   build(snap, keys, 0, ne);
+   refit(snap);
+}
+
+int
+SilConeTree::build(const MeshSnapshot& snap, vector<double>& keys, int begin, int end)
+{
+   // Make a node for edges begin..end-1 of _edges, and the nodes
+   // below it. Returns its index. Boxes and cones are filled in
+   // by refit().
+
+   int n = (int)_nodes.size();
+   _nodes.push_back(Node());
+
+   if (end - begin <= LEAF_SIZE) {
+      _nodes[n]._first = begin;
+      _nodes[n]._count = end - begin;
+      return n;
+   }
+
+   // Split at the median along the key where the edges are most
+   // spread out. Positions are measured against the size of the
+   // group and normals against their range (2), so the two kinds
+   // of keys take turns as groups get small and flat:
+   double lo[NUM_KEYS], hi[NUM_KEYS];
+   for (int k=0; k<NUM_KEYS; k++)
+      lo[k] = hi[k] = keys[NUM_KEYS*_edges[begin] + k];
+   for (int i=begin+1; i<end; i++) {
+      const double* key = &keys[NUM_KEYS*_edges[i]];
+      for (int k=0; k<NUM_KEYS; k++) {
+         lo[k] = min(lo[k], key[k]);
+         hi[k] = max(hi[k], key[k]);
+      }
+   }
+   double size = Wvec(hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]).length();
+   int    axis = 0;
+   double best = -1;
+   for (int k=0; k<NUM_KEYS; k++) {
+      double spread = (k < 3) ? (size > 0 ? (hi[k] - lo[k])/size : 0) :
+                                (hi[k] - lo[k])/2;
+      if (spread > best) {
+         best = spread;
+         axis = k;
+      }
+   }
+   int mid = (begin + end)/2;
+   nth_element(_edges.begin() + begin, _edges.begin() + mid,
+               _edges.begin() + end,
+               [&](int a, int b) {
+                  return keys[NUM_KEYS*a + axis] < keys[NUM_KEYS*b + axis];
+               });
+
+   build(snap, keys, begin, mid);
+   int right = build(snap, keys, mid, end);
+   _nodes[n]._first = right;
+   _nodes[n]._count = 0;
+   return n;
+}
+
+void
+SilConeTree::fit_leaf(const MeshSnapshot& snap, Node& node) const
+{
+   // Box around the faces of the edges, and cone around their
+   // normals. Any point of a face will do for the facing test,
+   // so the box only has to hold the vertices:
+   for (int k=0; k<3; k++) {
+      node._lo[k] =  numeric_limits<double>::max();
+      node._hi[k] = -numeric_limits<double>::max();
+   }
+   Wvec axis;
+   bool open = false;   // true: never skip this node
+   for (int i=node._first; i<node._first + node._count; i++) {
+      const int* ef = snap.edge_faces(_edges[i]);
+      if ((ef[0] < 0) != (ef[1] < 0))
+         open = true;   // border edges are always silhouettes
+      for (int j=0; j<2; j++) {
+         if (ef[j] < 0)
+            continue;
+         Wvec n = snap.norm(ef[j]);
+         if (n.is_null())
+            open = true;
+         axis += n;
+         const int* fv = snap.face_verts(ef[j]);
+         for (int v=0; v<3; v++) {
+            Wpt p = snap.loc(fv[v]);
+            for (int k=0; k<3; k++) {
+               node._lo[k] = min(node._lo[k], p[k]);
+               node._hi[k] = max(node._hi[k], p[k]);
+            }
+         }
+      }
+   }
+   double angle = M_PI;
+   if (!open && !axis.is_null()) {
+      axis = axis.normalized();
+      angle = 0;
+      for (int i=node._first; i<node._first + node._count; i++) {
+         const int* ef = snap.edge_faces(_edges[i]);
+         for (int j=0; j<2; j++)
+            if (ef[j] >= 0)
+               angle = max(angle, Acos(axis * snap.norm(ef[j])));
+      }
+   }
+   for (int k=0; k<3; k++)
+      node._axis[k] = axis[k];
+   node._angle = angle;
+}
+
+void
+SilConeTree::merge(const Node& a, const Node& b, Node& node)
+{
+   // Box around both boxes, and cone around both cones:
+   for (int k=0; k<3; k++) {
+      node._lo[k] = min(a._lo[k], b._lo[k]);
+      node._hi[k] = max(a._hi[k], b._hi[k]);
+   }
+   Wvec aa(a._axis[0], a._axis[1], a._axis[2]);
+   Wvec ba(b._axis[0], b._axis[1], b._axis[2]);
+   Wvec axis  = aa;
+   double angle = M_PI;
+   if (a._angle < M_PI && b._angle < M_PI) {
+      double gap = Acos(aa * ba);
+      if (gap + b._angle <= a._angle) {
+         angle = a._angle;
+      } else if (gap + a._angle <= b._angle) {
+         axis  = ba;
+         angle = b._angle;
+      } else {
+         // rotate a's axis toward b's, so the new cone just
+         // touches the far sides of both:
+         angle = (gap + a._angle + b._angle)/2;
+         Wvec w = ba - aa*(aa * ba);
+         if (w.is_null()) {
+            angle = max(a._angle, b._angle) + gap;
+         } else {
+            double t = angle - a._angle;
+            axis = (aa*cos(t) + w.normalized()*sin(t)).normalized();
+         }
+      }
+   }
+   for (int k=0; k<3; k++)
+      node._axis[k] = axis[k];
+   node._angle = min(angle, M_PI);
+}
+
+void
+SilConeTree::refit(const MeshSnapshot& snap)
+{
+   // Leaves first, across threads; then the other nodes, whose
+   // children come after them, in reverse:
+   int nn = nnodes();
+   parallel_for(nn, 256, [&](int begin, int end) {
+      for (int i=begin; i<end; i++)
+         if (_nodes[i]._count > 0)
+            fit_leaf(snap, _nodes[i]);
+   });
+   for (int i=nn-1; i>=0; i--) {
+      Node& node = _nodes[i];
+      if (node._count == 0)
+         merge(_nodes[i + 1], _nodes[node._first], node);
+   }
+}
+
+bool
+SilConeTree::no_sils(const Node& node, CWpt& eye)
+{
+   // Seen from eye, the faces of node all face the same way if,
+   // for every normal n in the cone and point p in the box, the
+   // angle between n and eye - p stays on one side of 90 degrees.
+   // That angle is within (cone angle + angle the box subtends)
+   // of the angle between the cone axis and the box center:
+   if (node._angle >= M_PI/2)
+      return false;
+   Wpt  c((node._lo[0] + node._hi[0])/2,
+          (node._lo[1] + node._hi[1])/2,
+          (node._lo[2] + node._hi[2])/2);
+   double r = Wvec(node._hi[0] - node._lo[0],
+                   node._hi[1] - node._lo[1],
+                   node._hi[2] - node._lo[2]).length()/2;
+   Wvec   v = eye - c;
+   double d = v.length();
+   if (d <= r*(1 + MARGIN))
+      return false;
+   Wvec   axis(node._axis[0], node._axis[1], node._axis[2]);
+   double phi    = Acos((axis * v)/d);
+   double spread = node._angle + asin(r/d) + MARGIN;
+   return (phi + spread < M_PI/2) || (phi - spread > M_PI/2);
+}
+
+void
+SilConeTree::candidates(CWpt& eye, vector<int>& ret) const
+{
+   if (_nodes.empty())
+      return;
+
+   int stack[MAX_DEPTH + 1];
+   int top = 0;
+   stack[top++] = 0;
+   while (top > 0) {
+      int n = stack[--top];
+      const Node& node = _nodes[n];
+      if (no_sils(node, eye))
+         continue;
+      if (node._count > 0) {
+         ret.insert(ret.end(), _edges.begin() + node._first,
+                    _edges.begin() + node._first + node._count);
+         continue;
+      }
+      stack[top++] = node._first;
+      stack[top++] = n + 1;
+      assert(top <= MAX_DEPTH);
+   }
+}
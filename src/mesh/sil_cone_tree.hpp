@@ -0,0 +1,102 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef SIL_CONE_TREE_H_IS_INCLUDED
+#define SIL_CONE_TREE_H_IS_INCLUDED
+
+#include "mlib/points.hpp"
+
+#include <vector>
+
+class MeshSnapshot;
+
+/*****************************************************************
+ * SilConeTree:
+ *
+ *      Hierarchy over the edges of a mesh, for finding silhouette
+ *      edges without testing every edge. Built from a MeshSnapshot,
+ *      and refers to edges by their snapshot indices.
+ *
+ *      Each node holds a group of edges, with a box around the
+ *      faces next to them and a cone holding all their normals.
+ *      From an eye point outside the box, and looking at it from
+ *      a direction outside the cone, the faces are either all
+ *      front-facing or all back-facing, so none of the edges is
+ *      a silhouette and the node is skipped. The test leaves a
+ *      margin for round-off, so edges are never skipped wrongly:
+ *      the edges that remain are candidates, to be tested as in
+ *      Bedge::is_sil(). Groups with a border edge or a face with
+ *      no normal are never skipped.
+ *
+ *      Edges are grouped by position and normal together (the
+ *      split axis is the one where they are most spread out).
+ *      When vertices move, the tree is refit (boxes and cones
+ *      recomputed bottom up, same groups); when the topology
+ *      changes it must be rebuilt.
+ *
+ *      Get one from BMESH::sil_cone_tree().
+ *****************************************************************/
+class SilConeTree {
+ public:
+
+   //******** MANAGERS ********
+
+   SilConeTree(const MeshSnapshot& snap);
+
+   //******** ACCESSORS ********
+
+   int nedges() const { return (int)_edges.size(); }
+   int nnodes() const { return (int)_nodes.size(); }
+
+   //******** UPDATING ********
+
+   // Recompute boxes and cones after vertex positions changed:
+   void refit(const MeshSnapshot& snap);
+
+   //******** QUERIES ********
+
+   // Append to ret the edges that may be silhouettes as seen from
+   // eye, in no particular order:
+   void candidates(mlib::CWpt& eye, std::vector<int>& ret) const;
+
+ protected:
+   // A node is a leaf iff _count > 0: its edges are _edges[_first]
+   // through _edges[_first + _count - 1]. Otherwise its children
+   // are the next node and node _first. The cone has unit axis
+   // _axis and half-angle _angle; an angle of M_PI or more means
+   // the node is never skipped:
+   struct Node {
+      double _lo[3], _hi[3];
+      double _axis[3];
+      double _angle;
+      int    _first;
+      int    _count;
+   };
+
+   std::vector<Node> _nodes;
+   std::vector<int>  _edges;    // edge indices, grouped by leaf
+
+   //******** INTERNAL METHODS ********
+
+   int  build(const MeshSnapshot& snap, std::vector<double>& keys,
+              int begin, int end);
+   void fit_leaf(const MeshSnapshot& snap, Node& node) const;
+   static void merge(const Node& a, const Node& b, Node& node);
+   static bool no_sils(const Node& node, mlib::CWpt& eye);
+};
+
+#endif // SIL_CONE_TREE_H_IS_INCLUDED
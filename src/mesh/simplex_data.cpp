@@ -17,6 +17,10 @@
  *****************************************************************/
 #include "bsimplex.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 void
 SimplexData::set(uintptr_t id, Bsimplex* s)
 {
@@ -31,13 +35,119 @@ SimplexData::set(uintptr_t id, Bsimplex* s)
       _simplex->add_simplex_data(this);
 }
 
+void
+SimplexData::set_id(uintptr_t id)
+{
+   if (_simplex)
+      _simplex->rekey_simplex_data(this, id);
+   else
+      _id = id;
+}
+
 SimplexData::~SimplexData()
 {
    // Get out of the data list on the simplex:
    set(0,nullptr);
 }
 
+/*****************************************************************
+ * lookup slots
+ *****************************************************************/
+// IDs with registered slots, in slot order. IDs are only added
+// (under the lock), and the count is bumped after the ID is
+// stored, so readers need no lock:
+static uintptr_t        slot_ids[SimplexData::MAX_SLOTS];
+static std::atomic<int> num_slots(0);
+static std::mutex       slot_lock;
+
+int
+SimplexData::register_slot(uintptr_t id)
+{
+   if (id == 0)
+      return -1;
+
+   std::lock_guard<std::mutex> guard(slot_lock);
+
+   int ret = slot_of(id);
+   if (ret >= 0)
+      return ret;
+   int n = num_slots.load();
+   if (n == MAX_SLOTS) {
+      err_msg("SimplexData::register_slot: all %d slots are taken", n);
+      return -1;
+   }
+   slot_ids[n] = id;
+   num_slots.store(n + 1);
+   return n;
+}
+
+int
+SimplexData::slot_of(uintptr_t id)
+{
+   int n = num_slots.load();
+   for (int i=0; i<n; i++)
+      if (slot_ids[i] == id)
+         return i;
+   return -1;
+}
+
+/*****************************************************************
+ * SimplexDataList
+ *****************************************************************/
 SimplexDataList::~SimplexDataList() 
 {
    // do nothing at this time
 }
+
+void
+SimplexDataList::add(SimplexData* sd)
+{
+   assert(sd);
+   push_back(sd);
+   slot_in(sd);
+}
+
+bool
+SimplexDataList::remove(SimplexData* sd)
+{
+   iterator it = std::find(begin(), end(), sd);
+   if (it == end())
+      return false;
+   erase(it);
+   slot_out(sd);
+   return true;
+}
+
+void
+SimplexDataList::rekey(SimplexData* sd, uintptr_t id)
+{
+   assert(sd && std::find(begin(), end(), sd) != end());
+   slot_out(sd);
+   sd->_id = id;
+   slot_in(sd);
+}
+
+void
+SimplexDataList::slot_in(SimplexData* sd)
+{
+   int slot = SimplexData::slot_of(sd->id());
+   if (slot >= 0 && !_slots[slot])
+      _slots[slot] = sd;
+   else
+      _num_unslotted++;
+}
+
+void
+SimplexDataList::slot_out(SimplexData* sd)
+{
+   // The key may have gotten its slot after sd was added, so
+   // check where sd actually is rather than where its key says:
+   for (auto& s : _slots) {
+      if (s == sd) {
+         s = nullptr;
+         return;
+      }
+   }
+   assert(_num_unslotted > 0);
+   _num_unslotted--;
+}
@@ -58,6 +58,25 @@ class SimplexData {
    uintptr_t  id()                      const   { return _id; }
    Bsimplex*  simplex()                 const   { return _simplex; }
 
+   //******** LOOKUP SLOTS ********
+
+   // An owner that looks up its data often (e.g. UVdata, or the
+   // boss Memes of a Bbase) can register its ID once to get a
+   // "slot": each SimplexDataList keeps the items of registered
+   // owners in a small array indexed by slot, so finding them
+   // takes no search (see Bsimplex::find_data(key, slot)).
+   // There are only a few slots, so per-instance IDs (e.g. the
+   // address of an object) should not be registered. Returns
+   // the slot, or -1 if they are all taken:
+   enum { MAX_SLOTS = 8 };
+   static int register_slot(uintptr_t id);
+   static int register_slot(const string& str) {
+      return register_slot((uintptr_t)str.c_str());
+   }
+
+   // The slot registered for the ID, or -1 if none:
+   static int slot_of(uintptr_t id);
+
    //******** VIRTUAL METHODS ********
 
    // Notification that the simplex changed, meaning:
@@ -107,6 +126,13 @@ class SimplexData {
  protected:
    uintptr_t _id;       // unique ID of the owner of this data
    Bsimplex* _simplex;  // the simplex this is attached to.
+
+   friend class SimplexDataList;
+
+   // Change the lookup key while staying on the same simplex.
+   // Subclasses must use this rather than assign _id, so the
+   // data list on the simplex can keep its slots in sync:
+   void set_id(uintptr_t id);
 };
 
 /*****************************************************************
@@ -114,14 +140,27 @@ class SimplexData {
  *
  *      Convenience class -- an array of SimplexData pointers.
  *      Can lookup a SimplexData item from its owner's unique ID,
- *      or "key."
+ *      or "key." Items whose owners registered a slot can also
+ *      be found by slot index (see SimplexData::register_slot()).
+ *
+ *      Use add() and remove() to change the list, so the slots
+ *      stay in sync.
  *****************************************************************/
 class SimplexDataList : public vector<SimplexData*> {
  public:
    //******** MANAGERS ********
-   SimplexDataList(int n=0) : vector<SimplexData*>() { reserve(n); }
+   SimplexDataList(int n=0) : vector<SimplexData*>(), _slots(), _num_unslotted(0) {
+      reserve(n);
+   }
    ~SimplexDataList();
 
+   void add(SimplexData* sd);
+   bool remove(SimplexData* sd);
+
+   // Give an item in the list a new lookup key
+   // (see SimplexData::set_id()):
+   void rekey(SimplexData* sd, uintptr_t id);
+
    //******** LOOKUP ********
    SimplexData* get_item(uintptr_t key) const {
       for (vector<SimplexData*>::size_type k=0; k<size(); k++)
@@ -130,6 +169,16 @@ class SimplexDataList : public vector<SimplexData*> {
       return nullptr;
    }
 
+   // Lookup by slot, given the slot registered for the key
+   // (or -1). Only searches the list if it holds items that
+   // were added before their key had a slot, or whose key has
+   // none:
+   SimplexData* get_item(uintptr_t key, int slot) const {
+      if (slot >= 0 && _slots[slot] && _slots[slot]->id() == key)
+         return _slots[slot];
+      return _num_unslotted ? get_item(key) : nullptr;
+   }
+
    //******** CONVENIENCE METHODS ********
    void notify_split(Bsimplex* new_simp) const {
       for (vector<SimplexData*>::size_type k=0; k<size(); k++)
@@ -163,6 +212,15 @@ class SimplexDataList : public vector<SimplexData*> {
          ret = at(k)->handle_subdiv_calc() || ret;
       return ret;
    }
+
+ protected:
+   SimplexData*  _slots[SimplexData::MAX_SLOTS]; // items of registered owners
+   int           _num_unslotted;                 // number of other items
+
+   // Put an item in the slot for its key if that is free, or
+   // count it as unslotted; and undo that:
+   void slot_in (SimplexData* sd);
+   void slot_out(SimplexData* sd);
 };
 
 #endif // SIMPLEX_DATA_H_IS_INCLUDED
@@ -0,0 +1,84 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "mesh/simplex_pool.hpp"
+
+#include <new>
+
+// Slabs start small (for the many tiny meshes built by tools
+// and widgets) and double as the mesh grows, up to a limit.
+// An explicit reserve() can exceed the limit:
+static const size_t MIN_SLAB_BLOCKS = 64;
+static const size_t MAX_SLAB_BLOCKS = 1 << 16;
+
+// Blocks are aligned for any element type:
+static const size_t BLOCK_ALIGN = 16;
+
+static void
+free_slab(char* p)
+{
+   ::operator delete(p);
+}
+
+void
+SimplexPool::add_slab(size_t sz)
+{
+   if (_block_size == 0) {
+      // First allocation fixes the block size:
+      _block_size = max(sz, sizeof(free_block_t));
+      _block_size = (_block_size + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1);
+   }
+
+   size_t n = max(_hint, min(max(_capacity, MIN_SLAB_BLOCKS), MAX_SLAB_BLOCKS));
+   _hint = 0;
+
+   char* slab = (char*)::operator new(n * _block_size);
+   _slabs.push_back(shared_ptr<char>(slab, free_slab));
+
+   _cur = slab;
+   _end = slab + n * _block_size;
+   _capacity += n;
+}
+
+void
+SimplexPool::share(const SimplexPool& p)
+{
+   if (&p == this || p._slabs.empty())
+      return;
+
+   if (_block_size == 0)
+      _block_size = p._block_size;
+   else if (_block_size != p._block_size) {
+      // Elements of different types can't share a free list.
+      // The meshes are the same class when this is called
+      // (see BMESH::merge()), so this shouldn't happen:
+      err_msg("SimplexPool::share: error: block sizes differ (%d vs %d)",
+              (int)_block_size, (int)p._block_size);
+      assert(0);
+   }
+
+   _slabs.insert(_slabs.end(), p._slabs.begin(), p._slabs.end());
+}
+
+void
+SimplexPool::clear()
+{
+   _free = nullptr;
+   _cur  = _end = nullptr;
+   _capacity = 0;
+   _slabs.clear();
+}
@@ -0,0 +1,135 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef SIMPLEX_POOL_H_IS_INCLUDED
+#define SIMPLEX_POOL_H_IS_INCLUDED
+
+#include "std/support.hpp"
+
+#include <memory>
+#include <vector>
+
+/*****************************************************************
+ * SimplexPool:
+ *
+ *      Slab allocator for fixed-size mesh elements.
+ *
+ *      Each BMESH owns one pool for its vertices, one for its
+ *      edges and one for its faces. Elements are carved out of
+ *      large contiguous slabs, so elements of one mesh sit
+ *      next to each other in memory. Released blocks go on a
+ *      free list and get reused by later allocations; the
+ *      slabs themselves are returned to the system in one step
+ *      per slab by clear() (or when the pool is destroyed).
+ *
+ *      The pool only hands out raw memory. The mesh is
+ *      responsible for constructing elements with placement
+ *      new and running their destructors before the block is
+ *      released (see BMESH::new_vert() and BMESH::delete_vert()).
+ *
+ *      Block size is fixed by the first allocation, so a BMESH
+ *      pool holds Bverts while an LMESH pool holds Lverts.
+ *
+ *      Slabs are reference counted. When elements migrate from
+ *      one mesh to another (BMESH::_merge(), split_components()),
+ *      the receiving pool calls share() so the slabs holding
+ *      those elements stay alive as long as either mesh does.
+ *****************************************************************/
+class SimplexPool {
+ public:
+
+   //******** MANAGERS ********
+
+   SimplexPool() :
+      _block_size(0),
+      _free(nullptr),
+      _cur(nullptr),
+      _end(nullptr),
+      _capacity(0),
+      _hint(0) {}
+
+   // Pools are owned by a mesh and never copied:
+   SimplexPool(const SimplexPool&) = delete;
+   SimplexPool& operator=(const SimplexPool&) = delete;
+
+   //******** ALLOCATION ********
+
+   // Return memory for one element of size sz:
+   void* alloc(size_t sz) {
+      if (_free) {
+         assert(sz <= _block_size);
+         free_block_t* ret = _free;
+         _free = ret->_next;
+         return ret;
+      }
+      if (_cur == _end)
+         add_slab(sz);
+      assert(sz <= _block_size);
+      void* ret = _cur;
+      _cur += _block_size;
+      return ret;
+   }
+
+   // Return a block obtained from alloc() (from this pool or
+   // one it shares slabs with) to the free list:
+   void release(void* p) {
+      if (!p)
+         return;
+      free_block_t* b = (free_block_t*)p;
+      b->_next = _free;
+      _free = b;
+   }
+
+   // Make sure the next slab has room for at least n elements,
+   // so a mesh of known size is laid out in one piece:
+   void reserve(size_t n) { _hint = max(_hint, n); }
+
+   // Hold references to the slabs of another pool whose
+   // elements are moving into the mesh that owns this pool:
+   void share(const SimplexPool& p);
+
+   // Drop the free list and all slab references. Caller must
+   // ensure no element allocated by this pool is still alive
+   // (unless it has migrated to a mesh that shares the slab):
+   void clear();
+
+   //******** DIAGNOSTIC ********
+
+   size_t block_size()  const { return _block_size; }
+   size_t num_slabs()   const { return _slabs.size(); }
+   size_t capacity()    const { return _capacity; }
+   size_t num_bytes()   const { return _capacity * _block_size; }
+
+ protected:
+   struct free_block_t {
+      free_block_t* _next;
+   };
+
+   size_t                     _block_size; // bytes per element (aligned)
+   free_block_t*              _free;       // released blocks
+   char*                      _cur;        // next unused block in last slab
+   char*                      _end;        // end of last slab
+   size_t                     _capacity;   // total blocks in our slabs
+   size_t                     _hint;       // min blocks for next slab
+   vector<shared_ptr<char> >  _slabs;      // slab memory (shared)
+
+   //******** INTERNAL METHODS ********
+
+   void add_slab(size_t sz);
+};
+
+#endif // SIMPLEX_POOL_H_IS_INCLUDED
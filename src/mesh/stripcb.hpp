@@ -56,6 +56,12 @@ class StripCB {
    virtual void begin_triangles()               {}  
    virtual void end_triangles  ()               {}
 
+   // Patch::draw_tri_strips() sends an ordered triangle list
+   // (begin_triangles() ... end_triangles()) unless strips were
+   // asked for. Callbacks that depend on the strips themselves
+   // (e.g. to write them out) return true here:
+   virtual bool needs_tri_strips() const        { return false; }
+
    double alpha;
 };
 
@@ -246,13 +246,17 @@ class LoopCalc : public SubdivCalc<T> {
 
       // XXX - should cache omega in lookup table:
 
-      int n = v->p_degree();
+      return interp(centroid(v), get_val(v), smooth_limit_weight(v->p_degree()));
+   }
+
+   // Weight of the vertex itself in the smooth limit mask (the
+   // rest is spread evenly over its n neighbors):
+   static double smooth_limit_weight(int n) {
       double a = 5.0/8 - sqr(3 + 2*cos(TWO_PI/n))/64;
       double o = 3*n/(8*a);
-      double w = o / (o + n);
+      return o / (o + n);
 //       double omega = 3 * n / (5.0 - sqr(3.0 + 2.0*cos(2*M_PI/n))/8.0);
 //       double w = omega / (omega + n);
-      return interp(centroid(v), get_val(v), w);
    }
 
    T crease_limit_val (CLvert* v) const {
@@ -343,45 +347,58 @@ class LoopLoc : public LoopCalc<Wpt> {
       // get neighbors in CCW order:
       Bvert_list nbrs = v->get_ccw_nbrs();
       assert((int)nbrs.size() == v->degree());
-      
-      Wpt t1, t2; // tangent "vectors" 
+
+      Wvec t1, t2;
+      bool ok = limit_tangents(v, nbrs, t1, t2);
+      // number of border edges not 0 or 2: error
+      assert(ok);
+      return ok ? cross(t1, t2).normalized() : Wvec::null();
+   }
+
+   // The two tangent masks of Hoppe et al., given the neighbors
+   // of v in CCW order (as from Bvert::get_ccw_nbrs()). For a
+   // border vertex t1 runs along the border. Returns false (for
+   // more than 2 border edges) if v doesn't have them:
+   static bool limit_tangents(CBvert* v, CBvert_list& nbrs, Wvec& t1, Wvec& t2) {
+      Wpt a, b; // tangent "vectors"
       Bvert_list::size_type n = nbrs.size();
       int bd = v->border_degree();
       if (bd == 0) {
          // no borders: simple case
          for (Bvert_list::size_type k=0; k<n; k++) {
             double theta = TWO_PI * k / n;
-            t1 += nbrs[k]->loc() * cos(theta);
-            t2 += nbrs[k]->loc() * sin(theta);
+            a += nbrs[k]->loc() * cos(theta);
+            b += nbrs[k]->loc() * sin(theta);
          }
       } else if (bd == 2) {
          // t1: along the border:
-         t1 = nbrs.front()->loc() + (-1 * nbrs.back()->loc());
+         a = nbrs.front()->loc() + (-1 * nbrs.back()->loc());
          // t2 goes across the border:
          if (n == 4) {
             // regular case
-            t2 = (      v->loc()*(-2) +
-                  nbrs[0]->loc()*(-1) +
-                  nbrs[1]->loc()*( 2) +
-                  nbrs[2]->loc()*( 2) +
-                  nbrs[3]->loc()*(-1));
+            b = (      v->loc()*(-2) +
+                 nbrs[0]->loc()*(-1) +
+                 nbrs[1]->loc()*( 2) +
+                 nbrs[2]->loc()*( 2) +
+                 nbrs[3]->loc()*(-1));
          } else if (n == 2) {
-            t2 = nbrs.front()->loc() + nbrs.back()->loc() + (-2 * v->loc());
+            b = nbrs.front()->loc() + nbrs.back()->loc() + (-2 * v->loc());
          } else if (n == 3) {
-            t2 = nbrs[1]->loc() + (-1 * v->loc());
+            b = nbrs[1]->loc() + (-1 * v->loc());
          } else {
             double theta = M_PI/(n - 1);
             double c = 2*cos(theta) - 2;
-            t2 = (nbrs.front()->loc() + nbrs.back()->loc())*sin(theta);
+            b = (nbrs.front()->loc() + nbrs.back()->loc())*sin(theta);
             for (Bvert_list::size_type i=1; i<n-1; i++) {
-               t2 += c*sin(i*theta)*nbrs[i]->loc();
+               b += c*sin(i*theta)*nbrs[i]->loc();
             }   
          }
       } else {
-         // number of border edges not 0 or 2: error
-         assert(0);
+         return false;
       }
-      return (cross(t1 - Wpt::Origin(), t2 - Wpt::Origin())).normalized();
+      t1 = a - Wpt::Origin();
+      t2 = b - Wpt::Origin();
+      return true;
    }
 
    //******** DUPLICATING ********
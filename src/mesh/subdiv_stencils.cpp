@@ -0,0 +1,433 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "std/parallel.hpp"
+#include "mesh/lmesh.hpp"
+#include "mesh/subdiv_stencils.hpp"
+
+#include <atomic>
+#include <memory>
+#include <typeinfo>
+
+using namespace mlib;
+
+// rows per thread task:
+static const int STENCIL_GRAIN = 2048;
+
+/*****************************************************************
+ * Weights:
+ *
+ *      Weighted sum of vertices, as (vertex index, weight) pairs
+ *      sorted by index. Has the arithmetic the SubdivCalc
+ *      templates use on points, so a LoopCalc<Weights> (etc.)
+ *      returns the weights of the sum a LoopCalc<Wpt> computes.
+ *****************************************************************/
+class Weights {
+ public:
+   Weights() {}
+   explicit Weights(int i) : _w(1, make_pair(i, 1.0)) {}
+
+   const vector<pair<int,double> >& pairs() const { return _w; }
+
+   // a*s + b*t:
+   static Weights sum(const Weights& a, double s, const Weights& b, double t) {
+      Weights ret;
+      ret._w.reserve(a._w.size() + b._w.size());
+      size_t i = 0, j = 0;
+      while (i < a._w.size() || j < b._w.size()) {
+         if (j == b._w.size() ||
+             (i < a._w.size() && a._w[i].first < b._w[j].first)) {
+            ret.add(a._w[i].first, a._w[i].second*s);
+            i++;
+         } else if (i == a._w.size() || b._w[j].first < a._w[i].first) {
+            ret.add(b._w[j].first, b._w[j].second*t);
+            j++;
+         } else {
+            ret.add(a._w[i].first, a._w[i].second*s + b._w[j].second*t);
+            i++;
+            j++;
+         }
+      }
+      return ret;
+   }
+
+ protected:
+   vector<pair<int,double> > _w;
+
+   void add(int i, double w) {
+      if (w != 0)
+         _w.push_back(make_pair(i, w));
+   }
+};
+
+inline Weights
+operator+(const Weights& a, const Weights& b)
+{
+   return Weights::sum(a, 1, b, 1);
+}
+
+inline Weights
+operator-(const Weights& a, const Weights& b)
+{
+   return Weights::sum(a, 1, b, -1);
+}
+
+inline Weights
+operator*(const Weights& a, double s)
+{
+   return Weights::sum(a, s, Weights(), 0);
+}
+
+inline Weights
+operator*(double s, const Weights& a)
+{
+   return a*s;
+}
+
+inline Weights
+operator/(const Weights& a, double s)
+{
+   return a*(1/s);
+}
+
+/*****************************************************************
+ * WeightCalc:
+ *
+ *      Runs the subdivision scheme C (e.g. LoopCalc<Weights>)
+ *      on weights: the value at each vertex of the mesh is that
+ *      vertex alone, named by its snapshot index.
+ *****************************************************************/
+template <class C>
+class WeightCalc : public C {
+ public:
+   WeightCalc(const MeshSnapshot& snap) : _snap(snap) {}
+
+   virtual Weights get_val(CBvert* v) const {
+      return Weights(_snap.index(v));
+   }
+
+ protected:
+   const MeshSnapshot& _snap;
+};
+
+// The scheme of calc, working on weights; null if not supported.
+// Exact types are checked since e.g. VolPreserve<LoopLoc> is a
+// LoopLoc but not linear:
+static SubdivCalc<Weights>*
+weight_calc(SubdivLocCalc* calc, const MeshSnapshot& snap)
+{
+   if (!calc)
+      return nullptr;
+   if (typeid(*calc) == typeid(LoopLoc))
+      return new WeightCalc<LoopCalc<Weights> >(snap);
+   if (typeid(*calc) == typeid(CatmullClarkLoc))
+      return new WeightCalc<CatmullClarkCalc<Weights> >(snap);
+   if (typeid(*calc) == typeid(HybridLoc))
+      return new WeightCalc<HybridCalc<Weights> >(snap);
+   return nullptr;
+}
+
+// True if SimplexData on s compute its subdivision value:
+static bool
+handles_subdiv(CBsimplex* s)
+{
+   return s->has_data() &&
+      ((SimplexDataList*)s->data_list())->handle_subdiv_calc();
+}
+
+/*****************************************************************
+ * SubdivStencils
+ *****************************************************************/
+SubdivStencils::SubdivStencils(LMESH* ctrl, int levels) :
+   _valid(false),
+   _levels(levels)
+{
+   _valid = build(ctrl, levels);
+   if (!_valid) {
+      _tables.clear();
+      _limit = Table();
+   }
+}
+
+int
+SubdivStencils::num_weights() const
+{
+   int ret = (int)_limit._weight.size();
+   for (auto& t : _tables)
+      ret += (int)t._weight.size();
+   return ret;
+}
+
+bool
+SubdivStencils::matches(LMESH* ctrl, int level) const
+{
+   LMESH* m = ctrl;
+   for (int k=0; k<=level; k++, m = m->_subdiv_mesh.get()) {
+      if (!m || k >= (int)_nverts.size() ||
+          m->nverts() != _nverts[k] ||
+          m->nedges() != _nedges[k] ||
+          m->nfaces() != _nfaces[k])
+         return false;
+   }
+   return true;
+}
+
+bool
+SubdivStencils::build(LMESH* ctrl, int levels)
+{
+   if (!ctrl || !ctrl->is_control_mesh() || levels < 1)
+      return false;
+
+   vector<LMESH*> meshes;
+   for (LMESH* m = ctrl; m && (int)meshes.size() <= levels;
+        m = m->_subdiv_mesh.get())
+      meshes.push_back(m);
+   if ((int)meshes.size() <= levels)
+      return false;
+   for (auto m : meshes) {
+      _nverts.push_back(m->nverts());
+      _nedges.push_back(m->nedges());
+      _nfaces.push_back(m->nfaces());
+   }
+
+   for (int k=0; k<levels; k++) {
+      LMESH* m = meshes[k];
+      LMESH* c = meshes[k+1];
+      if (!m->_dirty_verts.empty())
+         return false;         // not up to date
+      const MeshSnapshot& snap  = m->snapshot();
+      const MeshSnapshot& csnap = c->snapshot();
+      unique_ptr<SubdivCalc<Weights> > calc(weight_calc(m->loc_calc(), snap));
+      if (!calc)
+         return false;
+
+      // Each vertex of the child mesh comes from one vertex or
+      // edge of this mesh, as in Lvert::update_subdivision() and
+      // Ledge::update_subdivision():
+      vector<Weights> rows(c->nverts());
+      vector<bool>    done(c->nverts(), false);
+      for (int i=0; i<m->nverts(); i++) {
+         Lvert* v = m->lv(i);
+         Lvert* s = v->subdiv_vertex();
+         if (!s)
+            continue;
+         if (handles_subdiv(v) || s->has_offset())
+            return false;
+         int r = csnap.index(s);
+         rows[r] = (v->corner_value() > 0) ? Weights(i) : calc->subdiv_val(v);
+         done[r] = true;
+      }
+      for (int i=0; i<m->nedges(); i++) {
+         Ledge* e = m->le(i);
+         Lvert* s = e->subdiv_vertex();
+         if (!s)
+            continue;
+         if (handles_subdiv(e) || s->has_offset())
+            return false;
+         int r = csnap.index(s);
+         rows[r] = calc->subdiv_val(e);
+         done[r] = true;
+      }
+      Table t;
+      t._start.reserve(rows.size() + 1);
+      t._start.push_back(0);
+      for (size_t r=0; r<rows.size(); r++) {
+         if (!done[r])
+            return false;      // e.g. a vertex added by an edit
+         for (auto& w : rows[r].pairs()) {
+            t._index.push_back(w.first);
+            t._weight.push_back(w.second);
+         }
+         t._start.push_back((int)t._index.size());
+      }
+      _tables.push_back(t);
+   }
+
+   // Limit positions of the finest level. The hybrid scheme
+   // takes them from the Loop rules; Catmull-Clark has none:
+   LMESH* f = meshes[levels];
+   const MeshSnapshot& snap = f->snapshot();
+   unique_ptr<SubdivCalc<Weights> > calc(weight_calc(f->loc_calc(), snap));
+   if (calc && typeid(*f->loc_calc()) != typeid(CatmullClarkLoc)) {
+      _limit._start.reserve(f->nverts() + 1);
+      _limit._start.push_back(0);
+      for (int i=0; i<f->nverts(); i++) {
+         Lvert* v = f->lv(i);
+         Weights w = (v->corner_value() > 0) ? Weights(i) : calc->limit_val(v);
+         for (auto& p : w.pairs()) {
+            _limit._index.push_back(p.first);
+            _limit._weight.push_back(p.second);
+         }
+         _limit._start.push_back((int)_limit._index.size());
+      }
+   }
+   return true;
+}
+
+void
+SubdivStencils::apply(const Table& t, const vector<Wpt>& src, vector<Wpt>& dst)
+{
+   int n = t.nrows();
+   dst.resize(n);
+   parallel_for(n, STENCIL_GRAIN, [&](int begin, int end) {
+      for (int i=begin; i<end; i++) {
+         double x = 0, y = 0, z = 0;
+         for (int j=t._start[i]; j<t._start[i+1]; j++) {
+            const Wpt& p = src[t._index[j]];
+            double     w = t._weight[j];
+            x += w*p[0];
+            y += w*p[1];
+            z += w*p[2];
+         }
+         dst[i] = Wpt(x, y, z);
+      }
+   });
+}
+
+// True if v is waiting for an update other than its subdivision
+// position (see Lvert::update_subdivision() and
+// Ledge::update_subdivision()):
+static bool
+needs_more(Lvert* v)
+{
+   if (v->is_clear(Lvert::SUBDIV_CORNER_VALID_BIT) ||
+       (v->is_clear(Lvert::SUBDIV_COLOR_VALID_BIT) && v->has_color()))
+      return true;
+   for (int j=0; j<v->degree(); j++) {
+      Ledge* e = v->le(j);
+      if (e->is_clear(Ledge::SUBDIV_CREASE_VALID_BIT) ||
+          (e->is_clear(Ledge::SUBDIV_COLOR_VALID_BIT) && e->v1()->has_color()))
+         return true;
+   }
+   return false;
+}
+
+bool
+SubdivStencils::update(LMESH* ctrl, int level)
+{
+   if (!_valid || level < 1 || level > levels() || !matches(ctrl, level) ||
+       ctrl->_dirty_verts.empty())
+      return false;
+
+   vector<LMESH*> meshes;
+   for (LMESH* m = ctrl; (int)meshes.size() <= level; m = m->_subdiv_mesh.get())
+      meshes.push_back(m);
+
+   // Only positions may be out of date:
+   for (int k=0; k<level; k++) {
+      CBvert_list& dirty = meshes[k]->_dirty_verts;
+      for (Bvert_list::size_type i=0; i<dirty.size(); i++)
+         if (needs_more((Lvert*)dirty[i]))
+            return false;
+   }
+
+   // All positions down to the given level are about to be
+   // computed, so empty the dirty lists above it:
+   for (int k=0; k<level; k++) {
+      Bvert_list& dirty = meshes[k]->_dirty_verts;
+      for (Bvert_list::size_type i=0; i<dirty.size(); i++) {
+         Lvert* v = (Lvert*)dirty[i];
+         v->clear_bit(Lvert::DIRTY_VERT_LIST_BIT);
+         v->set_bit(Lvert::SUBDIV_LOC_VALID_BIT);
+         for (int j=0; j<v->degree(); j++)
+            v->le(j)->set_bit(Ledge::SUBDIV_LOC_VALID_BIT);
+      }
+      dirty.clear();
+   }
+
+   LMESH* m = ctrl;
+   _src.resize(m->nverts());
+   parallel_for(m->nverts(), STENCIL_GRAIN, [&](int begin, int end) {
+      for (int i=begin; i<end; i++)
+         _src[i] = m->bv(i)->loc();
+   });
+
+   for (int k=0; k<level; k++) {
+      apply(_tables[k], _src, _dst);
+      _src.swap(_dst);
+
+      // Set the positions, and clear what Bvert::geometry_changed()
+      // would, each element in one thread. SimplexData are told
+      // afterward, in this thread:
+      LMESH* c = meshes[k+1];
+      atomic<bool> has_data(false);
+      parallel_for(c->nverts(), STENCIL_GRAIN, [&](int begin, int end) {
+         for (int i=begin; i<end; i++) {
+            Lvert* v = c->lv(i);
+            v->_loc = _src[i];
+            v->clear_bit(Bvert::VALID_NORMAL_BIT);
+            v->clear_bit(Bvert::VALID_STRESSED_BIT);
+            v->clear_bit(Lvert::DISPLACED_LOC_VALID);
+            if (v->has_data())
+               has_data = true;
+         }
+      });
+      parallel_for(c->nedges(), STENCIL_GRAIN, [&](int begin, int end) {
+         for (int i=begin; i<end; i++) {
+            Bedge* e = c->be(i);
+            e->clear_bit(Bedge::CONVEX_VALID_BIT);
+            e->set_sil_stamp(0);
+            if (e->has_data())
+               has_data = true;
+         }
+      });
+      parallel_for(c->nfaces(), STENCIL_GRAIN, [&](int begin, int end) {
+         for (int i=begin; i<end; i++) {
+            Bface* f = c->bf(i);
+            f->_ff_stamp = 0;
+            f->clear_bit(Bface::VALID_NORMAL_BIT);
+            if (f->has_data())
+               has_data = true;
+         }
+      });
+      if (has_data) {
+         for (int i=0; i<c->nverts(); i++) {
+            c->bv(i)->Bsimplex::geometry_changed();
+            c->bv(i)->Bsimplex::normal_changed();
+         }
+         for (int i=0; i<c->nedges(); i++) {
+            c->be(i)->Bsimplex::geometry_changed();
+            c->be(i)->Bsimplex::normal_changed();
+         }
+         for (int i=0; i<c->nfaces(); i++)
+            c->bf(i)->Bsimplex::geometry_changed();
+      }
+      c->BMESH::changed(BMESH::VERT_POSITIONS_CHANGED);
+   }
+
+   // The last level's own subdivision meshes (if any) are now
+   // out of date, and its vertices must be dirty for when they
+   // are made:
+   meshes[level]->mark_all_dirty();
+
+   return true;
+}
+
+bool
+SubdivStencils::limit_locs(LMESH* ctrl, vector<Wpt>& ret) const
+{
+   if (!_valid || !has_limit() || !matches(ctrl, levels()))
+      return false;
+   LMESHptr f = ctrl->subdiv_mesh(levels());
+   vector<Wpt> src(f->nverts());
+   parallel_for(f->nverts(), STENCIL_GRAIN, [&](int begin, int end) {
+      for (int i=begin; i<end; i++)
+         src[i] = f->bv(i)->loc();
+   });
+   apply(_limit, src, ret);
+   return true;
+}
@@ -0,0 +1,119 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef SUBDIV_STENCILS_H_IS_INCLUDED
+#define SUBDIV_STENCILS_H_IS_INCLUDED
+
+#include "mlib/points.hpp"
+
+#include <vector>
+
+class LMESH;
+
+/*****************************************************************
+ * SubdivStencils:
+ *
+ *      Subdivision positions of an LMESH hierarchy as tables of
+ *      weights. For each level, every vertex is a weighted sum of
+ *      vertices of the level above; the weights are found once,
+ *      by running the mesh's own SubdivCalc (Loop, Catmull-Clark
+ *      or hybrid) on weights instead of points. After that, when
+ *      the control vertices move but the topology stays the same
+ *      (e.g. an animated character), each level is a sparse
+ *      matrix times the positions of the level above, computed
+ *      across threads, without visiting the Lverts and Ledges.
+ *
+ *      For Loop and hybrid meshes there is also a table for the
+ *      limit positions of the finest level.
+ *
+ *      Built by LMESH::update_subdivision() for control meshes
+ *      with stencils turned on (LMESH::set_use_stencils()); the
+ *      LMESH discards them when the topology, creases, corners,
+ *      offsets or subdivision scheme change. Tables are not built
+ *      (is_valid() is false) for schemes other than the above,
+ *      for levels with subdivision offsets ("detail"), or where
+ *      SimplexData take over the subdivision calculation.
+ *****************************************************************/
+class SubdivStencils {
+ public:
+
+   //******** MANAGERS ********
+
+   // Build tables for the given number of levels below ctrl,
+   // which must be up to date down to that level:
+   SubdivStencils(LMESH* ctrl, int levels);
+
+   //******** ACCESSORS ********
+
+   bool is_valid()  const { return _valid; }
+   int  levels()    const { return _levels; }
+   bool has_limit() const { return !_limit._start.empty(); }
+
+   // Number of weights in all the tables (for statistics):
+   int  num_weights() const;
+
+   // True if ctrl still has the element counts the tables were
+   // built for, down to the given level:
+   bool matches(LMESH* ctrl, int level) const;
+
+   //******** EVALUATION ********
+
+   // Set positions of levels 1 through level from the control
+   // vertices, and bring the meshes up to date as the regular
+   // LMESH::update_subdivision() would. Returns false (doing
+   // nothing) if the tables can't be used, e.g. because some
+   // change other than vertex positions is waiting:
+   bool update(LMESH* ctrl, int level);
+
+   // Limit positions of the vertices of the finest level, from
+   // their current positions. Returns false if there is no
+   // limit table:
+   bool limit_locs(LMESH* ctrl, std::vector<mlib::Wpt>& ret) const;
+
+ protected:
+   // Compressed rows: the weights of row i are _weight[_start[i]]
+   // through _weight[_start[i+1] - 1], on vertices _index[...]
+   // of the level above:
+   struct Table {
+      std::vector<int>    _start;
+      std::vector<int>    _index;
+      std::vector<double> _weight;
+      int nrows() const { return (int)_start.size() - 1; }
+   };
+
+   bool               _valid;
+   int                _levels;  // levels asked for, even if not valid
+   std::vector<Table> _tables;  // _tables[k]: level k+1 from level k
+   Table              _limit;   // finest level to its limit
+
+   // element counts of each level, 0 through levels():
+   std::vector<int>   _nverts;
+   std::vector<int>   _nedges;
+   std::vector<int>   _nfaces;
+
+   // positions of the level above and the level being computed:
+   std::vector<mlib::Wpt> _src;
+   std::vector<mlib::Wpt> _dst;
+
+   //******** INTERNAL METHODS ********
+
+   bool build(LMESH* ctrl, int levels);
+   static void apply(const Table& t, const std::vector<mlib::Wpt>& src,
+                     std::vector<mlib::Wpt>& dst);
+};
+
+#endif // SUBDIV_STENCILS_H_IS_INCLUDED
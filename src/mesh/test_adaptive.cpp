@@ -0,0 +1,182 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_adaptive.cpp:
+ *
+ *    Regression test for AdaptiveSubdiv on a closed mesh (a torus),
+ *    seen from close by so depths vary across it, for a few eye
+ *    positions and face budgets:
+ *
+ *      balance:  faces sharing a vertex differ by at most a level;
+ *      seams:    the triangles drawn close up: each edge is drawn
+ *                once each way, so no crack or T-junction is left
+ *                between regions at different depths, and each
+ *                corner is sent with a face that holds its vertex;
+ *      creases:  the crease strips of the control patch are made
+ *                of edges of the faces drawn, skipping the edges
+ *                of coarse faces next to finer ones.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/lmesh.hpp"
+#include "mesh/patch.hpp"
+#include "mesh/stripcb.hpp"
+#include "mesh/adaptive_subdiv.hpp"
+
+#include <map>
+
+using namespace mlib;
+
+static int num_failed = 0;
+
+static void
+check(bool ok, const string& what)
+{
+   if (!ok) {
+      cerr << "FAILED: " << what << endl;
+      num_failed++;
+   }
+}
+
+// An n x m torus, with a ring of creases:
+static LMESHptr
+torus(int n, int m)
+{
+   LMESHptr ret = make_shared<LMESH>();
+   Patch* p = ret->new_patch();
+   for (int i = 0; i < n; i++) {
+      double u = 2*M_PI*i/n;
+      for (int j = 0; j < m; j++) {
+         double v = 2*M_PI*j/m;
+         double r = 3 + cos(v);
+         ret->add_vertex(Wpt(r*cos(u), r*sin(u), sin(v)));
+      }
+   }
+   auto vi = [&](int i, int j) { return (i % n)*m + (j % m); };
+   for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+         ret->add_face(vi(i,j), vi(i+1,j), vi(i+1,j+1), p);
+         ret->add_face(vi(i,j), vi(i+1,j+1), vi(i,j+1), p);
+      }
+   }
+   for (int i = 0; i < n; i++)
+      ret->bv(vi(i,0))->lookup_edge(ret->bv(vi(i+1,0)))->set_crease();
+   ret->changed(BMESH::TRIANGULATION_CHANGED);
+   return ret;
+}
+
+// Records the triangles drawn:
+class TriangleCB : public StripCB {
+ public:
+   vector<CBvert*> _verts;
+   bool            _corners_ok = true;
+
+   virtual void faceCB(CBvert* v, CBface* f) {
+      _corners_ok = _corners_ok && f && f->contains(v);
+      _verts.push_back(v);
+   }
+};
+
+static void
+test_view(LMESHptr& m, CWpt& eye, double pix_scale, int budget,
+          const string& what)
+{
+   AdaptiveSubdiv* a = m->adaptive();
+   a->set_face_budget(budget);
+   a->update(eye, pix_scale);
+
+   // balance, and a spread of depths to test on:
+   const MeshSnapshot& snap = m->snapshot();
+   bool balanced = true;
+   int lo = a->max_level(), hi = 0;
+   for (int f = 0; f < snap.nfaces(); f++) {
+      lo = min(lo, a->depth(f));
+      hi = max(hi, a->depth(f));
+      const int* fe = snap.face_edges(f);
+      for (int k = 0; k < 3; k++) {
+         const int* fv = snap.edge_verts(fe[k]);
+         for (int i = 0; i < 2; i++) {
+            const int* ve = snap.vert_edges(fv[i]);
+            for (int j = 0; j < snap.degree(fv[i]); j++) {
+               const int* ef = snap.edge_faces(ve[j]);
+               for (int g = 0; g < 2; g++)
+                  if (ef[g] >= 0 && abs(a->depth(f) - a->depth(ef[g])) > 1)
+                     balanced = false;
+            }
+         }
+      }
+   }
+   check(hi - lo >= 2, what + ": depths vary");
+   check(balanced, what + ": neighbors within a level");
+
+   // seams: each directed edge is matched by its reverse:
+   TriangleCB cb;
+   int n = a->draw_triangles(&cb);
+   check(n > (int)a->front().size(), what + ": seams split");
+   map<pair<CBvert*,CBvert*>,int> count;
+   bool degenerate = false;
+   for (size_t t = 0; t + 2 < cb._verts.size(); t += 3) {
+      for (int k = 0; k < 3; k++) {
+         CBvert* u = cb._verts[t + k], *v = cb._verts[t + (k+1)%3];
+         degenerate = degenerate || u == v;
+         count[make_pair(u, v)]++;
+      }
+   }
+   bool closed = true;
+   for (auto& c : count)
+      closed = closed && c.second == 1 &&
+         count.count(make_pair(c.first.second, c.first.first)) &&
+         count[make_pair(c.first.second, c.first.first)] == 1;
+   check(!degenerate, what + ": no degenerate triangles");
+   check(closed, what + ": drawn surface closed");
+   check(cb._corners_ok, what + ": corners sent with their faces");
+
+   // creases:
+   EdgeStrip* creases = a->creases(m->patches()[0]);
+   check(creases && !creases->empty(), what + ": creases found");
+   bool on_front = true;
+   AdaptiveFrontEdgeFilter front(a);
+   for (int i = 0; creases && i < creases->num(); i++)
+      on_front = on_front && creases->edge(i)->is_crease() &&
+         front.accept(creases->edge(i));
+   check(on_front, what + ": creases on the faces drawn");
+}
+
+int
+main(int argc, char *argv[])
+{
+   LMESHptr m = torus(24, 12);
+   AdaptiveSubdiv* a = new AdaptiveSubdiv(m.get());
+   a->set_max_level(4);
+   m->set_adaptive(a);
+
+   // close to one side, then the other (releasing nothing, and
+   // refining again), then with a budget that runs out, then
+   // nearly touching, where the depths wanted jump by more than
+   // a level from face to face:
+   test_view(m, Wpt( 4.5, 0,  0.5), 100, 1000000, "near +x");
+   test_view(m, Wpt(-4.5, 0, -0.5), 100, 1000000, "near -x");
+   test_view(m, Wpt( 0, 4.2,  0.8), 100, 20000, "near +y, small budget");
+   test_view(m, Wpt(4.02, 0, 0.01), 10, 1000000, "touching +x");
+
+   if (num_failed) {
+      cerr << num_failed << " check(s) failed" << endl;
+      return 1;
+   }
+   cerr << "all checks passed" << endl;
+   return 0;
+}
@@ -0,0 +1,145 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_binio.cpp:
+ *
+ *    Regression test for the binary mesh format: a mesh with
+ *    patches, creases, weak edges, colors, UVs, secondary faces
+ *    and shadow settings is written as .sm text and in the binary
+ *    format and read back; the binary copy must match exactly,
+ *    the text one to the digits written. Read twice, the binary
+ *    file gives meshes with their own keys. An icosahedron must
+ *    read back from both as a closed surface.
+ *
+ *    Files are written to the current directory and removed.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/uv_data.hpp"
+
+using namespace mlib;
+
+// An n x n jittered grid cut along random diagonals into 2
+// patches, with a secondary "fin" standing on its first row:
+static BMESHptr
+grid_mesh(int n)
+{
+   BMESHptr ret = make_shared<BMESH>();
+   Patch* half[2] = { ret->new_patch(), ret->new_patch() };
+   for (int y=0; y<=n; y++)
+      for (int x=0; x<=n; x++)
+         ret->add_vertex(Wpt(x + 0.3*(drand48()-0.5), y + 0.3*(drand48()-0.5), 0));
+   for (int y=0; y<n; y++) {
+      for (int x=0; x<n; x++) {
+         int i = y*(n+1) + x;
+         Patch* p = half[x < n/2 ? 0 : 1];
+         if (drand48() < 0.5) {
+            ret->add_face(i, i+1, i+n+2, p);
+            ret->add_face(i, i+n+2, i+n+1, p);
+         } else {
+            ret->add_face(i, i+1, i+n+1, p);
+            ret->add_face(i+1, i+n+2, i+n+1, p);
+         }
+      }
+   }
+   Bface_list fin;
+   int top = ret->nverts();
+   for (int x=0; x<=n; x++)
+      ret->add_vertex(Wpt(x, 0, 1));
+   for (int x=0; x<n; x++) {
+      fin.push_back(ret->add_face(x+1, x, top+x, half[0]));
+      fin.push_back(ret->add_face(x+1, top+x, top+x+1, half[0]));
+   }
+   fin.push_layer();
+   ret->changed(BMESH::TRIANGULATION_CHANGED);
+
+   for (int i=0; i<ret->nedges(); i++) {
+      Bedge* e = ret->be(i);
+      if (e->nfaces() == 2 && drand48() < 0.2)
+         e->set_crease();
+      else if (e->nfaces() == 2 && !e->f1()->is_quad() &&
+               !e->f2()->is_quad() && drand48() < 0.2)
+         ret->set_weak_edge(e->v1()->index(), e->v2()->index());
+   }
+   for (int i=0; i<ret->nverts(); i++)
+      ret->bv(i)->set_color(COLOR(drand48(), drand48(), drand48()));
+   for (int i=0; i<ret->nfaces(); i++) {
+      Bface* f = ret->bf(i);
+      if (f->is_primary())
+         UVdata::set(f, UVpt(f->v1()->loc()[0]/n, f->v1()->loc()[1]/n),
+                        UVpt(f->v2()->loc()[0]/n, f->v2()->loc()[1]/n),
+                        UVpt(f->v3()->loc()[0]/n, f->v3()->loc()[1]/n));
+   }
+   ret->set_occluder(true);
+   ret->set_shadow_scale(2.5);
+   ret->set_shadow_offset(0.125);
+   return ret;
+}
+
+static void
+test_binary()
+{
+   const int n = 8;
+   const string text_file = "test_binio.sm", bin_file = "test_binio.jbm";
+   srand48(1);
+   BMESHptr m = grid_mesh(n);
+
+   check(m->write_file(text_file.c_str()), "binary: write .sm");
+   check(m->write_binary_file(bin_file.c_str()), "binary: write binary");
+
+   BMESHptr t = BMESH::read_jot_file(text_file.c_str());
+   BMESHptr b = BMESH::read_jot_file(bin_file.c_str());
+   check(t && same_mesh(m, t, 1e-5*n, false), "binary: .sm round trip");
+   check(b && same_mesh(m, b, 0, true), "binary: binary round trip");
+
+   // A binary file read twice gives two meshes with distinct keys:
+   if (b) {
+      BMESHptr c = BMESH::read_jot_file(bin_file.c_str());
+      vector<uintptr_t> keys = key_all(b, "binary");
+      check(c && same_mesh(b, c, 0, true), "binary: read twice");
+      if (c) {
+         vector<uintptr_t> keys2 = key_all(c, "binary, second copy");
+         check_stale(b, keys, "binary");
+         key_all(c, "binary, second copy after the first is gone");
+         check_stale(c, keys2, "binary, second copy");
+      }
+   }
+
+   // A closed surface must read back as one:
+   BMESHptr ico = make_shared<BMESH>();
+   ico->Icosahedron();
+   check(ico->write_file(text_file.c_str()) &&
+         ico->write_binary_file(bin_file.c_str()), "binary: write closed mesh");
+   t = BMESH::read_jot_file(text_file.c_str());
+   b = BMESH::read_jot_file(bin_file.c_str());
+   check(t && same_mesh(ico, t, 1e-5, false) && t->is_closed_surface(),
+         "binary: closed mesh .sm round trip");
+   check(b && same_mesh(ico, b, 0, true) && b->is_closed_surface(),
+         "binary: closed mesh binary round trip");
+
+   remove(text_file.c_str());
+   remove(bin_file.c_str());
+}
+
+int
+main(int argc, char *argv[])
+{
+   test_binary();
+
+   return check_summary();
+}
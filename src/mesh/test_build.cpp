@@ -0,0 +1,120 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_build.cpp:
+ *
+ *    Regression test for BMESH::build() and add_faces(): a grid,
+ *    a second grid appended to it, then triangles joining the two
+ *    (and one repeated, one with a repeated vertex, one with a
+ *    bad index), each with its own patch, must give the mesh that
+ *    add_face() one triangle at a time gives: the same faces
+ *    returned, and the same edges and faces in the same order, in
+ *    the same patches.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+// Same elements in the same order, faces in the same patches:
+static bool
+same_order(CBMESHptr& a, CBMESHptr& b)
+{
+   if (a->nverts() != b->nverts() || a->nedges() != b->nedges() ||
+       a->nfaces() != b->nfaces() || a->npatches() != b->npatches())
+      return false;
+   for (int i=0; i<a->nedges(); i++)
+      if (a->be(i)->v1()->index() != b->be(i)->v1()->index() ||
+          a->be(i)->v2()->index() != b->be(i)->v2()->index())
+         return false;
+   for (int i=0; i<a->nfaces(); i++) {
+      for (int k=1; k<=3; k++)
+         if (a->bf(i)->v(k)->index() != b->bf(i)->v(k)->index())
+            return false;
+      if (a->patches().get_index(a->bf(i)->patch()) !=
+          b->patches().get_index(b->bf(i)->patch()))
+         return false;
+   }
+   return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+   const int n = 12;
+   Wpt_list pts;
+   vector<Point3i> tris;
+   grid(n, pts, tris);
+
+   // one at a time:
+   BMESHptr a = make_shared<BMESH>();
+   for (auto& p : pts)
+      a->add_vertex(p);
+   for (auto& tri : tris)
+      a->add_face(tri[0], tri[1], tri[2]);
+
+   // all at once:
+   BMESHptr b = make_shared<BMESH>();
+   Bface_list got = b->build(pts, tris);
+   check(got.size() == tris.size() &&
+         std::count(got.begin(), got.end(), nullptr) == 0,
+         "build: a face per triangle");
+   check(same_order(a, b), "build: same mesh as add_face()");
+
+   // A second grid above the first, appended to the mesh:
+   Wpt_list up;
+   for (auto& p : pts)
+      up.push_back(p + Wvec(0, 0, 1));
+   int top = a->nverts();
+   for (auto& p : up)
+      a->add_vertex(p);
+   for (auto& tri : tris)
+      a->add_face(tri[0] + top, tri[1] + top, tri[2] + top);
+   b->build(up, tris);
+   check(same_order(a, b), "build: appended to a mesh");
+
+   // Then triangles joining their first rows, with a patch each,
+   // the first triangle again, one with a repeated vertex, and
+   // one with a bad index:
+   vector<Point3i> more;
+   for (int x=0; x<n; x++) {
+      more.push_back(Point3i(x+1, x, top+x));
+      more.push_back(Point3i(x+1, top+x, top+x+1));
+   }
+   more.push_back(tris[0]);
+   more.push_back(Point3i(0, 1, 1));
+   more.push_back(Point3i(0, 1, 2*top));
+   vector<Patch*> pa, pb;
+   for (size_t i=0; i<more.size(); i++) {
+      pa.push_back(a->new_patch());
+      pb.push_back(b->new_patch());
+   }
+   vector<Bface*> one;
+   for (size_t i=0; i<more.size(); i++)
+      one.push_back(a->add_face(more[i][0], more[i][1], more[i][2], pa[i]));
+   Bface_list all = b->add_faces(more, pb);
+
+   bool same_ret = (all.size() == more.size());
+   for (size_t i=0; same_ret && i<more.size(); i++)
+      same_ret = (!one[i] == !all[i]) &&
+         (!one[i] || one[i]->index() == all[i]->index());
+   check(same_ret, "add_faces: same faces returned as add_face()");
+   check(same_order(a, b), "add_faces: same mesh as add_face()");
+
+   return check_summary();
+}
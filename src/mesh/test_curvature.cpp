@@ -0,0 +1,69 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_curvature.cpp:
+ *
+ *    Regression test for incremental curvature updates: on a
+ *    sphere pushed out by a brush in each of several frames, the
+ *    curvature BMESH::curvature() brings up to date must match
+ *    (exactly) the curvature computed from scratch, while only
+ *    recomputing part of the mesh. Then every vertex moves, and
+ *    they must still match.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+static bool
+same_everywhere(BMESHptr m, BMESHcurvature_data* c)
+{
+   BMESHcurvature_data scratch(m);
+   for (int i=0; i<m->nverts(); i++)
+      if (!same_curvature(c, &scratch, m->bv(i)))
+         return false;
+   return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+   const int num_frames = 8;
+
+   BMESHptr m = plain_sphere(3);
+   m->curvature();
+
+   bool match = true, partial = true;
+   for (int frame=0; frame<num_frames; frame++) {
+      brush_stroke(m, frame, num_frames);
+      BMESHcurvature_data* c = m->curvature();
+      partial = partial &&
+         c->num_recomputed() > 0 && c->num_recomputed() < m->nverts()/2;
+      match = match && same_everywhere(m, c);
+   }
+   check(partial, "curvature: brush frames recompute part of the mesh");
+   check(match,   "curvature: incremental matches from scratch");
+
+   for (int i=0; i<m->nverts(); i++)
+      m->bv(i)->set_loc(m->bv(i)->loc()*1.01);
+   m->changed(BMESH::VERT_POSITIONS_CHANGED);
+   check(same_everywhere(m, m->curvature()),
+         "curvature: matches from scratch after every vertex moves");
+
+   return check_summary();
+}
@@ -0,0 +1,115 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_decode.cpp:
+ *
+ *    Regression test for reading text streams: with reads from the
+ *    stream buffer and the tag index table turned off (the old
+ *    way) and on, the same text must read the same:
+ *
+ *      mesh:    a scanned mesh written as .sm text, exactly;
+ *      points:  its vertex positions, as a Wpt_list, exactly;
+ *      records: records of a class with 40 tags, each value to
+ *               the digits written;
+ *      tokens:  all of the above, read as strings.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+#include <sstream>
+
+using namespace mlib;
+
+int
+main(int argc, char *argv[])
+{
+   const int num_records = 50;
+
+   bool fast = STDdstream::fast_reads(), hash = DATA_ITEM::use_tag_index();
+
+   srand48(1);
+   BMESHptr m = scanned_mesh(16);
+   ostringstream mesh_text;
+   m->write_stream(mesh_text);
+
+   Wpt_list pts = m->verts().pts();
+   ostringstream pts_text;
+   {
+      STDdstream out(&pts_text);
+      out << pts;
+   }
+
+   TagRecord written;
+   ostringstream record_text;
+   {
+      STDdstream out(&record_text);
+      for (int i=0; i<num_records; i++)
+         written.format(out);
+   }
+   string all_text = mesh_text.str() + pts_text.str() + record_text.str();
+
+   BMESHptr got[2];
+   Wpt_list got_pts[2];
+   TagRecord record[2];
+   int num_tokens[2];
+   bool records_ok = true;
+   for (int k = 0; k < 2; k++) {
+      STDdstream::set_fast_reads(k == 1);
+      DATA_ITEM::set_use_tag_index(k == 1);
+
+      istringstream in(mesh_text.str());
+      got[k] = BMESH::read_jot_stream(in);
+
+      istringstream pin(pts_text.str());
+      STDdstream pds(&pin);
+      pds >> got_pts[k];
+
+      istringstream rin(record_text.str());
+      STDdstream rds(&rin);
+      for (int i=0; i<num_records; i++) {
+         for (auto& v : record[k]._v)
+            v = -1;
+         string name;
+         rds >> name;
+         record[k].decode(rds);
+         records_ok = records_ok && name == written.class_name();
+         for (int j=0; j<TagRecord::NUM_TAGS; j++)
+            records_ok = records_ok && fabs(record[k]._v[j] - written._v[j]) < 1e-5;
+      }
+
+      istringstream tin(all_text);
+      STDdstream tds(&tin);
+      string s;
+      num_tokens[k] = 0;
+      while (!(tds >> s).fail())
+         num_tokens[k]++;
+   }
+   STDdstream::set_fast_reads(fast);
+   DATA_ITEM::set_use_tag_index(hash);
+
+   check(got[0] && got[0]->nfaces() == m->nfaces(), "mesh: read the old way");
+   check(got[0] && got[1] && same_mesh(got[0], got[1], 0, true),
+         "mesh: the same both ways");
+   check(got_pts[0].size() == pts.size() && got_pts[0] == got_pts[1],
+         "points: the same both ways");
+   check(records_ok, "records: the values written, both ways");
+   check(num_tokens[0] > 0 && num_tokens[0] == num_tokens[1],
+         "tokens: the same number both ways");
+
+   return check_summary();
+}
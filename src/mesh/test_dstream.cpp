@@ -0,0 +1,129 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_dstream.cpp:
+ *
+ *    Regression test for the binary STDdstream encoding: a scanned
+ *    mesh written as a mesh record (the .sm format) and its vertex
+ *    positions, as a Wpt_list, must read back exactly from the
+ *    binary encoding, and to the digits written from the text
+ *    one. A stream in the other byte order must read back too.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+#include <sstream>
+
+using namespace mlib;
+
+static void
+swapped_bytes(ostringstream& os, const void* data, size_t size)
+{
+   for (size_t i = size; i > 0; i--)
+      os.put(((const char*)data)[i - 1]);
+}
+
+// A stream with the same values as "out << 7 << 2.5 << pts",
+// made by hand, with the bytes of each scalar reversed, must
+// read back those values:
+static bool
+check_swapped()
+{
+   const int one = 1;
+   Wpt_list pts;
+   pts.push_back(Wpt(1, 2, 3));
+   pts.push_back(Wpt(-4.5, 1e-9, 6e20));
+   ostringstream os;
+   os.write("\0JOTBIN", 7);
+   os.put(*(const char*)&one ? 'b' : 'l');
+   int32_t i = 7;
+   double  d = 2.5;
+   os.put('i');
+   swapped_bytes(os, &i, 4);
+   os.put('d');
+   swapped_bytes(os, &d, 8);
+   uint32_t comps = 3;
+   uint64_t num   = pts.size();
+   os.put('[');
+   os.put('d');
+   swapped_bytes(os, &comps, 4);
+   swapped_bytes(os, &num, 8);
+   for (auto& p : pts)
+      for (int k = 0; k < 3; k++)
+         swapped_bytes(os, &p[k], 8);
+
+   istringstream in(os.str());
+   STDdstream ds(&in);
+   int      i2 = 0;
+   double   d2 = 0;
+   Wpt_list pts2;
+   ds >> i2 >> d2 >> pts2;
+   return ds.binary_in() && ds.swap_bytes() && !ds.fail() &&
+      i2 == 7 && d2 == 2.5 && pts2 == pts;
+}
+
+int
+main(int argc, char *argv[])
+{
+   const int n = 16;
+
+   srand48(1);
+   BMESHptr m = scanned_mesh(n);
+   Wpt_list pts = m->verts().pts();
+
+   BMESHptr got[2];
+   Wpt_list got_pts[2];
+   bool binary[2];
+   for (int k = 0; k < 2; k++) {
+      ostringstream os;
+      {
+         STDdstream out(&os);
+         if (k == 1)
+            out.set_binary();
+         m->format(out);
+      }
+      istringstream in(os.str());
+      got[k] = BMESH::read_jot_stream(in);
+
+      ostringstream pos;
+      {
+         STDdstream out(&pos);
+         if (k == 1)
+            out.set_binary();
+         out << pts;
+      }
+      binary[k] = (pos.str().compare(0, 7, string("\0JOTBIN", 7)) == 0);
+      istringstream pin(pos.str());
+      STDdstream pds(&pin);
+      pds >> got_pts[k];
+   }
+   check(!binary[0] && binary[1], "binary: encoding chosen per stream");
+
+   // text keeps 6 digits; binary is exact:
+   check(got[1] && same_mesh(m, got[1], 0, true), "binary: mesh read back exactly");
+   check(got_pts[1] == pts, "binary: points read back exactly");
+   check(got[0] && same_mesh(m, got[0], 1e-5*n, false), "text: mesh read back");
+   bool pts_ok = (got_pts[0].size() == pts.size());
+   for (size_t i=0; pts_ok && i<pts.size(); i++)
+      pts_ok = got_pts[0][i].dist(pts[i]) < 1e-5*n;
+   check(pts_ok, "text: points read back");
+
+   check(check_swapped(), "binary: other byte order read back");
+
+   return check_summary();
+}
@@ -0,0 +1,87 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_keys.cpp:
+ *
+ *    Regression test for Bsimplex keys: meshes are built, keyed
+ *    and deleted over and over, until key table slots have been
+ *    recycled through all their generations. A key must find its
+ *    element while it lives and nothing after; no key may ever be
+ *    handed out twice; slots out of generations are retired; and
+ *    freed slots are reused, so the table stays far smaller than
+ *    the number of keys made.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+#include <unordered_set>
+
+using namespace mlib;
+
+/*****************************************************************
+ * keys
+ *****************************************************************/
+static void
+test_keys()
+{
+   // Each slot is reused about once every 1.5 rounds, so after
+   // 300 rounds all of them have run out of generations:
+   const int num_verts = 2*Bsimplex::IDtable::MIN_FREE;
+   const int num_rounds = 300;
+
+   unordered_set<uintptr_t> seen;
+   vector<uintptr_t> old_keys;
+   bool found = true, stale = false, unique = true;
+   size_t start_size = Bsimplex::key_table_size();
+   for (int r = 0; r < num_rounds; r++) {
+      BMESHptr m = make_shared<BMESH>();
+      for (int i = 0; i < num_verts; i++)
+         m->add_vertex(Wpt(i, r, 0));
+      vector<uintptr_t> keys;
+      for (int i = 0; i < num_verts; i++) {
+         uintptr_t k = m->bv(i)->key();
+         keys.push_back(k);
+         unique = unique && k && seen.insert(k).second;
+      }
+      for (int i = 0; i < num_verts; i++)
+         found = found && Bsimplex::lookup(keys[i]) == m->bv(i);
+      for (auto k : old_keys)
+         stale = stale || Bsimplex::lookup(k);
+      m.reset();
+      for (auto k : keys)
+         stale = stale || Bsimplex::lookup(k);
+      old_keys.insert(old_keys.end(), keys.begin(), keys.end());
+   }
+   check(found,   "keys: live keys find their elements");
+   check(!stale,  "keys: dead keys find nothing");
+   check(unique,  "keys: no key handed out twice");
+   check(Bsimplex::num_retired() > 0, "keys: used-up slots are retired");
+   check(Bsimplex::key_table_size() - start_size < seen.size()/16,
+         "keys: freed slots are reused");
+}
+
+/*****************************************************************
+ * main
+ *****************************************************************/
+int
+main(int argc, char *argv[])
+{
+   test_keys();
+
+   return check_summary();
+}
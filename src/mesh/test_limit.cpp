@@ -0,0 +1,73 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_limit.cpp:
+ *
+ *    Regression test for LMESH::limit_data(): at levels 1 to 3 of
+ *    a bumpy Loop mesh, the limit positions and normals it finds
+ *    for all vertices at once must match LMESH::limit_loc() and
+ *    LoopLoc::limit_normal() for each vertex, and tangents must
+ *    be unit length. Also for a subset of the vertices, with only
+ *    positions asked for.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+int
+main(int argc, char *argv[])
+{
+   for (int level = 1; level <= 3; level++) {
+      string what = "level " + to_string(level);
+      LMESHptr ctrl = bumpy_lmesh();
+      ctrl->update_subdivision(level);
+      LMESHptr m = ctrl->subdiv_mesh(level);
+      int n = m->nverts();
+
+      vector<Wpt>  locs;
+      vector<Wvec> norms, tans;
+      m->limit_data(m->verts(), &locs, &norms, &tans);
+      bool sizes_ok = ((int)locs.size() == n && (int)norms.size() == n &&
+                       (int)tans.size() == n);
+      check(sizes_ok, what + ": a result per vertex");
+
+      LoopLoc loop;
+      bool locs_ok = sizes_ok, norms_ok = sizes_ok, tans_ok = sizes_ok;
+      for (int i=0; sizes_ok && i<n; i++) {
+         locs_ok  = locs_ok  && (locs[i] - m->limit_loc(m->bv(i))).is_null(1e-9);
+         norms_ok = norms_ok && (norms[i] - loop.limit_normal(m->bv(i))).is_null(1e-9);
+         tans_ok  = tans_ok  && fabs(tans[i].length() - 1) < 1e-9;
+      }
+      check(locs_ok,  what + ": positions match limit_loc()");
+      check(norms_ok, what + ": normals match limit_normal()");
+      check(tans_ok,  what + ": unit tangents");
+
+      Bvert_list some;
+      for (int i=0; i<n; i += 3)
+         some.push_back(m->bv(i));
+      vector<Wpt> some_locs;
+      m->limit_data(some, &some_locs);
+      bool some_ok = (some_locs.size() == some.size());
+      for (size_t i=0; some_ok && i<some.size(); i++)
+         some_ok = (some_locs[i] == locs[3*i]);
+      check(some_ok, what + ": same positions for a subset");
+   }
+
+   return check_summary();
+}
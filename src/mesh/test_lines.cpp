@@ -0,0 +1,83 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_lines.cpp:
+ *
+ *    Regression test for FeatureLines: on a bumpy sphere, from 16
+ *    eye positions, the suggestive contours it traces must cross
+ *    (with one segment each) just the faces the serial per-vertex
+ *    evaluation of the line drawing shader's test finds. All four
+ *    kinds of lines together must find some lines, and again
+ *    when the same stamp is given twice.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/feature_lines.hpp"
+
+using namespace mlib;
+
+int
+main(int argc, char *argv[])
+{
+   const int num_eyes = 16;
+   const int all_kinds = FeatureLines::SUGGESTIVE | FeatureLines::RIDGES |
+      FeatureLines::VALLEYS | FeatureLines::APPARENT_RIDGES;
+
+   BMESHptr m = bumpy_sphere(4);
+   m->curvature();
+   m->update_normals();
+
+   FeatureLines lines;
+   double fs = m->curvature()->feature_size();
+   double sc_thresh = lines.sug_thresh()/(fs*fs);
+
+   bool sc_ok = true, found = false, all_ok = true, stamp_ok = true;
+   vector<ZXseg> segs;
+   for (int k=0; k<num_eyes; k++) {
+      double a = 2*M_PI*k/num_eyes;
+      Wpt eye(3*cos(a), 3*sin(a), 1.5*cos(3*a));
+
+      int serial = 0;
+      for (int i=0; i<m->nfaces(); i++)
+         if (serial_sc_face(m, m->bf(i), eye, sc_thresh))
+            serial++;
+
+      segs.clear();
+      lines.extract(m, eye, FeatureLines::SUGGESTIVE, segs);
+      int traced = 0;
+      for (auto& seg : segs)
+         if (!seg.end())
+            traced++;
+      sc_ok = sc_ok && traced == serial;
+      found = found || serial > 0;
+
+      segs.clear();
+      int num = lines.extract(m, eye, all_kinds, segs, nullptr, k+1);
+      all_ok = all_ok && num > 0 && lines.num_faces() > 0;
+
+      vector<ZXseg> again;
+      int num2 = lines.extract(m, eye, all_kinds, again, nullptr, k+1);
+      stamp_ok = stamp_ok && num2 == num && again.size() == segs.size();
+   }
+   check(found,    "lines: some suggestive contours");
+   check(sc_ok,    "lines: a segment per face the serial test finds");
+   check(all_ok,   "lines: all kinds find lines");
+   check(stamp_ok, "lines: same lines from the kept fields");
+
+   return check_summary();
+}
@@ -0,0 +1,173 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_nearest.cpp:
+ *
+ *    Regression test for ProximityIndex and BMESH::nearest_vert()
+ *    and nearest_edge(): for random points near the surface, the
+ *    nearest, k nearest and within-radius vertices and edges must
+ *    be as far as brute force search finds them. Run on a
+ *    subdivided icosahedron before and after its vertices move
+ *    (so the indices are refit), and on a grid before and after
+ *    faces are added (so they are rebuilt).
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/proximity_index.hpp"
+
+#include <algorithm>
+
+using namespace mlib;
+
+// Distance from p to vertex or edge i of m:
+static double
+dist(CBMESHptr& m, ProximityIndex::elem_t type, int i, CWpt& p)
+{
+   if (type == ProximityIndex::VERTS)
+      return p.dist(m->bv(i)->loc());
+   Wpt q;
+   m->be(i)->project_to_simplex(p, q);
+   return p.dist(q);
+}
+
+// Sorted distances from p to the given elements:
+static vector<double>
+dists(CBMESHptr& m, ProximityIndex::elem_t type, const vector<int>& elems,
+      CWpt& p)
+{
+   vector<double> ret;
+   for (int i : elems)
+      ret.push_back(dist(m, type, i, p));
+   sort(ret.begin(), ret.end());
+   return ret;
+}
+
+static bool
+same_dists(const vector<double>& a, const vector<double>& b)
+{
+   if (a.size() != b.size())
+      return false;
+   for (size_t i=0; i<a.size(); i++)
+      if (fabs(a[i] - b[i]) > 1e-12)
+         return false;
+   return true;
+}
+
+static void
+check_queries(BMESHptr m, ProximityIndex& index, const string& what)
+{
+   ProximityIndex::elem_t type = index.type();
+   int n = (type == ProximityIndex::VERTS) ? m->nverts() : m->nedges();
+   string name = what + ((type == ProximityIndex::VERTS) ? " verts" : " edges");
+   double r = 2*m->avg_len();
+
+   srand48(1);
+   bool nearest_ok = true, mesh_ok = true, knn_ok = true, within_ok = true;
+   for (int j=0; j<200; j++) {
+      Bvert* v = m->bv(lrand48() % m->nverts());
+      Wpt p = v->loc() + Wvec(drand48()-0.5, drand48()-0.5, drand48()-0.5)*0.2;
+
+      vector<int> all(n);
+      for (int i=0; i<n; i++)
+         all[i] = i;
+      vector<double> brute = dists(m, type, all, p);
+
+      int i = index.nearest(p);
+      nearest_ok = nearest_ok && i >= 0 &&
+         fabs(dist(m, type, i, p) - brute[0]) < 1e-12;
+
+      // the index BMESH keeps for nearest_vert() / nearest_edge():
+      Bsimplex *s, *t;
+      if (type == ProximityIndex::VERTS) {
+         s = m->nearest_vert(p);
+         t = brute_nearest_vert(m, p);
+      } else {
+         s = m->nearest_edge(p);
+         t = brute_nearest_edge(m, p);
+      }
+      Wpt a, b;
+      mesh_ok = mesh_ok && s &&
+         fabs(p.dist(s->project_to_simplex(p, a)) -
+              p.dist(t->project_to_simplex(p, b))) < 1e-12;
+
+      vector<int> ret;
+      index.k_nearest(p, 8, ret);
+      knn_ok = knn_ok &&
+         same_dists(dists(m, type, ret, p),
+                    vector<double>(brute.begin(), brute.begin() + 8));
+
+      index.within(p, r, ret);
+      within_ok = within_ok &&
+         same_dists(dists(m, type, ret, p),
+                    vector<double>(brute.begin(),
+                                   upper_bound(brute.begin(), brute.end(), r)));
+   }
+   check(nearest_ok, name + ": nearest");
+   check(mesh_ok,    name + ": BMESH nearest");
+   check(knn_ok,     name + ": k nearest");
+   check(within_ok,  name + ": within radius");
+}
+
+static void
+check_both(BMESHptr m, ProximityIndex& verts, ProximityIndex& edges,
+           const string& what)
+{
+   check_queries(m, verts, what);
+   check_queries(m, edges, what);
+}
+
+int
+main(int argc, char *argv[])
+{
+   LMESHptr ctrl = subdiv_icosahedron(3);
+   BMESHptr cur = ctrl->cur_mesh();
+   {
+      ProximityIndex verts(cur.get(), ProximityIndex::VERTS);
+      ProximityIndex edges(cur.get(), ProximityIndex::EDGES);
+      check_both(cur, verts, edges, "sphere");
+
+      for (int i=0; i<cur->nverts(); i++) {
+         Wpt p = cur->bv(i)->loc();
+         cur->bv(i)->set_loc(Wpt(p[0]*1.5, p[1], p[2]*0.5));
+      }
+      cur->changed(BMESH::VERT_POSITIONS_CHANGED);
+      check_both(cur, verts, edges, "moved sphere");
+   }
+
+   const int n = 16;
+   Wpt_list pts;
+   vector<Point3i> tris;
+   grid(n, pts, tris);
+   BMESHptr m = make_shared<BMESH>();
+   m->build(pts, tris);
+   m->changed(BMESH::TOPOLOGY_CHANGED);
+   {
+      ProximityIndex verts(m.get(), ProximityIndex::VERTS);
+      ProximityIndex edges(m.get(), ProximityIndex::EDGES);
+      check_both(m, verts, edges, "grid");
+
+      // a second grid above the first:
+      for (auto& p : pts)
+         p += Wvec(0, 0, 0.5);
+      m->build(pts, tris);
+      m->changed(BMESH::TOPOLOGY_CHANGED);
+      check_both(m, verts, edges, "grown grid");
+   }
+
+   return check_summary();
+}
@@ -0,0 +1,105 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_normals.cpp:
+ *
+ *    Regression test for BMESH::update_normals() (forced on for
+ *    any size of mesh): after the vertices move, the face and
+ *    vertex normals it computes in one batch must match the ones
+ *    Bface::norm() and Bvert::norm() compute lazily. Run on a
+ *    bumpy subdivided icosahedron, and on a bumpy grid (border
+ *    vertices) with fins above and below one side (non-manifold
+ *    edges).
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+// Moves every vertex (sin bumps on all 3 axes), then tells the
+// mesh:
+static void
+bump(BMESHptr m, double amount)
+{
+   for (int i=0; i<m->nverts(); i++) {
+      Wpt p = m->bv(i)->loc();
+      m->bv(i)->set_loc(p + Wvec(sin(3*p[1]), sin(5*p[2]), sin(7*p[0]))*amount);
+   }
+   m->changed(BMESH::VERT_POSITIONS_CHANGED);
+}
+
+// Lazy normals vs. batch normals, after a move:
+static void
+check_normals(BMESHptr m, const string& what)
+{
+   m->update_normals();
+   bump(m, 0.05);
+   vector<Wvec> vn, fn;
+   for (int i=0; i<m->nverts(); i++)
+      vn.push_back(m->bv(i)->norm());
+   for (int i=0; i<m->nfaces(); i++)
+      fn.push_back(m->bf(i)->norm());
+
+   // the normals go stale again, for the batch to recompute:
+   for (int i=0; i<m->nverts(); i++)
+      m->bv(i)->set_loc(m->bv(i)->loc());
+   m->changed(BMESH::VERT_POSITIONS_CHANGED);
+   m->update_normals();
+   bool faces_ok = true, verts_ok = true;
+   for (int i=0; i<m->nfaces(); i++)
+      faces_ok = faces_ok && m->bf(i)->is_set(Bface::VALID_NORMAL_BIT) &&
+         (m->bf(i)->norm() - fn[i]).is_null(1e-6);
+   // (non-manifold vertices are left to the lazy path)
+   for (int i=0; i<m->nverts(); i++) {
+      Bvert* v = m->bv(i);
+      verts_ok = verts_ok &&
+         (v->is_set(Bvert::VALID_NORMAL_BIT) || !v->is_manifold()) &&
+         (v->norm() - vn[i]).is_null(1e-6);
+   }
+   check(faces_ok, what + ": batch face normals match lazy ones");
+   check(verts_ok, what + ": batch vertex normals match lazy ones");
+}
+
+int
+main(int argc, char *argv[])
+{
+   Config::set_var_int("JOT_BATCH_NORMALS_MIN_FACES", 0);
+
+   LMESHptr ctrl = subdiv_icosahedron(3);
+   check_normals(ctrl->cur_mesh(), "sphere");
+
+   const int n = 16;
+   Wpt_list pts;
+   vector<Point3i> tris;
+   grid(n, pts, tris);
+   for (int z=-1; z<=1; z+=2) {
+      int top = pts.size();
+      for (int x=0; x<=n; x++)
+         pts.push_back(Wpt(x, 0, z));
+      for (int x=0; x<n; x++) {
+         tris.push_back(Point3i(x+1, x, top+x));
+         tris.push_back(Point3i(x+1, top+x, top+x+1));
+      }
+   }
+   BMESHptr m = make_shared<BMESH>();
+   m->build(pts, tris);
+   m->changed(BMESH::TOPOLOGY_CHANGED);
+   check_normals(m, "grid");
+
+   return check_summary();
+}
@@ -0,0 +1,104 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_obj.cpp:
+ *
+ *    Regression test for reading .obj files: a grid of quads and
+ *    triangles with UVs, normals, materials, negative indices and
+ *    line continuations is read with OBJReader::read() and
+ *    read_file(); both must give the same mesh, with the UVs and
+ *    creases the file describes. Each mesh also has all its
+ *    elements keyed; the keys must find their elements, and once
+ *    the mesh is gone, nothing.
+ *
+ *    The file is written to the current directory and removed.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/objreader.hpp"
+#include "mesh/uv_data.hpp"
+
+#include <fstream>
+
+using namespace mlib;
+
+static void
+test_obj()
+{
+   const int n = 8;
+   const string name = "test_obj.obj";
+   srand48(2);
+   write_obj(name, n);
+
+   BMESHptr got[2];
+   OBJReader readers[2];
+   ifstream in(name.c_str());
+   check(readers[0].read(in), "obj: read()");
+   check(readers[1].read_file(name), "obj: read_file()");
+   for (int k=0; k<2; k++)
+      got[k] = readers[k].get_mesh();
+   remove(name.c_str());
+   if (!got[0] || !got[1]) {
+      check(false, "obj: meshes built");
+      return;
+   }
+
+   // Both readers give the same mesh:
+   BMESHptr& a = got[0], &b = got[1];
+   check(same_obj_mesh(a, b), "obj: read() and read_file() agree");
+
+   // ... and it is the mesh in the file:
+   check(a->nverts() == (n+1)*(n+1) && a->nfaces() == 2*n*n,
+         "obj: vertex and face counts");
+   check(a->npatches() == 4, "obj: a patch per material");
+   bool uvs_ok = true;
+   for (int i=0; i<a->nfaces(); i++) {
+      Bface* f = a->bf(i);
+      for (int c=1; c<=3; c++) {
+         int v = f->v(c)->index();
+         UVpt uv(double(v % (n+1))/n, double(v / (n+1))/n);
+         uvs_ok = uvs_ok && UVdata::has_uv(f) &&
+            UVdata::get_uv(f->v(c), f).dist(uv) < 1e-6;
+      }
+   }
+   check(uvs_ok, "obj: texture coordinates");
+   int creases = 0;
+   bool creases_ok = true;
+   for (int i=0; i<a->nedges(); i++) {
+      Bedge* e = a->be(i);
+      if (e->is_crease()) {
+         creases++;
+         creases_ok = creases_ok &&
+            e->v1()->index() / (n+1) == n/2 && e->v2()->index() / (n+1) == n/2;
+      }
+   }
+   check(creases == n && creases_ok, "obj: creases where the normals change");
+
+   vector<uintptr_t> keys = key_all(a, "obj");
+   check_stale(a, keys, "obj");
+   keys = key_all(b, "obj, read_file()");
+   check_stale(b, keys, "obj, read_file()");
+}
+
+int
+main(int argc, char *argv[])
+{
+   test_obj();
+
+   return check_summary();
+}
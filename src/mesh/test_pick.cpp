@@ -0,0 +1,83 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_pick.cpp:
+ *
+ *    Regression test for BMESH::pick_face() and pick_faces() with
+ *    the FaceBVH: on a subdivided icosahedron, rays through it and
+ *    rays that miss it must hit what a brute force loop over all
+ *    faces hits, before and after the vertices move (so the tree
+ *    is refit).
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+// Picks all rays one at a time and batched, comparing hit points
+// with the brute force ones (faces may differ when a ray passes
+// exactly through an edge or vertex):
+static void
+check_picks(CBMESHptr& m, const vector<Wline>& rays, const string& what)
+{
+   vector<Bface*> batch_faces;
+   vector<Wpt>    batch_hits;
+   m->pick_faces(rays, batch_faces, batch_hits);
+
+   bool hits_ok = true, batch_ok = true;
+   for (size_t i=0; i<rays.size(); i++) {
+      Wpt slow_hit, fast_hit;
+      Bface* slow = brute_pick(m, rays[i], slow_hit);
+      Bface* fast = m->pick_face(rays[i], fast_hit);
+      hits_ok = hits_ok && !slow == !fast &&
+         (!slow || slow_hit.dist(fast_hit) < 1e-9);
+      batch_ok = batch_ok && batch_faces[i] == fast &&
+         (!fast || batch_hits[i].dist(fast_hit) < 1e-9);
+   }
+   check(hits_ok,  what + ": pick_face() hits what brute force hits");
+   check(batch_ok, what + ": pick_faces() hits what pick_face() hits");
+}
+
+int
+main(int argc, char *argv[])
+{
+   // Rays from outside through random points inside, and rays
+   // passing the sphere by:
+   srand48(1);
+   vector<Wline> rays;
+   for (int i=0; i<500; i++) {
+      Wvec dir = Wvec(drand48()-0.5, drand48()-0.5, drand48()-0.5);
+      Wpt  a   = Wpt::Origin() + dir.normalized()*4;
+      Wpt  b   = Wpt(drand48()-0.5, drand48()-0.5, drand48()-0.5)*0.5;
+      rays.push_back(Wline(a, b));
+      rays.push_back(Wline(a, b + cross(dir, b - a).normalized()*3));
+   }
+
+   LMESHptr ctrl = subdiv_icosahedron(3);
+   BMESHptr cur = ctrl->cur_mesh();
+   check_picks(cur, rays, "pick");
+
+   for (int i=0; i<cur->nverts(); i++) {
+      Wpt p = cur->bv(i)->loc();
+      cur->bv(i)->set_loc(Wpt(p[0]*1.5, p[1], p[2]*0.5));
+   }
+   cur->changed(BMESH::VERT_POSITIONS_CHANGED);
+   check_picks(cur, rays, "pick after a move");
+
+   return check_summary();
+}
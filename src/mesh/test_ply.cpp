@@ -0,0 +1,81 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_ply.cpp:
+ *
+ *    Regression test for loading PLY files directly: a grid
+ *    written as ascii and both binary PLY formats must load as
+ *    the mesh ply2sm makes of it, and a tetrahedron as a closed
+ *    surface. Each loaded grid also has all its elements keyed;
+ *    the keys must find their elements, and once the mesh is
+ *    gone, nothing.
+ *
+ *    Files are written to the current directory and removed.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+static void
+test_ply()
+{
+   static const char* formats[3] = {
+      "ascii", "binary_little_endian", "binary_big_endian"
+   };
+   const int n = 8;
+   const string name = "test_ply.ply";
+   srand48(3);
+
+   vector<float> xyz;
+   vector<unsigned char> rgb;
+   vector<vector<int>> faces;
+   BMESHptr m = ply_grid(n, xyz, rgb, faces);
+
+   for (auto format : formats) {
+      string what = string("ply, ") + format;
+      write_ply(name, format, xyz, rgb, faces);
+      BMESHptr got = BMESH::read_jot_file(name.c_str());
+      remove(name.c_str());
+      check(got && same_ply_mesh(m, got), what + ": loads the ply2sm mesh");
+      if (got) {
+         vector<uintptr_t> keys = key_all(got, what);
+         check_stale(got, keys, what);
+      }
+   }
+
+   // A tetrahedron must load as a closed surface:
+   vector<float> tet_xyz = { 0,0,0, 1,0,0, 0,1,0, 0,0,1 };
+   vector<unsigned char> tet_rgb(12, 128);
+   vector<vector<int>> tet_faces = { {0,2,1}, {0,1,3}, {0,3,2}, {1,2,3} };
+   for (auto format : formats) {
+      write_ply(name, format, tet_xyz, tet_rgb, tet_faces);
+      BMESHptr got = BMESH::read_jot_file(name.c_str());
+      remove(name.c_str());
+      check(got && got->nfaces() == 4 && got->is_closed_surface(),
+            string("ply, ") + format + ": tetrahedron is a closed surface");
+   }
+}
+
+int
+main(int argc, char *argv[])
+{
+   test_ply();
+
+   return check_summary();
+}
@@ -0,0 +1,94 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_prefetch.cpp:
+ *
+ *    Regression test for IOManager::prefetch(): given a scene
+ *    naming 6 mesh files with "mesh_data_file" tags (and one that
+ *    doesn't exist), each file must be read ahead, taken once,
+ *    and decode (with read_data(), as TEXBODY does) to the mesh
+ *    read_file() reads from it. The missing file and files not
+ *    named get nothing, and clear_prefetched() drops what was
+ *    not taken.
+ *
+ *    Files are written to the current directory and removed.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "net/io_manager.hpp"
+
+#include <fstream>
+
+using namespace mlib;
+
+int
+main(int argc, char *argv[])
+{
+   const int num_meshes = 6;
+   const string scene = "test_prefetch.jot", missing = "test_prefetch_missing.sm";
+
+   // (what TEXBODY registers, which isn't linked in here)
+   IOManager::add_prefetch_tag("mesh_data_file", IOManager::read_bytes);
+
+   srand48(1);
+   vector<string> names = write_grid_scene(scene, 16, num_meshes);
+   {
+      ofstream out(scene.c_str(), ios::app);
+      out << "TEXBODY {\n\tname missing\n\tmesh_data_file { "
+          << missing << " }\n\t}\n";
+   }
+   string prefix = IOManager::load_prefix();
+
+   vector<BMESHptr> serial;
+   for (auto& name : names) {
+      serial.push_back(make_shared<LMESH>());
+      serial.back()->read_file((prefix + name).c_str());
+   }
+
+   IOManager::prefetch(scene);
+   bool found = true, same = true, once = true;
+   for (int k = 0; k < num_meshes; k++) {
+      string path = prefix + names[k];
+      shared_ptr<string> data =
+         static_pointer_cast<string>(IOManager::take_prefetched(path));
+      found = found && data && !data->empty();
+      if (!data)
+         continue;
+      BMESHptr m = make_shared<LMESH>();
+      same = same && m->read_data(*data) && same_ply_mesh(serial[k], m);
+      once = once && !IOManager::take_prefetched(path);
+   }
+   check(found, "prefetch: every mesh file read ahead");
+   check(same,  "prefetch: each decodes to the mesh read_file() reads");
+   check(once,  "prefetch: each taken once");
+   check(!IOManager::take_prefetched(prefix + missing),
+         "prefetch: nothing for a missing file");
+   check(!IOManager::take_prefetched(prefix + scene),
+         "prefetch: nothing for a file not named");
+
+   IOManager::prefetch(scene);
+   IOManager::clear_prefetched();
+   check(!IOManager::take_prefetched(prefix + names[0]),
+         "prefetch: cleared");
+
+   for (auto& name : names)
+      remove(name.c_str());
+   remove(scene.c_str());
+
+   return check_summary();
+}
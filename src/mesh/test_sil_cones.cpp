@@ -0,0 +1,86 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_sil_cones.cpp:
+ *
+ *    Regression test for the SilConeTree: on a bumpy sphere, from
+ *    eye positions circling it (in close and far out), the tree's
+ *    candidates must include every silhouette edge the brute
+ *    force per-edge test finds, and find_sil_edges_culled() must
+ *    find exactly those edges. Checked again after the vertices
+ *    move (so the tree is refit) and after the mesh is rebuilt
+ *    with more faces (so it is rebuilt); from afar, the tree must
+ *    rule some edges out.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+#include <algorithm>
+
+using namespace mlib;
+
+static void
+check_cones(BMESHptr m, const string& what)
+{
+   const int num_eyes = 12;
+   m->update_normals();
+
+   bool cand_ok = true, culled_ok = true, culls = false;
+   vector<int> brute, culled, cand;
+   for (int k=0; k<num_eyes; k++) {
+      double a = 2*M_PI*k/num_eyes;
+      double r = 1.3 + 2*(1 + cos(a));    // 1.3 to 5.3 from center
+      Wpt eye(r*cos(a), r*sin(a), 0.5*sin(2*a));
+
+      brute.clear();
+      for (int i=0; i<m->nedges(); i++)
+         if (serial_sil(m->be(i), eye))
+            brute.push_back(i);
+
+      cand.clear();
+      m->sil_cone_tree().candidates(eye, cand);
+      sort(cand.begin(), cand.end());
+      cand_ok = cand_ok && !brute.empty() &&
+         includes(cand.begin(), cand.end(), brute.begin(), brute.end());
+      culls = culls || (int)cand.size() < m->nedges();
+
+      m->find_sil_edges_culled(eye, culled);
+      culled_ok = culled_ok && culled == brute;
+   }
+   check(cand_ok,   what + ": candidates include every silhouette edge");
+   check(culled_ok, what + ": culled search finds the brute force edges");
+   check(culls,     what + ": some edges ruled out");
+}
+
+int
+main(int argc, char *argv[])
+{
+   BMESHptr m = bumpy_sphere(3);
+   check_cones(m, "bumpy sphere");
+
+   for (int frame=0; frame<4; frame++)
+      brush_stroke(m, frame, 4);
+   check_cones(m, "brushed sphere");
+
+   // the same mesh, rebuilt one level finer:
+   BMESHptr finer = bumpy_sphere(4);
+   *m = *finer;
+   check_cones(m, "rebuilt sphere");
+
+   return check_summary();
+}
@@ -0,0 +1,96 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_sils.cpp:
+ *
+ *    Regression test for BMESH::find_sil_edges() and
+ *    find_zcross_faces(), from 16 eye positions: the silhouette
+ *    edges must be the ones the per-edge Bedge::is_sil() test
+ *    finds, and the zero-crossing candidates must include every
+ *    face the per-face ZcrossPath::has_sil() test accepts. Run on
+ *    a subdivided icosahedron before and after its vertices move,
+ *    and on a bumpy grid (with border edges).
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+#include <algorithm>
+
+using namespace mlib;
+
+static void
+check_sils(BMESHptr m, const string& what)
+{
+   const int num_eyes = 16;
+   m->update_normals();
+
+   bool sils_ok = true, zx_ok = true;
+   vector<int> serial, batch;
+   for (int k=0; k<num_eyes; k++) {
+      double a = 2*M_PI*k/num_eyes;
+      Wpt eye(3*cos(a), 3*sin(a), 1.5*cos(3*a));
+
+      serial.clear();
+      for (int i=0; i<m->nedges(); i++)
+         if (serial_sil(m->be(i), eye))
+            serial.push_back(i);
+      m->find_sil_edges(eye, batch);
+      sils_ok = sils_ok && !serial.empty() && serial == batch;
+
+      serial.clear();
+      for (int i=0; i<m->nfaces(); i++)
+         if (serial_zcross(m->bf(i), eye))
+            serial.push_back(i);
+      m->find_zcross_faces(eye, batch);
+      zx_ok = zx_ok && includes(batch.begin(), batch.end(),
+                                serial.begin(), serial.end());
+   }
+   check(sils_ok, what + ": silhouette edges match the per-edge test");
+   check(zx_ok,   what + ": zero-crossing candidates include the per-face test's");
+}
+
+int
+main(int argc, char *argv[])
+{
+   LMESHptr ctrl = subdiv_icosahedron(3);
+   BMESHptr cur = ctrl->cur_mesh();
+   check_sils(cur, "sphere");
+
+   for (int i=0; i<cur->nverts(); i++) {
+      Wpt p = cur->bv(i)->loc();
+      cur->bv(i)->set_loc(Wpt(p[0]*1.5, p[1], p[2]*0.5));
+   }
+   cur->changed(BMESH::VERT_POSITIONS_CHANGED);
+   check_sils(cur, "moved sphere");
+
+   // a 2x2 grid, centered, with bumps:
+   const int n = 16;
+   Wpt_list pts;
+   vector<Point3i> tris;
+   grid(n, pts, tris);
+   for (auto& p : pts) {
+      p = Wpt(p[0]*2/n - 1, p[1]*2/n - 1, 0);
+      p[2] = 0.2*sin(4*p[0])*cos(3*p[1]);
+   }
+   BMESHptr m = make_shared<BMESH>();
+   m->build(pts, tris);
+   m->changed(BMESH::TOPOLOGY_CHANGED);
+   check_sils(m, "grid");
+
+   return check_summary();
+}
@@ -0,0 +1,151 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_slots.cpp:
+ *
+ *    Regression test for SimplexData slots:
+ *
+ *      changes:  SimplexData found by slot must track changes of
+ *                key (as Memes make when they take charge or get
+ *                demoted), removal, and keys given a slot after
+ *                their data was added.
+ *      lookups:  on a subdivided icosahedron with several items
+ *                per vertex, lookups by slot (and UVdata::lookup())
+ *                must find what the search by key finds.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/uv_data.hpp"
+
+using namespace mlib;
+
+/*****************************************************************
+ * changes
+ *****************************************************************/
+
+// SimplexData that can change its key, as a Meme does:
+class TestData : public SimplexData {
+ public:
+   TestData(uintptr_t key, Bsimplex* s) : SimplexData(key, s) {}
+   void rekey(uintptr_t key) { set_id(key); }
+};
+
+static void
+test_changes()
+{
+   static const char boss = 0, demoted = 0, late = 0;
+   uintptr_t boss_key = uintptr_t(&boss), demoted_key = uintptr_t(&demoted);
+   uintptr_t late_key = uintptr_t(&late);
+   int boss_slot = SimplexData::register_slot(boss_key);
+   check(boss_slot >= 0 && SimplexData::slot_of(boss_key) == boss_slot,
+         "slots: register a slot");
+
+   BMESHptr m = make_shared<BMESH>();
+   Bvert* v = m->add_vertex(Wpt::Origin());
+
+   // A boss item, found by slot:
+   TestData* a = new TestData(boss_key, v);
+   check(v->find_data(boss_key, boss_slot) == a, "slots: found by slot");
+
+   // Demoted, it no longer answers for the boss key:
+   a->rekey(demoted_key);
+   check(!v->find_data(boss_key, boss_slot) && !v->find_data(boss_key),
+         "slots: demoted item leaves its slot");
+   check(v->find_data(demoted_key) == a, "slots: demoted item found by its new key");
+
+   // A new boss takes the slot; the old one keeps its new key:
+   TestData* b = new TestData(boss_key, v);
+   check(v->find_data(boss_key, boss_slot) == b, "slots: new boss takes the slot");
+
+   // The demoted item takes charge again once the new boss is gone:
+   delete b;
+   check(!v->find_data(boss_key, boss_slot), "slots: deleted item leaves its slot");
+   a->rekey(boss_key);
+   check(v->find_data(boss_key, boss_slot) == a, "slots: item back in its slot");
+   delete a;
+   check(!v->find_data(boss_key, boss_slot) && !v->find_data(demoted_key),
+         "slots: nothing left after deletion");
+
+   // Data added before its key got a slot is still found, and
+   // can be removed:
+   TestData* c = new TestData(late_key, v);
+   int late_slot = SimplexData::register_slot(late_key);
+   check(late_slot >= 0 && v->find_data(late_key, late_slot) == c,
+         "slots: data added before its key got a slot");
+   TestData* d = new TestData(boss_key, v);
+   delete c;
+   check(!v->find_data(late_key, late_slot) &&
+         v->find_data(boss_key, boss_slot) == d,
+         "slots: removing unslotted data");
+   delete d;
+   check(!v->has_data(), "slots: data list empty");
+}
+
+/*****************************************************************
+ * lookups
+ *****************************************************************/
+static void
+test_lookups()
+{
+   // As in "bench_mesh data": 4 items keyed by owner address, a
+   // "boss" item with a slotted key, and a UVdata, on every other
+   // vertex:
+   const int num_owners = 4;
+   static const char owners[num_owners] = {};
+   static const char boss = 0;
+   uintptr_t boss_key  = uintptr_t(&boss);
+   int       boss_slot = SimplexData::register_slot(boss_key);
+   uintptr_t uv_key    = uintptr_t(UVdata::static_name().c_str());
+
+   LMESHptr ctrl = subdiv_icosahedron(2);
+   BMESHptr cur = ctrl->cur_mesh();
+   for (int i=0; i<cur->nverts(); i += 2) {
+      Bvert* v = cur->bv(i);
+      for (int k=0; k<num_owners; k++)
+         new SimplexData(uintptr_t(&owners[k]), v);
+      new SimplexData(boss_key, v);
+      UVdata::get_data(v);
+   }
+
+   bool uv_ok = true, boss_ok = true;
+   for (int i=0; i<cur->nverts(); i++) {
+      Bvert* v = cur->bv(i);
+      SimplexData* uv = v->find_data(uv_key);
+      uv_ok = uv_ok && (uv != nullptr) == (i % 2 == 0) &&
+         (SimplexData*)UVdata::lookup(v) == uv;
+      for (int j=0; j<v->degree(); j++) {
+         Bvert* u = v->nbr(j);
+         boss_ok = boss_ok &&
+            u->find_data(boss_key, boss_slot) == u->find_data(boss_key);
+      }
+   }
+   check(uv_ok,   "lookups: UVdata found by slot as by key");
+   check(boss_ok, "lookups: boss items found by slot as by key");
+}
+
+/*****************************************************************
+ * main
+ *****************************************************************/
+int
+main(int argc, char *argv[])
+{
+   test_changes();
+   test_lookups();
+
+   return check_summary();
+}
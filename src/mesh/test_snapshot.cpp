@@ -0,0 +1,106 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_snapshot.cpp:
+ *
+ *    Regression test for MeshSnapshot, on a subdivided icosahedron:
+ *    its index arrays must name the mesh's own vertices, edges and
+ *    faces, and after the vertices move, BMESH::snapshot() must
+ *    refresh the same snapshot to the new positions, face normals
+ *    and areas.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+// Snapshot topology names the mesh's elements:
+static bool
+same_topology(CBMESHptr& m, const MeshSnapshot& s)
+{
+   if (s.nverts() != m->nverts() || s.nedges() != m->nedges() ||
+       s.nfaces() != m->nfaces())
+      return false;
+   for (int i=0; i<m->nfaces(); i++) {
+      Bface* f = m->bf(i);
+      if (s.index(f) != i)
+         return false;
+      for (int k=0; k<3; k++)
+         if (s.face_verts(i)[k] != f->v(k+1)->index() ||
+             s.face_edges(i)[k] != f->e(k+1)->index())
+            return false;
+   }
+   for (int i=0; i<m->nedges(); i++) {
+      Bedge* e = m->be(i);
+      if (s.index(e) != i ||
+          s.edge_verts(i)[0] != e->v1()->index() ||
+          s.edge_verts(i)[1] != e->v2()->index() ||
+          s.edge_faces(i)[0] != (e->f1() ? e->f1()->index() : -1) ||
+          s.edge_faces(i)[1] != (e->f2() ? e->f2()->index() : -1))
+         return false;
+   }
+   for (int i=0; i<m->nverts(); i++) {
+      Bvert* v = m->bv(i);
+      if (s.index(v) != i || s.degree(i) != v->degree())
+         return false;
+      for (int j=0; j<v->degree(); j++)
+         if (s.vert_edges(i)[j] != v->get_adj()[j]->index())
+            return false;
+   }
+   return true;
+}
+
+// Snapshot positions, normals and areas match the mesh's:
+static bool
+same_geometry(CBMESHptr& m, const MeshSnapshot& s)
+{
+   for (int i=0; i<m->nverts(); i++)
+      if (s.loc(i).dist(m->bv(i)->loc()) > 1e-12)
+         return false;
+   for (int i=0; i<m->nfaces(); i++)
+      if (!(s.norm(i) - m->bf(i)->norm()).is_null(1e-6) ||
+          fabs(s.area(i) - m->bf(i)->area()) > 1e-9)
+         return false;
+   return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+   LMESHptr ctrl = subdiv_icosahedron(2);
+   BMESHptr cur = ctrl->cur_mesh();
+
+   const MeshSnapshot& snap = cur->snapshot();
+   check(same_topology(cur, snap), "snapshot: topology matches the mesh");
+   check(same_geometry(cur, snap), "snapshot: geometry matches the mesh");
+
+   // Move the vertices (unevenly, so normals and areas change):
+   for (int i=0; i<cur->nverts(); i++) {
+      Wpt p = cur->bv(i)->loc();
+      cur->bv(i)->set_loc(Wpt(p[0]*2, p[1], p[2] + p[0]*p[1]));
+   }
+   cur->changed(BMESH::VERT_POSITIONS_CHANGED);
+   for (int i=0; i<cur->nfaces(); i++)
+      cur->bf(i)->geometry_changed();
+
+   const MeshSnapshot& moved = cur->snapshot();
+   check(&moved == &snap, "snapshot: refreshed in place after a move");
+   check(same_geometry(cur, moved), "snapshot: geometry follows the move");
+
+   return check_summary();
+}
@@ -0,0 +1,162 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_traverse.cpp:
+ *
+ *    Regression test for searches with TraversalMarks, on a mesh
+ *    of 4 separate grids of different sizes:
+ *
+ *      components: get_components() and reachable_faces() must
+ *                  find what the old flag-based search finds,
+ *                  and leave face flags alone.
+ *      nested:     more searches under way at once than there
+ *                  are mark slots must each find the whole grid.
+ *      split:      split_components() must leave one grid in
+ *                  the mesh and move each other one into its own.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/traversal_marks.hpp"
+
+#include <algorithm>
+#include <memory>
+
+using namespace mlib;
+
+static const int num_grids = 4;
+
+// Grid k has n = k+2:
+static BMESHptr
+grids()
+{
+   Wpt_list all_pts;
+   vector<Point3i> all_tris;
+   for (int k=0; k<num_grids; k++) {
+      Wpt_list pts;
+      vector<Point3i> tris;
+      grid(k+2, pts, tris);
+      int base = (int)all_pts.size();
+      for (auto& p : pts)
+         all_pts.push_back(p + Wvec(k*10, 0, 0));
+      for (auto& tri : tris)
+         all_tris.push_back(Point3i(tri[0]+base, tri[1]+base, tri[2]+base));
+   }
+   BMESHptr ret = make_shared<BMESH>();
+   ret->build(all_pts, all_tris);
+   ret->changed(BMESH::TOPOLOGY_CHANGED);
+   return ret;
+}
+
+static int
+grid_faces(int k)
+{
+   return 2*(k+2)*(k+2);
+}
+
+static bool
+same_lists(const vector<Bface_list>& a, const vector<Bface_list>& b)
+{
+   if (a.size() != b.size())
+      return false;
+   for (size_t i=0; i<a.size(); i++)
+      if (a[i].size() != b[i].size() || !a[i].contains_all(b[i]))
+         return false;
+   return true;
+}
+
+static void
+test_components()
+{
+   BMESHptr m = grids();
+   vector<Bface_list> slow = flag_components(m);
+
+   // (the checks below use flags, so the searches go first)
+   m->faces().set_flags(3);
+   vector<Bface_list> fast = m->get_components();
+   vector<Bface_list> reached;
+   for (int i=0; i<m->nfaces(); i += 5)
+      reached.push_back(Bface_list::reachable_faces(m->bf(i)));
+   bool flags_ok = true;
+   for (int i=0; i<m->nfaces(); i++)
+      flags_ok = flags_ok && m->bf(i)->flag() == 3;
+   check(flags_ok, "components: face flags untouched");
+
+   bool sizes_ok = (fast.size() == size_t(num_grids));
+   for (int k=0; sizes_ok && k<num_grids; k++)
+      sizes_ok = (fast[k].size() == size_t(grid_faces(k)));
+   check(sizes_ok, "components: one per grid");
+   check(same_lists(slow, fast), "components: same as the flag-based search");
+
+   bool reach_ok = true;
+   for (size_t i=0; i<reached.size(); i++) {
+      Bface* f = m->bf(5*i);
+      for (auto& comp : fast)
+         if (std::count(comp.begin(), comp.end(), f))
+            reach_ok = reach_ok && reached[i].size() == comp.size() &&
+               reached[i].contains_all(comp);
+   }
+   check(reach_ok, "components: reachable_faces() finds the component");
+}
+
+static void
+test_nested()
+{
+   BMESHptr m = grids();
+   Bface* f = m->bf(0);
+   const int num_searches = 12;
+   vector<unique_ptr<TraversalMarks>> marks;
+   vector<Bface_list> found(num_searches);
+   for (int i=0; i<num_searches; i++)
+      marks.push_back(unique_ptr<TraversalMarks>(new TraversalMarks));
+   for (int i=0; i<num_searches; i++)
+      found[i].grow_connected(f, *marks[i]);
+
+   bool ok = true;
+   for (int i=0; i<num_searches; i++)
+      ok = ok && found[i].size() == size_t(grid_faces(0));
+   check(ok, "nested: every search finds the whole grid");
+}
+
+static void
+test_split()
+{
+   BMESHptr m = grids();
+   vector<BMESHptr> pieces = m->split_components();
+   check(pieces.size() == size_t(num_grids - 1), "split: a mesh per other grid");
+
+   int total = m->nfaces();
+   bool ok = (m->get_components().size() == 1);
+   for (auto& p : pieces) {
+      total += p->nfaces();
+      ok = ok && p->get_components().size() == 1;
+   }
+   int all = 0;
+   for (int k=0; k<num_grids; k++)
+      all += grid_faces(k);
+   check(ok && total == all, "split: each grid whole, in one mesh");
+}
+
+int
+main(int argc, char *argv[])
+{
+   test_components();
+   test_nested();
+   test_split();
+
+   return check_summary();
+}
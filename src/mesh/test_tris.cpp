@@ -0,0 +1,128 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_tris.cpp:
+ *
+ *    Regression test for TriList, on the 4 patches of an irregular
+ *    "scanned" mesh: each patch's triangle list must hold each of
+ *    its faces once, with indices naming the face's vertices in
+ *    order and vertices numbered by first use. Drawn through a
+ *    StripCB, the lists must send each face's 3 vertices once,
+ *    and cover the faces the triangle strips cover, with a lower
+ *    ACMR. Lists are kept while vertices move, and rebuilt after
+ *    the triangulation changes.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+#include "mesh/stripcb.hpp"
+
+#include <map>
+
+using namespace mlib;
+
+// Records the vertices sent for each face:
+class FaceCB : public StripCB {
+ public:
+   virtual void faceCB(CBvert* v, CBface* f) { _verts[f].push_back(v); }
+   map<CBface*, vector<CBvert*>> _verts;
+};
+
+static bool
+check_list(Patch* p)
+{
+   const TriList& list = p->tri_list();
+   if (list.num() != p->num_faces() ||
+       list.indices().size() != size_t(3*list.num()))
+      return false;
+   map<CBface*, int> seen;
+   int next = 0;       // next vertex number not yet used
+   for (int i=0; i<list.num(); i++) {
+      Bface* f = list.faces()[i];
+      if (f->patch() != p || seen[f]++)
+         return false;
+      for (int j=0; j<3; j++) {
+         int k = list.indices()[3*i + j];
+         if (k < 0 || k > next || list.verts()[k] != f->v(j+1))
+            return false;
+         if (k == next)
+            next++;
+      }
+   }
+   return next == (int)list.verts().size();
+}
+
+int
+main(int argc, char *argv[])
+{
+   srand48(1);
+   BMESHptr m = scanned_mesh(32);
+   check(m->npatches() == 4, "mesh: 4 patches");
+
+   // triangle strips first, then lists:
+   FaceCB strips, lists;
+   double acmr[2] = { 0, 0 };
+   for (int use_lists = 0; use_lists < 2; use_lists++) {
+      Patch::set_use_tri_strips(!use_lists);
+      m->patches().triangulation_changed();
+      for (int i=0; i<m->npatches(); i++) {
+         m->patch(i)->draw_tri_strips(use_lists ? &lists : &strips);
+         acmr[use_lists] += m->patch(i)->acmr()*m->patch(i)->num_faces()/m->nfaces();
+      }
+   }
+
+   bool lists_ok = true;
+   for (int i=0; i<m->npatches(); i++)
+      lists_ok = lists_ok && check_list(m->patch(i));
+   check(lists_ok, "lists: each face once, indices in order of first use");
+
+   bool drawn_ok = (lists._verts.size() == size_t(m->nfaces()));
+   for (auto& fv : lists._verts) {
+      CBface* f = fv.first;
+      drawn_ok = drawn_ok && fv.second.size() == 3 &&
+         fv.second[0] == f->v1() && fv.second[1] == f->v2() &&
+         fv.second[2] == f->v3();
+   }
+   check(drawn_ok, "lists: each face drawn once, vertices in order");
+
+   bool same_faces = (strips._verts.size() == lists._verts.size());
+   for (auto& fv : strips._verts)
+      same_faces = same_faces && lists._verts.count(fv.first);
+   check(same_faces, "lists: the same faces the strips draw");
+   check(acmr[1] < acmr[0], "lists: lower ACMR than strips");
+
+   // moving vertices keeps the lists, new triangulations rebuild them:
+   vector<uint> stamps;
+   for (int i=0; i<m->npatches(); i++)
+      stamps.push_back(m->patch(i)->tri_list().stamp());
+   for (int i=0; i<m->nverts(); i++)
+      m->bv(i)->set_loc(m->bv(i)->loc() + Wvec(0, 0, 0.1));
+   m->changed(BMESH::VERT_POSITIONS_CHANGED);
+   bool kept = true;
+   for (int i=0; i<m->npatches(); i++)
+      kept = kept && m->patch(i)->cur_tri_list()->stamp() == stamps[i];
+   check(kept, "lists: kept when vertices move");
+
+   m->patches().triangulation_changed();
+   bool rebuilt = true;
+   for (int i=0; i<m->npatches(); i++)
+      rebuilt = rebuilt && m->patch(i)->cur_tri_list()->stamp() != stamps[i] &&
+         check_list(m->patch(i));
+   check(rebuilt, "lists: rebuilt after the triangulation changes");
+
+   return check_summary();
+}
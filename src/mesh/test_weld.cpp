@@ -0,0 +1,136 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+/**********************************************************************
+ * test_weld.cpp:
+ *
+ *    Regression test for BMESH::weld_vertices(), on "triangle
+ *    soups" (a grid with every triangle given its own vertices):
+ *
+ *      exact:     weld_vertices(0) must give the mesh the old
+ *                 pair-at-a-time merge gives: the grid's vertices,
+ *                 edges and faces, each face on the same spots,
+ *                 and a remap naming the vertex each went to.
+ *      tolerance: after the copies are jittered, a tolerance
+ *                 above the jitter welds them all, and one below
+ *                 it welds none.
+ *      cleanup:   a repeated triangle is removed, and so is one
+ *                 that collapses when its vertices are welded.
+ **********************************************************************/
+#include "std/config.hpp"
+#include "mesh/mesh_fixtures.hpp"
+
+using namespace mlib;
+
+static const int n = 8;
+static const int num_verts = (n+1)*(n+1);
+static const int num_faces = 2*n*n;
+
+// Same number of elements, and faces on the same spots:
+static bool
+same_faces(CBMESHptr& a, CBMESHptr& b)
+{
+   if (a->nverts() != b->nverts() || a->nedges() != b->nedges() ||
+       a->nfaces() != b->nfaces())
+      return false;
+   for (int i=0; i<a->nfaces(); i++)
+      for (int k=1; k<=3; k++)
+         if (a->bf(i)->v(k)->loc() != b->bf(i)->v(k)->loc())
+            return false;
+   return true;
+}
+
+static void
+test_exact()
+{
+   srand48(1);
+   BMESHptr a = soup(n, 0);
+   pairwise_weld(a);
+
+   BMESHptr b = soup(n, 0);
+   int old_nverts = b->nverts();
+   vector<int> remap;
+   int merged = b->weld_vertices(0, false, &remap);
+   check(merged == old_nverts - num_verts && b->nverts() == num_verts &&
+         b->nfaces() == num_faces, "exact: grid counts");
+   check(same_faces(a, b), "exact: same mesh as pairwise merging");
+
+   BMESHptr c = soup(n, 0);
+   bool remap_ok = (remap.size() == size_t(old_nverts));
+   for (size_t i=0; remap_ok && i<remap.size(); i++)
+      remap_ok = remap[i] >= 0 && remap[i] < b->nverts() &&
+         b->bv(remap[i])->loc() == c->bv(i)->loc();
+   check(remap_ok, "exact: remap names the welded vertices");
+
+   // only the grid's outline is left as border:
+   int num_border = 0, num_inner = 0;
+   for (int i=0; i<b->nedges(); i++) {
+      num_border += (b->be(i)->nfaces() == 1);
+      num_inner  += (b->be(i)->nfaces() == 2);
+   }
+   check(num_border == 4*n && num_inner == b->nedges() - 4*n,
+         "exact: edges joined");
+}
+
+static void
+test_tolerance()
+{
+   srand48(1);
+   BMESHptr a = soup(n, 1e-6);
+   a->weld_vertices(1e-4);
+   check(a->nverts() == num_verts && a->nfaces() == num_faces,
+         "tolerance: jittered copies welded");
+
+   srand48(1);
+   BMESHptr b = soup(n, 1e-6);
+   int old_nverts = b->nverts();
+   check(b->weld_vertices(1e-9) == 0 && b->nverts() == old_nverts,
+         "tolerance: nothing welded below the jitter");
+}
+
+static void
+test_cleanup()
+{
+   // a repeated triangle, and a sliver that collapses to a point:
+   Wpt_list pts;
+   vector<Point3i> tris;
+   grid(2, pts, tris);
+   pts.push_back(pts[tris[0][0]]);
+   pts.push_back(pts[tris[0][1]]);
+   pts.push_back(pts[tris[0][2]]);
+   tris.push_back(Point3i(9, 10, 11));
+   pts.push_back(Wpt(5, 5, 0));
+   pts.push_back(Wpt(5, 5 + 1e-6, 0));
+   pts.push_back(Wpt(5 + 1e-6, 5, 0));
+   tris.push_back(Point3i(12, 13, 14));
+
+   BMESHptr m = make_shared<BMESH>();
+   m->build(pts, tris);
+   m->weld_vertices(1e-4);
+   check(m->nfaces() == 8, "cleanup: repeated and collapsed faces removed");
+   check(m->nverts() == 10, "cleanup: collapsed face welded to one vertex");
+}
+
+int
+main(int argc, char *argv[])
+{
+   test_exact();
+   test_tolerance();
+   test_cleanup();
+
+   return check_summary();
+}
@@ -0,0 +1,76 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "mesh/traversal_marks.hpp"
+
+#include <atomic>
+
+// Slots in use, one bit each. A slot whose stamps ran out is
+// never released, so its old marks can't be mistaken for new ones:
+static std::atomic<uint> slots_used(0);
+
+// Last stamp handed out for each slot; only the owner of a slot
+// touches its entry. Stamps start at 1, since new simplices
+// have 0 in every slot:
+static uint last_stamp[Bsimplex::NUM_MARK_SLOTS];
+
+TraversalMarks::TraversalMarks() :
+   _slot(-1),
+   _stamp(0)
+{
+   uint used = slots_used.load();
+   for (int i=0; i<Bsimplex::NUM_MARK_SLOTS; i++) {
+      uint bit = 1u << i;
+      while (!(used & bit)) {
+         if (slots_used.compare_exchange_weak(used, used | bit)) {
+            _slot = i;
+            new_stamp();
+            return;
+         }
+      }
+   }
+}
+
+TraversalMarks::~TraversalMarks()
+{
+   if (_slot >= 0)
+      slots_used.fetch_and(~(1u << _slot));
+}
+
+void
+TraversalMarks::new_stamp()
+{
+   assert(_slot >= 0);
+   if (++last_stamp[_slot] == 0) {
+      // Out of stamps: keep the slot (so nobody else gets it)
+      // and use the hash set from now on:
+      err_msg("TraversalMarks: retiring mark slot %d", _slot);
+      _slot = -1;
+      _stamp = 0;
+      return;
+   }
+   _stamp = last_stamp[_slot];
+}
+
+void
+TraversalMarks::reset()
+{
+   if (_slot >= 0)
+      new_stamp();
+   else
+      _set.clear();
+}
@@ -0,0 +1,110 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef TRAVERSAL_MARKS_H_IS_INCLUDED
+#define TRAVERSAL_MARKS_H_IS_INCLUDED
+
+#include "mesh/bsimplex.hpp"
+
+#include <unordered_set>
+
+/*****************************************************************
+ * TraversalMarks:
+ *
+ *      "Visited" marks for one graph search over mesh elements,
+ *      used instead of the shared Bsimplex flag. Nothing has to
+ *      be cleared before or after a search:
+ *
+ *        TraversalMarks marks;
+ *        ...
+ *        if (marks.try_mark(f))  // first visit to f
+ *           ...
+ *
+ *      Each Bsimplex has a few mark slots, each holding a stamp.
+ *      A TraversalMarks takes a free slot for its lifetime and a
+ *      new stamp for that slot; an element is marked iff its
+ *      stamp in the slot is the current one. So several searches
+ *      can be under way at once, nested or on other threads,
+ *      without seeing each other's marks. When every slot is
+ *      taken, marks go in a hash set instead, which is slower
+ *      but works the same.
+ *
+ *      A TraversalMarks only marks; it is up to the caller to
+ *      not touch the same elements from two threads at once.
+ *****************************************************************/
+class TraversalMarks {
+ public:
+
+   //******** MANAGERS ********
+
+   TraversalMarks();
+   ~TraversalMarks();
+
+   //******** MARKS ********
+
+   bool is_marked(CBsimplex* s) const {
+      return (_slot >= 0) ? (s->_marks[_slot] == _stamp) : (_set.count(s) > 0);
+   }
+   void mark(CBsimplex* s) {
+      if (_slot >= 0)
+         s->_marks[_slot] = _stamp;
+      else
+         _set.insert(s);
+   }
+   void unmark(CBsimplex* s) {
+      if (_slot >= 0)
+         s->_marks[_slot] = 0;
+      else
+         _set.erase(s);
+   }
+
+   // Mark s, returning true if it was not marked before:
+   bool try_mark(CBsimplex* s) {
+      if (is_marked(s))
+         return false;
+      mark(s);
+      return true;
+   }
+
+   // Mark every simplex in a list:
+   template <class L>
+   void mark_all(const L& list) {
+      for (size_t i=0; i<list.size(); i++)
+         mark(list[i]);
+   }
+
+   // Forget all marks, in O(1) time:
+   void reset();
+
+   //******** DIAGNOSTIC ********
+
+   // Is this using a slot (or the fallback hash set)?
+   bool has_slot() const { return _slot >= 0; }
+
+ protected:
+   int                         _slot;   // slot in Bsimplex::_marks, or -1
+   uint                        _stamp;  // current stamp for the slot
+   unordered_set<CBsimplex*>   _set;    // marks, when there is no slot
+
+   void new_stamp();
+
+   // not copyable (the slot belongs to one object):
+   TraversalMarks(const TraversalMarks&) = delete;
+   TraversalMarks& operator=(const TraversalMarks&) = delete;
+};
+
+#endif // TRAVERSAL_MARKS_H_IS_INCLUDED
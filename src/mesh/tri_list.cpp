@@ -0,0 +1,251 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#include "mesh/stripcb.hpp"
+#include "mesh/tri_strip.hpp"
+#include "mesh/tri_list.hpp"
+
+#include <unordered_map>
+
+// Scoring constants from Forsyth's article. The LRU cache used
+// for scoring holds MAX_CACHE vertices (plus 3 while a triangle
+// is added):
+static const int    MAX_CACHE      = 32;
+static const double CACHE_DECAY    = 1.5;
+static const double LAST_TRI_SCORE = 0.75;
+static const double VALENCE_SCALE  = 2.0;
+static const double VALENCE_POWER  = 0.5;
+static const int    MAX_VALENCE    = 32;   // higher counts score the same
+
+// Score of a vertex at the given cache position (-1 if not in
+// the cache) with the given number of triangles left to emit.
+// Tabulated, since it's needed for every vertex of every
+// triangle near the cache:
+class VertScore {
+ public:
+   VertScore() {
+      for (int p = -1; p < MAX_CACHE; p++) {
+         double c = 0;
+         if (p >= 0)
+            c = (p < 3) ? LAST_TRI_SCORE :
+               pow(1.0 - double(p - 3)/(MAX_CACHE - 3), CACHE_DECAY);
+         _tab[p + 1][0] = -1;   // no triangles left: never wanted
+         for (int n = 1; n <= MAX_VALENCE; n++)
+            _tab[p + 1][n] = c + VALENCE_SCALE*pow(double(n), -VALENCE_POWER);
+      }
+   }
+   double operator()(int pos, int left) const {
+      return _tab[pos + 1][min(left, MAX_VALENCE)];
+   }
+ protected:
+   double _tab[MAX_CACHE + 1][MAX_VALENCE + 1];
+};
+
+uint TriList::_next_stamp = 0;
+
+void
+TriList::build(CBface_list& faces)
+{
+   static const VertScore score;
+
+   reset();
+   _stamp = ++_next_stamp;
+
+   // Number the vertices and triangles of the faces to draw:
+   unordered_map<Bvert*,int> vmap;
+   vmap.reserve(faces.size());
+   Bvert_list  vlist;
+   vector<int> tris;
+   Bface_list  tfaces;
+   for (auto& f : faces) {
+      if (f->flag())
+         continue;
+      tfaces.push_back(f);
+      for (int c = 1; c <= 3; c++) {
+         auto it = vmap.insert(make_pair(f->v(c), (int)vlist.size()));
+         if (it.second)
+            vlist.push_back(f->v(c));
+         tris.push_back(it.first->second);
+      }
+   }
+   int nv = vlist.size(), nt = tfaces.size();
+   if (nt == 0)
+      return;
+
+   // Triangles of each vertex, in compressed rows. The first
+   // left[v] entries of row v are the ones not yet emitted:
+   vector<int> start(nv + 1, 0), left(nv, 0);
+   for (int i = 0; i < 3*nt; i++)
+      start[tris[i] + 1]++;
+   for (int v = 0; v < nv; v++)
+      start[v + 1] += start[v];
+   vector<int> adj(3*nt);
+   for (int i = 0; i < 3*nt; i++) {
+      int v = tris[i];
+      adj[start[v] + left[v]++] = i/3;
+   }
+
+   vector<int>    pos(nv, -1);
+   vector<double> vscore(nv);
+   for (int v = 0; v < nv; v++)
+      vscore[v] = score(-1, left[v]);
+   vector<double> tscore(nt);
+   vector<bool>   done(nt, false);
+   int best = 0;
+   for (int t = 0; t < nt; t++) {
+      tscore[t] = vscore[tris[3*t]] + vscore[tris[3*t+1]] + vscore[tris[3*t+2]];
+      if (tscore[t] > tscore[best])
+         best = t;
+   }
+
+   vector<int> cache, next_cache, order;
+   cache.reserve(MAX_CACHE + 3);
+   next_cache.reserve(MAX_CACHE + 3);
+   order.reserve(nt);
+   int scan = 0;        // no triangle before this is left
+   while ((int)order.size() < nt) {
+      if (best < 0) {
+         // nothing near the cache: start over elsewhere
+         while (done[scan])
+            scan++;
+         best = scan;
+      }
+      done[best] = true;
+      order.push_back(best);
+
+      // take it off its vertices' lists, and put its vertices at
+      // the front of the cache:
+      next_cache.clear();
+      for (int c = 0; c < 3; c++) {
+         int v = tris[3*best + c];
+         int* row = &adj[start[v]];
+         for (int k = 0; k < left[v]; k++) {
+            if (row[k] == best) {
+               swap(row[k], row[left[v] - 1]);
+               break;
+            }
+         }
+         left[v]--;
+         next_cache.push_back(v);
+      }
+      for (auto& v : cache)
+         if (v != next_cache[0] && v != next_cache[1] && v != next_cache[2])
+            next_cache.push_back(v);
+      for (size_t k = MAX_CACHE; k < next_cache.size(); k++) {
+         pos[next_cache[k]] = -1;
+         vscore[next_cache[k]] = score(-1, left[next_cache[k]]);
+      }
+      if (next_cache.size() > (size_t)MAX_CACHE)
+         next_cache.resize(MAX_CACHE);
+      cache.swap(next_cache);
+
+      // rescore the cache, then the triangles that touch it, and
+      // take the best of those next:
+      for (size_t k = 0; k < cache.size(); k++) {
+         pos[cache[k]] = k;
+         vscore[cache[k]] = score(k, left[cache[k]]);
+      }
+      best = -1;
+      double best_score = -1;
+      for (auto& v : cache) {
+         for (int k = 0; k < left[v]; k++) {
+            int t = adj[start[v] + k];
+            tscore[t] = vscore[tris[3*t]] + vscore[tris[3*t+1]] + vscore[tris[3*t+2]];
+            if (tscore[t] > best_score) {
+               best_score = tscore[t];
+               best = t;
+            }
+         }
+      }
+   }
+
+   // Renumber the vertices by first use:
+   vector<int> renum(nv, -1);
+   _indices.reserve(3*nt);
+   _faces.reserve(nt);
+   for (auto& t : order) {
+      _faces.push_back(tfaces[t]);
+      for (int c = 0; c < 3; c++) {
+         int& r = renum[tris[3*t + c]];
+         if (r < 0) {
+            r = _verts.size();
+            _verts.push_back(vlist[tris[3*t + c]]);
+         }
+         _indices.push_back(r);
+      }
+   }
+   _acmr = acmr(_indices, _verts.size(), cache_size());
+}
+
+void
+TriList::draw(StripCB* cb) const
+{
+   if (empty())
+      return;
+
+   cb->begin_triangles();
+   for (size_t i = 0; i < _faces.size(); i++) {
+      cb->faceCB(_verts[_indices[3*i    ]], _faces[i]);
+      cb->faceCB(_verts[_indices[3*i + 1]], _faces[i]);
+      cb->faceCB(_verts[_indices[3*i + 2]], _faces[i]);
+   }
+   cb->end_triangles();
+}
+
+double
+TriList::acmr(const vector<int>& indices, int num_verts, int cache)
+{
+   // A vertex is in the FIFO cache if it went in (missed) within
+   // the last 'cache' misses:
+   if (indices.empty())
+      return 0;
+   vector<int> in(num_verts, -1);
+   int misses = 0;
+   for (auto& i : indices) {
+      if (in[i] < 0 || misses - in[i] >= cache)
+         in[i] = misses++;
+   }
+   return double(misses)/(indices.size()/3);
+}
+
+double
+TriList::acmr(const vector<TriStrip*>& strips, int cache)
+{
+   // number the vertices in drawing order, and count the
+   // triangles (each strip vertex after the first 2):
+   unordered_map<Bvert*,int> vmap;
+   vector<int> seq;
+   int tris = 0;
+   for (auto& s : strips) {
+      if (s->empty())
+         continue;
+      if (s->orientation())
+         seq.push_back(vmap.insert(make_pair(s->vert(0), (int)vmap.size())).first->second);
+      for (int i = 0; i < s->num(); i++)
+         seq.push_back(vmap.insert(make_pair(s->vert(i), (int)vmap.size())).first->second);
+      tris += max(s->num() - 2, 0);
+   }
+   if (tris == 0)
+      return 0;
+   vector<int> in(vmap.size(), -1);
+   int misses = 0;
+   for (auto& i : seq) {
+      if (in[i] < 0 || misses - in[i] >= cache)
+         in[i] = misses++;
+   }
+   return double(misses)/tris;
+}
@@ -0,0 +1,97 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ *
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef TRI_LIST_H_IS_INCLUDED
+#define TRI_LIST_H_IS_INCLUDED
+
+#include "bface.hpp"
+
+#include <vector>
+
+class StripCB;
+class TriStrip;
+
+/**********************************************************************
+ * TriList:
+ *
+ *    Indexed triangle list, with the triangles ordered for the
+ *    post-transform vertex cache, following T. Forsyth, "Linear-
+ *    Speed Vertex Cache Optimisation" (2006): each step emits the
+ *    triangle whose vertices score highest, favoring vertices
+ *    recently used (still in a simulated LRU cache) and vertices
+ *    with few triangles left.
+ *
+ *    The vertices are numbered in the order triangles first use
+ *    them, so indices() can go straight to an index buffer.
+ *
+ *    Patch builds one in place of its triangle strips (see
+ *    Patch::draw_tri_strips()).
+ **********************************************************************/
+class TriList {
+ public:
+   //******** MANAGERS ********
+   TriList() : _acmr(0), _stamp(0) {}
+
+   //******** ACCESSORS ********
+   CBvert_list& verts()           const { return _verts; }
+   CBface_list& faces()           const { return _faces; }
+   const vector<int>& indices()   const { return _indices; }
+
+   bool empty()                   const { return _faces.empty(); }
+   int  num()                     const { return _faces.size(); }
+
+   // Average cache miss ratio (vertices transformed per triangle)
+   // of the current order, for a FIFO cache of cache_size()
+   // entries, found in build():
+   double acmr()                  const { return _acmr; }
+
+   // Size of the simulated cache:
+   static int cache_size()              { return 32; }
+
+   // Changes (to a value no other TriList had) with each build():
+   uint stamp()                   const { return _stamp; }
+
+   //******** BUILDING ********
+   void reset() { _verts.clear(); _faces.clear(); _indices.clear(); _acmr = 0; }
+
+   // Order the given faces, skipping those with their flag set:
+   void build(CBface_list& faces);
+
+   //******** DRAWING ********
+   // Send the triangles to cb, between begin_triangles() and
+   // end_triangles():
+   void draw(StripCB* cb) const;
+
+   //******** STATISTICS ********
+   // ACMR of a sequence of triangles (3 indices each), for a FIFO
+   // cache of the given size:
+   static double acmr(const vector<int>& indices, int num_verts, int cache);
+
+   // ACMR of triangle strips, as drawn by TriStrip::draw():
+   static double acmr(const vector<TriStrip*>& strips, int cache);
+
+ protected:
+   Bvert_list  _verts;     // vertices, in order of first use
+   Bface_list  _faces;     // face of each triangle
+   vector<int> _indices;   // 3 per triangle, into _verts
+   double      _acmr;
+   uint        _stamp;
+
+   static uint _next_stamp;
+};
+
+#endif // TRI_LIST_H_IS_INCLUDED
@@ -175,7 +175,7 @@ class UVdata : public SimplexData {
    //******** LOOKUP ********
    // Lookup a UVdata* from a Bsimplex:
    static UVdata* lookup(CBsimplex* s) {
-      return s ? (UVdata*)s->find_data(key()) : nullptr;
+      return s ? (UVdata*)s->find_data(key(), slot()) : nullptr;
    }
 
    // Similar to above, but creates a UVdata if it wasn't found
@@ -270,6 +270,12 @@ class UVdata : public SimplexData {
       return ret;
    }
 
+   // The lookup slot for the ID (see SimplexData::register_slot()):
+   static int slot() {
+      static int ret = register_slot(key());
+      return ret;
+   }
+
    //******** PROTECTED CONSTRUCTOR ********
    // The constructor is called (internally) only when the given
    // simplex does not already have a UVdata associated with it.
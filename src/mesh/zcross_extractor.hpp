@@ -34,6 +34,7 @@
 #include "std/support.hpp"
 #include "mlib/points.hpp"
 #include "mesh/bmesh.hpp"
+#include "mesh/mesh_snapshot.hpp"
 #include "mesh/zcross_path.hpp"
 
 /*!
@@ -180,7 +181,8 @@ class ZCrossExtractor {
                    ScalarField sfield_in = ScalarField(),
                    Confidence conf_in = Confidence(),
                    FaceGenerator fgen_in = FaceGenerator())
-      : mesh(mesh_in), sfield(sfield_in), conf(conf_in), fgen(fgen_in)
+      : snap(nullptr), mesh(mesh_in), sfield(sfield_in), conf(conf_in),
+        fgen(fgen_in), type(STYPE_SUGLINE)
       { }
       
    //@}
@@ -198,6 +200,11 @@ class ZCrossExtractor {
       
    const BMESHptr get_mesh() const { return mesh; }
       
+   //! \brief The stroke type (STYPE_SUGLINE by default) given to the
+   //! extracted segments.
+   int get_type() const { return type; }
+   void set_type(int type_in) { type = type_in; }
+      
    //@}
       
    //! \name Result Accessors
@@ -230,14 +237,19 @@ class ZCrossExtractor {
    
    std::vector<ZXseg> extracted_segs;
    
+   //! \brief Faces already visited, by snapshot index.
    std::vector<bool> face_markers;
       
+   const MeshSnapshot *snap;
+      
    const BMESHptr mesh;
       
    ScalarField sfield;
    Confidence conf;
    FaceGenerator fgen;
    
+   int type;
+   
 };
 
 /*!
@@ -248,6 +260,13 @@ class ZCrossExtractor {
  *  a \c double that is the value of the scalar field that the zero crossing lines
  *  are being extracted from at the given vertex.
  *
+ *  The ZCrossExtractor asks for values a face at a time, through the second
+ *  form, which takes a \c const \c Bface* and fills in the values at its three
+ *  vertices.  By default it uses the first form.  Fields that are only defined
+ *  up to sign at each vertex (e.g. derivatives along a principal direction)
+ *  override it to give values whose signs agree within the face.  It returns
+ *  \c false to keep lines out of the face altogether.
+ *
  */
 class ZCrossScalarFieldInterface {
    
@@ -255,6 +274,9 @@ class ZCrossScalarFieldInterface {
    
    virtual ~ZCrossScalarFieldInterface() {}
    virtual double operator()(const Bvert*) = 0;
+   virtual bool operator()(const Bface *f, double vals[3])
+      { for(int i = 0; i < 3; ++i) vals[i] = (*this)(f->v(i + 1));
+        return true; }
    
 };
 
@@ -335,6 +357,37 @@ class ZCrossAllFaceGenerator : public ZCrossFaceGeneratorInterface {
    
 };
 
+/*!
+ *  \brief A FaceGenerator for the ZCrossExtractor class that generates the
+ *  faces in a given list of face indices (e.g. faces found to hold lines by a
+ *  pass over the whole mesh).
+ *
+ *  The list is not copied, and must outlive the extraction.
+ *
+ */
+class ZCrossListFaceGenerator : public ZCrossFaceGeneratorInterface {
+   
+ public:
+   
+   ZCrossListFaceGenerator(const std::vector<int> *faces_in = nullptr)
+      : i(0), faces(faces_in)
+      { }
+   
+   virtual ~ZCrossListFaceGenerator() {}
+   template <typename ScalarField, typename Confidence, typename FaceGenerator>
+   void operator()(const ZCrossExtractor<ScalarField,Confidence,FaceGenerator>*)
+      { i = 0; }
+      
+   virtual int operator()()
+      { return (faces && i < faces->size()) ? (*faces)[i++] : -1; }
+      
+ private:
+   
+   std::vector<int>::size_type i;
+   const std::vector<int> *faces;
+   
+};
+
 /*!
  *  \brief A FaceGenerator for the ZCrossExtractor class that generates random
  *  faces on the mesh being processed.
@@ -448,6 +501,9 @@ ZCrossExtractor<ScalarField, Confidence, FaceGenerator>::extract()
    // Reset the FaceGenerator
    fgen(this);
    
+   // Faces are marked by snapshot index (Bface::index() is a linear search):
+   snap = &mesh->snapshot();
+   
    // Reset the face markers:
    assert(face_markers.size() == 0);
    face_markers.resize(mesh->nfaces(), false);
@@ -469,6 +525,8 @@ ZCrossExtractor<ScalarField, Confidence, FaceGenerator>::extract()
    
    face_markers.clear();
    
+   snap = nullptr;
+   
 }
 
 template <typename ScalarField, typename Confidence, typename FaceGenerator>
@@ -483,10 +541,11 @@ ZCrossExtractor<ScalarField,
    double sf_vals[3];
    
    // Get scalar field values for all vertices on this face:
+   if(!sfield(f, sf_vals))
+      return false;
+   
    for(int i = 0; i < 3; ++i){
       
-      sf_vals[i] = sfield(f->v(i + 1));
-      
       // Perturb scalar field slightly so that we don't have any zeros exactly
       // on vertices:
       sf_vals[i] = (sf_vals[i] == 0.0) ? 1.0e-8 : sf_vals[i];
@@ -607,16 +666,29 @@ ZCrossExtractor<ScalarField,
 
 #endif // NDEBUG
       
-      // This face shouldn't have been seen before:
-      assert(face_markers[cur_face->index()] == false);
+      // A face seen before ends the line.  That only happens (like the
+      // checks below failing) when the field's values at a vertex differ
+      // from face to face, or the field keeps lines out of some faces:
+      int cur_idx = snap->index(cur_face);
       
-      face_markers[cur_face->index()] = true;
+      if(face_markers[cur_idx])
+         break;
       
-      // This should never fail:
       if(!get_zcross_points(cur_face, zcross_pts, zcross_edges))
          break;
       
-      int next_pt = (cur_face->nbr(zcross_edges[0] + 1) == prev_face) ? 1 : 0;
+      // The face is left unmarked if the line doesn't come in from prev_face,
+      // so a line of its own can still be found there:
+      int next_pt;
+      
+      if(cur_face->nbr(zcross_edges[0] + 1) == prev_face)
+         next_pt = 1;
+      else if(cur_face->nbr(zcross_edges[1] + 1) == prev_face)
+         next_pt = 0;
+      else
+         break;
+      
+      face_markers[cur_idx] = true;
       
       next_face = cur_face->nbr(zcross_edges[next_pt] + 1);
       
@@ -775,7 +847,7 @@ ZCrossExtractor<ScalarField,
             f->v(vert_index + 1),         // Vertex (what's this for?)
             seg.get_start_conf(),         // Confidence
             seg.get_start_bc().to_Wvec(), // Barycentric coords
-            STYPE_SUGLINE,                // Type
+            type,                         // Type
             false)                        // End flag
       );
    
@@ -787,7 +859,7 @@ ZCrossExtractor<ScalarField,
                f->v(vert_index + 1),         // Vertex (what's this for?)
                seg.get_end_conf(),           // Confidence
                seg.get_end_bc().to_Wvec(),   // Barycentric coords
-               STYPE_SUGLINE,                // Type
+               type,                         // Type
                true)                         // End flag
          );
          
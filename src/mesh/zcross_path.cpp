@@ -140,8 +140,8 @@ ZcrossPath::start_sil(Bface *f )
    //never check across a crease boundary ()
    //it's a discontinuity in the isosurface
 
-   f1 = ( f->e(ex1+1)->is_crease()) ? nullptr : f->nbr(ex1+1);
-   f2 = ( f->e(ex2+1)->is_crease()) ? nullptr : f->nbr(ex2+1);
+   f1 = ( f->e(ex1+1)->is_crease()) ? nullptr : nbr(f, ex1+1);
+   f2 = ( f->e(ex2+1)->is_crease()) ? nullptr : nbr(f, ex2+1);
 
 
    //case 1 - we search and close the loop
@@ -346,6 +346,8 @@ ZcrossPath::sil_walk_search ( Bface *f, Bvert * vrt[3], double g[3] )
    //
 
    Bface * next_f = f->opposite_face(vrt[1-cross_vrt]);
+   if (next_f && _filter && !_filter->accept(next_f))
+      next_f = nullptr;
    Wvec bc(0,0,0);
 
    if ( !next_f || f->shared_edge(next_f)->is_crease() ) {
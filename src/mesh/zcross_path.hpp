@@ -197,13 +197,14 @@ public:
    //******** MANAGERS ********
 
    // Create an empty strip:
-   ZcrossPath() : _patch(nullptr), _index(-1) {}
+   ZcrossPath() : _patch(nullptr), _index(-1), _filter(nullptr) {}
 
    // Given a list of edges to search, build a strip of
    // edges that satisfy a given property.
    ZcrossPath(CBface_list& list) :
          _patch(nullptr),
-         _index(-1)
+         _index(-1),
+         _filter(nullptr)
    {
 
       build(list);
@@ -268,6 +269,9 @@ public:
 
    ZXseg&  seg(int i )                 { return _segs[i]; }
    void set_eye(CWpt& eye )     { _eye = eye; }
+   // if set, paths end where they would enter faces it rejects,
+   // as at a border:
+   void set_face_filter(CSimplexFilter* f) { _filter = f; }
    CWpt& eye()                  const   { return _eye; }
    CWpt& first()                const { return _segs[0].p(); }
    CWpt& last()                 const { return _segs[num()-1].p(); }
@@ -292,11 +296,18 @@ protected:
    Patch*               _patch;       // patch this is assigned to
    int                  _index;       // index in patch's list
    Wpt                  _eye;         // eye_local ( set by bmesh )
+   CSimplexFilter*      _filter;      // faces paths may enter, if set
    //******** PROTECTED METHODS ********
 
    // used internally when generating
    // strips of edges of a given type:
 
+   // neighbor of f across edge k (1 to 3), if the filter takes it:
+   Bface* nbr(Bface* f, int k) const {
+      Bface* ret = f->nbr(k);
+      return (ret && _filter && !_filter->accept(ret)) ? nullptr : ret;
+   }
+
    // setting the Patch -- nobody's bizness but the Patch's:
    // (to set it call Patch::add(ZcrossPath*))
    void   set_patch(Patch* p)           { _patch = p; }
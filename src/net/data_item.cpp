@@ -18,6 +18,10 @@
 #include "std/config.hpp"
 #include "data_item.hpp"
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 using mlib::Wpt;
 using mlib::Wvec;
 
@@ -163,17 +167,13 @@ DATA_ITEM::decode(STDdstream &ds)
       // if object only has 1 unnamed tag, then just call its decoder
       tags()[0]->decode(this, *d);
    } else {
+      string tag_name;
       while (d) {
-         string tag_name;
          *d >> tag_name;
-         TAGlist::size_type j;
-         for (j = 0; j < tags().size(); j++) {
-            if (tags()[j]->name() == tag_name) {
-               tags()[j]->decode(this, *d);
-               break;
-            }
-         }
-         if (j == tags().size()) {
+         int j = find_tag(tag_name);
+         if (j >= 0) {
+            tags()[j]->decode(this, *d);
+         } else {
             if (comment.name() == tag_name) {
                comment.decode(this, *d);
             } else { // skip over tag's data section
@@ -181,6 +181,8 @@ DATA_ITEM::decode(STDdstream &ds)
                while (!finished) {
                   string s;
                   *d >> s;
+                  if (s.empty())              // end of input
+                     break;
                   if (!count && s[0] != '{')  // tag is single-valued
                      break;
                   // skip over matching { }'s
@@ -203,6 +205,81 @@ DATA_ITEM::decode(STDdstream &ds)
    return *d;
 }
 
+/* -----------------------------------------------------
+    Finding tags by name.  Each tag list gets a hash table
+  from tag names to indices the first time an item that
+  uses it is decoded. Lists are static per class, or live
+  as long as their item, and only grow, so a table is
+  rebuilt if its list has grown. A name found in a table is
+  checked against the list (an item's own list may be gone
+  and its address reused); names not found are looked for
+  in turn, as before, so unknown tags cost what they did.
+  Short lists are always just searched.
+   ----------------------------------------------------- */
+int DATA_ITEM::_use_tag_index = -1;
+
+static const size_t MIN_INDEXED_TAGS = 8;
+
+namespace {
+struct tag_index_t {
+   size_t                    _size;     // list size when built
+   unordered_map<string,int> _index;
+};
+}
+static mutex tag_index_mutex;
+
+// Made on first use, since items may be decoded while other
+// files' statics are being constructed (e.g. when the config
+// file is loaded), and never destroyed, for the same reason:
+static unordered_map<CTAGlist*,shared_ptr<const tag_index_t> >&
+tag_indices()
+{
+   static auto* ret = new unordered_map<CTAGlist*,shared_ptr<const tag_index_t> >;
+   return *ret;
+}
+
+bool
+DATA_ITEM::use_tag_index()
+{
+   if (_use_tag_index < 0)
+      _use_tag_index = Config::get_var_bool("JOT_HASH_TAGS",true) ? 1 : 0;
+   return _use_tag_index == 1;
+}
+
+int
+DATA_ITEM::find_tag(const string &name) const
+{
+   CTAGlist& list = tags();
+   if (list.size() >= MIN_INDEXED_TAGS && use_tag_index()) {
+      // The table used last (by this thread) is kept at hand, since
+      // an item's tags are looked up one after another:
+      static thread_local CTAGlist* last_list = nullptr;
+      static thread_local shared_ptr<const tag_index_t> last_index;
+      if (last_list != &list || last_index->_size != list.size()) {
+         lock_guard<mutex> lock(tag_index_mutex);
+         shared_ptr<const tag_index_t>& entry = tag_indices()[&list];
+         if (!entry || entry->_size != list.size()) {
+            auto t = make_shared<tag_index_t>();
+            t->_size = list.size();
+            for (TAGlist::size_type j = 0; j < list.size(); j++)
+               t->_index.insert(make_pair(list[j]->name(), (int)j)); // keeps first
+            entry = t;
+         }
+         last_list  = &list;
+         last_index = entry;
+      }
+      const tag_index_t* index = last_index.get();
+      auto it = index->_index.find(name);
+      if (it != index->_index.end() && it->second < (int)list.size() &&
+          list[it->second]->name() == name)
+         return it->second;
+   }
+   for (TAGlist::size_type j = 0; j < list.size(); j++)
+      if (list[j]->name() == name)
+         return j;
+   return -1;
+}
+
 STDdstream  &
 DATA_ITEM::format(STDdstream &ds) const 
 {
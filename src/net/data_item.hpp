@@ -131,13 +131,17 @@ class TAG_meth : public TAG {
                                         _format(format), _decode(decode) { }
     virtual ~TAG_meth() {}
 
-    STDdstream &format(CDATA_ITEM *me, STDdstream &d) { _delim.set_stream(&d);
-                                       (((T *)me)->*_format)(_delim); return d;}
+    // (each call formats thru its own copy of _delim, since the
+    // tag is shared by every thread reading or writing a T)
+    STDdstream &format(CDATA_ITEM *me, STDdstream &d) { TAGformat delim(_delim);
+                                       delim.set_stream(&d);
+                                       (((T *)me)->*_format)(delim); return d;}
     STDdstream &decode(CDATA_ITEM *me, STDdstream &d) 
-                                      { _delim.set_stream(&d);
-                                       _delim.read_id();
-                                       (((T *)me)->*_decode)(_delim);
-                                       _delim.read_end_id();
+                                      { TAGformat delim(_delim);
+                                       delim.set_stream(&d);
+                                       delim.read_id();
+                                       (((T *)me)->*_decode)(delim);
+                                       delim.read_end_id();
                                        return d; }
     const string &name()     const   { return _delim.name(); }
 };
@@ -162,14 +166,14 @@ class TAG_val : public TAG {
          output = (((T *)me)->*_test)();
       }
       if (output) {
-         _delim.set_stream(&d);
-         _delim.id() << (((T *)me)->*_value)();
+         TAGformat delim(&d, _delim.name(), 0);
+         delim.id() << (((T *)me)->*_value)();
       }
       return d;
    }
    STDdstream &decode(CDATA_ITEM *me, STDdstream &d)
-      { _delim.set_stream(&d);
-      _delim.read_id()>>(((T *)me)->*_value)();
+      { TAGformat delim(&d, _delim.name(), 0);
+      delim.read_id()>>(((T *)me)->*_value)();
       return d; }
    const string &name()     const      { return _delim.name(); }
 };
@@ -246,6 +250,20 @@ class DATA_ITEM {
                                                   }
      /* -------- Static debugging functions -------- */
  static  map<string,DATA_ITEM*> *di_hash()        { return _hash; }
+
+     /* -------- Finding tags by name -------- */
+     // decode() finds each tag it reads in tags() through a hash
+     // table built once per tag list (see data_item.cpp), instead
+     // of comparing names in turn. Set with JOT_HASH_TAGS (default: on):
+ static  bool        use_tag_index();
+ static  void        set_use_tag_index(bool b) { _use_tag_index = b ? 1 : 0; }
+
+   protected:
+     // Index in tags() of the first tag with the given name, or -1:
+         int         find_tag(const string &name) const;
+
+   private:
+ static  int         _use_tag_index;     // -1 until read from config
 };
 
 inline STDdstream &operator<<(STDdstream &s, CDATA_ITEM &d)
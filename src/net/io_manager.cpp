@@ -16,8 +16,16 @@
  * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
  *****************************************************************/
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include "io_manager.hpp"
+#include "std/config.hpp"
 #include "std/file.hpp"
+#include "std/parallel.hpp"
 
 /*****************************************************************
  * IOManager
@@ -874,3 +882,235 @@ IOManager::split_filename(
 
    return result;
 }
+
+/*****************************************************************
+ * IOManager - Prefetching
+ *****************************************************************/
+
+namespace {
+
+typedef map<string,IOManager::prefetch_t> prefetch_map_t;
+
+// (function statics, so classes can register from static initializers)
+prefetch_map_t& prefetch_tags() { static prefetch_map_t m; return m; }
+prefetch_map_t& prefetch_exts() { static prefetch_map_t m; return m; }
+map<string,string>& prefetch_includes() { static map<string,string> m; return m; }
+
+mutex                          prefetched_mutex;
+map<string,shared_ptr<void> >  prefetched;
+
+// A file to read, and the loader to read it with:
+struct prefetch_job_t {
+   string                path;
+   IOManager::prefetch_t load;
+};
+
+// Absolute path with no "." or ".." parts or links, so names built
+// by the scan and by the code that loads the file agree:
+string
+canonical_path(const string& path)
+{
+#ifdef WIN32
+   char buf[_MAX_PATH];
+   return _fullpath(buf, path.c_str(), _MAX_PATH) ? string(buf) : path;
+#else
+   char buf[PATH_MAX];
+   return realpath(path.c_str(), buf) ? string(buf) : path;
+#endif
+}
+
+bool
+file_exists(const string& path)
+{
+   return ifstream(path.c_str()).good();
+}
+
+bool
+ends_with(const string& s, const string& end)
+{
+   // (ignoring case)
+   if (s.size() < end.size())
+      return false;
+   return equal(end.begin(), end.end(), s.end() - end.size(),
+                [](char a, char b) { return tolower(a) == tolower(b); });
+}
+
+// Find the files named in the text file at path, adding a job for
+// each one not seen yet. prefix is the load prefix, as updated by
+// any "basename" tag seen along the way:
+void
+scan_file(
+   const string&           path,
+   string&                 prefix,
+   bool                    full_scene,
+   set<string>&            seen,
+   vector<prefetch_job_t>& jobs)
+{
+   MappedFile f;
+   if (!f.open(path))
+      return;
+
+   const char* p   = f.data();
+   const char* end = p + f.size();
+   string tag;                  // tag whose value comes next, if any
+
+   while (p < end) {
+      while (p < end && (isspace(*p) || *p == '{' || *p == '}'))
+         p++;
+      const char* q = p;
+      while (q < end && !isspace(*q) && *q != '{' && *q != '}')
+         q++;
+      if (q == p)
+         break;
+      string tok(p, q);
+      p = q;
+
+      if (tag.empty()) {
+         if ((tok == "basename" && full_scene) ||
+             prefetch_tags().count(tok) || prefetch_includes().count(tok)) {
+            tag = tok;
+         } else {
+            // any file name with a registered extension:
+            for (auto& e : prefetch_exts()) {
+               if (!ends_with(tok, e.first))
+                  continue;
+               string file = tok;
+               if (tok[0] != '/') {
+                  if (file_exists(prefix + tok))
+                     file = prefix + tok;
+                  else if (file_exists(Config::JOT_ROOT() + tok))
+                     file = Config::JOT_ROOT() + tok;
+               }
+               if (file_exists(file) && seen.insert(canonical_path(file)).second)
+                  jobs.push_back(prefetch_job_t{file, e.second});
+               break;
+            }
+         }
+         continue;
+      }
+
+      // tok is the value of the tag:
+      string t = tag;
+      tag = "";
+      if (tok == "NULL_STR")
+         continue;
+      if (t == "basename") {
+         prefix = IOManager::cwd() + tok + "--";
+      } else if (prefetch_tags().count(t)) {
+         string file = prefix + tok;
+         if (seen.insert(canonical_path(file)).second)
+            jobs.push_back(prefetch_job_t{file, prefetch_tags()[t]});
+      } else {
+         string file = prefix + tok + prefetch_includes()[t];
+         if (seen.insert(canonical_path(file)).second)
+            scan_file(file, prefix, false, seen, jobs);
+      }
+   }
+}
+
+} // namespace
+
+/////////////////////////////////////
+// add_prefetch_tag()
+/////////////////////////////////////
+void
+IOManager::add_prefetch_tag(const string& tag, prefetch_t f)
+{
+   prefetch_tags()[tag] = f;
+}
+
+/////////////////////////////////////
+// add_prefetch_ext()
+/////////////////////////////////////
+void
+IOManager::add_prefetch_ext(const string& ext, prefetch_t f)
+{
+   prefetch_exts()[ext] = f;
+}
+
+/////////////////////////////////////
+// add_prefetch_include()
+/////////////////////////////////////
+void
+IOManager::add_prefetch_include(const string& tag, const string& ext)
+{
+   prefetch_includes()[tag] = ext;
+}
+
+/////////////////////////////////////
+// read_bytes()
+/////////////////////////////////////
+shared_ptr<void>
+IOManager::read_bytes(const string& path)
+{
+   ifstream in(path.c_str(), ios::in | ios::binary);
+   if (!in)
+      return nullptr;
+   in.seekg(0, ios::end);
+   shared_ptr<string> ret = make_shared<string>(size_t(in.tellg()), '\0');
+   in.seekg(0, ios::beg);
+   if (!ret->empty() && !in.read(&(*ret)[0], ret->size()))
+      return nullptr;
+   return ret;
+}
+
+/////////////////////////////////////
+// prefetch()
+/////////////////////////////////////
+void
+IOManager::prefetch(const string& scene_file)
+{
+   clear_prefetched();
+
+   if (Config::get_var_bool("JOT_NO_PREFETCH", false))
+      return;
+
+   state_t s = state();
+   string prefix = (s == STATE_PARTIAL_LOAD) ? cached_prefix() : cwd();
+
+   set<string> seen;
+   vector<prefetch_job_t> jobs;
+   scan_file(scene_file, prefix, s == STATE_SCENE_LOAD, seen, jobs);
+   if (jobs.empty())
+      return;
+
+   err_mesg(ERR_LEV_SPAM, "IOManager::prefetch() - Reading %d files named in '%s'...",
+            int(jobs.size()), scene_file.c_str());
+
+   // The loaders only read files (see io_manager.hpp), so this
+   // thread just waits for them:
+   parallel_jobs(int(jobs.size()), [&](int i) {
+      shared_ptr<void> ret = jobs[i].load(jobs[i].path);
+      if (ret) {
+         lock_guard<mutex> lock(prefetched_mutex);
+         prefetched[canonical_path(jobs[i].path)] = ret;
+      }
+   });
+}
+
+/////////////////////////////////////
+// take_prefetched()
+/////////////////////////////////////
+shared_ptr<void>
+IOManager::take_prefetched(const string& path)
+{
+   lock_guard<mutex> lock(prefetched_mutex);
+   if (prefetched.empty())
+      return nullptr;
+   auto i = prefetched.find(canonical_path(path));
+   if (i == prefetched.end())
+      return nullptr;
+   shared_ptr<void> ret = i->second;
+   prefetched.erase(i);
+   return ret;
+}
+
+/////////////////////////////////////
+// clear_prefetched()
+/////////////////////////////////////
+void
+IOManager::clear_prefetched()
+{
+   lock_guard<mutex> lock(prefetched_mutex);
+   prefetched.clear();
+}
@@ -18,6 +18,7 @@
 #ifndef IO_MANAGER_H_IS_INCLUDED
 #define IO_MANAGER_H_IS_INCLUDED
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -148,6 +149,44 @@ class IOManager : public SAVEobs, public LOADobs, public DATA_ITEM {
    static std::string load_prefix()    { return instance()->load_prefix_(); }
    static std::string save_prefix()    { return instance()->save_prefix_(); }
 
+   /******** PREFETCHING ********/
+   // Before a scene is decoded (which happens serially, in order),
+   // the external files it names can be read on several threads.
+   // Classes register a loader for the files named by one of their
+   // tags (e.g. "mesh_data_file") or for file names with a given
+   // extension (e.g. ".png"); include tags name files (e.g. .npr
+   // files) that are scanned for more names in turn. The scan is
+   // only a hint: callers ask for the result with take_prefetched(),
+   // and load the file as usual if there is none.
+   //
+   // Loaders run on worker threads, so they may only read the file
+   // and build objects nothing else refers to (e.g. a decoded
+   // Image). Anything that touches shared state -- meshes, with
+   // their keys, observers and tag tables -- is decoded on the main
+   // thread when taken, from the bytes read_bytes() returns.
+
+   // Reads the file at path, or returns null:
+   typedef std::shared_ptr<void> (*prefetch_t)(const std::string& path);
+
+   // Loader that just reads the whole file (into a std::string):
+   static std::shared_ptr<void> read_bytes(const std::string& path);
+
+   static void add_prefetch_tag(const std::string& tag, prefetch_t f);
+   static void add_prefetch_ext(const std::string& ext, prefetch_t f);
+   static void add_prefetch_include(const std::string& tag,
+                                    const std::string& ext);
+
+   // Scan the given text scene file (with the IO state of the load
+   // that's about to decode it) and run the loaders for the files it
+   // names, returning when all are done. Results not taken are kept
+   // until the next prefetch, since some (e.g. textures) are only
+   // asked for when first drawn:
+   static void prefetch(const std::string& scene_file);
+
+   // Result of the loader for the file at path (removing it), or null:
+   static std::shared_ptr<void> take_prefetched(const std::string& path);
+   static void clear_prefetched();
+
    /******** LOADobs METHODS ********/
    virtual void notify_preload (STDdstream &, load_status_t &, bool);
    virtual void notify_postload(STDdstream &, load_status_t &, bool);
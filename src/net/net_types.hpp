@@ -160,6 +160,128 @@ inline STDdstream &operator>>(STDdstream &ds, mlib::Plane<PLANE,P,V,L> &plane)
      { char brace;
        return ds >> brace >> plane.normal() >> plane.d() >> brace; }
 
+// Lists whose elements are a few scalars (points, vectors,
+// numbers) go in binary streams as one block of scalars (see
+// STDdstream::write_block()). dstream_block<T>::type is the scalar
+// type ('d', 'f' or 'i'; 0 if T isn't written that way) and ::num
+// the scalars in each T. The overloads below pick them, so classes
+// derived from the mlib types get them too:
+template <char TYPE, int NUM, size_t SIZE>
+struct dstream_block_t {
+   static const char   type = TYPE;
+   static const int    num  = NUM;
+   static const size_t size = SIZE;    // bytes per scalar in the stream
+};
+
+template <class P, class V>
+dstream_block_t<'d',3,8> dstream_block_of(const mlib::Point3<P,V>*);
+template <class V>
+dstream_block_t<'d',3,8> dstream_block_of(const mlib::Vec3<V>*);
+template <class P, class V>
+dstream_block_t<'d',2,8> dstream_block_of(const mlib::Point2<P,V>*);
+template <class V>
+dstream_block_t<'d',2,8> dstream_block_of(const mlib::Vec2<V>*);
+dstream_block_t<'i',3,4> dstream_block_of(const mlib::Point3i*);
+dstream_block_t<'i',2,4> dstream_block_of(const mlib::Point2i*);
+dstream_block_t<'d',1,8> dstream_block_of(const double*);
+dstream_block_t<'f',1,4> dstream_block_of(const float*);
+dstream_block_t<'i',1,4> dstream_block_of(const int*);
+dstream_block_t< 0 ,0,1> dstream_block_of(const void*);
+
+template <class T>
+struct dstream_block {
+   typedef decltype(dstream_block_of((const T*)nullptr)) B;
+   // (only if T holds just the scalars, in the stream's sizes)
+   static const char type = (sizeof(T) == B::num*B::size) ? B::type : 0;
+   static const int  num  = B::num;
+};
+
+template <class T, bool = (dstream_block<T>::type != 0)>
+struct dstream_blocks {
+   static bool put(STDdstream &, const vector<T> &) { return false; }
+   static bool get(STDdstream &,       vector<T> &) { return false; }
+};
+
+template <class T>
+struct dstream_blocks<T,true> {
+   typedef dstream_block<T> B;
+
+   static bool put(STDdstream &ds, const vector<T> &list) {
+      if (!ds.binary_out())
+         return false;
+      ds.write_block(B::type, B::num, list.size(), list.data());
+      return true;
+   }
+
+   // Appends the elements of a block, if one comes next. The
+   // block's scalars are regrouped if its elements are another
+   // size (e.g. points read as doubles):
+   static bool get(STDdstream &ds, vector<T> &list) {
+      char   type;
+      int    comps;
+      size_t num;
+      if (!ds.next_block(type, comps, num))
+         return false;
+      size_t count = num*comps, old = list.size();
+      list.resize(old + (count + B::num - 1)/B::num);
+      ds.read_block(type, B::type, count, list.data() + old);
+      if (count % B::num != 0)
+         ds.istr()->setstate(ios::failbit);
+      return true;
+   }
+};
+
+// Lists of such lists (e.g. mesh faces) go as a block of sizes and
+// a block of all the elements:
+template <class T, bool = (dstream_block<T>::type != 0)>
+struct dstream_lists {
+   static bool put(STDdstream &, const vector<vector<T> > &) { return false; }
+   static bool get(STDdstream &,       vector<vector<T> > &) { return false; }
+};
+
+template <class T>
+struct dstream_blocks<vector<T>,false> : public dstream_lists<T> {};
+
+template <class T>
+struct dstream_lists<T,true> {
+   typedef dstream_block<T> B;
+
+   static bool put(STDdstream &ds, const vector<vector<T> > &lists) {
+      if (!ds.binary_out())
+         return false;
+      vector<int> sizes;
+      vector<T>   all;
+      sizes.reserve(lists.size());
+      for (auto& l : lists) {
+         sizes.push_back(l.size());
+         all.insert(all.end(), l.begin(), l.end());
+      }
+      dstream_blocks<int>::put(ds, sizes);
+      dstream_blocks<T>::put(ds, all);
+      return true;
+   }
+
+   static bool get(STDdstream &ds, vector<vector<T> > &lists) {
+      vector<int> sizes;
+      vector<T>   all;
+      if (!dstream_blocks<int>::get(ds, sizes))
+         return false;
+      if (!dstream_blocks<T>::get(ds, all))
+         ds.istr()->setstate(ios::failbit);
+      size_t k = 0;
+      lists.reserve(lists.size() + sizes.size());
+      for (auto& n : sizes) {
+         if (n < 0 || k + n > all.size()) {
+            ds.istr()->setstate(ios::failbit);
+            break;
+         }
+         lists.push_back(vector<T>(all.begin() + k, all.begin() + k + n));
+         k += n;
+      }
+      return true;
+   }
+};
+
 template <class T>
 inline STDdstream  &operator<<(STDdstream &ds, const ARRAY<T> &list) {
    ds << "{";
@@ -187,6 +309,8 @@ inline STDdstream &operator>>(STDdstream &ds, ARRAY<T> &list) {
 
 template <class T>
 inline STDdstream  &operator<<(STDdstream &ds, const vector<T> &list) {
+   if (dstream_blocks<T>::put(ds, list))
+      return ds;
    ds << "{";
    for (auto & elem : list) {
       ds << elem;
@@ -197,6 +321,8 @@ inline STDdstream  &operator<<(STDdstream &ds, const vector<T> &list) {
 
 template <class T>
 inline STDdstream &operator>>(STDdstream &ds, vector<T> &list) {
+   if (dstream_blocks<T>::get(ds, list))
+      return ds;
    char brace; ds >> brace;
    while (ds.check_end_delim()) {
       // Declare 'var' inside this loop (not outside) in case it is
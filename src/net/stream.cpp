@@ -23,8 +23,17 @@
  *
  * ------------------------------------------------------------------------- */
 
+#include <algorithm>
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 
+#include "std/config.hpp"
 #include "std/support.hpp"
 #include "stream.hpp"
 
@@ -38,6 +47,9 @@ STDdstream::STDdstream():
    _istream(nullptr),
    _ostream(nullptr),
    _indent(0),
+   _bin_out(false),
+   _bin_in(-1),
+   _swap(false),
    _name(""),
    _fail(false)
 {
@@ -48,12 +60,18 @@ STDdstream::STDdstream(const string &name, STDdstream::StreamFlags flags):
    _istream(nullptr),
    _ostream(nullptr),
    _indent(0),
+   _bin_out(false),
+   _bin_in(-1),
+   _swap(false),
    _name(name),
    _fail(false)
 {
    int readable  = flags & read;
    int writeable = flags & write;
 
+   // without the ascii flag, the stream is binary (see below):
+   fstream::openmode mode = (flags & ascii) ? fstream::openmode(0) : fstream::binary;
+
    fstream *fs = nullptr;
    if (readable && writeable) {
       // We don't expect this to happen...
@@ -63,11 +81,11 @@ STDdstream::STDdstream(const string &name, STDdstream::StreamFlags flags):
            << "stream is readable AND writeable. Truncating file: "
            << name
            << endl;
-      fs = new fstream(name.c_str(), fstream::in | fstream::out | fstream::trunc);
+      fs = new fstream(name.c_str(), fstream::in | fstream::out | fstream::trunc | mode);
    } else if (writeable) {
-      fs = new fstream(name.c_str(), fstream::out | fstream::trunc);
+      fs = new fstream(name.c_str(), fstream::out | fstream::trunc | mode);
    } else if (readable) {
-      fs = new fstream(name.c_str(), fstream::in);
+      fs = new fstream(name.c_str(), fstream::in | mode);
    } else {
       // this never happens, does it?
       assert(0);
@@ -83,6 +101,9 @@ STDdstream::STDdstream(const string &name, STDdstream::StreamFlags flags):
    _iostream = fs;
    _istream = dynamic_cast<istream*>(fs);
    _ostream = dynamic_cast<ostream*>(fs);
+
+   if (fs && writeable && !(flags & ascii))
+      set_binary();
 }
 
 STDdstream::STDdstream(iostream* s):
@@ -90,6 +111,9 @@ STDdstream::STDdstream(iostream* s):
    _istream(nullptr),
    _ostream(nullptr),
    _indent(0),
+   _bin_out(false),
+   _bin_in(-1),
+   _swap(false),
    _name(""),
    _fail(false)
 {
@@ -100,6 +124,9 @@ STDdstream::STDdstream(istream* s):
    _istream(s),
    _ostream(nullptr),
    _indent(0),
+   _bin_out(false),
+   _bin_in(-1),
+   _swap(false),
    _name(""),
    _fail(false)
 {
@@ -110,11 +137,757 @@ STDdstream::STDdstream(ostream* s):
    _istream(nullptr),
    _ostream(s),
    _indent(0),
+   _bin_out(false),
+   _bin_in(-1),
+   _swap(false),
    _name(""),
    _fail(false)
 {
 }
 
+/* -------------------------------------------------------------------------
+ * DESCR   :	Reading straight from the stream buffer.
+ *
+ *		The get_*() methods read one value the way istream's
+ *		formatted extraction does (skip white space, take the
+ *		characters that can be part of the value, stop before
+ *		the first that can't, set eof/fail the same way), but
+ *		take the characters from the streambuf directly into a
+ *		small local buffer: no sentry, no locale facets, no
+ *		allocation per value. Numbers are converted with
+ *		strtol()/strtod(), as libstdc++ does, so values are
+ *		the same.
+ * ------------------------------------------------------------------------- */
+int STDdstream::_fast_reads = -1;
+
+bool
+STDdstream::fast_reads()
+{
+   if (_fast_reads < 0)
+      _fast_reads = Config::get_var_bool("JOT_FAST_DSTREAM_READS",true) ? 1 : 0;
+   return _fast_reads == 1;
+}
+
+// Skip white space; returns the next character (not taken), or
+// EOF after setting the stream's eof and fail bits:
+inline int
+skip_space(istream* is, streambuf* sb)
+{
+   int c = sb->sgetc();
+   while (c != EOF && isspace(c))
+      c = sb->snextc();
+   if (c == EOF)
+      is->setstate(ios::eofbit | ios::failbit);
+   return c;
+}
+
+bool
+STDdstream::get_token(string& s)
+{
+   istream* is = istr();
+   streambuf* sb = is->rdbuf();
+   s.clear();
+   if (!is->good()) {
+      is->setstate(ios::failbit);
+      return false;
+   }
+   int c = skip_space(is, sb);
+   if (c == EOF)
+      return false;
+   char buf[256];
+   int  n = 0;
+   do {
+      if (n == (int)sizeof(buf)) {
+         s.append(buf, n);
+         n = 0;
+      }
+      buf[n++] = (char)c;
+      c = sb->snextc();
+   } while (c != EOF && !isspace(c));
+   s.append(buf, n);
+   if (c == EOF)
+      is->setstate(ios::eofbit);
+   return true;
+}
+
+bool
+STDdstream::get_char(char& ch)
+{
+   istream* is = istr();
+   if (!is->good()) {
+      is->setstate(ios::failbit);
+      return false;
+   }
+   int c = skip_space(is, is->rdbuf());
+   if (c == EOF)
+      return false;
+   ch = (char)c;
+   is->rdbuf()->sbumpc();
+   return true;
+}
+
+int
+STDdstream::get_number(char* buf, int size, bool real)
+{
+   // Take the characters of a number: sign, digits, and for real
+   // numbers a decimal point and exponent. Returns 1 if there were
+   // digits, 0 if not (the value read is then 0), or -1 if there
+   // was nothing to read (the value is left alone), as istream does:
+   istream* is = istr();
+   streambuf* sb = is->rdbuf();
+   if (!is->good()) {
+      is->setstate(ios::failbit);
+      return -1;
+   }
+   int c = skip_space(is, sb);
+   if (c == EOF)
+      return -1;
+   int  n = 0;
+   bool digits = false, point = false, exp = false;
+   auto take = [&]() {
+      if (n < size - 1)
+         buf[n++] = (char)c;
+      c = sb->snextc();
+   };
+   if (c == '+' || c == '-')
+      take();
+   for (;;) {
+      if (c == EOF) {
+         break;
+      } else if (isdigit(c)) {
+         digits = true;
+         take();
+      } else if (real && c == '.' && !point && !exp) {
+         point = true;
+         take();
+      } else if (real && (c == 'e' || c == 'E') && digits && !exp) {
+         exp = true;
+         take();
+         if (c == '+' || c == '-')
+            take();
+      } else {
+         break;
+      }
+   }
+   buf[n] = 0;
+   if (c == EOF)
+      is->setstate(ios::eofbit);
+   if (!digits) {
+      is->setstate(ios::failbit);
+      return 0;
+   }
+   return 1;
+}
+
+bool
+STDdstream::get_long(long& val, long lo, long hi)
+{
+   char buf[64];
+   int  r = get_number(buf, sizeof(buf), false);
+   if (r <= 0) {
+      if (r == 0)
+         val = 0;
+      return false;
+   }
+   errno = 0;
+   long v = strtol(buf, nullptr, 10);
+   if (errno == ERANGE || v < lo || v > hi) {
+      val = (v < lo) ? lo : hi;
+      istr()->setstate(ios::failbit);
+      return false;
+   }
+   val = v;
+   return true;
+}
+
+bool
+STDdstream::get_ulong(unsigned long& val, unsigned long hi)
+{
+   // As with istream, a negative number is negated in the
+   // unsigned type, if its magnitude is in range:
+   char buf[64];
+   int  r = get_number(buf, sizeof(buf), false);
+   if (r <= 0) {
+      if (r == 0)
+         val = 0;
+      return false;
+   }
+   bool neg = (buf[0] == '-');
+   errno = 0;
+   unsigned long v = strtoul(buf + (neg || buf[0] == '+'), nullptr, 10);
+   if (errno == ERANGE || v > hi) {
+      val = hi;
+      istr()->setstate(ios::failbit);
+      return false;
+   }
+   val = neg ? ((0 - v) & hi) : v;
+   return true;
+}
+
+bool
+STDdstream::get_double(double& val)
+{
+   char buf[128];
+   int  r = get_number(buf, sizeof(buf), true);
+   if (r <= 0) {
+      if (r == 0)
+         val = 0;
+      return false;
+   }
+   char* end = nullptr;
+   errno = 0;
+   double v = strtod(buf, &end);
+   if (*end != 0) {
+      val = 0;
+      istr()->setstate(ios::failbit);
+      return false;
+   }
+   val = v;
+   if (errno == ERANGE && (v == HUGE_VAL || v == -HUGE_VAL)) {
+      // overflow gives the largest value, as with istream:
+      val = (v > 0) ? DBL_MAX : -DBL_MAX;
+      istr()->setstate(ios::failbit);
+      return false;
+   }
+   return true;
+}
+
+bool
+STDdstream::get_float(float& val)
+{
+   char buf[128];
+   int  r = get_number(buf, sizeof(buf), true);
+   if (r <= 0) {
+      if (r == 0)
+         val = 0;
+      return false;
+   }
+   char* end = nullptr;
+   errno = 0;
+   float v = strtof(buf, &end);
+   if (*end != 0) {
+      val = 0;
+      istr()->setstate(ios::failbit);
+      return false;
+   }
+   val = v;
+   if (errno == ERANGE && (v == HUGE_VALF || v == -HUGE_VALF)) {
+      val = (v > 0) ? FLT_MAX : -FLT_MAX;
+      istr()->setstate(ios::failbit);
+      return false;
+   }
+   return true;
+}
+
+/* -------------------------------------------------------------------------
+ * DESCR   :	Binary encoding.
+ *
+ *		A binary stream starts with the 7 bytes "\0JOTBIN" and
+ *		a byte giving the writer's byte order ('l' or 'b').
+ *		Text never starts with a 0 byte, so readers tell the
+ *		two apart on the first read. Then each value is a tag
+ *		byte and the value in the writer's byte order (readers
+ *		swap bytes if their order is the other one):
+ *
+ *		   c C      char, unsigned char      (1 byte)
+ *		   h H      short, unsigned short    (2 bytes)
+ *		   i I      int, unsigned int        (4 bytes)
+ *		   l L      long, unsigned long      (8 bytes)
+ *		   f d      float, double            (4, 8 bytes)
+ *		   s        string: 4 byte length, then the characters
+ *		   { }      delimiters
+ *		   \n       a line break
+ *		   [        block: scalar type ('d', 'f' or 'i'), 4 byte
+ *		            count of scalars per element, 8 byte count
+ *		            of elements, then the scalars
+ *
+ *		Strings are split into words the way text is read back:
+ *		white space is dropped except line breaks (which stop
+ *		get_string_with_spaces()), and words made of braces
+ *		become delimiters. So readers get the same values from
+ *		binary as from text, and can read a value as another
+ *		type where text would allow it (a number as a string,
+ *		a string of digits as a number).
+ * ------------------------------------------------------------------------- */
+static const char BIN_MAGIC[] = { 0, 'J', 'O', 'T', 'B', 'I', 'N' };
+
+inline char
+host_order()
+{
+   const int one = 1;
+   return *(const char*)&one ? 'l' : 'b';
+}
+
+// Bytes in the value after a tag, or -1 if the tag has no value:
+inline int
+bin_size(int tag)
+{
+   switch (tag) {
+    case 'c': case 'C':                 return 1;
+    case 'h': case 'H':                 return 2;
+    case 'i': case 'I': case 'f':       return 4;
+    case 'l': case 'L': case 'd':       return 8;
+   }
+   return -1;
+}
+
+inline void
+bin_write(ostream* os, const void* data, size_t size)
+{
+   if (size && os->rdbuf()->sputn((const char*)data, size) != (streamsize)size)
+      os->setstate(ios::badbit);
+}
+
+inline void
+bin_put(ostream* os, char tag)
+{
+   if (os->rdbuf()->sputc(tag) == EOF)
+      os->setstate(ios::badbit);
+}
+
+template <class T>
+inline void
+bin_put(ostream* os, char tag, T val)
+{
+   bin_put(os, tag);
+   bin_write(os, &val, sizeof(val));
+}
+
+static void
+bin_put_text(ostream* os, const char* s, size_t n)
+{
+   for (size_t i = 0; i < n; ) {
+      if (s[i] == '\n') {
+         bin_put(os, '\n');
+         i++;
+         continue;
+      } else if (isspace((unsigned char)s[i])) {
+         i++;
+         continue;
+      }
+      size_t j = i;
+      bool braces = true;
+      for ( ; j < n && !isspace((unsigned char)s[j]); j++)
+         braces = braces && (s[j] == '{' || s[j] == '}');
+      if (braces) {
+         for ( ; i < j; i++)
+            bin_put(os, s[i]);
+      } else {
+         bin_put(os, 's', (uint32_t)(j - i));
+         bin_write(os, s + i, j - i);
+      }
+      i = j;
+   }
+}
+
+inline void
+bin_swap(char* data, size_t size, size_t count)
+{
+   for (size_t k = 0; k < count; k++, data += size)
+      std::reverse(data, data + size);
+}
+
+inline bool
+bin_read_bytes(istream* is, void* data, size_t size)
+{
+   if (size && (size_t)is->rdbuf()->sgetn((char*)data, size) != size) {
+      is->setstate(ios::eofbit | ios::failbit);
+      return false;
+   }
+   return true;
+}
+
+template <class T>
+inline bool
+bin_read(istream* is, bool swap, T& val)
+{
+   if (!bin_read_bytes(is, &val, sizeof(val)))
+      return false;
+   if (swap)
+      bin_swap((char*)&val, sizeof(val), 1);
+   return true;
+}
+
+// The next tag, past line breaks (not taken), or EOF after
+// setting eof and fail as text reads do at the end:
+static int
+bin_peek(istream* is)
+{
+   if (!is->good()) {
+      is->setstate(ios::failbit);
+      return EOF;
+   }
+   streambuf* sb = is->rdbuf();
+   int c = sb->sgetc();
+   while (c == '\n')
+      c = sb->snextc();
+   if (c == EOF)
+      is->setstate(ios::eofbit | ios::failbit);
+   return c;
+}
+
+// One value read from a binary stream:
+struct bin_val_t {
+   enum kind_t { NONE, CHAR, INT, UINT, REAL, STRING };
+   kind_t             kind;
+   char               tag;
+   long long          i;     // CHAR or INT
+   unsigned long long u;     // UINT
+   double             d;     // REAL
+};
+
+// Takes the next value. Delimiters and blocks are not taken;
+// they come back as NONE with their tag:
+static bool
+bin_get(istream* is, bool swap, bin_val_t& v, string& s)
+{
+   int c = bin_peek(is);
+   if (c == EOF)
+      return false;
+   v.kind = bin_val_t::NONE;
+   v.tag  = (char)c;
+   if (c == '{' || c == '}' || c == '[')
+      return true;
+   is->rdbuf()->sbumpc();
+
+   if (c == 's') {
+      uint32_t len;
+      if (!bin_read(is, swap, len))
+         return false;
+      s.resize(len);
+      v.kind = bin_val_t::STRING;
+      return len == 0 || bin_read_bytes(is, &s[0], len);
+   }
+   char buf[8];
+   int  size = bin_size(c);
+   if (size < 0) {
+      // not something this encoding writes:
+      is->setstate(ios::failbit);
+      return false;
+   }
+   if (!bin_read_bytes(is, buf, size))
+      return false;
+   if (swap)
+      bin_swap(buf, size, 1);
+   switch (c) {
+    case 'c': { int8_t   x; memcpy(&x, buf, 1); v.i = x; v.kind = bin_val_t::CHAR; } break;
+    case 'C': { uint8_t  x; memcpy(&x, buf, 1); v.i = x; v.kind = bin_val_t::CHAR; } break;
+    case 'h': { int16_t  x; memcpy(&x, buf, 2); v.i = x; v.kind = bin_val_t::INT;  } break;
+    case 'H': { uint16_t x; memcpy(&x, buf, 2); v.u = x; v.kind = bin_val_t::UINT; } break;
+    case 'i': { int32_t  x; memcpy(&x, buf, 4); v.i = x; v.kind = bin_val_t::INT;  } break;
+    case 'I': { uint32_t x; memcpy(&x, buf, 4); v.u = x; v.kind = bin_val_t::UINT; } break;
+    case 'l': { int64_t  x; memcpy(&x, buf, 8); v.i = x; v.kind = bin_val_t::INT;  } break;
+    case 'L': { uint64_t x; memcpy(&x, buf, 8); v.u = x; v.kind = bin_val_t::UINT; } break;
+    case 'f': { float    x; memcpy(&x, buf, 4); v.d = x; v.kind = bin_val_t::REAL; } break;
+    case 'd': { double   x; memcpy(&x, buf, 8); v.d = x; v.kind = bin_val_t::REAL; } break;
+   }
+   return true;
+}
+
+// Takes the block that comes next, without reading it:
+static void
+bin_skip_block(STDdstream& ds)
+{
+   char   type;
+   int    comps;
+   size_t num;
+   if (ds.next_block(type, comps, num))
+      ds.istr()->ignore(num*comps*bin_size(type));
+}
+
+// A value as text would have it:
+static string
+bin_text(const bin_val_t& v, const string& s)
+{
+   switch (v.kind) {
+    case bin_val_t::CHAR:   return string(1, (char)v.i);
+    case bin_val_t::INT:    return std::to_string(v.i);
+    case bin_val_t::UINT:   return std::to_string(v.u);
+    case bin_val_t::STRING: return s;
+    case bin_val_t::REAL: {
+       ostringstream os;
+       if (v.tag == 'f')
+          os << (float)v.d;
+       else
+          os << v.d;
+       return os.str();
+    }
+    default:
+       return string(1, v.tag);
+   }
+}
+
+// Reads a number from the next value. Failures give 0 and leave
+// a delimiter in place, as in text:
+static bool
+bin_get_number(STDdstream& ds, bin_val_t& v, bool real)
+{
+   istream* is = ds.istr();
+   string   s;
+   if (!bin_get(is, ds.swap_bytes(), v, s))
+      return false;
+   if (v.kind == bin_val_t::STRING) {
+      // a number written as a string:
+      const char* str = s.c_str();
+      char* end = nullptr;
+      errno = 0;
+      if (real) {
+         v.d = strtod(str, &end);
+         v.kind = bin_val_t::REAL;
+      } else if (str[0] == '-') {
+         v.i = strtoll(str, &end, 10);
+         v.kind = bin_val_t::INT;
+      } else {
+         v.u = strtoull(str, &end, 10);
+         v.kind = bin_val_t::UINT;
+      }
+      if (end != str + s.size() || s.empty() || errno == ERANGE)
+         v.kind = bin_val_t::NONE;
+   }
+   if (v.kind == bin_val_t::NONE || v.kind == bin_val_t::CHAR) {
+      if (v.tag == '[')
+         bin_skip_block(ds);
+      is->setstate(ios::failbit);
+      return false;
+   }
+   return true;
+}
+
+static bool
+bin_get_long(STDdstream& ds, long& val, long lo, long hi)
+{
+   bin_val_t v;
+   if (!bin_get_number(ds, v, false)) {
+      val = 0;
+      return false;
+   }
+   bool ok = true;
+   long long x = 0;
+   switch (v.kind) {
+    case bin_val_t::INT:
+      x = v.i;
+      break;
+    case bin_val_t::UINT:
+      ok = (v.u <= (unsigned long long)hi);
+      x  = ok ? (long long)v.u : hi;
+      break;
+    default:
+      ok = (v.d >= lo && v.d <= hi);
+      x  = ok ? (long long)v.d : (v.d < lo) ? lo : hi;
+   }
+   if (x < lo || x > hi) {
+      ok = false;
+      x  = (x < lo) ? lo : hi;
+   }
+   val = (long)x;
+   if (!ok)
+      ds.istr()->setstate(ios::failbit);
+   return ok;
+}
+
+static bool
+bin_get_ulong(STDdstream& ds, unsigned long& val, unsigned long hi)
+{
+   // As in text, negative numbers are negated in the unsigned type:
+   bin_val_t v;
+   if (!bin_get_number(ds, v, false)) {
+      val = 0;
+      return false;
+   }
+   bool ok = true;
+   unsigned long long x = 0;
+   switch (v.kind) {
+    case bin_val_t::INT:
+      ok = (v.i >= 0) ? ((unsigned long long)v.i <= hi) : (0ULL - v.i <= hi);
+      x  = ok ? ((unsigned long long)v.i & hi) : hi;
+      break;
+    case bin_val_t::UINT:
+      ok = (v.u <= hi);
+      x  = ok ? v.u : hi;
+      break;
+    default:
+      ok = (v.d > -1 && v.d <= hi);
+      x  = ok ? (unsigned long long)v.d : hi;
+   }
+   val = (unsigned long)x;
+   if (!ok)
+      ds.istr()->setstate(ios::failbit);
+   return ok;
+}
+
+static bool
+bin_get_double(STDdstream& ds, double& val)
+{
+   bin_val_t v;
+   if (!bin_get_number(ds, v, true)) {
+      val = 0;
+      return false;
+   }
+   switch (v.kind) {
+    case bin_val_t::INT:  val = (double)v.i; break;
+    case bin_val_t::UINT: val = (double)v.u; break;
+    default:              val = v.d;
+   }
+   return true;
+}
+
+static bool
+bin_get_char(STDdstream& ds, char& ch)
+{
+   // Delimiters and one character values read as a char:
+   istream* is = ds.istr();
+   bin_val_t v;
+   string    s;
+   if (!bin_get(is, ds.swap_bytes(), v, s))
+      return false;
+   if (v.tag == '{' || v.tag == '}') {
+      is->rdbuf()->sbumpc();
+      ch = v.tag;
+      return true;
+   }
+   if (v.tag == '[')
+      bin_skip_block(ds);
+   string str = (v.kind == bin_val_t::NONE) ? string() : bin_text(v, s);
+   if (str.size() != 1) {
+      is->setstate(ios::failbit);
+      return false;
+   }
+   ch = str[0];
+   return true;
+}
+
+static bool
+bin_get_string(STDdstream& ds, string& str)
+{
+   // Any value reads as a string; a block (which text
+   // doesn't have) reads as "[]":
+   istream* is = ds.istr();
+   bin_val_t v;
+   if (!bin_get(is, ds.swap_bytes(), v, str))
+      return false;
+   if (v.tag == '{' || v.tag == '}') {
+      is->rdbuf()->sbumpc();
+      str = string(1, v.tag);
+   } else if (v.tag == '[') {
+      bin_skip_block(ds);
+      str = "[]";
+   } else if (v.kind != bin_val_t::STRING) {
+      str = bin_text(v, str);
+   }
+   return !is->fail();
+}
+
+void
+STDdstream::set_binary()
+{
+   ostream* os = ostr();
+   if (_bin_out || !os)
+      return;
+   bin_write(os, BIN_MAGIC, sizeof(BIN_MAGIC));
+   bin_put(os, host_order());
+   _bin_out = true;
+   _fail = os->fail();
+}
+
+bool
+STDdstream::check_binary()
+{
+   // Nothing to look at yet means check again on the next read:
+   istream* is = istr();
+   if (!is || !is->good() || is->rdbuf()->sgetc() == EOF)
+      return false;
+   _bin_in = 0;
+   if (is->rdbuf()->sgetc() != 0)
+      return false;
+
+   char head[sizeof(BIN_MAGIC) + 1];
+   if (!bin_read_bytes(is, head, sizeof(head)) ||
+       memcmp(head, BIN_MAGIC, sizeof(BIN_MAGIC)) != 0 ||
+       (head[sizeof(BIN_MAGIC)] != 'l' && head[sizeof(BIN_MAGIC)] != 'b')) {
+      cerr << "STDdstream::check_binary: error: bad binary header"
+           << (_name.empty() ? "" : " in ") << _name << endl;
+      is->setstate(ios::failbit);
+      return false;
+   }
+   _bin_in = 1;
+   _swap   = (head[sizeof(BIN_MAGIC)] != host_order());
+   return true;
+}
+
+void
+STDdstream::write_block(char type, int comps, size_t num, const void* data)
+{
+   ostream* os = ostr();
+   bin_put(os, '[');
+   bin_put(os, type, (uint32_t)comps);
+   uint64_t n = num;
+   bin_write(os, &n, sizeof(n));
+   bin_write(os, data, num*comps*bin_size(type));
+   _fail = os->fail();
+}
+
+bool
+STDdstream::next_block(char& type, int& comps, size_t& num)
+{
+   istream* is = istr();
+   if (!binary_in() || !is->good() || bin_peek(is) != '[')
+      return false;
+   is->rdbuf()->sbumpc();
+   int t = is->rdbuf()->sbumpc();
+   uint32_t c = 0;
+   uint64_t n = 0;
+   if (!bin_read(is, _swap, c) || !bin_read(is, _swap, n) ||
+       (t != 'd' && t != 'f' && t != 'i')) {
+      is->setstate(ios::failbit);
+      _fail = true;
+      return false;
+   }
+   type  = (char)t;
+   comps = (int)c;
+   num   = (size_t)n;
+   return true;
+}
+
+bool
+STDdstream::read_block(char from, char to, size_t count, void* data)
+{
+   istream* is = istr();
+   size_t fsize = bin_size(from), tsize = bin_size(to);
+   if (from == to) {
+      if (!bin_read_bytes(is, data, count*fsize))
+         return !(_fail = true);
+      if (_swap)
+         bin_swap((char*)data, fsize, count);
+      return true;
+   }
+
+   // Convert a buffer full at a time:
+   char  buf[4096];
+   char* out = (char*)data;
+   for (size_t done = 0; done < count; ) {
+      size_t n = min(count - done, sizeof(buf)/fsize);
+      if (!bin_read_bytes(is, buf, n*fsize))
+         return !(_fail = true);
+      if (_swap)
+         bin_swap(buf, fsize, n);
+      for (size_t k = 0; k < n; k++, out += tsize) {
+         double x;
+         switch (from) {
+          case 'd': memcpy(&x, buf + 8*k, 8); break;
+          case 'f': { float   f; memcpy(&f, buf + 4*k, 4); x = f; } break;
+          default:  { int32_t i; memcpy(&i, buf + 4*k, 4); x = i; }
+         }
+         switch (to) {
+          case 'd': memcpy(out, &x, 8); break;
+          case 'f': { float   f = (float)x;   memcpy(out, &f, 4); } break;
+          default:  { int32_t i = (int32_t)x; memcpy(out, &i, 4); }
+         }
+      }
+      done += n;
+   }
+   return true;
+}
+
 /* -------------------------------------------------------------------------
  * DESCR   :	Checks if the next input character is the end delimiter.
  * ------------------------------------------------------------------------- */
@@ -122,6 +895,14 @@ bool
 STDdstream::check_end_delim()
 {
    int brace;
+   if (binary_in())
+      return bin_peek(istr()) != '}';
+   if (fast_reads()) {
+      brace = istr()->good() ? skip_space(istr(), istr()->rdbuf()) : EOF;
+      if (brace == EOF)
+         istr()->setstate(ios::failbit);
+      return brace != '}';
+   }
    std::istream::sentry s(*istr(), false);
    if (s)
       brace = istr()->rdbuf()->sgetc();
@@ -155,6 +936,22 @@ STDdstream::write_delim(char c)
 string
 STDdstream::get_string_with_spaces()
 {
+   if (binary_in()) {
+      // The values up to a delimiter or line break:
+      string ret, s;
+      bin_val_t v;
+      for (;;) {
+         int c = istr()->good() ? istr()->rdbuf()->sgetc() : EOF;
+         if (c == EOF || c == '\n' || c == '{' || c == '}' || c == '[' ||
+             !bin_get(istr(), _swap, v, s))
+            break;
+         if (!ret.empty())
+            ret += ' ';
+         ret += bin_text(v, s);
+      }
+      return ret;
+   }
+
    const int bufsize = 1024;
    char buf[bufsize];
    int  i = 0;
@@ -212,9 +1009,11 @@ operator << (STDdstream &ds, NETenum m)
    switch (m) {
       case NETflush:
       {
-         *ds.ostr() << endl;
+         if (!ds.binary_out())
+            *ds.ostr() << endl;
          ds.ostr()->flush();
       }
+      // fall through
       default: {
          int x(m);
          ds << x;
@@ -229,6 +1028,13 @@ operator << (STDdstream &ds, NETenum m)
 STDdstream &
 operator >> (STDdstream &ds, char * &data)
 {  
+   if (ds.binary_in()) {
+      string str;
+      ds._fail = !bin_get_string(ds, str);
+      if (!ds._fail)
+         strcpy(data, str.c_str());
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -237,6 +1043,11 @@ operator >> (STDdstream &ds, char * &data)
 STDdstream &
 operator << (STDdstream &ds, const char * const data)
 {
+   if (ds._bin_out) {
+      bin_put_text(ds.ostr(), data, strlen(data));
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data;
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -248,6 +1059,15 @@ operator << (STDdstream &ds, const char * const data)
 STDdstream &
 operator >> (STDdstream &ds, string &data)
 {  
+   if (ds.binary_in()) {
+      ds._fail = !bin_get_string(ds, data);
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      ds._fail = !ds.get_token(data);
+      return ds;
+   }
+
    const int buflen = 4096;
    char      buff[buflen];
    char     *usebuff = buff;
@@ -262,6 +1082,11 @@ operator >> (STDdstream &ds, string &data)
 STDdstream &
 operator << (STDdstream &ds, const string &data)
 {
+   if (ds._bin_out) {
+      bin_put_text(ds.ostr(), data.data(), data.size());
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data.c_str() << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -273,6 +1098,18 @@ operator << (STDdstream &ds, const string &data)
 STDdstream &
 operator >> (STDdstream &ds, short &data)
 {  
+   if (ds.binary_in()) {
+      long val = data;
+      ds._fail = !bin_get_long(ds, val, SHRT_MIN, SHRT_MAX);
+      data = (short)val;
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      long val = data;
+      ds._fail = !ds.get_long(val, SHRT_MIN, SHRT_MAX);
+      data = (short)val;
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -280,6 +1117,11 @@ operator >> (STDdstream &ds, short &data)
 STDdstream &
 operator << (STDdstream &ds, short data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'h', (int16_t)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -291,6 +1133,18 @@ operator << (STDdstream &ds, short data)
 STDdstream &
 operator >> (STDdstream &ds, int &data)
 {  
+   if (ds.binary_in()) {
+      long val = data;
+      ds._fail = !bin_get_long(ds, val, INT_MIN, INT_MAX);
+      data = (int)val;
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      long val = data;
+      ds._fail = !ds.get_long(val, INT_MIN, INT_MAX);
+      data = (int)val;
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -298,6 +1152,11 @@ operator >> (STDdstream &ds, int &data)
 STDdstream &
 operator << (STDdstream &ds, int data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'i', (int32_t)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -309,6 +1168,14 @@ operator << (STDdstream &ds, int data)
 STDdstream &
 operator >> (STDdstream &ds, long &data)
 {  
+   if (ds.binary_in()) {
+      ds._fail = !bin_get_long(ds, data, LONG_MIN, LONG_MAX);
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      ds._fail = !ds.get_long(data, LONG_MIN, LONG_MAX);
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -316,6 +1183,11 @@ operator >> (STDdstream &ds, long &data)
 STDdstream &
 operator << (STDdstream &ds, long data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'l', (int64_t)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -327,6 +1199,18 @@ operator << (STDdstream &ds, long data)
 STDdstream &
 operator >> (STDdstream &ds, unsigned short &data)
 {  
+   if (ds.binary_in()) {
+      unsigned long val = data;
+      ds._fail = !bin_get_ulong(ds, val, USHRT_MAX);
+      data = (unsigned short)val;
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      unsigned long val = data;
+      ds._fail = !ds.get_ulong(val, USHRT_MAX);
+      data = (unsigned short)val;
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -334,6 +1218,11 @@ operator >> (STDdstream &ds, unsigned short &data)
 STDdstream &
 operator << (STDdstream &ds, unsigned short data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'H', (uint16_t)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -345,6 +1234,18 @@ operator << (STDdstream &ds, unsigned short data)
 STDdstream &
 operator >> (STDdstream &ds, unsigned int &data)
 {  
+   if (ds.binary_in()) {
+      unsigned long val = data;
+      ds._fail = !bin_get_ulong(ds, val, UINT_MAX);
+      data = (unsigned int)val;
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      unsigned long val = data;
+      ds._fail = !ds.get_ulong(val, UINT_MAX);
+      data = (unsigned int)val;
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -352,6 +1253,11 @@ operator >> (STDdstream &ds, unsigned int &data)
 STDdstream &
 operator << (STDdstream &ds, unsigned int data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'I', (uint32_t)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -363,6 +1269,14 @@ operator << (STDdstream &ds, unsigned int data)
 STDdstream &
 operator >> (STDdstream &ds, unsigned long &data)
 {  
+   if (ds.binary_in()) {
+      ds._fail = !bin_get_ulong(ds, data, ULONG_MAX);
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      ds._fail = !ds.get_ulong(data, ULONG_MAX);
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -370,6 +1284,11 @@ operator >> (STDdstream &ds, unsigned long &data)
 STDdstream &
 operator << (STDdstream &ds, unsigned long data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'L', (uint64_t)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -381,6 +1300,16 @@ operator << (STDdstream &ds, unsigned long data)
 STDdstream &
 operator >> (STDdstream &ds, float &temp)
 {  
+   if (ds.binary_in()) {
+      double val;
+      ds._fail = !bin_get_double(ds, val);
+      temp = (float)val;
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      ds._fail = !ds.get_float(temp);
+      return ds;
+   }
    *ds.istr() >> temp;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -388,6 +1317,11 @@ operator >> (STDdstream &ds, float &temp)
 STDdstream &
 operator << (STDdstream &ds, float data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'f', data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -399,6 +1333,14 @@ operator << (STDdstream &ds, float data)
 STDdstream &
 operator >> (STDdstream &ds, double &data)
 {  
+   if (ds.binary_in()) {
+      ds._fail = !bin_get_double(ds, data);
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      ds._fail = !ds.get_double(data);
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -406,6 +1348,11 @@ operator >> (STDdstream &ds, double &data)
 STDdstream &
 operator << (STDdstream &ds, double data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'd', (double)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -417,6 +1364,14 @@ operator << (STDdstream &ds, double data)
 STDdstream &
 operator >> (STDdstream &ds, char &data)
 {  
+   if (ds.binary_in()) {
+      ds._fail = !bin_get_char(ds, data);
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      ds._fail = !ds.get_char(data);
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -424,6 +1379,15 @@ operator >> (STDdstream &ds, char &data)
 STDdstream &
 operator << (STDdstream &ds, char data)
 {
+   if (ds._bin_out) {
+      // delimiters and line breaks as in strings:
+      if (data == '{' || data == '}' || data == '\n')
+         bin_put(ds.ostr(), data);
+      else if (!isspace((unsigned char)data))
+         bin_put(ds.ostr(), 'c', data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -435,6 +1399,18 @@ operator << (STDdstream &ds, char data)
 STDdstream &
 operator >> (STDdstream &ds, unsigned char &data)
 {  
+   if (ds.binary_in()) {
+      char c = data;
+      ds._fail = !bin_get_char(ds, c);
+      data = (unsigned char)c;
+      return ds;
+   }
+   if (STDdstream::fast_reads()) {
+      char c = data;
+      ds._fail = !ds.get_char(c);
+      data = (unsigned char)c;
+      return ds;
+   }
    *ds.istr() >> data;
    ds._fail = ds.istr()->fail();
    return ds;
@@ -442,6 +1418,11 @@ operator >> (STDdstream &ds, unsigned char &data)
 STDdstream &
 operator << (STDdstream &ds, unsigned char data)
 {
+   if (ds._bin_out) {
+      bin_put(ds.ostr(), 'C', (uint8_t)data);
+      ds._fail = ds.ostr()->fail();
+      return ds;
+   }
    *ds.ostr() << data << " ";
    ds._fail = ds.ostr()->fail();
    return ds;
@@ -99,12 +99,61 @@ class STDdstream {
    // using a binary stream, but different when doing ascii
    string get_string_with_spaces();
 
+   // Read values straight from the stream buffer instead of through
+   // istream extraction (the values and stream states are the same;
+   // see stream.cpp). Set with JOT_FAST_DSTREAM_READS (default: on):
+   static bool fast_reads();
+   static void set_fast_reads(bool b) { _fast_reads = b ? 1 : 0; }
+
+   //******** BINARY ENCODING ********
+
+   // Write everything after this in binary (see stream.cpp). It
+   // writes the header that readers detect, so call it before
+   // writing anything else. Streams opened on a file without the
+   // ascii flag are binary from the start:
+   void    set_binary();
+   bool    binary_out()                 const { return _bin_out; }
+
+   // Whether the input is binary, i.e. starts with the header
+   // (checked on the first read):
+   bool    binary_in() { return (_bin_in < 0) ? check_binary() : _bin_in == 1; }
+
+   // Whether binary input was written with the other byte order:
+   bool    swap_bytes()                 const { return _swap; }
+
+   // Blocks of scalars, read and written in bulk. 'type' is 'd'
+   // (double), 'f' (float) or 'i' (int); each of the 'num' elements
+   // has 'comps' scalars:
+   void    write_block(char type, int comps, size_t num, const void* data);
+
+   // If the next input is a block, takes its header and returns
+   // true; its 'count' scalars must be read next with read_block(),
+   // which converts them to the given type if needed:
+   bool    next_block(char& type, int& comps, size_t& num);
+   bool    read_block(char from, char to, size_t count, void* data);
+
  protected:
 
    iostream*    _iostream;      // iostream, may be null
    istream*     _istream;       // just an in stream (used when iostream is null)
    ostream*     _ostream;       // just an out stream (used when iostream is null)
    int          _indent;
+   bool         _bin_out;       // writing binary
+   int          _bin_in;        // reading binary (-1 until checked)
+   bool         _swap;          // binary input has the other byte order
+
+   static int   _fast_reads;    // -1 until read from config
+
+   // Fast reads: one value each, false on failure:
+   bool    get_token (string& s);
+   bool    get_char  (char& c);
+   int     get_number(char* buf, int size, bool real);
+   bool    get_long  (long& val, long lo, long hi);
+   bool    get_ulong (unsigned long& val, unsigned long hi);
+   bool    get_double(double& val);
+   bool    get_float (float& val);
+
+   bool    check_binary();
 
  private:
    string       _name;
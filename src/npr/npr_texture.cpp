@@ -51,6 +51,12 @@ bool NPRTexture::_show_coats = true;
 
 static bool ZX_NEW_BRANCH = Config::get_var_bool("ZX_NEW_BRANCH",true,true);
 
+// The .npr file named by an "npr_data_file" tag is scanned for the
+// (texture) files it names, to read them ahead of time (see
+// IOManager::prefetch()):
+static bool npr_prefetch_added =
+   (IOManager::add_prefetch_include("npr_data_file", ".npr"), true);
+
 /////////////////////////////////////
 // Constructor
 /////////////////////////////////////
@@ -1457,9 +1463,10 @@ NPRTexture::get_see_thru_flags (TAGformat &d)
 
    *d >> n;
 
-   assert(n == ZXFLAG_NUM);
+   // Files written before more flags were added have fewer:
+   assert(n <= ZXFLAG_NUM);
 
-   for (int i=0; i<ZXFLAG_NUM; i++) {
+   for (int i=0; i<n; i++) {
       int f;
       *d >> f;
       _see_thru_flags[i] = (f==1);
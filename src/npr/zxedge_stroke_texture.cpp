@@ -21,6 +21,7 @@
 */
 #include <cmath>
 #include "mesh/lmesh.hpp"
+#include "mesh/adaptive_subdiv.hpp"
 #include "npr/npr_view.hpp"
 #include "zxedge_stroke_texture.hpp"
 // Must have std/support.hpp (actually windows.h) before gl.h so
@@ -82,6 +83,7 @@ ZXedgeStrokeTexture::ZXedgeStrokeTexture(Patch* patch) :
       OGLTexture(patch),
       _stroke_3d(nullptr),
       _polyline(nullptr),
+      _feature_line_kinds(FeatureLines::SUGGESTIVE),
       _pix_to_ndc_scale(0),
       _vis_sampling(2),
       _stroke_sampling(6),
@@ -119,6 +121,7 @@ ZXedgeStrokeTexture::ZXedgeStrokeTexture(CLMESHptr& mesh) :
       OGLTexture(nullptr),
       _stroke_3d(nullptr),
       _polyline(nullptr),
+      _feature_line_kinds(FeatureLines::SUGGESTIVE),
       _pix_to_ndc_scale(0),
       _vis_sampling(2),
       _stroke_sampling(6),
@@ -346,6 +349,8 @@ ZXedgeStrokeTexture::sil_path_preprocess_seethru()
       add_creases_to_sils();
    if ( type_is_enabled(STYPE_BORDER) )
       add_borders_to_sils();
+   if ( type_is_enabled(STYPE_SUGLINE) )
+      add_suglines_to_sils();
    if (type_is_enabled(STYPE_WPATH) )
       add_wpath_to_sils();
    if (type_is_enabled(STYPE_POLYLINE) )
@@ -626,6 +631,8 @@ ZXedgeStrokeTexture::sil_path_preprocess()
       add_creases_to_sils();
    if ( type_is_enabled(STYPE_BORDER) )
       add_borders_to_sils();
+   if ( type_is_enabled(STYPE_SUGLINE) )
+      add_suglines_to_sils();
 
 
    const Wtransf& ndc_xform =     get_obj_to_ndc(_patch, _mesh);
@@ -1615,6 +1622,32 @@ ZXedgeStrokeTexture::add_borders_to_sils()
       add_to_sils(*borders, STYPE_BORDER);
 }
 
+void
+ZXedgeStrokeTexture::add_suglines_to_sils()
+{
+   // Add suggestive contours etc. on the current mesh (in case of
+   // subdivision), kept to the current patch:
+
+   if (!_patch || !_feature_line_kinds)
+      return;
+   Patch* p = _patch->cur_patch();
+   BMESHptr mesh = p ? p->mesh() : nullptr;
+   if (!mesh)
+      return;
+
+   // With adaptive subdivision, on the faces drawn at each level:
+   LMESHptr lmesh = dynamic_pointer_cast<LMESH>(mesh);
+   if (lmesh && lmesh->adaptive()) {
+      lmesh->adaptive()->extract_feature_lines(p, _feature_line_kinds,
+                                               _pre_zx_segs, VIEW::stamp());
+      return;
+   }
+
+   // The mesh keeps what the patches share, once per frame:
+   mesh->feature_lines().extract(mesh, mesh->eye_local(), _feature_line_kinds,
+                                 _pre_zx_segs, p, VIEW::stamp());
+}
+
 void
 ZXedgeStrokeTexture::add_wpath_to_sils()
 { 
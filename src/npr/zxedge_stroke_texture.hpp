@@ -22,6 +22,7 @@
 #include "gtex/ref_image.hpp"
 #include "mesh/uv_data.hpp"
 #include "mesh/bsimplex.hpp"
+#include "mesh/feature_lines.hpp"
 #include "stroke/base_stroke.hpp"
 
 #include <vector>
@@ -55,6 +56,7 @@ enum {ZXFLAG_SIL_VISIBLE=0, ZXFLAG_SIL_HIDDEN,   ZXFLAG_SIL_OCCLUDED,
       ZXFLAG_BF_SIL_VISIBLE, ZXFLAG_BF_SIL_HIDDEN,  ZXFLAG_BF_SIL_OCCLUDED,
       ZXFLAG_BORDER_VISIBLE, ZXFLAG_BORDER_HIDDEN,  ZXFLAG_BORDER_OCCLUDED,
       ZXFLAG_CREASE_VISIBLE, ZXFLAG_CREASE_HIDDEN,  ZXFLAG_CREASE_OCCLUDED,
+      ZXFLAG_SUGLINE_VISIBLE, ZXFLAG_SUGLINE_HIDDEN, ZXFLAG_SUGLINE_OCCLUDED,
       ZXFLAG_NUM };
 
 
@@ -830,6 +832,8 @@ protected:
    CEdgeStrip*                  _stroke_3d;     // if there is no patch, we use EdgeStrip
    mlib::CWpt_list*             _polyline;      // if we don't have a EdgeStrip,
                                                 // we might have a polyline
+   int                          _feature_line_kinds; // FeatureLines kinds drawn
+                                                     // as STYPE_SUGLINE
    vector<ZXseg>                _pre_zx_segs;
    NDCSilPath                   _ref_segs;
    NDCSilPath                   _sil_segs;   
@@ -980,6 +984,10 @@ protected:
 
    void add_polyline_to_sils();
 
+   // Add suggestive contours (or the kinds of feature lines set
+   // with set_feature_line_kinds()), found in object space:
+   void add_suglines_to_sils();
+
    // Add given edge strip to the list of valid silhouettes:
    void add_to_sils(CEdgeStrip& strip, int type, double angle=-1.0);  //we need to indicate the type now because the zx_sils need to be marked.
 
@@ -1002,6 +1010,11 @@ public:
    double   get_crease_max_bend_angle() const           { return _crease_max_bend_angle;    }
    void     set_crease_max_bend_angle(double a)         { _crease_max_bend_angle = a;       }
 
+   // Kinds of lines (FeatureLines::SUGGESTIVE etc.) drawn as
+   // suglines; suggestive contours by default:
+   int      get_feature_line_kinds() const              { return _feature_line_kinds;       }
+   void     set_feature_line_kinds(int k)               { _feature_line_kinds = k;          }
+
    // Number of points tested for visibility for each one added
    // to a stroke. Useful for stepping along pre-processed
    // _npoints array. (I.e. _npoints is already sampled at
@@ -85,6 +85,13 @@ Bbase::key()
    return k;
 }
 
+int
+Bbase::slot()
+{
+   static int s = SimplexData::register_slot(key());
+   return s;
+}
+
 void
 Bbase::delete_elements()
 {
@@ -127,9 +127,12 @@ class Bbase : public Bnode, public RefImageClient, public BMESHobs {
    // for SimplexData lookup:
    static uintptr_t key();
 
+   // The lookup slot for boss memes (see SimplexData::register_slot()):
+   static int slot();
+
    // Returns the boss meme (if any) on the given simplex:
    static Meme* find_boss_meme(CBsimplex* s) {
-      return s ? (Meme*)s->find_data(key()) : nullptr;
+      return s ? (Meme*)s->find_data(key(), slot()) : nullptr;
    }
 
    // Convenience -- does casts:
@@ -72,7 +72,7 @@ Meme::take_charge()
    assert(!Bbase::find_boss_meme(_simplex));
 
    // Set our lookup key to the boss ID:
-   _id = Bbase::key();
+   set_id(Bbase::key());
 
    bbase()->invalidate();
 
@@ -101,7 +101,7 @@ Meme::get_demoted()
    assert(!_simplex->find_data((uintptr_t)_owner));
 
    // make the switch
-   _id = (uintptr_t)_owner;
+   set_id((uintptr_t)_owner);
 
    // Notify Bbase
    bbase()->invalidate();
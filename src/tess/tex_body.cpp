@@ -37,6 +37,12 @@ HaloBase* HaloBase::_instance    = nullptr;
 
 static int foo = DECODER_ADD(TEXBODY);
 
+// The files named by "mesh_data_file" tags are read before the
+// scene is decoded (see IOManager::prefetch()); the meshes are
+// decoded from them in get_mesh_data_file():
+static bool prefetch_mesh_added =
+   (IOManager::add_prefetch_tag("mesh_data_file", IOManager::read_bytes), true);
+
 //******** CONSTRUCTORS ********
 TEXBODY::TEXBODY() :
    _apply_xf(0),
@@ -763,13 +769,19 @@ TEXBODY::get_mesh_data_file(TAGformat &d)
    } else {
       _mesh_file = filename;
       string fname = IOManager::load_prefix() + _mesh_file;
+      // the file's contents, if read ahead of time:
+      shared_ptr<string> pre =
+         static_pointer_cast<string>(IOManager::take_prefetched(fname));
       if (debug_io) {
          cerr << "TEXBODY::get_mesh_data_file: file: "
               << filename
               << ", path: "
-              << fname << endl;
+              << fname << (pre ? " (prefetched)" : "") << endl;
       }
-      cur->read_file(fname.c_str());
+      if (pre)
+         cur->read_data(*pre);
+      else
+         cur->read_file(fname.c_str());
    }
 }
 
@@ -21,6 +21,9 @@
 #ifndef WIN32
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 //////////////////////////////////////////////////////
@@ -223,3 +226,67 @@ vector<string> dir_list(const string &path)
    return list;
 }
 
+
+//////////////////////////////////////////////////////
+// MappedFile
+//////////////////////////////////////////////////////
+bool
+MappedFile::open(const string &path)
+{
+   close();
+
+#ifdef WIN32
+   FILE* f = fopen(path.c_str(), "rb");
+   if (!f)
+      return false;
+   fseek(f, 0, SEEK_END);
+   long n = ftell(f);
+   fseek(f, 0, SEEK_SET);
+   _buf.resize(n > 0 ? n : 0);
+   bool ok = (n >= 0 && fread(_buf.data(), 1, _buf.size(), f) == _buf.size());
+   fclose(f);
+   if (!ok)
+      return false;
+   _data = _buf.data();
+   _size = _buf.size();
+#else
+   int fd = ::open(path.c_str(), O_RDONLY);
+   if (fd < 0)
+      return false;
+   struct stat statbuf;
+   if (fstat(fd, &statbuf) != 0) {
+      ::close(fd);
+      return false;
+   }
+   _size = statbuf.st_size;
+   if (_size > 0) {
+      void* p = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+         ::close(fd);
+         _size = 0;
+         return false;
+      }
+      madvise(p, _size, MADV_SEQUENTIAL);
+      _data   = (const char*)p;
+      _mapped = true;
+   } else {
+      _data = _buf.data();     // empty, but open
+   }
+   ::close(fd);                 // the mapping stays valid
+#endif
+
+   return true;
+}
+
+void
+MappedFile::close()
+{
+#ifndef WIN32
+   if (_mapped)
+      munmap((void*)_data, _size);
+#endif
+   _data   = nullptr;
+   _size   = 0;
+   _mapped = false;
+   _buf.clear();
+}
@@ -29,4 +29,34 @@ bool     chdir_(const string &);
 string   getcwd_();
 vector<string> dir_list(const string &path);
 
+/**********************************************************************
+ * MappedFile:
+ *
+ *    Read-only contents of a whole file, mapped into memory (on
+ *    WIN32, read into memory). Pages are loaded as they are read,
+ *    so big files can be used without a copy.
+ **********************************************************************/
+class MappedFile {
+ public:
+   MappedFile() : _data(nullptr), _size(0), _mapped(false) {}
+   ~MappedFile() { close(); }
+
+   // Map the file; returns false if it can't be opened or read:
+   bool open(const string &path);
+   void close();
+
+   const char* data() const { return _data; }
+   size_t      size() const { return _size; }
+
+ protected:
+   const char*  _data;
+   size_t       _size;
+   bool         _mapped;        // else _data is _buf
+   vector<char> _buf;
+
+ private:
+   MappedFile(const MappedFile&);
+   MappedFile& operator=(const MappedFile&);
+};
+
 #endif //FILE_H_IN_DA_HAUS
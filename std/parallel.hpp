@@ -0,0 +1,86 @@
+/*****************************************************************
+ * This file is part of jot-lib (or "jot" for short):
+ *   <http://code.google.com/p/jot-lib/>
+ * 
+ * jot-lib is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * jot-lib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with jot-lib.  If not, see <http://www.gnu.org/licenses/>.`
+ *****************************************************************/
+#ifndef PARALLEL_H_HAS_BEEN_INCLUDED
+#define PARALLEL_H_HAS_BEEN_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**********************************************************************
+ * parallel_num_threads:
+ *
+ *   Number of threads used by parallel_for(). Set with the
+ *   JOT_NUM_THREADS config variable (1 turns threading off);
+ *   defaults to the number of hardware threads.
+ **********************************************************************/
+int parallel_num_threads();
+
+/**********************************************************************
+ * parallel_for:
+ *
+ *   Calls f(begin, end) on disjoint ranges that together cover
+ *   [0, n), on up to parallel_num_threads() threads (including the
+ *   calling thread), and returns when all calls are done. Ranges
+ *   hold at least min_grain items, so small jobs stay on one
+ *   thread. f may read shared data freely but must only write
+ *   data belonging to its own range.
+ **********************************************************************/
+template <class F>
+void
+parallel_for(int n, int min_grain, const F& f)
+{
+   if (n <= 0)
+      return;
+   int num = std::min(parallel_num_threads(), n / std::max(min_grain, 1));
+   if (num <= 1) {
+      f(0, n);
+      return;
+   }
+   std::vector<std::thread> workers;
+   workers.reserve(num - 1);
+   for (int i = 1; i < num; i++)
+      workers.push_back(std::thread(f, int((long long)n*i/num),
+                                       int((long long)n*(i+1)/num)));
+   f(0, int(n/num));
+   for (auto& w : workers)
+      w.join();
+}
+
+/**********************************************************************
+ * parallel_jobs:
+ *
+ *   Calls f(i) once for each i in [0, n), on up to
+ *   parallel_num_threads() threads, and returns when all calls are
+ *   done. Unlike parallel_for(), jobs are handed out one at a time
+ *   in order, so it suits a few jobs of very uneven cost (e.g. one
+ *   per file to read).
+ **********************************************************************/
+template <class F>
+void
+parallel_jobs(int n, const F& f)
+{
+   std::atomic<int> next(0);
+   parallel_for(std::min(parallel_num_threads(), n), 1, [&](int, int) {
+      for (int i; (i = next++) < n; )
+         f(i);
+   });
+}
+
+#endif // PARALLEL_H_HAS_BEEN_INCLUDED